@@ -0,0 +1,404 @@
+﻿#include "Benchmark.h"
+#include "../Src/Math/Batch/Transform.h"
+#include "../Src/Math/Batch/MatrixBatch.h"
+#include "../Src/Math/Batch/QuaternionBatch.h"
+#include "../Src/Math/Batch/TRSBatch.h"
+#include "../Src/Math/Batch/Palette.h"
+#include "../Src/Math/Batch/Culling.h"
+#include "../Src/Math/Batch/Hierarchy.h"
+#include "../Src/Math/Vector/VectorStream.h"
+#include <thread>
+
+/*
+配列版の関数
+	対応する単体演算と group / name / type を揃えて form だけ "batch" にする
+	(Transform は単体版の比較対象もここで登録する)
+
+視錐台カリング
+	1要素 = 1オブジェクト。画角90度・near 1・far 1000 の視錐台に対して、x, y が [-100, 100]、z が [-50, 150] に
+	散らばったオブジェクトを判定する (4割程度が可視)
+	"scalar" は Intersects をループで呼んで同じビットマスクを書く。"compact" はマスクから可視インデックスを詰める
+
+親子階層 (Hierarchy)
+	1要素 = 1ボーン。親は直前の8個以内から選び、元の並びは逆順にしておく (親が子より後ろに来る)
+	"scalar" は子の一覧を元の並びのまま再帰で辿る以前の方法、"batch" は FlattenHierarchy + LocalToWorld
+	local_to_world は 64 ボーンのスケルトンを count / 64 インスタンス、local_to_world_single は count ボーンの1階層
+*/
+namespace bench {
+	namespace {
+		using namespace mff;
+
+		//f(a, r, count)
+		template<typename A, typename R, typename F>
+		void AddUnaryBatch(const char* group, const char* name, const char* type, F f) {
+			AddCase(group, name, type, "batch", sizeof(A) + sizeof(R), [f](size_t count) -> Pass {
+				auto a = MakeArray<A>(count, 1);
+				auto r = std::make_shared<Array<R>>(count);
+				return [f, a, r]() {
+					f(a->data(), r->data(), a->size());
+					ClobberMemory();
+				};
+			});
+		}
+
+		//f(a, b, r, count)
+		template<typename A, typename B, typename R, typename F>
+		void AddBinaryBatch(const char* group, const char* name, const char* type, F f) {
+			AddCase(group, name, type, "batch", sizeof(A) + sizeof(B) + sizeof(R), [f](size_t count) -> Pass {
+				auto a = MakeArray<A>(count, 1);
+				auto b = MakeArray<B>(count, 2);
+				auto r = std::make_shared<Array<R>>(count);
+				return [f, a, b, r]() {
+					f(a->data(), b->data(), r->data(), a->size());
+					ClobberMemory();
+				};
+			});
+		}
+
+		template<int N>
+		std::shared_ptr<VectorStream<N>> MakeStream(size_t count, uint32_t seed) {
+			auto src = MakeArray<typename VectorStream<N>::Element>(count, seed);
+			return std::make_shared<VectorStream<N>>(src->data(), count);
+		}
+
+		//f(a, b, out) : VectorStream 同士の演算
+		template<int N, typename F>
+		void AddStreamBinary(const char* group, const char* name, F f) {
+			AddCase(group, name, "float", "batch", sizeof(float) * N * 3, [f](size_t count) -> Pass {
+				auto a = MakeStream<N>(count, 1);
+				auto b = MakeStream<N>(count, 2);
+				auto r = std::make_shared<VectorStream<N>>(count);
+				return [f, a, b, r]() {
+					f(*a, *b, *r);
+					ClobberMemory();
+				};
+			});
+		}
+
+		template<int N>
+		void RegisterStream(const char* group) {
+			using Stream = VectorStream<N>;
+			AddStreamBinary<N>(group, "add", [](const Stream& a, const Stream& b, Stream& r) { mff::Add(a, b, r); });
+			AddStreamBinary<N>(group, "sub", [](const Stream& a, const Stream& b, Stream& r) { mff::Sub(a, b, r); });
+			AddStreamBinary<N>(group, "mul", [](const Stream& a, const Stream& b, Stream& r) { mff::Mul(a, b, r); });
+			AddCase(group, "mul_scalar", "float", "batch", sizeof(float) * (N * 2 + 1), [](size_t count) -> Pass {
+				auto a = MakeStream<N>(count, 1);
+				auto r = std::make_shared<Stream>(count);
+				return [a, r]() {
+					Scale(*a, 0.25f, *r);
+					ClobberMemory();
+				};
+			});
+			AddCase(group, "muladd", "float", "batch", sizeof(float) * N * 4, [](size_t count) -> Pass {
+				auto a = MakeStream<N>(count, 1);
+				auto b = MakeStream<N>(count, 2);
+				auto c = MakeStream<N>(count, 3);
+				auto r = std::make_shared<Stream>(count);
+				return [a, b, c, r]() {
+					MulAdd(*a, *b, *c, *r);
+					ClobberMemory();
+				};
+			});
+			AddCase(group, "dot", "float", "batch", sizeof(float) * (N * 2 + 1), [](size_t count) -> Pass {
+				auto a = MakeStream<N>(count, 1);
+				auto b = MakeStream<N>(count, 2);
+				auto r = std::make_shared<Array<float>>(count);
+				return [a, b, r]() {
+					dot(*a, *b, r->data());
+					ClobberMemory();
+				};
+			});
+			AddCase(group, "normalize", "float", "batch", sizeof(float) * N * 2, [](size_t count) -> Pass {
+				auto a = MakeStream<N>(count, 1);
+				auto r = std::make_shared<Stream>(count);
+				return [a, r]() {
+					Normalize(*a, *r);
+					ClobberMemory();
+				};
+			});
+		}
+
+		void RegisterTransform() {
+			Matrix4x4<float> mat;
+			Random random(7);
+			Randomize(random, mat);
+			using V3 = Vector3<float>;
+			using V4 = Vector4<float>;
+
+			AddUnary<V3, V3>("Transform", "points_vec3", "float", [mat](const V3& v) {
+				const V4 r = mat * V4(v.x, v.y, v.z, 1.0f);
+				return V3(r.x, r.y, r.z);
+			});
+			AddUnary<V3, V3>("Transform", "directions_vec3", "float", [mat](const V3& v) {
+				const V4 r = mat * V4(v.x, v.y, v.z, 0.0f);
+				return V3(r.x, r.y, r.z);
+			});
+			AddUnary<V3, V3>("Transform", "normals_vec3", "float", [mat](const V3& v) {
+				const V4 r = mat * V4(v.x, v.y, v.z, 0.0f);
+				return Normalize(V3(r.x, r.y, r.z));
+			});
+			AddUnary<V4, V4>("Transform", "points_vec4", "float", [mat](const V4& v) { return mat * v; });
+
+			AddUnaryBatch<V3, V3>("Transform", "points_vec3", "float", [mat](const V3* src, V3* dst, size_t n) { TransformPoints(mat, src, dst, n); });
+			AddUnaryBatch<V3, V3>("Transform", "directions_vec3", "float", [mat](const V3* src, V3* dst, size_t n) { TransformDirections(mat, src, dst, n); });
+			AddUnaryBatch<V3, V3>("Transform", "normals_vec3", "float", [mat](const V3* src, V3* dst, size_t n) { TransformNormals(mat, src, dst, n); });
+			AddUnaryBatch<V4, V4>("Transform", "points_vec4", "float", [mat](const V4* src, V4* dst, size_t n) { TransformPoints(mat, src, dst, n); });
+			AddCase("Transform", "points_soa", "float", "batch", sizeof(float) * 6, [mat](size_t count) -> Pass {
+				auto in = MakeArray<float>(count * 3, 1);
+				auto out = std::make_shared<Array<float>>(count * 3);
+				return [mat, in, out, count]() {
+					const float* p = in->data();
+					float* o = out->data();
+					TransformPoints(mat, p, p + count, p + count * 2, o, o + count, o + count * 2, count);
+					ClobberMemory();
+				};
+			});
+		}
+
+		//clip = viewProj * (x, y, z, 1) の D3D 形式の透視投影 (カメラは原点で +z 向き)
+		Frustum<float> MakeCullingFrustum() {
+			const float n = 1.0f, f = 1000.0f;
+			const Matrix4x4<float> viewProj(
+				Vector4<float>(1, 0, 0, 0),
+				Vector4<float>(0, 1, 0, 0),
+				Vector4<float>(0, 0, f / (f - n), -n * f / (f - n)),
+				Vector4<float>(0, 0, 1, 0));
+			return ToFrustum(viewProj);
+		}
+
+		Vector3<float> RandomCenter(Random& random) {
+			return Vector3<float>(random.Range(-100, 100), random.Range(-100, 100), random.Range(-50, 150));
+		}
+
+		std::shared_ptr<Array<BoundingSphere<float>>> MakeSpheres(size_t count) {
+			auto ret = std::make_shared<Array<BoundingSphere<float>>>(count);
+			Random random(12);
+			for (auto& s : *ret) {
+				s = BoundingSphere<float>(RandomCenter(random), random.Range(0.5f, 2.0f));
+			}
+			return ret;
+		}
+
+		std::shared_ptr<Array<AABB<float>>> MakeBoxes(size_t count) {
+			auto ret = std::make_shared<Array<AABB<float>>>(count);
+			Random random(13);
+			for (auto& b : *ret) {
+				const Vector3<float> c = RandomCenter(random);
+				const Vector3<float> e(random.Range(0.5f, 2.0f), random.Range(0.5f, 2.0f), random.Range(0.5f, 2.0f));
+				b = AABB<float>(c - e, c + e);
+			}
+			return ret;
+		}
+
+		//オブジェクトごとに Intersects を呼んでビットマスクを書く
+		template<typename Bounds>
+		void CullScalar(const Frustum<float>& frustum, const Array<Bounds>& objects, uint32_t* mask) {
+			const size_t count = objects.size();
+			for (size_t w = 0; w < (count + 31) / 32; ++w) {
+				uint32_t bits = 0;
+				const size_t end = (w + 1) * 32 < count ? (w + 1) * 32 : count;
+				for (size_t i = w * 32; i < end; ++i) {
+					bits |= Intersects(frustum, objects[i]) ? 1u << (i & 31) : 0u;
+				}
+				mask[w] = bits;
+			}
+		}
+
+		void RegisterCulling() {
+			const Frustum<float> frustum = MakeCullingFrustum();
+			//bytesPerElement は入力の大きさ (ビットマスクは1要素 1/8 byte なので含めない)
+			AddCase("Culling", "spheres", "float", "scalar", sizeof(BoundingSphere<float>), [frustum](size_t count) -> Pass {
+				auto spheres = MakeSpheres(count);
+				auto mask = std::make_shared<Array<uint32_t>>((count + 31) / 32);
+				return [frustum, spheres, mask]() {
+					CullScalar(frustum, *spheres, mask->data());
+					ClobberMemory();
+				};
+			});
+			AddCase("Culling", "spheres", "float", "batch", sizeof(float) * 4, [frustum](size_t count) -> Pass {
+				auto spheres = MakeSpheres(count);
+				auto stream = std::make_shared<Vec4Stream>();
+				AssignBounds(spheres->data(), count, *stream);
+				auto mask = std::make_shared<Array<uint32_t>>((count + 31) / 32);
+				return [frustum, stream, mask]() {
+					CullSpheres(frustum, *stream, mask->data());
+					ClobberMemory();
+				};
+			});
+			AddCase("Culling", "boxes", "float", "scalar", sizeof(AABB<float>), [frustum](size_t count) -> Pass {
+				auto boxes = MakeBoxes(count);
+				auto mask = std::make_shared<Array<uint32_t>>((count + 31) / 32);
+				return [frustum, boxes, mask]() {
+					CullScalar(frustum, *boxes, mask->data());
+					ClobberMemory();
+				};
+			});
+			AddCase("Culling", "boxes", "float", "batch", sizeof(float) * 6, [frustum](size_t count) -> Pass {
+				auto boxes = MakeBoxes(count);
+				auto centers = std::make_shared<Vec3Stream>();
+				auto extents = std::make_shared<Vec3Stream>();
+				AssignBounds(boxes->data(), count, *centers, *extents);
+				auto mask = std::make_shared<Array<uint32_t>>((count + 31) / 32);
+				return [frustum, centers, extents, mask]() {
+					CullBoxes(frustum, *centers, *extents, mask->data());
+					ClobberMemory();
+				};
+			});
+			AddCase("Culling", "compact", "float", "batch", sizeof(uint32_t), [frustum](size_t count) -> Pass {
+				auto spheres = MakeSpheres(count);
+				Vec4Stream stream;
+				AssignBounds(spheres->data(), count, stream);
+				auto mask = std::make_shared<Array<uint32_t>>((count + 31) / 32);
+				CullSpheres(frustum, stream, mask->data());
+				auto indices = std::make_shared<Array<uint32_t>>(count);
+				return [mask, indices, count]() {
+					CompactVisible(mask->data(), count, indices->data());
+					ClobberMemory();
+				};
+			});
+		}
+
+		//親が子より後ろに来る boneCount 個の森
+		std::vector<int> MakeSkeleton(size_t boneCount, uint32_t seed) {
+			const int n = static_cast<int>(boneCount);
+			std::vector<int> parents(boneCount, -1);
+			Random random(seed);
+			for (int i = 1; i < n; ++i) {
+				//64 個に1つはルート
+				if (random.Next() % 64 == 0) {
+					continue;
+				}
+				const int window = i < 8 ? i : 8;
+				const int parent = i - 1 - static_cast<int>(random.Next() % window);
+				parents[n - 1 - i] = n - 1 - parent;
+			}
+			return parents;
+		}
+
+		//FlattenHierarchy を使わない比較用の再帰
+		struct SourceHierarchy {
+			explicit SourceHierarchy(const std::vector<int>& parents) : children(parents.size()) {
+				for (size_t i = 0; i < parents.size(); ++i) {
+					if (parents[i] < 0) {
+						roots.push_back(static_cast<int>(i));
+					}
+					else {
+						children[parents[i]].push_back(static_cast<int>(i));
+					}
+				}
+			}
+
+			void LocalToWorld(const Matrix4x4<float>* local, Matrix4x4<float>* world) const {
+				for (int root : roots) {
+					world[root] = local[root];
+					Propagate(root, local, world);
+				}
+			}
+
+			void Propagate(int bone, const Matrix4x4<float>* local, Matrix4x4<float>* world) const {
+				for (int child : children[bone]) {
+					world[child] = world[bone] * local[child];
+					Propagate(child, local, world);
+				}
+			}
+
+			std::vector<std::vector<int> > children;
+			std::vector<int> roots;
+		};
+
+		void RegisterHierarchy() {
+			using Mat = Matrix4x4<float>;
+			const size_t skeletonBones = 64;
+			AddCase("Hierarchy", "flatten", "int", "batch", sizeof(int) * 5, [](size_t count) -> Pass {
+				auto parents = std::make_shared<std::vector<int> >(MakeSkeleton(count, 21));
+				auto flat = std::make_shared<FlatHierarchy>();
+				return [parents, flat]() {
+					FlattenHierarchy(parents->data(), parents->size(), *flat);
+					ClobberMemory();
+				};
+			});
+			AddCase("Hierarchy", "local_to_world", "float", "scalar", sizeof(Mat) * 2, [skeletonBones](size_t count) -> Pass {
+				const size_t instances = (count + skeletonBones - 1) / skeletonBones;
+				auto hierarchy = std::make_shared<SourceHierarchy>(MakeSkeleton(skeletonBones, 22));
+				auto local = MakeArray<Mat>(instances * skeletonBones, 1);
+				auto world = std::make_shared<Array<Mat> >(instances * skeletonBones);
+				return [hierarchy, local, world, instances, skeletonBones]() {
+					for (size_t inst = 0; inst < instances; ++inst) {
+						hierarchy->LocalToWorld(local->data() + inst * skeletonBones, world->data() + inst * skeletonBones);
+					}
+					ClobberMemory();
+				};
+			});
+			AddCase("Hierarchy", "local_to_world", "float", "batch", sizeof(Mat) * 2, [skeletonBones](size_t count) -> Pass {
+				const size_t instances = (count + skeletonBones - 1) / skeletonBones;
+				const std::vector<int> parents = MakeSkeleton(skeletonBones, 22);
+				auto hierarchy = std::make_shared<FlatHierarchy>();
+				FlattenHierarchy(parents.data(), parents.size(), *hierarchy);
+				auto local = MakeArray<Mat>(instances * skeletonBones, 1);
+				auto world = std::make_shared<Array<Mat> >(instances * skeletonBones);
+				return [hierarchy, local, world, instances]() {
+					LocalToWorld(*hierarchy, local->data(), world->data(), instances);
+					ClobberMemory();
+				};
+			});
+			AddCase("Hierarchy", "local_to_world_single", "float", "scalar", sizeof(Mat) * 2, [](size_t count) -> Pass {
+				auto hierarchy = std::make_shared<SourceHierarchy>(MakeSkeleton(count, 23));
+				auto local = MakeArray<Mat>(count, 1);
+				auto world = std::make_shared<Array<Mat> >(count);
+				return [hierarchy, local, world]() {
+					hierarchy->LocalToWorld(local->data(), world->data());
+					ClobberMemory();
+				};
+			});
+			//ハードウェアスレッド数で部分木に分けて並列に処理する
+			AddCase("Hierarchy", "local_to_world_single", "float", "batch", sizeof(Mat) * 2, [](size_t count) -> Pass {
+				const std::vector<int> parents = MakeSkeleton(count, 23);
+				auto hierarchy = std::make_shared<FlatHierarchy>();
+				FlattenHierarchy(parents.data(), parents.size(), *hierarchy);
+				SplitSubtrees(*hierarchy, std::thread::hardware_concurrency());
+				auto local = MakeArray<Mat>(count, 1);
+				auto world = std::make_shared<Array<Mat> >(count);
+				return [hierarchy, local, world]() {
+					LocalToWorld(*hierarchy, local->data(), world->data(), 1, nullptr, 0);
+					ClobberMemory();
+				};
+			});
+		}
+
+		void RegisterMatrixBatch() {
+			using Mat = Matrix4x4<float>;
+			using Quat = Quaternion<float>;
+			AddUnaryBatch<Mat, Mat>("Matrix4x4", "inverse", "float", [](const Mat* src, Mat* dst, size_t n) { InverseMatrices(src, dst, n); });
+			AddUnaryBatch<Mat, Mat>("Matrix4x4", "affine_inverse", "float", [](const Mat* src, Mat* dst, size_t n) { AffineInverseMatrices(src, dst, n); });
+			//行列積の配列版はスキニング行列の生成 (world * baseInv) で測る
+			AddBinaryBatch<Mat, Mat, Mat>("Matrix4x4", "mul", "float", [](const Mat* a, const Mat* b, Mat* dst, size_t n) { BuildPalette(a, b, n, dst, PaletteLayout4x4); });
+
+			AddBinaryBatch<Quat, Quat, Quat>("Quaternion", "mul", "float", [](const Quat* a, const Quat* b, Quat* dst, size_t n) { MultiplyQuaternions(a, b, dst, n); });
+			AddBinaryBatch<Quat, Quat, Quat>("Quaternion", "nlerp", "float", [](const Quat* a, const Quat* b, Quat* dst, size_t n) { NlerpQuaternions(a, b, 0.25f, dst, n); });
+			AddBinaryBatch<Quat, Quat, Quat>("Quaternion", "slerp", "float", [](const Quat* a, const Quat* b, Quat* dst, size_t n) { SlerpQuaternions(a, b, 0.25f, dst, n); });
+			AddUnaryBatch<Quat, Mat>("Quaternion", "to_matrix", "float", [](const Quat* src, Mat* dst, size_t n) { QuaternionsToMatrices(src, dst, n); });
+
+			AddUnaryBatch<TRS<float>, Mat>("TRS", "compose", "float", [](const TRS<float>* src, Mat* dst, size_t n) { TRSToMatrices(src, dst, n); });
+			AddUnaryBatch<Mat, TRS<float>>("TRS", "decompose", "float", [](const Mat* src, TRS<float>* dst, size_t n) { DecomposeMatrices(src, dst, n); });
+		}
+	} // namespace
+
+	void RegisterBatchCases() {
+		RegisterTransform();
+		RegisterMatrixBatch();
+		RegisterCulling();
+		RegisterHierarchy();
+
+		RegisterStream<3>("Vector3");
+		AddStreamBinary<3>("Vector3", "cross", [](const Vec3Stream& a, const Vec3Stream& b, Vec3Stream& r) { cross(a, b, r); });
+		AddCase("Vector3", "length", "float", "batch", sizeof(float) * 4, [](size_t count) -> Pass {
+			auto a = MakeStream<3>(count, 1);
+			auto r = std::make_shared<Array<float>>(count);
+			return [a, r]() {
+				Length(*a, r->data());
+				ClobberMemory();
+			};
+		});
+		RegisterStream<4>("Vector4");
+	}
+} // namespace bench
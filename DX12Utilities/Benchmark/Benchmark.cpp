@@ -0,0 +1,346 @@
+﻿#include "Benchmark.h"
+#include "../Src/Math/Simd/Simd.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+/*
+使い方
+	MathBenchmark [--format=text|csv|json] [--out=path] [--filter=str] [--sizes=L1,L2,L3,DRAM]
+	              [--min-time=ms] [--repetitions=n] [--label=str] [--list]
+
+	--sizes       : 作業領域のサイズ。L1 (16KiB), L2 (256KiB), L3 (4MiB), DRAM (64MiB) か、
+	                K/M/G 接尾辞付きのバイト数 (例: 32K,1M)
+	--filter      : "group/name/type/form" に含まれる文字列で絞り込む
+	--min-time    : 1サンプルの最小計測時間 (既定 20ms)
+	--repetitions : サンプル数 (既定 5)。中央値・最小値・最大値を出力する
+	--label       : 出力に含める任意の文字列 (コミットハッシュなど)
+
+	CSV / JSON の各行は (group, name, type, form, size) で一意になるので、
+	コミット間の比較はこのキーで突き合わせればよい
+*/
+namespace bench {
+	std::vector<Case>& Cases() {
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void AddCase(const char* group, const char* name, const char* type, const char* form, size_t bytesPerElement, std::function<Pass(size_t count)> prepare) {
+		Cases().push_back(Case{ group, name, type, form, bytesPerElement, std::move(prepare) });
+	}
+
+	namespace {
+		struct Size {
+			std::string label;
+			size_t bytes;
+		};
+
+		struct Options {
+			std::string format = "text";
+			std::string out;
+			std::string filter;
+			std::string label;
+			std::vector<Size> sizes;
+			double minTimeMs = 20.0;
+			int repetitions = 5;
+			bool list = false;
+		};
+
+		struct Result {
+			const Case* benchCase;
+			const Size* size;
+			size_t elements;
+			uint64_t iterations;
+			double medianNs;
+			double minNs;
+			double maxNs;
+		};
+
+		std::string Key(const Case& c) {
+			return c.group + "/" + c.name + "/" + c.type + "/" + c.form;
+		}
+
+		const char* SimdName() {
+#if defined(MFF_SIMD_AVX)
+			return "avx";
+#elif defined(MFF_SIMD_SSE41)
+			return "sse4.1";
+#elif defined(MFF_SIMD_SSE)
+			return "sse2";
+#elif defined(MFF_SIMD_NEON)
+			return "neon";
+#else
+			return "scalar";
+#endif
+		}
+
+		std::string CompilerName() {
+			char buf[64];
+#if defined(__clang__)
+			snprintf(buf, sizeof(buf), "clang %d.%d.%d", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+			snprintf(buf, sizeof(buf), "gcc %d.%d.%d", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+			snprintf(buf, sizeof(buf), "msvc %d", _MSC_VER);
+#else
+			snprintf(buf, sizeof(buf), "unknown");
+#endif
+			return buf;
+		}
+
+		const char* PrecisionName() {
+#if defined(MFF_ACCURATE_PRECISION)
+			return "accurate";
+#else
+			return "float";
+#endif
+		}
+
+		//"16K" などをバイト数にする。失敗したら0
+		size_t ParseBytes(const std::string& s) {
+			char* end = nullptr;
+			const double v = strtod(s.c_str(), &end);
+			if (end == s.c_str() || !(v > 0)) {
+				return 0;
+			}
+			double scale = 1;
+			if (*end == 'K' || *end == 'k') {
+				scale = 1024.0;
+				++end;
+			}
+			else if (*end == 'M' || *end == 'm') {
+				scale = 1024.0 * 1024.0;
+				++end;
+			}
+			else if (*end == 'G' || *end == 'g') {
+				scale = 1024.0 * 1024.0 * 1024.0;
+				++end;
+			}
+			return *end == '\0' ? static_cast<size_t>(v * scale) : 0;
+		}
+
+		bool ParseSizes(const std::string& arg, std::vector<Size>& sizes) {
+			static const Size tiers[] = {
+				{ "L1", 16 * 1024 },
+				{ "L2", 256 * 1024 },
+				{ "L3", 4 * 1024 * 1024 },
+				{ "DRAM", 64 * 1024 * 1024 },
+			};
+			sizes.clear();
+			size_t begin = 0;
+			while (begin <= arg.size()) {
+				size_t end = arg.find(',', begin);
+				if (end == std::string::npos) {
+					end = arg.size();
+				}
+				const std::string token = arg.substr(begin, end - begin);
+				begin = end + 1;
+				if (token.empty()) {
+					continue;
+				}
+				const Size* tier = nullptr;
+				for (const Size& t : tiers) {
+					if (t.label == token) {
+						tier = &t;
+					}
+				}
+				if (tier) {
+					sizes.push_back(*tier);
+					continue;
+				}
+				const size_t bytes = ParseBytes(token);
+				if (bytes == 0) {
+					fprintf(stderr, "invalid size: %s\n", token.c_str());
+					return false;
+				}
+				sizes.push_back(Size{ token, bytes });
+			}
+			return !sizes.empty();
+		}
+
+		bool ParseOptions(int argc, char** argv, Options& options) {
+			ParseSizes("L1,L2,L3,DRAM", options.sizes);
+			for (int i = 1; i < argc; ++i) {
+				const std::string arg = argv[i];
+				const size_t eq = arg.find('=');
+				const std::string key = arg.substr(0, eq);
+				const std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+				if (key == "--format" && (value == "text" || value == "csv" || value == "json")) {
+					options.format = value;
+				}
+				else if (key == "--out") {
+					options.out = value;
+				}
+				else if (key == "--filter") {
+					options.filter = value;
+				}
+				else if (key == "--label") {
+					options.label = value;
+				}
+				else if (key == "--sizes") {
+					if (!ParseSizes(value, options.sizes)) {
+						return false;
+					}
+				}
+				else if (key == "--min-time" && atof(value.c_str()) > 0) {
+					options.minTimeMs = atof(value.c_str());
+				}
+				else if (key == "--repetitions" && atoi(value.c_str()) > 0) {
+					options.repetitions = atoi(value.c_str());
+				}
+				else if (key == "--list") {
+					options.list = true;
+				}
+				else {
+					fprintf(stderr, "unknown option: %s\n", arg.c_str());
+					return false;
+				}
+			}
+			return true;
+		}
+
+		using Clock = std::chrono::steady_clock;
+
+		double RunPasses(const Pass& pass, uint64_t iterations) {
+			const Clock::time_point begin = Clock::now();
+			for (uint64_t i = 0; i < iterations; ++i) {
+				pass();
+			}
+			return std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+		}
+
+		Result Measure(const Case& c, const Size& size, const Options& options) {
+			//SIMDの4要素単位に揃える
+			size_t count = (size.bytes / c.bytesPerElement) & ~static_cast<size_t>(3);
+			count = (std::max)(count, static_cast<size_t>(4));
+			const Pass pass = c.prepare(count);
+
+			//1サンプルが minTime 以上になる回数を探す (ウォームアップを兼ねる)
+			const double minTimeNs = options.minTimeMs * 1e6;
+			uint64_t iterations = 1;
+			for (;;) {
+				const double elapsed = RunPasses(pass, iterations);
+				if (elapsed >= minTimeNs) {
+					break;
+				}
+				const double scale = elapsed > 0 ? minTimeNs / elapsed * 1.2 : 10.0;
+				iterations = static_cast<uint64_t>(static_cast<double>(iterations) * (std::min)((std::max)(scale, 2.0), 100.0));
+			}
+
+			std::vector<double> samples;
+			for (int i = 0; i < options.repetitions; ++i) {
+				samples.push_back(RunPasses(pass, iterations) / (static_cast<double>(iterations) * static_cast<double>(count)));
+			}
+			std::sort(samples.begin(), samples.end());
+			const size_t mid = samples.size() / 2;
+			const double median = samples.size() % 2 ? samples[mid] : (samples[mid - 1] + samples[mid]) * 0.5;
+			return Result{ &c, &size, count, iterations, median, samples.front(), samples.back() };
+		}
+
+		//バイト / ns = GB/s
+		double Throughput(const Result& r) {
+			return static_cast<double>(r.benchCase->bytesPerElement) / r.medianNs;
+		}
+
+		std::string JsonString(const std::string& s) {
+			std::string ret = "\"";
+			for (char ch : s) {
+				if (ch == '"' || ch == '\\') {
+					ret += '\\';
+				}
+				ret += ch;
+			}
+			return ret + "\"";
+		}
+
+		void WriteHeader(FILE* fp, const Options& options) {
+			if (options.format == "csv") {
+				fprintf(fp, "group,name,type,form,size,working_set_bytes,elements,iterations,ns_per_element_median,ns_per_element_min,ns_per_element_max,gb_per_s\n");
+			}
+			else if (options.format == "json") {
+				fprintf(fp, "{\n  \"meta\": {\"label\": %s, \"compiler\": %s, \"simd\": \"%s\", \"precision\": \"%s\", \"repetitions\": %d, \"min_time_ms\": %g},\n  \"results\": [",
+					JsonString(options.label).c_str(), JsonString(CompilerName()).c_str(), SimdName(), PrecisionName(), options.repetitions, options.minTimeMs);
+			}
+			else {
+				fprintf(fp, "# %s, simd=%s, precision=%s%s%s\n", CompilerName().c_str(), SimdName(), PrecisionName(),
+					options.label.empty() ? "" : ", label=", options.label.c_str());
+				fprintf(fp, "%-44s %-6s %10s %12s %12s %10s\n", "case", "size", "elements", "ns/elem", "min", "GB/s");
+			}
+		}
+
+		void WriteResult(FILE* fp, const Options& options, const Result& r, bool first) {
+			const Case& c = *r.benchCase;
+			if (options.format == "csv") {
+				fprintf(fp, "%s,%s,%s,%s,%s,%zu,%zu,%llu,%.4f,%.4f,%.4f,%.3f\n", c.group.c_str(), c.name.c_str(), c.type.c_str(), c.form.c_str(),
+					r.size->label.c_str(), r.size->bytes, r.elements, static_cast<unsigned long long>(r.iterations), r.medianNs, r.minNs, r.maxNs, Throughput(r));
+			}
+			else if (options.format == "json") {
+				fprintf(fp, "%s\n    {\"group\": %s, \"name\": %s, \"type\": %s, \"form\": %s, \"size\": %s, \"working_set_bytes\": %zu, \"elements\": %zu, \"iterations\": %llu, "
+					"\"ns_per_element_median\": %.4f, \"ns_per_element_min\": %.4f, \"ns_per_element_max\": %.4f, \"gb_per_s\": %.3f}",
+					first ? "" : ",", JsonString(c.group).c_str(), JsonString(c.name).c_str(), JsonString(c.type).c_str(), JsonString(c.form).c_str(),
+					JsonString(r.size->label).c_str(), r.size->bytes, r.elements, static_cast<unsigned long long>(r.iterations), r.medianNs, r.minNs, r.maxNs, Throughput(r));
+			}
+			else {
+				fprintf(fp, "%-44s %-6s %10zu %12.3f %12.3f %10.2f\n", Key(c).c_str(), r.size->label.c_str(), r.elements, r.medianNs, r.minNs, Throughput(r));
+			}
+			fflush(fp);
+		}
+
+		void WriteFooter(FILE* fp, const Options& options) {
+			if (options.format == "json") {
+				fprintf(fp, "\n  ]\n}\n");
+			}
+		}
+	} // namespace
+} // namespace bench
+
+int main(int argc, char** argv) {
+	using namespace bench;
+	Options options;
+	if (!ParseOptions(argc, argv, options)) {
+		return 1;
+	}
+	RegisterVectorCases();
+	RegisterMatrixCases();
+	RegisterBatchCases();
+	RegisterMeshCases();
+	RegisterBvhCases();
+
+	std::vector<const Case*> selected;
+	for (const Case& c : Cases()) {
+		if (Key(c).find(options.filter) != std::string::npos) {
+			selected.push_back(&c);
+		}
+	}
+	if (options.list) {
+		for (const Case* c : selected) {
+			printf("%s\n", Key(*c).c_str());
+		}
+		return 0;
+	}
+
+	FILE* fp = stdout;
+	if (!options.out.empty()) {
+		fp = fopen(options.out.c_str(), "w");
+		if (!fp) {
+			fprintf(stderr, "cannot open %s\n", options.out.c_str());
+			return 1;
+		}
+	}
+	WriteHeader(fp, options);
+	bool first = true;
+	//サイズごとにまとめて回し、同じサイズの結果を並べる
+	for (const Size& size : options.sizes) {
+		for (const Case* c : selected) {
+			WriteResult(fp, options, Measure(*c, size, options), first);
+			first = false;
+		}
+	}
+	WriteFooter(fp, options);
+	if (fp != stdout) {
+		fclose(fp);
+	}
+	return 0;
+}
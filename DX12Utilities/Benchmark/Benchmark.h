@@ -0,0 +1,277 @@
+﻿#pragma once
+#include "../Src/Math/Vector/Vector2.h"
+#include "../Src/Math/Vector/Vector3.h"
+#include "../Src/Math/Vector/Vector4.h"
+#include "../Src/Math/Matrix/Matrix4x4.h"
+#include "../Src/Math/Matrix/TRS.h"
+#include "../Src/Math/Quaternion/Quaternion.h"
+#include "../Src/Math/Simd/AlignedAllocator.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+mff 数学ライブラリのマイクロベンチマーク
+	ケースは「要素数 n を受け取ってバッファを用意し、n 要素を1回処理する関数を返す」形で登録する
+	計測は作業領域 (入出力バッファの合計) のサイズごとに行い、1要素あたりの時間を出力する
+*/
+namespace bench {
+	template<typename T>
+	using Array = std::vector<T, mff::AlignedAllocator<T, 64>>;
+
+	//1回分の処理
+	using Pass = std::function<void()>;
+
+	struct Case {
+		//"Vector3" など
+		std::string group;
+		//"add" など
+		std::string name;
+		//要素型 ("float", "float+int" など)
+		std::string type;
+		//"scalar" : 単体の演算をループで呼ぶ / "batch" : 配列版の関数を呼ぶ (Mesh は実装の違い)
+		std::string form;
+		//1要素あたりの入出力バイト数 (要素数の計算に使う)
+		size_t bytesPerElement;
+		std::function<Pass(size_t count)> prepare;
+	};
+
+	std::vector<Case>& Cases();
+	void AddCase(const char* group, const char* name, const char* type, const char* form, size_t bytesPerElement, std::function<Pass(size_t count)> prepare);
+
+	void RegisterVectorCases();
+	void RegisterMatrixCases();
+	void RegisterBatchCases();
+	void RegisterMeshCases();
+	void RegisterBvhCases();
+
+	//書き込んだメモリを計測区間内で確定させる
+	inline void ClobberMemory() {
+#if defined(_MSC_VER)
+		_ReadWriteBarrier();
+#else
+		asm volatile("" : : : "memory");
+#endif
+	}
+
+	//xorshift32 (入力データの生成用。再現性のため種は固定)
+	class Random {
+	public:
+		explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+
+		uint32_t Next() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+		//[lo, hi)
+		float Range(float lo, float hi) {
+			return lo + (hi - lo) * static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+		}
+
+		//[-2, -0.5] と [0.5, 2] (除算・正規化で0を避ける)
+		float NonZero() {
+			const float v = Range(0.5f, 2.0f);
+			return (Next() & 1) ? v : -v;
+		}
+
+	private:
+		uint32_t state;
+	};
+
+	inline void Randomize(Random& r, float& v) { v = r.NonZero(); }
+	inline void Randomize(Random& r, double& v) { v = r.NonZero(); }
+	inline void Randomize(Random& r, int& v) { v = static_cast<int>(r.Next() % 100) + 1; }
+	inline void Randomize(Random& r, char& v) { v = static_cast<char>(r.Next() % 10 + 1); }
+	inline void Randomize(Random& r, unsigned char& v) { v = static_cast<unsigned char>(r.Next() & 1); }
+
+	template<typename T>
+	void Randomize(Random& r, mff::Vector2<T>& v) {
+		for (auto& e : v.m) {
+			Randomize(r, e);
+		}
+	}
+
+	template<typename T>
+	void Randomize(Random& r, mff::Vector3<T>& v) {
+		for (auto& e : v.m) {
+			Randomize(r, e);
+		}
+	}
+
+	template<typename T>
+	void Randomize(Random& r, mff::Vector4<T>& v) {
+		for (auto& e : v.m) {
+			Randomize(r, e);
+		}
+	}
+
+	inline void Randomize(Random& r, mff::Quaternion<float>& q) {
+		q = mff::Normalize(mff::Quaternion<float>(r.Range(-1, 1), r.Range(-1, 1), r.Range(-1, 1), r.Range(0.1f, 1)));
+	}
+
+	inline void Randomize(Random& r, mff::TRS<float>& trs) {
+		Randomize(r, trs.translation);
+		Randomize(r, trs.rotation);
+		trs.scale = mff::Vector3<float>(r.Range(0.5f, 2), r.Range(0.5f, 2), r.Range(0.5f, 2));
+	}
+
+	//逆行列・分解が安定するようにアフィン変換を作る
+	template<typename T>
+	void Randomize(Random& r, mff::Matrix4x4<T>& mat) {
+		mff::TRS<float> trs;
+		Randomize(r, trs);
+		const mff::Matrix4x4<float> src = mff::ToMatrix4x4(trs);
+		for (int i = 0; i < 16; ++i) {
+			mat.m[i] = static_cast<T>(src.m[i]);
+		}
+	}
+
+	template<typename T>
+	std::shared_ptr<Array<T>> MakeArray(size_t count, uint32_t seed) {
+		auto ret = std::make_shared<Array<T>>(count);
+		Random r(seed);
+		for (auto& e : *ret) {
+			Randomize(r, e);
+		}
+		return ret;
+	}
+
+	//比較用: 半分の要素を a と同じ値、残りを一部の成分だけずらした値にする (分岐予測が効かないように)
+	inline void Perturb(Random& r, float& v) {
+		if (r.Next() & 1) {
+			v *= 1.001f;
+		}
+	}
+	inline void Perturb(Random& r, double& v) {
+		if (r.Next() & 1) {
+			v *= 1.001;
+		}
+	}
+
+	template<typename V>
+	void PerturbComponent(Random& r, V& v) {
+		const size_t count = sizeof(v.m) / sizeof(v.m[0]);
+		if (r.Next() & 1) {
+			v.m[r.Next() % count] *= 1.001f;
+		}
+	}
+
+	template<typename T> void Perturb(Random& r, mff::Vector2<T>& v) { PerturbComponent(r, v); }
+	template<typename T> void Perturb(Random& r, mff::Vector3<T>& v) { PerturbComponent(r, v); }
+	template<typename T> void Perturb(Random& r, mff::Vector4<T>& v) { PerturbComponent(r, v); }
+
+	//r[i] = f(a[i])
+	template<typename A, typename R, typename F>
+	void AddUnary(const char* group, const char* name, const char* type, F f) {
+		AddCase(group, name, type, "scalar", sizeof(A) + sizeof(R), [f](size_t count) -> Pass {
+			auto a = MakeArray<A>(count, 1);
+			auto r = std::make_shared<Array<R>>(count);
+			return [f, a, r]() {
+				const A* pa = a->data();
+				R* pr = r->data();
+				const size_t n = a->size();
+				for (size_t i = 0; i < n; ++i) {
+					pr[i] = f(pa[i]);
+				}
+				ClobberMemory();
+			};
+		});
+	}
+
+	//r[i] = f(a[i], b[i])
+	template<typename A, typename B, typename R, typename F>
+	void AddBinary(const char* group, const char* name, const char* type, F f) {
+		AddCase(group, name, type, "scalar", sizeof(A) + sizeof(B) + sizeof(R), [f](size_t count) -> Pass {
+			auto a = MakeArray<A>(count, 1);
+			auto b = MakeArray<B>(count, 2);
+			auto r = std::make_shared<Array<R>>(count);
+			return [f, a, b, r]() {
+				const A* pa = a->data();
+				const B* pb = b->data();
+				R* pr = r->data();
+				const size_t n = a->size();
+				for (size_t i = 0; i < n; ++i) {
+					pr[i] = f(pa[i], pb[i]);
+				}
+				ClobberMemory();
+			};
+		});
+	}
+
+	//r[i] = f(a[i], b[i], c[i])
+	template<typename A, typename B, typename C, typename R, typename F>
+	void AddTernary(const char* group, const char* name, const char* type, F f) {
+		AddCase(group, name, type, "scalar", sizeof(A) + sizeof(B) + sizeof(C) + sizeof(R), [f](size_t count) -> Pass {
+			auto a = MakeArray<A>(count, 1);
+			auto b = MakeArray<B>(count, 2);
+			auto c = MakeArray<C>(count, 3);
+			auto r = std::make_shared<Array<R>>(count);
+			return [f, a, b, c, r]() {
+				const A* pa = a->data();
+				const B* pb = b->data();
+				const C* pc = c->data();
+				R* pr = r->data();
+				const size_t n = a->size();
+				for (size_t i = 0; i < n; ++i) {
+					pr[i] = f(pa[i], pb[i], pc[i]);
+				}
+				ClobberMemory();
+			};
+		});
+	}
+
+	//複合代入: r[i] = a[i]; f(r[i], b[i]) (同じ値に繰り返し適用すると非正規化数やInfになるため毎回コピーする)
+	template<typename A, typename B, typename F>
+	void AddAssign(const char* group, const char* name, const char* type, F f) {
+		AddCase(group, name, type, "scalar", sizeof(A) * 2 + sizeof(B), [f](size_t count) -> Pass {
+			auto a = MakeArray<A>(count, 1);
+			auto b = MakeArray<B>(count, 2);
+			auto r = std::make_shared<Array<A>>(count);
+			return [f, a, b, r]() {
+				const A* pa = a->data();
+				const B* pb = b->data();
+				A* pr = r->data();
+				const size_t n = a->size();
+				for (size_t i = 0; i < n; ++i) {
+					A v = pa[i];
+					f(v, pb[i]);
+					pr[i] = v;
+				}
+				ClobberMemory();
+			};
+		});
+	}
+
+	//比較: 半分が一致するデータで r[i] = f(a[i], b[i])
+	template<typename A, typename F>
+	void AddCompare(const char* group, const char* name, const char* type, F f) {
+		AddCase(group, name, type, "scalar", sizeof(A) * 2 + 1, [f](size_t count) -> Pass {
+			auto a = MakeArray<A>(count, 1);
+			auto b = std::make_shared<Array<A>>(*a);
+			Random random(2);
+			for (auto& e : *b) {
+				Perturb(random, e);
+			}
+			auto r = std::make_shared<Array<unsigned char>>(count);
+			return [f, a, b, r]() {
+				const A* pa = a->data();
+				const A* pb = b->data();
+				unsigned char* pr = r->data();
+				const size_t n = a->size();
+				for (size_t i = 0; i < n; ++i) {
+					pr[i] = f(pa[i], pb[i]) ? 1 : 0;
+				}
+				ClobberMemory();
+			};
+		});
+	}
+} // namespace bench
@@ -0,0 +1,141 @@
+﻿#include "Benchmark.h"
+#include "../Src/Math/Bvh/Bvh.h"
+#include <math.h>
+
+/*
+三角形BVH (mff::Bvh) の構築とレイ判定
+	シーンは凹凸を付けた球 (緯度経度の格子で三角形数が count 以上)
+	1要素 = 1三角形。判定のケースは三角形数と同じ本数のレイを1回の処理で飛ばすので、時間は1レイあたりになる
+	name
+		"build"     : Build (form "serial" は1スレッド、"parallel" はハードウェアスレッド数)
+		"intersect" : 最も近い交差 (Intersect)
+		"occluded"  : いずれかと交差するか (Occluded)
+	type
+		"sphere"   : 構築する球
+		"random"   : 球を囲む箱の中の乱数の始点と方向 (キャッシュに乗らない最悪の入力)
+		"camera"   : 球の外に置いたカメラから格子状に飛ばす (隣のレイが同じノードを辿る)
+		"segments" : 球の内外の乱数の2点を結ぶ線分
+*/
+namespace bench {
+	namespace {
+		using namespace mff;
+
+		//三角形・パケット・ノードを合わせた1三角形あたりの大きさの目安
+		const size_t bytesPerTriangle = sizeof(Vector3<float>) * 3 + sizeof(uint32_t) * 5 + sizeof(Bvh::TrianglePacket) / 4 + sizeof(Bvh::Node) / 3;
+
+		//三角形数が count 以上の凹凸のある半径1前後の球
+		std::shared_ptr<Bvh> MakeSphere(size_t count) {
+			int n = 4;
+			while (static_cast<size_t>(n) * n * 4 < count) {
+				++n;
+			}
+			const int rings = n, segments = n * 2;
+			std::vector<Vector3<float> > positions;
+			for (int r = 0; r <= rings; ++r) {
+				const float theta = 3.14159265f * r / rings;
+				for (int s = 0; s <= segments; ++s) {
+					const float phi = 2.0f * 3.14159265f * s / segments;
+					const float radius = 1.0f + 0.05f * sinf(theta * 13.0f) * cosf(phi * 17.0f);
+					positions.push_back(Vector3<float>(radius * sinf(theta) * cosf(phi), radius * cosf(theta), radius * sinf(theta) * sinf(phi)));
+				}
+			}
+			std::vector<uint32_t> indices;
+			for (int r = 0; r < rings; ++r) {
+				for (int s = 0; s < segments; ++s) {
+					const uint32_t a = r * (segments + 1) + s;
+					const uint32_t b = a + segments + 1;
+					const uint32_t quad[6] = { a, b, a + 1, a + 1, b, b + 1 };
+					indices.insert(indices.end(), quad, quad + 6);
+				}
+			}
+			auto bvh = std::make_shared<Bvh>();
+			bvh->AddTriangles(positions.data(), sizeof(Vector3<float>), positions.size(), indices.data(), indices.size(), 0);
+			return bvh;
+		}
+
+		Vector3<float> RandomPoint(Random& random, float range) {
+			return Vector3<float>(random.Range(-range, range), random.Range(-range, range), random.Range(-range, range));
+		}
+
+		std::shared_ptr<std::vector<Ray> > MakeRandomRays(size_t count) {
+			auto rays = std::make_shared<std::vector<Ray> >(count);
+			Random random(31);
+			for (auto& ray : *rays) {
+				ray = Ray(RandomPoint(random, 1.5f), RandomPoint(random, 1.0f));
+			}
+			return rays;
+		}
+
+		//(0, 0, -3) から +z 向きに画角 45度程度で格子状に飛ばす
+		std::shared_ptr<std::vector<Ray> > MakeCameraRays(size_t count) {
+			int width = 1;
+			while (static_cast<size_t>(width) * width < count) {
+				++width;
+			}
+			auto rays = std::make_shared<std::vector<Ray> >(count);
+			const Vector3<float> origin(0, 0, -3);
+			for (size_t i = 0; i < count; ++i) {
+				const float x = (static_cast<float>(i % width) + 0.5f) / width * 2.0f - 1.0f;
+				const float y = (static_cast<float>(i / width) + 0.5f) / width * 2.0f - 1.0f;
+				(*rays)[i] = Ray(origin, Vector3<float>(x * 0.4f, y * 0.4f, 1.0f));
+			}
+			return rays;
+		}
+
+		std::shared_ptr<std::vector<Ray> > MakeSegments(size_t count) {
+			auto rays = std::make_shared<std::vector<Ray> >(count);
+			Random random(32);
+			for (auto& ray : *rays) {
+				ray = ToSegment(RandomPoint(random, 1.5f), RandomPoint(random, 1.5f));
+			}
+			return rays;
+		}
+
+		template<typename Make>
+		void AddIntersect(const char* type, Make make) {
+			AddCase("Bvh", "intersect", type, "bvh", bytesPerTriangle, [make](size_t count) -> Pass {
+				auto bvh = MakeSphere(count);
+				bvh->Build(0);
+				auto rays = make(count);
+				auto hits = std::make_shared<std::vector<RayHit> >(count);
+				return [bvh, rays, hits]() {
+					for (size_t i = 0; i < rays->size(); ++i) {
+						bvh->Intersect((*rays)[i], (*hits)[i]);
+					}
+					ClobberMemory();
+				};
+			});
+		}
+	} // namespace
+
+	void RegisterBvhCases() {
+		AddCase("Bvh", "build", "sphere", "serial", bytesPerTriangle, [](size_t count) -> Pass {
+			auto bvh = MakeSphere(count);
+			return [bvh]() {
+				bvh->Build(1);
+				ClobberMemory();
+			};
+		});
+		AddCase("Bvh", "build", "sphere", "parallel", bytesPerTriangle, [](size_t count) -> Pass {
+			auto bvh = MakeSphere(count);
+			return [bvh]() {
+				bvh->Build(0);
+				ClobberMemory();
+			};
+		});
+		AddIntersect("random", [](size_t count) { return MakeRandomRays(count); });
+		AddIntersect("camera", [](size_t count) { return MakeCameraRays(count); });
+		AddCase("Bvh", "occluded", "segments", "bvh", bytesPerTriangle, [](size_t count) -> Pass {
+			auto bvh = MakeSphere(count);
+			bvh->Build(0);
+			auto rays = MakeSegments(count);
+			auto occluded = std::make_shared<std::vector<unsigned char> >(count);
+			return [bvh, rays, occluded]() {
+				for (size_t i = 0; i < rays->size(); ++i) {
+					(*occluded)[i] = bvh->Occluded((*rays)[i]) ? 1 : 0;
+				}
+				ClobberMemory();
+			};
+		});
+	}
+} // namespace bench
@@ -0,0 +1,54 @@
+﻿#include "Benchmark.h"
+
+//Matrix4x4 / Quaternion / TRS の演算 (単体)
+namespace bench {
+	namespace {
+		using namespace mff;
+
+		template<typename T>
+		void RegisterMatrix(const char* type) {
+			using Mat = Matrix4x4<T>;
+			const char* group = "Matrix4x4";
+			AddBinary<Mat, Mat, Mat>(group, "add", type, [](const Mat& a, const Mat& b) { return a + b; });
+			AddBinary<Mat, Mat, Mat>(group, "sub", type, [](const Mat& a, const Mat& b) { return a - b; });
+			AddBinary<Mat, Mat, Mat>(group, "mul", type, [](const Mat& a, const Mat& b) { return a * b; });
+			AddBinary<Mat, Vector4<T>, Vector4<T>>(group, "mul_vector", type, [](const Mat& a, const Vector4<T>& v) { return a * v; });
+			AddBinary<Mat, T, Mat>(group, "mul_scalar", type, [](const Mat& a, T s) { return a * s; });
+			AddAssign<Mat, Mat>(group, "add_assign", type, [](Mat& a, const Mat& b) { a += b; });
+			AddAssign<Mat, Mat>(group, "sub_assign", type, [](Mat& a, const Mat& b) { a -= b; });
+			AddAssign<Mat, Mat>(group, "mul_assign", type, [](Mat& a, const Mat& b) { a *= b; });
+			AddUnary<Mat, Mat>(group, "transpose", type, [](const Mat& a) { return Transpose(a); });
+			AddUnary<Mat, Mat>(group, "inverse", type, [](const Mat& a) { return Inverse(a); });
+			AddUnary<Mat, Mat>(group, "affine_inverse", type, [](const Mat& a) { return AffineInverse(a); });
+			AddUnary<Mat, T>(group, "determinant", type, [](const Mat& a) { return Determinant(a); });
+			AddBinary<Mat, Mat, Mat>(group, "lerp", type, [](const Mat& a, const Mat& b) { return Lerp(a, b, static_cast<T>(0.25)); });
+			AddBinary<Mat, Mat, Mat>(group, "scaled_add", type, [](const Mat& a, const Mat& b) { return ScaledAdd(a, b, static_cast<T>(0.25)); });
+		}
+
+		void RegisterQuaternion() {
+			using Quat = Quaternion<float>;
+			const char* group = "Quaternion";
+			AddBinary<Quat, Quat, Quat>(group, "mul", "float", [](const Quat& a, const Quat& b) { return a * b; });
+			AddUnary<Quat, Quat>(group, "normalize", "float", [](const Quat& a) { return Normalize(a); });
+			AddUnary<Quat, Quat>(group, "inverse", "float", [](const Quat& a) { return Inverse(a); });
+			AddBinary<Quat, Vector3<float>, Vector3<float>>(group, "rotate", "float", [](const Quat& a, const Vector3<float>& v) { return Rotate(a, v); });
+			AddBinary<Quat, Quat, Quat>(group, "nlerp", "float", [](const Quat& a, const Quat& b) { return Nlerp(a, b, 0.25f); });
+			AddBinary<Quat, Quat, Quat>(group, "slerp", "float", [](const Quat& a, const Quat& b) { return Slerp(a, b, 0.25f); });
+			AddUnary<Quat, Matrix4x4<float>>(group, "to_matrix", "float", [](const Quat& a) { return ToMatrix4x4(a); });
+			AddUnary<Matrix4x4<float>, Quat>(group, "from_matrix", "float", [](const Matrix4x4<float>& a) { return ToQuaternion(a); });
+		}
+
+		void RegisterTRS() {
+			AddUnary<TRS<float>, Matrix4x4<float>>("TRS", "compose", "float", [](const TRS<float>& a) { return ToMatrix4x4(a); });
+			AddUnary<Matrix4x4<float>, TRS<float>>("TRS", "decompose", "float", [](const Matrix4x4<float>& a) { return Decompose(a); });
+			AddBinary<TRS<float>, TRS<float>, TRS<float>>("TRS", "lerp", "float", [](const TRS<float>& a, const TRS<float>& b) { return Lerp(a, b, 0.25f); });
+		}
+	} // namespace
+
+	void RegisterMatrixCases() {
+		RegisterMatrix<float>("float");
+		RegisterMatrix<double>("double");
+		RegisterQuaternion();
+		RegisterTRS();
+	}
+} // namespace bench
@@ -0,0 +1,224 @@
+﻿#include "Benchmark.h"
+#include "../Src/Lib/FbxLoader/MeshBuilder.h"
+#include <stdio.h>
+#include <string.h>
+
+/*
+メッシュ構築 (BuildMesh) の重複頂点の統合
+	1要素 = 1三角形。入力は MeshSource を作っておき、1回の処理で BuildMesh を丸ごと呼ぶ
+	form
+		"relation" : [マテリアル][コントロールポイント] ごとの vector を線形探索する以前の方法 (比較用にここで再現する)
+		"hash"     : VertexWelder (BuildMesh)
+		"parallel" : BuildMesh をハードウェアスレッド数で呼ぶ (準備の時に1スレッドの結果と一致するかを確認する)
+	type
+		"grid"  : 格子状のなめらかなメッシュ (コントロールポイントごとの頂点は1つ)
+		"seams" : 4マテリアル、8列ごとに UV の継ぎ目がある格子
+		"fans"  : フラットシェーディングの扇 (中心1つあたり 256 三角形で法線が全て違う)
+
+頂点変換後キャッシュに合わせた並べ替え (mff::OptimizeVertexCache)
+	1要素 = 1三角形。BuildMesh した各マテリアルのインデックスを並べ替える
+	form
+		"tipsify" : 出力順のまま
+		"shuffled": 三角形の順序を乱数で入れ替えてから (キャッシュもメモリアクセスも最悪の入力)
+*/
+namespace bench {
+	namespace {
+		using namespace mff;
+		using namespace FbxLoader;
+
+		//1三角形あたりの入力バイト数の目安 (cpIndices, texCoords, normals, materialIndices)
+		const size_t bytesPerTriangle = (sizeof(int) + sizeof(Vector2<float>) + sizeof(Vector3<float>)) * 3 + sizeof(int);
+
+		void AddCorner(MeshSource& source, int cp, const Vector2<float>& uv, const Vector3<float>& normal) {
+			source.cpIndices.push_back(cp);
+			source.texCoords.push_back(uv);
+			source.normals.push_back(normal);
+		}
+
+		//三角形数が count 以上になる格子
+		std::shared_ptr<MeshSource> MakeGrid(size_t count, bool hasSeams) {
+			int n = 1;
+			while (static_cast<size_t>(n) * n * 2 < count) {
+				++n;
+			}
+			auto source = std::make_shared<MeshSource>();
+			source->materials.resize(hasSeams ? 4 : 1);
+			for (int y = 0; y <= n; ++y) {
+				for (int x = 0; x <= n; ++x) {
+					source->positions.push_back(Vector3<float>(static_cast<float>(x), static_cast<float>(y), 0));
+				}
+			}
+			const Vector3<float> normal(0, 0, 1);
+			for (int y = 0; y < n; ++y) {
+				for (int x = 0; x < n; ++x) {
+					const int quad[6][2] = { { x, y }, { x + 1, y }, { x + 1, y + 1 }, { x, y }, { x + 1, y + 1 }, { x, y + 1 } };
+					for (const auto& p : quad) {
+						float u = p[0] / static_cast<float>(n);
+						if (hasSeams && p[0] % 8 == 0) {
+							u = (x & 1) ? 1.0f : 0.0f;
+						}
+						AddCorner(*source, p[1] * (n + 1) + p[0], Vector2<float>(u, p[1] / static_cast<float>(n)), normal);
+					}
+					const int material = hasSeams ? (x / 16 + y / 16) & 3 : 0;
+					source->materialIndices.push_back(material);
+					source->materialIndices.push_back(material);
+				}
+			}
+			return source;
+		}
+
+		std::shared_ptr<MeshSource> MakeFans(size_t count) {
+			const int fanSize = 256;
+			auto source = std::make_shared<MeshSource>();
+			source->materials.resize(1);
+			Random random(3);
+			for (size_t fan = 0; fan * fanSize < count; ++fan) {
+				const int center = static_cast<int>(source->positions.size());
+				source->positions.push_back(Vector3<float>(static_cast<float>(fan), 0, 0));
+				for (int i = 0; i <= fanSize; ++i) {
+					source->positions.push_back(Vector3<float>(static_cast<float>(fan), random.Range(-1, 1), random.Range(-1, 1)));
+				}
+				for (int i = 0; i < fanSize; ++i) {
+					Vector3<float> normal(random.Range(-1, 1), random.Range(-1, 1), 1);
+					normal = Normalize(normal);
+					AddCorner(*source, center, Vector2<float>(), normal);
+					AddCorner(*source, center + 1 + i, Vector2<float>(), normal);
+					AddCorner(*source, center + 2 + i, Vector2<float>(), normal);
+				}
+			}
+			return source;
+		}
+
+		//以前の統合方法
+		void BuildWithRelations(const MeshSource& source, StaticMesh& mesh) {
+			const int materialCount = static_cast<int>(source.materials.size());
+			mesh.materials.resize(materialCount);
+			std::vector<std::vector<std::vector<int>>> relations(materialCount);
+			for (auto& rel : relations) {
+				rel.resize(source.positions.size());
+			}
+			for (size_t corner = 0; corner < source.cpIndices.size(); ++corner) {
+				const int cpIndex = source.cpIndices[corner];
+				StaticVertex v;
+				v.position = source.positions[cpIndex];
+				v.texCoord = source.texCoords[corner];
+				v.normal = source.normals[corner];
+				v.tangent = Vector4<float>(1, 0, 0, 1);
+				const int materialIndex = source.materialIndices.empty() ? 0 : source.materialIndices[corner / 3];
+				Material<StaticVertex>& materialData = mesh.materials[materialIndex];
+				std::vector<int>& related = relations[materialIndex][cpIndex];
+				auto itr = related.begin();
+				for (; itr != related.end(); ++itr) {
+					if (IsSameAttribute(materialData.verteces[*itr], v)) {
+						break;
+					}
+				}
+				if (itr != related.end()) {
+					materialData.indeces.push_back(*itr);
+				}
+				else {
+					const int pushIndex = static_cast<int>(materialData.verteces.size());
+					materialData.indeces.push_back(pushIndex);
+					materialData.verteces.push_back(v);
+					related.push_back(pushIndex);
+				}
+			}
+		}
+
+		bool IsSameMesh(const StaticMesh& a, const StaticMesh& b) {
+			if (a.materials.size() != b.materials.size()) {
+				return false;
+			}
+			for (size_t i = 0; i < a.materials.size(); ++i) {
+				const auto& x = a.materials[i];
+				const auto& y = b.materials[i];
+				if (x.indeces != y.indeces || x.verteces.size() != y.verteces.size()) {
+					return false;
+				}
+				if (!x.verteces.empty() && memcmp(x.verteces.data(), y.verteces.data(), x.verteces.size() * sizeof(StaticVertex)) != 0) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//三角形単位で順序を入れ替える
+		void ShuffleTriangles(std::vector<unsigned int>& indeces, Random& random) {
+			const size_t triangleCount = indeces.size() / 3;
+			for (size_t i = triangleCount; i > 1; --i) {
+				const size_t j = static_cast<size_t>(random.Range(0, static_cast<float>(i))) % i;
+				for (size_t c = 0; c < 3; ++c) {
+					std::swap(indeces[(i - 1) * 3 + c], indeces[j * 3 + c]);
+				}
+			}
+		}
+
+		template<typename Make>
+		void AddVertexCache(const char* type, const char* form, bool shuffle, Make make) {
+			AddCase("Mesh", "vcache", type, form, sizeof(unsigned int) * 3, [make, shuffle](size_t count) -> Pass {
+				auto mesh = std::make_shared<StaticMesh>();
+				BuildMesh(*make(count), *mesh);
+				if (shuffle) {
+					Random random(5);
+					for (auto& material : mesh->materials) {
+						ShuffleTriangles(material.indeces, random);
+					}
+				}
+				auto dst = std::make_shared<std::vector<unsigned int>>();
+				return [mesh, dst]() {
+					for (const auto& material : mesh->materials) {
+						dst->resize(material.indeces.size());
+						OptimizeVertexCache(dst->data(), material.indeces.data(), material.indeces.size(), material.verteces.size());
+					}
+					ClobberMemory();
+				};
+			});
+		}
+
+		template<typename Make>
+		void AddWeld(const char* type, Make make) {
+			AddCase("Mesh", "weld", type, "relation", bytesPerTriangle, [make](size_t count) -> Pass {
+				auto source = make(count);
+				return [source]() {
+					StaticMesh mesh;
+					BuildWithRelations(*source, mesh);
+					ClobberMemory();
+				};
+			});
+			AddCase("Mesh", "weld", type, "hash", bytesPerTriangle, [make](size_t count) -> Pass {
+				auto source = make(count);
+				return [source]() {
+					StaticMesh mesh;
+					BuildMesh(*source, mesh);
+					ClobberMemory();
+				};
+			});
+			AddCase("Mesh", "weld", type, "parallel", bytesPerTriangle, [make, type](size_t count) -> Pass {
+				auto source = make(count);
+				StaticMesh serial, parallel;
+				BuildMesh(*source, serial, 1);
+				BuildMesh(*source, parallel, 0);
+				if (!IsSameMesh(serial, parallel)) {
+					fprintf(stderr, "Mesh/weld/%s: parallel result differs from serial (%zu triangles)\n", type, count);
+				}
+				return [source]() {
+					StaticMesh mesh;
+					BuildMesh(*source, mesh, 0);
+					ClobberMemory();
+				};
+			});
+		}
+	} // namespace
+
+	void RegisterMeshCases() {
+		AddWeld("grid", [](size_t count) { return MakeGrid(count, false); });
+		AddWeld("seams", [](size_t count) { return MakeGrid(count, true); });
+		AddWeld("fans", [](size_t count) { return MakeFans(count); });
+		for (int shuffle = 0; shuffle < 2; ++shuffle) {
+			const char* form = shuffle ? "shuffled" : "tipsify";
+			AddVertexCache("grid", form, shuffle != 0, [](size_t count) { return MakeGrid(count, false); });
+			AddVertexCache("seams", form, shuffle != 0, [](size_t count) { return MakeGrid(count, true); });
+			AddVertexCache("fans", form, shuffle != 0, [](size_t count) { return MakeFans(count); });
+		}
+	}
+} // namespace bench
@@ -0,0 +1,85 @@
+﻿#include "Benchmark.h"
+
+//Vector2/3/4 の演算子と関数、混在型の演算、FloatEqual
+namespace bench {
+	namespace {
+		using namespace mff;
+
+		//Vector2/3/4 に共通の演算
+		template<typename Vec, typename T>
+		void RegisterCommon(const char* group, const char* type) {
+			AddBinary<Vec, Vec, Vec>(group, "add", type, [](const Vec& a, const Vec& b) { return a + b; });
+			AddBinary<Vec, Vec, Vec>(group, "sub", type, [](const Vec& a, const Vec& b) { return a - b; });
+			AddBinary<Vec, Vec, Vec>(group, "mul", type, [](const Vec& a, const Vec& b) { return a * b; });
+			AddBinary<Vec, Vec, Vec>(group, "div", type, [](const Vec& a, const Vec& b) { return a / b; });
+			AddBinary<Vec, T, Vec>(group, "mul_scalar", type, [](const Vec& a, T s) { return a * s; });
+			AddBinary<Vec, T, Vec>(group, "div_scalar", type, [](const Vec& a, T s) { return a / s; });
+
+			AddAssign<Vec, Vec>(group, "add_assign", type, [](Vec& a, const Vec& b) { a += b; });
+			AddAssign<Vec, Vec>(group, "sub_assign", type, [](Vec& a, const Vec& b) { a -= b; });
+			AddAssign<Vec, Vec>(group, "mul_assign", type, [](Vec& a, const Vec& b) { a *= b; });
+			AddAssign<Vec, Vec>(group, "div_assign", type, [](Vec& a, const Vec& b) { a /= b; });
+			AddAssign<Vec, T>(group, "mul_scalar_assign", type, [](Vec& a, T s) { a *= s; });
+			AddAssign<Vec, T>(group, "div_scalar_assign", type, [](Vec& a, T s) { a /= s; });
+
+			AddCompare<Vec>(group, "equal", type, [](const Vec& a, const Vec& b) { return a == b; });
+			AddBinary<Vec, Vec, T>(group, "dot", type, [](const Vec& a, const Vec& b) { return dot(a, b); });
+			AddUnary<Vec, Vec>(group, "normalize", type, [](const Vec& a) { return Normalize(a); });
+			AddBinary<Vec, Vec, Vec>(group, "lerp", type, [](const Vec& a, const Vec& b) { return Lerp(a, b, static_cast<T>(0.25)); });
+			AddTernary<Vec, Vec, Vec, Vec>(group, "muladd", type, [](const Vec& a, const Vec& b, const Vec& c) { return MulAdd(a, b, c); });
+			AddBinary<Vec, Vec, Vec>(group, "scaled_add", type, [](const Vec& a, const Vec& b) { return ScaledAdd(a, b, static_cast<T>(0.25)); });
+		}
+
+		//混在型の演算 (結果型は PrecisionType で決まる)
+		template<template<typename> class V>
+		void RegisterMixed(const char* group) {
+			AddBinary<V<float>, V<int>, V<float>>(group, "add", "float+int", [](const V<float>& a, const V<int>& b) { return a + b; });
+			AddBinary<V<char>, V<int>, V<int>>(group, "add", "char+int", [](const V<char>& a, const V<int>& b) { return a + b; });
+			AddBinary<V<int>, V<double>, V<double>>(group, "mul", "int*double", [](const V<int>& a, const V<double>& b) { return a * b; });
+			AddBinary<V<float>, int, V<float>>(group, "mul_scalar", "float*int", [](const V<float>& a, int s) { return a * s; });
+			AddAssign<V<float>, V<int>>(group, "add_assign", "float+=int", [](V<float>& a, const V<int>& b) { a += b; });
+#if defined(MFF_ACCURATE_PRECISION)
+			//FloatPrecision では float と double の混在はコンパイルエラー
+			AddBinary<V<float>, V<double>, V<double>>(group, "add", "float+double", [](const V<float>& a, const V<double>& b) { return a + b; });
+			AddBinary<V<float>, V<double>, V<double>>(group, "mul", "float*double", [](const V<float>& a, const V<double>& b) { return a * b; });
+#endif
+		}
+
+		template<typename T>
+		void RegisterVector2(const char* type) {
+			using Vec = Vector2<T>;
+			RegisterCommon<Vec, T>("Vector2", type);
+			AddUnary<Vec, Vec>("Vector2", "neg", type, [](const Vec& a) { return -a; });
+			AddBinary<Vec, Vec, T>("Vector2", "cross", type, [](const Vec& a, const Vec& b) { return cross(a, b); });
+		}
+
+		template<typename T>
+		void RegisterVector3(const char* type) {
+			using Vec = Vector3<T>;
+			RegisterCommon<Vec, T>("Vector3", type);
+			AddBinary<Vec, Vec, Vec>("Vector3", "cross", type, [](const Vec& a, const Vec& b) { return cross(a, b); });
+			AddUnary<Vec, T>("Vector3", "length", type, [](const Vec& a) { return a.Length(); });
+		}
+
+		template<typename T>
+		void RegisterVector4(const char* type) {
+			RegisterCommon<Vector4<T>, T>("Vector4", type);
+		}
+	} // namespace
+
+	void RegisterVectorCases() {
+		AddCompare<float>("Scalar", "FloatEqual", "float", [](float a, float b) { return FloatEqual(a, b); });
+		AddCompare<double>("Scalar", "DoubleEqual", "double", [](double a, double b) { return DoubleEqual(a, b); });
+
+		RegisterVector2<float>("float");
+		RegisterVector2<double>("double");
+		RegisterVector3<float>("float");
+		RegisterVector3<double>("double");
+		RegisterVector4<float>("float");
+		RegisterVector4<double>("double");
+
+		RegisterMixed<Vector2>("Vector2");
+		RegisterMixed<Vector3>("Vector3");
+		RegisterMixed<Vector4>("Vector4");
+	}
+} // namespace bench
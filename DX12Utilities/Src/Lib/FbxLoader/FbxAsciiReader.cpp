@@ -0,0 +1,664 @@
+﻿#include "FbxAsciiReader.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace FbxLoader {
+	namespace fbx {
+		namespace {
+			//ノードが深すぎるファイルは壊れているとみなす
+			const int maxDepth = 64;
+			//数値1つの最大の文字数
+			const size_t maxTokenLength = 63;
+			//配列は Property::encodedSize (32bit) にバイト数が収まる要素数まで
+			const uint64_t maxArrayElements = 0xFFFFFFFFu / 8;
+
+			//double で正確に表せる10の累乗
+			const double exactPowers[] = {
+				1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+			};
+
+			bool IsNumberChar(int c) {
+				return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+			}
+
+			bool IsWordChar(int c) {
+				return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+			}
+
+			/**
+			* 数値の文字列を整数か小数に変換する
+			* 小数は仮数が 2^53 以下で指数が ±22 以内なら1回の乗除算で正しく丸められるのでそのまま計算し
+			* それ以外 (桁の多いものや指数の大きいもの) は strtod に任せる
+			*
+			* @param   isReal  '.' か指数を含むか、整数が int64_t に収まらなければ true
+			* @retval  true : 成功 false : 数値として不正
+			*/
+			bool ParseNumber(const char* begin, const char* end, int64_t& integer, double& real, bool& isReal) {
+				const char* p = begin;
+				bool isNegative = false;
+				if (p < end && (*p == '-' || *p == '+')) {
+					isNegative = *p == '-';
+					++p;
+				}
+				uint64_t mantissa = 0;
+				int digitCount = 0;
+				int exponent = 0;
+				bool hasDigit = false;
+				bool isTruncated = false;
+				while (p < end && *p >= '0' && *p <= '9') {
+					hasDigit = true;
+					if (digitCount < 19) {
+						mantissa = mantissa * 10 + (*p - '0');
+						digitCount += mantissa != 0;
+					}
+					else {
+						++exponent;
+						isTruncated = true;
+					}
+					++p;
+				}
+				isReal = false;
+				if (p < end && *p == '.') {
+					isReal = true;
+					++p;
+					while (p < end && *p >= '0' && *p <= '9') {
+						hasDigit = true;
+						if (digitCount < 19) {
+							mantissa = mantissa * 10 + (*p - '0');
+							digitCount += mantissa != 0;
+							--exponent;
+						}
+						else if (*p != '0') {
+							isTruncated = true;
+						}
+						++p;
+					}
+				}
+				if (p < end && (*p == 'e' || *p == 'E')) {
+					isReal = true;
+					++p;
+					bool isExponentNegative = false;
+					if (p < end && (*p == '-' || *p == '+')) {
+						isExponentNegative = *p == '-';
+						++p;
+					}
+					int value = 0;
+					bool hasExponentDigit = false;
+					while (p < end && *p >= '0' && *p <= '9') {
+						hasExponentDigit = true;
+						if (value < 10000) {
+							value = value * 10 + (*p - '0');
+						}
+						++p;
+					}
+					if (!hasExponentDigit) {
+						return false;
+					}
+					exponent += isExponentNegative ? -value : value;
+				}
+				if (!hasDigit || p != end) {
+					return false;
+				}
+
+				if (!isReal) {
+					const uint64_t limit = isNegative ? 0x8000000000000000ull : 0x7FFFFFFFFFFFFFFFull;
+					if (!isTruncated && mantissa <= limit) {
+						integer = isNegative ? static_cast<int64_t>(0 - mantissa) : static_cast<int64_t>(mantissa);
+						return true;
+					}
+					isReal = true;
+				}
+				else if (!isTruncated && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22) {
+					const double value = static_cast<double>(mantissa);
+					real = exponent < 0 ? value / exactPowers[-exponent] : value * exactPowers[exponent];
+					if (isNegative) {
+						real = -real;
+					}
+					return true;
+				}
+
+				char tmp[maxTokenLength + 1];
+				const size_t length = static_cast<size_t>(end - begin);
+				memcpy(tmp, begin, length);
+				tmp[length] = '\0';
+				char* parsedEnd = nullptr;
+				real = strtod(tmp, &parsedEnd);
+				return parsedEnd == tmp + length;
+			}
+
+			/**
+			* ノードを残すかどうか
+			* 親が残すノードの時だけ呼ぶ
+			*/
+			bool IsNeeded(const std::string& parentName, int depth, const std::string& name) {
+				if (depth == 0) {
+					return name == "FBXHeaderExtension" || name == "GlobalSettings" || name == "Objects" || name == "Connections";
+				}
+				if (depth == 1 && parentName == "FBXHeaderExtension") {
+					return name == "FBXVersion";
+				}
+				if (depth == 1 && parentName == "Objects") {
+					static const char* const classes[] = {
+						"Model", "Geometry", "Material", "Texture", "LayeredTexture", "NodeAttribute", "Deformer",
+						"AnimationStack", "AnimationLayer", "AnimationCurveNode", "AnimationCurve",
+					};
+					for (const char* c : classes) {
+						if (name == c) {
+							return true;
+						}
+					}
+					return false;
+				}
+				return true;
+			}
+		}
+
+		/**
+		* ファイルを開いて読む
+		*
+		* @param   filename    読み込むファイル名
+		* @param   document    読み込んだノードの格納先 (元の内容は消える)
+		* @retval  true : 成功 false : ファイルが開けないかFBXとして不正
+		*/
+		bool AsciiReader::Read(const std::string& filename, Document& document) {
+#ifdef _WIN32
+			const int file = _open(filename.c_str(), _O_RDONLY | _O_BINARY);
+#else
+			const int file = open(filename.c_str(), O_RDONLY);
+#endif
+			if (file < 0) {
+				document.Clear();
+				return false;
+			}
+			const bool ret = Read(file, document);
+#ifdef _WIN32
+			_close(file);
+#else
+			close(file);
+#endif
+			return ret;
+		}
+
+		bool AsciiReader::Read(int fd, Document& document) {
+			document.Clear();
+			this->document = &document;
+			this->fd = fd;
+			buffer.reset(new char[chunkSize]);
+			cur = end = buffer.get();
+			isEof = false;
+			isError = false;
+			names.clear();
+
+			//配列の要素は少なくとも数字と区切りの2文字を使うので、通常のファイルならサイズから上限が決まる
+			maxElements = maxArrayElements;
+#ifdef _WIN32
+			struct _stat64 st;
+			if (_fstat64(fd, &st) == 0 && (st.st_mode & _S_IFREG) && static_cast<uint64_t>(st.st_size) / 2 < maxElements) {
+#else
+			struct stat st;
+			if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && static_cast<uint64_t>(st.st_size) / 2 < maxElements) {
+#endif
+				maxElements = static_cast<uint64_t>(st.st_size) / 2;
+			}
+
+			bool ret = ParseNodeList(0, std::string(), 0, true);
+			if (ret) {
+				const Node* header = document.FindChild(document.GetRoot(), "FBXHeaderExtension");
+				const Node* versionNode = header ? document.FindChild(*header, "FBXVersion") : nullptr;
+				const Property* version = versionNode ? document.GetProperty(*versionNode, 0) : nullptr;
+				document.version = version ? static_cast<uint32_t>(version->AsInt()) : 0;
+				//7.x 以降のみ対応 (6.x はオブジェクトの構成が違う)
+				ret = document.version >= 7000;
+			}
+
+			buffer.reset();
+			names.clear();
+			this->document = nullptr;
+			if (!ret) {
+				document.Clear();
+			}
+			return ret;
+		}
+
+		bool AsciiReader::Fill() {
+			if (isEof || isError) {
+				return false;
+			}
+			for (;;) {
+#ifdef _WIN32
+				const int size = _read(fd, buffer.get(), static_cast<unsigned int>(chunkSize));
+#else
+				const ssize_t size = read(fd, buffer.get(), chunkSize);
+				if (size < 0 && errno == EINTR) {
+					continue;
+				}
+#endif
+				if (size < 0) {
+					isError = true;
+					return false;
+				}
+				if (size == 0) {
+					isEof = true;
+					return false;
+				}
+				cur = buffer.get();
+				end = cur + size;
+				return true;
+			}
+		}
+
+		int AsciiReader::Peek() {
+			if (cur == end && !Fill()) {
+				return -1;
+			}
+			return static_cast<unsigned char>(*cur);
+		}
+
+		int AsciiReader::Get() {
+			const int c = Peek();
+			if (c >= 0) {
+				++cur;
+			}
+			return c;
+		}
+
+		void AsciiReader::SkipSpace(bool isMultiLine) {
+			for (;;) {
+				if (cur == end && !Fill()) {
+					return;
+				}
+				const char c = *cur;
+				if (c == ' ' || c == '\t' || c == '\r' || (isMultiLine && c == '\n')) {
+					++cur;
+				}
+				else if (isMultiLine && c == ';') {
+					SkipLine();
+				}
+				else {
+					return;
+				}
+			}
+		}
+
+		void AsciiReader::SkipLine() {
+			for (;;) {
+				if (cur == end && !Fill()) {
+					return;
+				}
+				const char* newLine = static_cast<const char*>(memchr(cur, '\n', end - cur));
+				if (newLine) {
+					cur = newLine + 1;
+					return;
+				}
+				cur = end;
+			}
+		}
+
+		/**
+		* '}' か終端までのノードの並びを読む
+		*
+		* @param   parent      追加するノードの親 (isKept が false なら使わない)
+		* @param   parentName  親のノード名 (残すノードの判定用)
+		* @param   isKept      false ならノードを作らずに読み飛ばす
+		*/
+		bool AsciiReader::ParseNodeList(int parent, const std::string& parentName, int depth, bool isKept) {
+			if (depth > maxDepth) {
+				return false;
+			}
+			std::string name;
+			int prev = -1;
+			for (;;) {
+				SkipSpace(true);
+				const int c = Peek();
+				if (c < 0) {
+					return !isError && depth == 0;
+				}
+				if (c == '}') {
+					++cur;
+					return depth > 0;
+				}
+				if (!ReadName(name)) {
+					return false;
+				}
+
+				const bool isNodeKept = isKept && IsNeeded(parentName, depth, name);
+				int index = -1;
+				if (isNodeKept) {
+					std::vector<Node>& nodes = document->nodes;
+					index = static_cast<int>(nodes.size());
+					Node node;
+					node.name = Intern(name);
+					node.nameLength = static_cast<uint32_t>(name.size());
+					node.firstProperty = static_cast<uint32_t>(document->properties.size());
+					nodes.push_back(node);
+					if (prev < 0) {
+						nodes[parent].firstChild = index;
+					}
+					else {
+						nodes[prev].nextSibling = index;
+					}
+					prev = index;
+				}
+
+				//プロパティは改行まで (',' で終わる行は次の行に続く)、'{' があれば子の並び
+				for (;;) {
+					SkipSpace(false);
+					const int next = Peek();
+					if (next < 0 || next == '\n') {
+						break;
+					}
+					if (next == ';') {
+						SkipLine();
+						break;
+					}
+					if (next == '{') {
+						++cur;
+						if (!ParseNodeList(index, name, depth + 1, isNodeKept)) {
+							return false;
+						}
+						break;
+					}
+					if (next == ',') {
+						++cur;
+						SkipSpace(true);
+						continue;
+					}
+
+					Property property;
+					bool isValid;
+					if (next == '"') {
+						isValid = ReadString(isNodeKept, property);
+					}
+					else if (next == '*') {
+						isValid = ReadArray(name, isNodeKept, property);
+					}
+					else if (IsNumberChar(next)) {
+						isValid = ReadNumber(property);
+					}
+					else {
+						isValid = ReadWord(isNodeKept, property);
+					}
+					if (!isValid) {
+						return false;
+					}
+					if (isNodeKept) {
+						document->properties.push_back(property);
+						++document->nodes[index].propertyCount;
+					}
+				}
+			}
+		}
+
+		bool AsciiReader::ReadName(std::string& name) {
+			name.clear();
+			for (;;) {
+				const int c = Get();
+				if (c == ':') {
+					return !name.empty();
+				}
+				//バイナリと同じく名前は255文字まで
+				if (!IsWordChar(c) || name.size() >= 255) {
+					return false;
+				}
+				name.push_back(static_cast<char>(c));
+			}
+		}
+
+		bool AsciiReader::ReadString(bool isKept, Property& property) {
+			++cur;
+			str.clear();
+			for (;;) {
+				if (cur == end && !Fill()) {
+					return false;
+				}
+				const char* quote = static_cast<const char*>(memchr(cur, '"', end - cur));
+				const char* stop = quote ? quote : end;
+				if (isKept) {
+					str.append(cur, stop);
+				}
+				cur = stop;
+				if (quote) {
+					++cur;
+					break;
+				}
+			}
+			property.type = 'S';
+			if (!isKept) {
+				return true;
+			}
+			//アスキーでは '"' を &quot; と書く
+			for (size_t pos = str.find("&quot;"); pos != std::string::npos; pos = str.find("&quot;", pos + 1)) {
+				str.replace(pos, 6, 1, '"');
+			}
+			if (str.size() > 0xFFFFFFFFu) {
+				return false;
+			}
+			property.data = Store(str);
+			property.size = static_cast<uint32_t>(str.size());
+			return true;
+		}
+
+		/**
+		* 引用符のない値 (Shading: T など)
+		* T Y F N はバイナリと同じく 'C' にする
+		*/
+		bool AsciiReader::ReadWord(bool isKept, Property& property) {
+			str.clear();
+			while (IsWordChar(Peek())) {
+				if (str.size() >= 255) {
+					return false;
+				}
+				str.push_back(*cur++);
+			}
+			if (str.empty()) {
+				return false;
+			}
+			if (str == "T" || str == "Y" || str == "F" || str == "N") {
+				property.type = 'C';
+				property.integer = str == "T" || str == "Y" ? 1 : 0;
+				return true;
+			}
+			property.type = 'S';
+			if (isKept) {
+				property.data = Store(str);
+				property.size = static_cast<uint32_t>(str.size());
+			}
+			return true;
+		}
+
+		bool AsciiReader::ReadNumber(Property& property) {
+			const char* token;
+			const size_t length = ReadNumberToken(token);
+			int64_t integer = 0;
+			double real = 0;
+			bool isReal;
+			if (length == 0 || !ParseNumber(token, token + length, integer, real, isReal)) {
+				return false;
+			}
+			if (isReal) {
+				property.type = 'D';
+				property.real = real;
+			}
+			else {
+				property.type = 'L';
+				property.integer = integer;
+			}
+			return true;
+		}
+
+		/**
+		* 配列 (*要素数 { a: 値,値,... })
+		* 値はチャンクから直接変換して Document の領域に書き込むので、テキストは保持しない
+		*
+		* @param   name    配列を持つノードの名前
+		*/
+		bool AsciiReader::ReadArray(const std::string& name, bool isKept, Property& property) {
+			++cur;
+			const char* token;
+			size_t length = ReadNumberToken(token);
+			int64_t count = 0;
+			double real;
+			bool isReal;
+			if (length == 0 || !ParseNumber(token, token + length, count, real, isReal) || isReal || count < 0) {
+				return false;
+			}
+			SkipSpace(false);
+			if (Get() != '{') {
+				return false;
+			}
+
+			if (!isKept) {
+				//数値と区切りしか含まないので '}' まで飛ばす
+				for (;;) {
+					if (cur == end && !Fill()) {
+						return false;
+					}
+					const char* close = static_cast<const char*>(memchr(cur, '}', end - cur));
+					if (close) {
+						cur = close + 1;
+						property.type = 'd';
+						return true;
+					}
+					cur = end;
+				}
+			}
+
+			if (static_cast<uint64_t>(count) > maxElements) {
+				return false;
+			}
+			const size_t allocatedSize = static_cast<size_t>(count ? count : 1) * 8;
+			char* data = document->Allocate(allocatedSize);
+			int64_t index = 0;
+			//小数が出てくるまでは int64_t、出てきたらそれまでの分を double に直す
+			bool isRealArray = false;
+			//int32_t に収まる整数の配列はバイナリと同じ 'i' にする
+			bool isInt32 = true;
+			SkipSpace(true);
+			if (Peek() == 'a') {
+				++cur;
+				SkipSpace(false);
+				if (Get() != ':') {
+					return false;
+				}
+				SkipSpace(true);
+				if (Peek() != '}') {
+					for (;;) {
+						length = ReadNumberToken(token);
+						int64_t integer = 0;
+						if (length == 0 || !ParseNumber(token, token + length, integer, real, isReal) || index >= count) {
+							return false;
+						}
+						if (isReal && !isRealArray) {
+							for (int64_t i = 0; i < index; ++i) {
+								int64_t value;
+								memcpy(&value, data + i * 8, 8);
+								const double converted = static_cast<double>(value);
+								memcpy(data + i * 8, &converted, 8);
+							}
+							isRealArray = true;
+						}
+						if (isRealArray) {
+							const double value = isReal ? real : static_cast<double>(integer);
+							memcpy(data + index * 8, &value, 8);
+						}
+						else {
+							memcpy(data + index * 8, &integer, 8);
+							isInt32 = isInt32 && integer >= INT32_MIN && integer <= INT32_MAX;
+						}
+						++index;
+
+						SkipSpace(true);
+						if (Peek() != ',') {
+							break;
+						}
+						++cur;
+						SkipSpace(true);
+					}
+				}
+			}
+			if (Get() != '}' || index != count) {
+				return false;
+			}
+
+			property.size = static_cast<uint32_t>(count);
+			property.encoding = 0;
+			if (!isRealArray && (isInt32 || name == "KeyAttrDataFloat")) {
+				//前から詰めるので読む前の要素を上書きすることはない
+				for (int64_t i = 0; i < count; ++i) {
+					int64_t value;
+					memcpy(&value, data + i * 8, 8);
+					const uint32_t bits = static_cast<uint32_t>(value);
+					memcpy(data + i * 4, &bits, 4);
+				}
+				//アスキーでは KeyAttrDataFloat の float をビット列の整数として書いている
+				property.type = name == "KeyAttrDataFloat" ? 'f' : 'i';
+				property.encodedSize = static_cast<uint32_t>(count * 4);
+				data = document->Shrink(data, allocatedSize, static_cast<size_t>(count) * 4);
+			}
+			else {
+				property.type = isRealArray ? 'd' : 'l';
+				property.encodedSize = static_cast<uint32_t>(count * 8);
+			}
+			property.data = data;
+			return true;
+		}
+
+		size_t AsciiReader::ReadNumberToken(const char*& token) {
+			if (cur == end && !Fill()) {
+				return 0;
+			}
+			const char* p = cur;
+			while (p < end && IsNumberChar(*p)) {
+				++p;
+			}
+			if (p < end) {
+				//チャンク内で終わっていればそのまま使う
+				const size_t length = static_cast<size_t>(p - cur);
+				token = cur;
+				cur = p;
+				return length <= maxTokenLength ? length : 0;
+			}
+			//チャンクの終わりにかかったものは tokenBuffer に集める
+			size_t length = 0;
+			for (;;) {
+				while (cur < end && IsNumberChar(*cur)) {
+					if (length >= maxTokenLength) {
+						return 0;
+					}
+					tokenBuffer[length++] = *cur++;
+				}
+				if (cur < end || !Fill()) {
+					break;
+				}
+			}
+			token = tokenBuffer;
+			return length;
+		}
+
+		const char* AsciiReader::Intern(const std::string& name) {
+			auto itr = names.find(name);
+			if (itr != names.end()) {
+				return itr->second;
+			}
+			const char* stored = Store(name);
+			names.emplace(name, stored);
+			return stored;
+		}
+
+		const char* AsciiReader::Store(const std::string& str) {
+			char* dst = document->Allocate(str.size() ? str.size() : 1);
+			memcpy(dst, str.data(), str.size());
+			return dst;
+		}
+	}// namespace fbx
+}// namespace FbxLoader
@@ -0,0 +1,68 @@
+﻿#ifndef FbxAsciiReader_h
+#define FbxAsciiReader_h
+
+#include "FbxDocument.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace FbxLoader {
+	namespace fbx {
+		/*
+		アスキーFBX (7.x) の読み込み
+		ファイルを chunkSize ずつ読みながらトークンを切り出して Document のノードを作る
+		テキスト全体は保持せず、使わないノードは読み飛ばす
+			トップレベルは FBXHeaderExtension (FBXVersion のみ), GlobalSettings, Objects, Connections だけを残す
+			Objects の中は FbxScene で使うクラスだけを残す (Video の埋め込みデータや Pose などは捨てる)
+		数値配列はバイナリの無圧縮配列と同じ形で持つので、Document::ReadArray でそのまま読める
+			整数だけで全て int32_t に収まれば 'i' (4バイトずつ)、収まらなければ 'l' (8バイトずつ)、小数を含めば 'd'
+			(KeyAttrDataFloat は float のビット列なので 'f' に戻す)
+			ReadArray は要素の型を変換して読むので、KeyTime が 'i' になっても int64_t の配列として読める
+		*/
+		class AsciiReader {
+		public:
+			static const size_t chunkSize = 64 * 1024;
+
+			bool Read(const std::string& filename, Document& document);
+			//fd は読み込み用に開いたもの (閉じるのは呼び出し側)
+			bool Read(int fd, Document& document);
+
+		private:
+			bool Fill();
+			int Peek();
+			int Get();
+			//空白を飛ばす (isMultiLine なら改行とコメントも飛ばす)
+			void SkipSpace(bool isMultiLine);
+			void SkipLine();
+
+			bool ParseNodeList(int parent, const std::string& parentName, int depth, bool isKept);
+			bool ReadName(std::string& name);
+			bool ReadString(bool isKept, Property& property);
+			bool ReadWord(bool isKept, Property& property);
+			bool ReadNumber(Property& property);
+			bool ReadArray(const std::string& name, bool isKept, Property& property);
+			//数値の文字列を token に切り出す (長さ 0 なら数値でない)
+			size_t ReadNumberToken(const char*& token);
+			const char* Intern(const std::string& name);
+			const char* Store(const std::string& str);
+
+			Document* document = nullptr;
+			int fd = -1;
+			std::unique_ptr<char[]> buffer;
+			const char* cur = nullptr;
+			const char* end = nullptr;
+			bool isEof = false;
+			bool isError = false;
+			//配列の要素数の上限 (ファイルサイズから決める)
+			uint64_t maxElements = 0;
+			//チャンクをまたいだ数値の切り出し用
+			char tokenBuffer[64];
+			std::string str;
+			std::unordered_map<std::string, const char*> names;
+		};
+	}// namespace fbx
+}// namespace FbxLoader
+
+#endif /* FbxAsciiReader_h */
@@ -0,0 +1,437 @@
+﻿#include "FbxDocument.h"
+#include "FbxAsciiReader.h"
+#include "Inflate.h"
+#include <string.h>
+
+namespace FbxLoader {
+	namespace fbx {
+		namespace {
+			const char binaryMagic[] = "Kaydara FBX Binary  ";
+			//マジック (21byte) + 0x1A 0x00 + バージョン (4byte)
+			const size_t binaryHeaderSize = 27;
+			//ノードが深すぎるファイルは壊れているとみなす
+			const int maxDepth = 64;
+			//アスキー用の領域の確保単位 (これより大きい配列は個別に確保する)
+			const size_t blockSize = 256 * 1024;
+
+			template<typename T>
+			T ReadValue(const uint8_t* p) {
+				T ret;
+				memcpy(&ret, p, sizeof(T));
+				return ret;
+			}
+
+			size_t ElementSize(char type) {
+				switch (type) {
+				case 'b':
+					return 1;
+				case 'i':
+				case 'f':
+					return 4;
+				case 'l':
+				case 'd':
+					return 8;
+				default:
+					return 0;
+				}
+			}
+
+			template<typename T>
+			struct ArrayType;
+			template<>
+			struct ArrayType<double> { static const char value = 'd'; };
+			template<>
+			struct ArrayType<float> { static const char value = 'f'; };
+			template<>
+			struct ArrayType<int32_t> { static const char value = 'i'; };
+			template<>
+			struct ArrayType<int64_t> { static const char value = 'l'; };
+
+			template<typename T>
+			void ConvertArray(char type, const uint8_t* src, T* dst, size_t count) {
+				switch (type) {
+				case 'b':
+					for (size_t i = 0; i < count; ++i) {
+						dst[i] = static_cast<T>(src[i]);
+					}
+					break;
+				case 'i':
+					for (size_t i = 0; i < count; ++i) {
+						dst[i] = static_cast<T>(ReadValue<int32_t>(src + i * 4));
+					}
+					break;
+				case 'f':
+					for (size_t i = 0; i < count; ++i) {
+						dst[i] = static_cast<T>(ReadValue<float>(src + i * 4));
+					}
+					break;
+				case 'l':
+					for (size_t i = 0; i < count; ++i) {
+						dst[i] = static_cast<T>(ReadValue<int64_t>(src + i * 8));
+					}
+					break;
+				case 'd':
+					for (size_t i = 0; i < count; ++i) {
+						dst[i] = static_cast<T>(ReadValue<double>(src + i * 8));
+					}
+					break;
+				default:
+					break;
+				}
+			}
+
+			template<typename T>
+			bool DecodeArray(const Property& property, std::vector<T>& dst) {
+				if (!property.IsArray()) {
+					return false;
+				}
+				const size_t count = property.size;
+				const size_t bytes = count * ElementSize(property.type);
+				const uint8_t* src = reinterpret_cast<const uint8_t*>(property.data);
+				if (property.encoding == 0) {
+					dst.resize(count);
+					if (property.type == ArrayType<T>::value) {
+						memcpy(dst.data(), src, bytes);
+					}
+					else {
+						ConvertArray(property.type, src, dst.data(), count);
+					}
+					return true;
+				}
+				//deflate の最大圧縮率 (約1032倍) を超える要素数は壊れている
+				if (property.encoding != 1 || bytes / 1032 > property.encodedSize) {
+					dst.clear();
+					return false;
+				}
+				dst.resize(count);
+				if (property.type == ArrayType<T>::value) {
+					if (!Inflate(src, property.encodedSize, dst.data(), bytes)) {
+						dst.clear();
+						return false;
+					}
+					return true;
+				}
+				std::vector<uint8_t> tmp(bytes);
+				if (!Inflate(src, property.encodedSize, tmp.data(), bytes)) {
+					dst.clear();
+					return false;
+				}
+				ConvertArray(property.type, tmp.data(), dst.data(), count);
+				return true;
+			}
+		}
+
+		bool Node::Is(const char* str) const {
+			return strlen(str) == nameLength && memcmp(name, str, nameLength) == 0;
+		}
+
+		/**
+		* ファイルを開いてノード木を読む
+		*
+		* @param   filename    読み込むファイル名
+		* @retval  true : 成功 false : ファイルが開けないかFBXとして不正
+		*/
+		bool Document::Open(const std::string& filename) {
+			Clear();
+			if (!file.Open(filename)) {
+				return false;
+			}
+			if (file.Size() < binaryHeaderSize || memcmp(file.Data(), binaryMagic, sizeof(binaryMagic)) != 0) {
+				//アスキーはマップしたままにせず固定長ずつ読む
+				file.Close();
+				AsciiReader reader;
+				return reader.Read(filename, *this);
+			}
+			if (!Parse(file.Data(), file.Size())) {
+				Clear();
+				return false;
+			}
+			return true;
+		}
+
+		bool Document::Parse(const void* data, size_t size) {
+			nodes.assign(1, Node());
+			properties.clear();
+			version = 0;
+			const uint8_t* begin = static_cast<const uint8_t*>(data);
+			if (size >= binaryHeaderSize && memcmp(begin, binaryMagic, sizeof(binaryMagic)) == 0) {
+				return ParseBinary(begin, begin + size);
+			}
+			return false;
+		}
+
+		void Document::Clear() {
+			nodes.assign(1, Node());
+			properties.clear();
+			version = 0;
+			file.Close();
+			blocks.clear();
+			blockCur = nullptr;
+			blockLeft = 0;
+		}
+
+		const Node* Document::GetFirstChild(const Node& node) const {
+			return node.firstChild < 0 ? nullptr : &nodes[node.firstChild];
+		}
+
+		const Node* Document::GetNextSibling(const Node& node) const {
+			return node.nextSibling < 0 ? nullptr : &nodes[node.nextSibling];
+		}
+
+		const Node* Document::FindChild(const Node& node, const char* name) const {
+			for (const Node* child = GetFirstChild(node); child; child = GetNextSibling(*child)) {
+				if (child->Is(name)) {
+					return child;
+				}
+			}
+			return nullptr;
+		}
+
+		const Property* Document::GetProperty(const Node& node, uint32_t index) const {
+			return index < node.propertyCount ? &properties[node.firstProperty + index] : nullptr;
+		}
+
+		bool Document::ReadArray(const Property& property, std::vector<double>& dst) const {
+			return DecodeArray(property, dst);
+		}
+
+		bool Document::ReadArray(const Property& property, std::vector<float>& dst) const {
+			return DecodeArray(property, dst);
+		}
+
+		bool Document::ReadArray(const Property& property, std::vector<int32_t>& dst) const {
+			return DecodeArray(property, dst);
+		}
+
+		bool Document::ReadArray(const Property& property, std::vector<int64_t>& dst) const {
+			return DecodeArray(property, dst);
+		}
+
+		char* Document::Allocate(size_t size) {
+			size = (size + 7) & ~static_cast<size_t>(7);
+			if (size > blockSize / 4) {
+				blocks.emplace_back(new char[size]);
+				return blocks.back().get();
+			}
+			if (size > blockLeft) {
+				//使い切っていないブロックは捨てる (大きい配列は上で個別に確保するので無駄は 1/4 以下)
+				blocks.emplace_back(new char[blockSize]);
+				blockCur = blocks.back().get();
+				blockLeft = blockSize;
+			}
+			char* ret = blockCur;
+			blockCur += size;
+			blockLeft -= size;
+			return ret;
+		}
+
+		char* Document::Shrink(char* data, size_t size, size_t newSize) {
+			size = (size + 7) & ~static_cast<size_t>(7);
+			if (size <= blockSize / 4 || blocks.empty() || blocks.back().get() != data) {
+				return data;
+			}
+			std::unique_ptr<char[]> block(new char[newSize ? newSize : 1]);
+			memcpy(block.get(), data, newSize);
+			blocks.back() = std::move(block);
+			return blocks.back().get();
+		}
+
+		bool Document::ParseBinary(const uint8_t* begin, const uint8_t* end) {
+			version = ReadValue<uint32_t>(begin + 23);
+			//7.x 以降のみ対応 (6.x はオブジェクトの構成が違う)
+			if (version < 7000) {
+				return false;
+			}
+			const uint8_t* cur = begin + binaryHeaderSize;
+			return ParseNodeList(begin, cur, end, 0, 0);
+		}
+
+		/**
+		* ノードの並びを読む
+		* 終端のnullレコードか end まで読んで cur を進める
+		*
+		* @param   begin   ファイルの先頭 (ノードの終了位置はファイル先頭からのオフセット)
+		* @param   parent  追加するノードの親
+		*/
+		bool Document::ParseNodeList(const uint8_t* begin, const uint8_t*& cur, const uint8_t* end, int parent, int depth) {
+			if (depth > maxDepth) {
+				return false;
+			}
+			//7.5 からオフセットが64bit
+			const bool isWide = version >= 7500;
+			const size_t headerSize = isWide ? 25 : 13;
+			int prev = -1;
+			while (static_cast<size_t>(end - cur) >= headerSize) {
+				uint64_t endOffset, propertyCount, propertyBytes;
+				if (isWide) {
+					endOffset = ReadValue<uint64_t>(cur);
+					propertyCount = ReadValue<uint64_t>(cur + 8);
+					propertyBytes = ReadValue<uint64_t>(cur + 16);
+				}
+				else {
+					endOffset = ReadValue<uint32_t>(cur);
+					propertyCount = ReadValue<uint32_t>(cur + 4);
+					propertyBytes = ReadValue<uint32_t>(cur + 8);
+				}
+				const uint8_t nameLength = cur[headerSize - 1];
+				//nullレコード
+				if (endOffset == 0) {
+					cur += headerSize;
+					return true;
+				}
+
+				const uint8_t* propertyBegin = cur + headerSize + nameLength;
+				if (endOffset > static_cast<uint64_t>(end - begin) || begin + endOffset < propertyBegin) {
+					return false;
+				}
+				const uint8_t* nodeEnd = begin + endOffset;
+				if (propertyBytes > static_cast<uint64_t>(nodeEnd - propertyBegin) || propertyCount > propertyBytes) {
+					return false;
+				}
+
+				const int index = static_cast<int>(nodes.size());
+				Node node;
+				node.name = reinterpret_cast<const char*>(cur + headerSize);
+				node.nameLength = nameLength;
+				node.firstProperty = static_cast<uint32_t>(properties.size());
+				node.propertyCount = static_cast<uint32_t>(propertyCount);
+				nodes.push_back(node);
+				if (prev < 0) {
+					nodes[parent].firstChild = index;
+				}
+				else {
+					nodes[prev].nextSibling = index;
+				}
+				prev = index;
+
+				const uint8_t* propertyCur = propertyBegin;
+				const uint8_t* propertyEnd = propertyBegin + propertyBytes;
+				for (uint64_t i = 0; i < propertyCount; ++i) {
+					Property property;
+					if (!ParseProperty(propertyCur, propertyEnd, property)) {
+						return false;
+					}
+					properties.push_back(property);
+				}
+
+				if (propertyEnd < nodeEnd) {
+					const uint8_t* childCur = propertyEnd;
+					if (!ParseNodeList(begin, childCur, nodeEnd, index, depth + 1)) {
+						return false;
+					}
+				}
+				cur = nodeEnd;
+			}
+			//トップレベルはnullレコードの後にフッターが続くので、子の並びだけ厳密に終端を見る
+			return depth == 0 || cur == end;
+		}
+
+		bool Document::ParseProperty(const uint8_t*& cur, const uint8_t* end, Property& property) {
+			if (cur >= end) {
+				return false;
+			}
+			property.type = static_cast<char>(*cur++);
+			const size_t left = static_cast<size_t>(end - cur);
+			switch (property.type) {
+			case 'Y':
+				if (left < 2) {
+					return false;
+				}
+				property.integer = ReadValue<int16_t>(cur);
+				cur += 2;
+				return true;
+			case 'C':
+				if (left < 1) {
+					return false;
+				}
+				property.integer = *cur ? 1 : 0;
+				cur += 1;
+				return true;
+			case 'I':
+				if (left < 4) {
+					return false;
+				}
+				property.integer = ReadValue<int32_t>(cur);
+				cur += 4;
+				return true;
+			case 'F':
+				if (left < 4) {
+					return false;
+				}
+				property.real = ReadValue<float>(cur);
+				cur += 4;
+				return true;
+			case 'D':
+				if (left < 8) {
+					return false;
+				}
+				property.real = ReadValue<double>(cur);
+				cur += 8;
+				return true;
+			case 'L':
+				if (left < 8) {
+					return false;
+				}
+				property.integer = ReadValue<int64_t>(cur);
+				cur += 8;
+				return true;
+			case 'S':
+			case 'R': {
+				if (left < 4) {
+					return false;
+				}
+				const uint32_t length = ReadValue<uint32_t>(cur);
+				if (length > left - 4) {
+					return false;
+				}
+				property.data = reinterpret_cast<const char*>(cur + 4);
+				property.size = length;
+				cur += 4 + length;
+				return true;
+			}
+			case 'f':
+			case 'd':
+			case 'l':
+			case 'i':
+			case 'b': {
+				if (left < 12) {
+					return false;
+				}
+				property.size = ReadValue<uint32_t>(cur);
+				property.encoding = ReadValue<uint32_t>(cur + 4);
+				property.encodedSize = ReadValue<uint32_t>(cur + 8);
+				if (property.encodedSize > left - 12) {
+					return false;
+				}
+				if (property.encoding == 0 && property.encodedSize != static_cast<uint64_t>(property.size) * ElementSize(property.type)) {
+					return false;
+				}
+				property.data = reinterpret_cast<const char*>(cur + 12);
+				cur += 12 + property.encodedSize;
+				return true;
+			}
+			default:
+				return false;
+			}
+		}
+
+		std::string ObjectName(const Property& property) {
+			if (!property.IsString()) {
+				return std::string();
+			}
+			const char* begin = property.data;
+			const char* end = property.data + property.size;
+			for (const char* p = begin; p + 1 < end; ++p) {
+				if (p[0] == '\0' && p[1] == '\x01') {
+					return std::string(begin, p);
+				}
+			}
+			for (const char* p = begin; p + 1 < end; ++p) {
+				if (p[0] == ':' && p[1] == ':') {
+					return std::string(p + 2, end);
+				}
+			}
+			return std::string(begin, end);
+		}
+	}// namespace fbx
+}// namespace FbxLoader
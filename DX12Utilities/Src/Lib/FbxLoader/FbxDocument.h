@@ -0,0 +1,134 @@
+﻿#ifndef FbxDocument_h
+#define FbxDocument_h
+
+#include "MappedFile.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace FbxLoader {
+	namespace fbx {
+		/*
+		ノードのプロパティ (type はバイナリFBXの型コード)
+			'Y' 'C' 'I' 'L' : integer
+			'F' 'D'         : real
+			'S' 'R'         : data から size バイト
+			'f' 'd' 'l' 'i' 'b' : 配列 (size は要素数)
+			                  data から encodedSize バイトが encoding (0 : 無圧縮, 1 : zlib) で格納されている
+		data はバイナリならファイルのマップ領域、アスキーなら Document の確保した領域を指す
+		*/
+		struct Property {
+			char type = 0;
+			int64_t integer = 0;
+			double real = 0;
+			const char* data = nullptr;
+			uint32_t size = 0;
+			uint32_t encoding = 0;
+			uint32_t encodedSize = 0;
+
+			bool IsArray() const {
+				return type == 'f' || type == 'd' || type == 'l' || type == 'i' || type == 'b';
+			}
+
+			bool IsString() const {
+				return type == 'S' || type == 'R';
+			}
+
+			int64_t AsInt() const {
+				return type == 'F' || type == 'D' ? static_cast<int64_t>(real) : integer;
+			}
+
+			double AsDouble() const {
+				return type == 'F' || type == 'D' ? real : static_cast<double>(integer);
+			}
+
+			std::string AsString() const {
+				return IsString() ? std::string(data, size) : std::string();
+			}
+		};
+
+		/*
+		ノード
+		子は firstChild から nextSibling をたどる (-1 で終端)
+		*/
+		struct Node {
+			const char* name = nullptr;
+			uint32_t nameLength = 0;
+			uint32_t firstProperty = 0;
+			uint32_t propertyCount = 0;
+			int firstChild = -1;
+			int nextSibling = -1;
+
+			bool Is(const char* str) const;
+		};
+
+		class AsciiReader;
+
+		/*
+		FBXファイルのノード木
+		バイナリはメモリマップして、ノードとプロパティの位置だけを読む (配列は ReadArray を呼んだ時に展開する)
+		アスキーは AsciiReader で必要なノードだけを読み込む
+		*/
+		class Document {
+		public:
+			bool Open(const std::string& filename);
+			//data は Document より長く保持すること
+			bool Parse(const void* data, size_t size);
+			void Clear();
+
+			//7400 なら 7.4
+			uint32_t GetVersion() const { return version; }
+
+			//トップレベルのノードを子に持つ仮のノード
+			const Node& GetRoot() const { return nodes[0]; }
+			const Node* GetFirstChild(const Node& node) const;
+			const Node* GetNextSibling(const Node& node) const;
+			const Node* FindChild(const Node& node, const char* name) const;
+			//範囲外なら nullptr
+			const Property* GetProperty(const Node& node, uint32_t index) const;
+
+			/*
+			配列プロパティを展開して dst に格納する (要素の型は T に変換する)
+			型が一致する場合は dst に直接展開する
+			配列でない場合や展開に失敗した場合は false
+			*/
+			bool ReadArray(const Property& property, std::vector<double>& dst) const;
+			bool ReadArray(const Property& property, std::vector<float>& dst) const;
+			bool ReadArray(const Property& property, std::vector<int32_t>& dst) const;
+			bool ReadArray(const Property& property, std::vector<int64_t>& dst) const;
+
+		private:
+			friend class AsciiReader;
+
+			bool ParseBinary(const uint8_t* begin, const uint8_t* end);
+			bool ParseNodeList(const uint8_t* begin, const uint8_t*& cur, const uint8_t* end, int parent, int depth);
+			bool ParseProperty(const uint8_t*& cur, const uint8_t* end, Property& property);
+
+			MappedFile file;
+			uint32_t version = 0;
+			std::vector<Node> nodes = std::vector<Node>(1);
+			std::vector<Property> properties;
+
+			//アスキーの名前・文字列・配列の格納先 (8byte境界, 解放は Clear でまとめて行う)
+			char* Allocate(size_t size);
+			//直前に Allocate した領域を newSize バイトに詰める (個別に確保した大きい領域だけ作り直す)
+			char* Shrink(char* data, size_t size, size_t newSize);
+			std::vector<std::unique_ptr<char[]>> blocks;
+			char* blockCur = nullptr;
+			size_t blockLeft = 0;
+		};
+
+		/*
+		オブジェクト名の取り出し
+		バイナリは "名前\x00\x01クラス"、アスキーは "クラス::名前" の形式
+		*/
+		std::string ObjectName(const Property& property);
+
+		//FBXの時間 (1秒あたりのtick数)
+		const int64_t TimeSecond = 46186158000ll;
+	}// namespace fbx
+}// namespace FbxLoader
+
+#endif /* FbxDocument_h */
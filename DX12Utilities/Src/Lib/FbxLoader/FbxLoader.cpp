@@ -1,4 +1,6 @@
 ﻿#include "FbxLoader.h"
+#include "MeshBuilder.h"
+#include "../../Math/Batch/Transform.h"
 #include <algorithm>
 #include <time.h>
 
@@ -57,6 +59,19 @@ namespace FbxLoader {
 	* @retval  true : 初期化成功 false : 初期化に失敗
 	*/
 	bool Loader::Initialize(const std::string& filename) {
+		cache.Close();
+		return ImportScene(filename);
+	}
+
+	/**
+	* FBX をシーンに読み込んで三角形化する (キャッシュはそのまま)
+	*
+	* @param   filename    読み込むファイル名
+	* @retval  true : 成功 false : 失敗
+	*/
+	bool Loader::ImportScene(const std::string& filename) {
+		sourceFilename = filename;
+		isSourceImported = false;
 		pManager = FbxManager::Create();
 
 		FbxIOSettings* ios = FbxIOSettings::Create(pManager, IOSROOT);
@@ -75,9 +90,52 @@ namespace FbxLoader {
 
 		FbxGeometryConverter gConverter(pManager);
 		gConverter.Triangulate(pScene, true);
+		isSourceImported = true;
 		return true;
 	}
 
+	/**
+	* キャッシュを使う初期化関数
+	*
+	* @param   filename        読み込むファイル名
+	* @param   cacheFilename   キャッシュファイル名 (なければ作る)
+	* @retval  true : 初期化成功 false : 初期化に失敗
+	*/
+	bool Loader::Initialize(const std::string& filename, const std::string& cacheFilename) {
+		uint64_t sourceHash, sourceSize;
+		if (!HashFile(filename, sourceHash, sourceSize)) {
+			printf("Failed to open %s.\n", filename.c_str());
+			return false;
+		}
+		if (cache.Open(cacheFilename, sourceHash, sourceSize, GetCacheOptions())) {
+			sourceFilename = filename;
+			isSourceImported = false;
+			return true;
+		}
+		if (!Initialize(filename)) {
+			return false;
+		}
+		BoneTreeData boneTree;
+		std::vector<StaticMesh> staticMeshes;
+		std::vector<SkinnedMesh> skinnedMeshes;
+		std::vector<Animation> animations;
+		LoadBone(boneTree);
+		LoadAllMesh(staticMeshes, skinnedMeshes);
+		LoadAnimation(animations);
+		//書けなくても FBX から読んだ内容で続ける
+		if (!MeshCache::Write(cacheFilename, sourceHash, sourceSize, GetCacheOptions(), staticMeshes, skinnedMeshes, boneTree, animations) ||
+			!cache.Open(cacheFilename, sourceHash, sourceSize, GetCacheOptions())) {
+			printf("Failed to write cache %s.\n", cacheFilename.c_str());
+		}
+		return true;
+	}
+
+	uint32_t Loader::GetCacheOptions() const {
+		return (boneBaseGetFromLink ? static_cast<uint32_t>(MeshCache::OptionBoneBaseGetFromLink) : 0u) |
+			(bakeBaseInv ? static_cast<uint32_t>(MeshCache::OptionBakeBaseInv) : 0u) |
+			(optimizeVertexCache ? static_cast<uint32_t>(MeshCache::OptionOptimizeVertexCache) : 0u);
+	}
+
 	/**
 	* ボーンのルートを探す
 	*
@@ -148,6 +206,10 @@ namespace FbxLoader {
 	*/
 
 	void Loader::LoadBone(BoneTreeData& boneTree) {
+		if (cache.IsOpen()) {
+			cache.LoadBone(boneTree);
+			return;
+		}
 		if (isBoneTreeInitialized) {
 			boneTree = publicBoneTree;
 			return;
@@ -169,10 +231,16 @@ namespace FbxLoader {
 
 				boneTree.data.push_back(boneData);
 
+				//push_back で参照が無効になるので、子は集めてから格納済みの要素に入れる (スケルトン以外の子は含めない)
+				std::vector<int> children;
 				int childCount = node->GetChildCount();
 				for (int i = 0; i < childCount; ++i) {
-					boneData.children.push_back(Run(node->GetChild(i), boneTree, boneData.boneId));
+					const int childId = Run(node->GetChild(i), boneTree, boneData.boneId);
+					if (childId >= 0) {
+						children.push_back(childId);
+					}
 				}
+				boneTree.data[boneData.boneId].children = std::move(children);
 				return boneData.boneId;
 			}
 		};
@@ -222,50 +290,73 @@ namespace FbxLoader {
 	* @param   skinnedMeshes   アニメーションをするメッシュの格納先
 	*/
 	void Loader::LoadAllMesh(std::vector<StaticMesh>& staticMeshes, std::vector<SkinnedMesh>& skinnedMeshes) {
+		if (cache.IsOpen()) {
+			cache.LoadAllMesh(staticMeshes, skinnedMeshes);
+			return;
+		}
+		//SDK からの読み出しは順に、頂点の構築は並列に行う
+		std::vector<MeshSource> staticSources;
+		std::vector<MeshSource> skinnedSources;
 		int meshCount = pScene->GetSrcObjectCount<FbxMesh>();
 		for (int meshIndex = 0; meshIndex < meshCount; ++meshIndex) {
 			FbxMesh* mesh = pScene->GetSrcObject<FbxMesh>(meshIndex);
 			if (mesh->GetDeformerCount(FbxDeformer::eSkin) > 0) {
-				int smIndex = skinnedMeshes.size();
-				skinnedMeshes.push_back({});
-				LoadSkinnedMesh(pScene->GetSrcObject<FbxMesh>(meshIndex), skinnedMeshes[smIndex]);
+				skinnedSources.push_back({});
+				ExtractMesh(mesh, true, skinnedSources.back());
 			}
 			else {
-				int smIndex = staticMeshes.size();
-				staticMeshes.push_back({});
-				LoadStaticeMesh(mesh, staticMeshes[smIndex]);
+				staticSources.push_back({});
+				ExtractMesh(mesh, false, staticSources.back());
 			}
 		}
+		BuildMeshes(staticSources, staticMeshes, skinnedSources, skinnedMeshes, threadCount, optimizeVertexCache, &vertexCacheReports);
 	}
 
 	void Loader::LoadSkinnedMesh(std::vector<SkinnedMesh>& meshes) {
+		if (cache.IsOpen()) {
+			cache.LoadSkinnedMesh(meshes);
+			return;
+		}
+		std::vector<MeshSource> staticSources;
+		std::vector<MeshSource> skinnedSources;
+		std::vector<StaticMesh> staticMeshes;
 		int meshCount = pScene->GetSrcObjectCount<FbxMesh>();
 		for (int i = 0; i < meshCount; ++i) {
 			FbxMesh* mesh = pScene->GetSrcObject<FbxMesh>(i);
 			if (mesh->GetDeformerCount(FbxDeformer::eSkin) > 0) {
-				int smIndex = meshes.size();
-				meshes.push_back({});
-				LoadSkinnedMesh(mesh, meshes[smIndex]);
+				skinnedSources.push_back({});
+				ExtractMesh(mesh, true, skinnedSources.back());
 			}
 		}
+		BuildMeshes(staticSources, staticMeshes, skinnedSources, meshes, threadCount, optimizeVertexCache, &vertexCacheReports);
 	}
 	void Loader::LoadStaticMesh(std::vector<StaticMesh>& meshes) {
+		//キャッシュにはスキンのあるメッシュの静的メッシュ版がないので FBX から作る
+		if (!isSourceImported && !ImportScene(sourceFilename)) {
+			return;
+		}
 		int meshCount = pScene->GetSrcObjectCount<FbxMesh>();
-		meshes.resize(meshCount);
+		std::vector<MeshSource> staticSources(meshCount);
+		std::vector<MeshSource> skinnedSources;
+		std::vector<SkinnedMesh> skinnedMeshes;
 		for (int i = 0; i < meshCount; ++i) {
-			LoadStaticeMesh(pScene->GetSrcObject<FbxMesh>(i), meshes[i]);
+			ExtractMesh(pScene->GetSrcObject<FbxMesh>(i), false, staticSources[i]);
 		}
+		meshes.clear();
+		BuildMeshes(staticSources, meshes, skinnedSources, skinnedMeshes, threadCount, optimizeVertexCache, &vertexCacheReports);
 	}
 
 
 	/**
-	* アニメーションをするメッシュの読み込み
+	* メッシュから三角形化済みのデータを取り出す
+	* SDK はスレッドセーフでないので、SDK に触れる処理はここで済ませて頂点の構築は BuildMesh で行う
 	*
-	* @param   mesh    ノードから取得したメッシュ
-	* @param   meshRef 読み込んだデータの格納先
+	* @param   mesh        ノードから取得したメッシュ
+	* @param   isSkinned   ウェイトを読むか
+	* @param   source      取り出したデータの格納先
 	*/
-	void Loader::LoadSkinnedMesh(FbxMesh* mesh, SkinnedMesh& meshRef) {
-		meshRef.name = mesh->GetNode()->GetName();
+	void Loader::ExtractMesh(FbxMesh* mesh, bool isSkinned, MeshSource& source) {
+		source.name = mesh->GetNode()->GetName();
 
 		auto toVector4 = [](auto v) {
 			return mff::Vector4<float>(v[0], v[1], v[2], v[3]);
@@ -284,90 +375,58 @@ namespace FbxLoader {
 		//頂点配列
 		FbxVector4* controlPoints = mesh->GetControlPoints();
 
-		int skinCount = mesh->GetDeformerCount(FbxDeformer::eSkin);
-
-		//      差分
-		//----------------------------------------------------------------------
-
-		if (!isBoneTreeInitialized) {
-			BoneTreeData tmp;
-			LoadBone(tmp);
-		}
+		if (isSkinned) {
+			if (!isBoneTreeInitialized) {
+				BoneTreeData tmp;
+				LoadBone(tmp);
+			}
 
-		std::vector<PerCpBoneIndexAndWeight> cpWeights(cpCount);
-		if (skinCount) {
+			source.cpWeights.resize(cpCount);
+			int skinCount = mesh->GetDeformerCount(FbxDeformer::eSkin);
 			for (int i = 0; i < skinCount; ++i) {
 				FbxSkin* skin = static_cast<FbxSkin*>(mesh->GetDeformer(i, FbxDeformer::eSkin));
-				if (skin) {
-					int clusterCount = skin->GetClusterCount();
-					for (int clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex) {
-						FbxCluster* cluster = skin->GetCluster(clusterIndex);
-						//                    switch (cluster->GetLinkMode()) {
-						//                        case fbxsdk::FbxCluster::eAdditive:
-						//                            std::cout << "additive" << std::endl;
-						//                            break;
-						//                        case fbxsdk::FbxCluster::eNormalize:
-						//                            std::cout << "normalize" << std::endl;
-						//                            break;
-						//                        default:
-						//                            std::cout << "total1" << std::endl;
-						//                            break;
-						//                    }
-
-						BoneData* pData = publicBoneTree.FindBone(cluster->GetLink()->GetName());
-
-						//影響を与える頂点インデックス(ControlPointのIndex)とそのWeightの取得
-						int relatedCpCount = cluster->GetControlPointIndicesCount();
-						int* relatedCpIndex = cluster->GetControlPointIndices();
-						double* weights = cluster->GetControlPointWeights();
-						for (int r = 0; r < relatedCpCount; ++r) {
-							std::vector<std::pair<int, double>>& pair = cpWeights[relatedCpIndex[r]].weights;
-
-							cpWeights[relatedCpIndex[r]].weights.push_back({ pData ? pData->boneId : clusterIndex, weights[r] });
-						}
+				if (!skin) {
+					continue;
+				}
+				int clusterCount = skin->GetClusterCount();
+				for (int clusterIndex = 0; clusterIndex < clusterCount; ++clusterIndex) {
+					FbxCluster* cluster = skin->GetCluster(clusterIndex);
+					BoneData* pData = publicBoneTree.FindBone(cluster->GetLink()->GetName());
+
+					//影響を与える頂点インデックス(ControlPointのIndex)とそのWeightの取得
+					int relatedCpCount = cluster->GetControlPointIndicesCount();
+					int* relatedCpIndex = cluster->GetControlPointIndices();
+					double* weights = cluster->GetControlPointWeights();
+					for (int r = 0; r < relatedCpCount; ++r) {
+						source.cpWeights[relatedCpIndex[r]].weights.push_back({ pData ? pData->boneId : clusterIndex, weights[r] });
 					}
 				}
 			}
-
 			//ウェイトを４つに制限とウェイトを正規化
-			for (auto& w : cpWeights) {
-				double sum = 0;
-				int count = 0;
-				if (w.weights.size() > 4) {
-					std::sort(w.weights.begin(), w.weights.end(), [](const std::pair<int, double>& a, const std::pair<int, double>& b) { return a.second > b.second; });
-					w.weights.erase(w.weights.begin() + 4, w.weights.end());
-				}
-
-				for (auto& weight : w.weights) {
-					sum += weight.second;
-					count++;
-				}
-				for (auto& weight : w.weights) {
-					weight.second /= sum;
-				}
-			}
+			LimitWeights(source.cpWeights);
 		}
 
-		//----------------------------------------------------------------------
-
-
 		FbxNode* meshNode = mesh->GetNode();
 
 		FbxAMatrix mat = meshNode->EvaluateGlobalTransform();
 		FbxAMatrix rot(FbxVector4(0, 0, 0), mat.GetR(), FbxVector4(1, 1, 1));
 
+		//コントロールポイントを一括で変換しておく
+		source.positions.resize(cpCount);
+		for (int i = 0; i < cpCount; ++i) {
+			source.positions[i] = toVector3(controlPoints[i]);
+		}
+		mff::TransformPoints(mff::Transpose(toMyMat(mat)), source.positions.data(), source.positions.data(), source.positions.size());
+
 		int materialCount = mesh->GetNode()->GetMaterialCount();
-		//            std::cout << "material num : " << materialCount << std::endl;
 		materialCount = materialCount ? materialCount : 1;
-
-		auto& materials = meshRef.materials;
-		materials.resize(materialCount);
+		source.materials.resize(materialCount);
 
 		//テクスチャ取得
 		for (int i = 0; i < materialCount; ++i) {
 			FbxSurfaceMaterial* material = meshNode->GetMaterial(i);
 			if (material) {
-				materials[i].name = material->GetName();
+				source.materials[i].name = material->GetName();
 				FbxProperty property = material->FindProperty(FbxSurfaceMaterial::sDiffuse);
 				int layerNum = property.GetSrcObjectCount<FbxLayeredTexture>();
 				if (0 < layerNum) {
@@ -377,25 +436,17 @@ namespace FbxLoader {
 						for (int textureIndex = 0; textureIndex < textureCount; ++textureIndex) {
 							FbxFileTexture* texture = layeredTexture->GetSrcObject<FbxFileTexture>(textureIndex);
 							if (texture) {
-								std::string textureName = texture->GetRelativeFileName();
-								std::cout << textureName << std::endl;
-								materials[i].textureName.push_back(textureName);
+								source.materials[i].textureName.push_back(texture->GetRelativeFileName());
 							}
 						}
 					}
 				}
 				else {
 					int fileTextureCount = property.GetSrcObjectCount<FbxFileTexture>();
-					if (0 < fileTextureCount) {
-						for (int j = 0; j < fileTextureCount; ++j) {
-							FbxFileTexture* texture = property.GetSrcObject<FbxFileTexture>(j);
-							if (texture) {
-								std::string textureName = texture->GetRelativeFileName();
-								materials[i].textureName.push_back(textureName);
-								std::string UVSetName = texture->UVSet.Get().Buffer();
-								std::cout << textureName << std::endl;
-								std::cout << UVSetName << std::endl;
-							}
+					for (int j = 0; j < fileTextureCount; ++j) {
+						FbxFileTexture* texture = property.GetSrcObject<FbxFileTexture>(j);
+						if (texture) {
+							source.materials[i].textureName.push_back(texture->GetRelativeFileName());
 						}
 					}
 				}
@@ -449,272 +500,53 @@ namespace FbxLoader {
 			materialIndexList = &fbxMaterialLayer->GetIndexArray();
 		}
 
-		//最適化用
-		//[マテリアルカウント][cpIndex]
-		std::vector<std::vector<Relation>> relations(materialCount);
-		for (auto& rel : relations) {
-			rel.resize(cpCount);
-		}
-
 		const int polygonCount = mesh->GetPolygonCount();
-
-		int polygonVertex = 0;
-		for (int polygonIndex = 0; polygonIndex < polygonCount; ++polygonIndex) {
-			for (int pos = 0; pos < 3; ++pos) {
-				const int cpIndex = mesh->GetPolygonVertex(polygonIndex, pos);
-				SkinnedVertex v;
-				v.position = toVector3(mat.MultT(controlPoints[cpIndex]));
-				static float buf = 10.0f;
-				static int cou = 0;
-				cou++;
-
-				if (hasColor) {
-					v.color = toVector4(GetElement(colorMappingMode, isColorDirectRef, colorIndexList, colorList, cpIndex, polygonVertex, FbxColor(1, 1, 1, 1)));
-				}
-				if (hasTexCoord) {
-					FbxVector2 uv;
-					bool unmapped;
-					mesh->GetPolygonVertexUV(polygonIndex, pos, uvSetNameList[0], uv, unmapped);
-					v.texCoord = toVector2(uv);
-				}
-
-				if (hasNormal) {
-					FbxVector4 norm;
-					mesh->GetPolygonVertexNormal(polygonIndex, pos, norm);
-					v.normal = mff::Normalize<float>(toVector3(rot.MultT(norm)));
-				}
-
-				v.tangent = mff::Vector4<float>(1, 0, 0, 1);
-				if (hasTangent) {
-					mff::Vector3<float> binormal = toVector3
-					(rot.MultT(GetElement(binormalMappingMode, isBinormalDirectRef, binormalIndexList, binormalList,
-						cpIndex, polygonVertex, FbxVector4(0, 0, 0, 1))));
-
-					mff::Vector3<float> tangent = toVector3
-					(rot.MultT(GetElement(tangentMappingMode, isTangentDirectRef, tangentIndexList, tangentList,
-						cpIndex, polygonVertex, FbxVector4(1, 0, 0, 1))));
-
-					v.tangent = mff::Vector4<float>(tangent, 1);
-
-					mff::Vector3<float> binormalTmp = Normalize(cross(v.normal, tangent));
-					if (dot(binormal, binormalTmp) < 0) {
-						v.tangent.w = -1;
-					}
-				}
-
-				//                    v.color = Vector4((Vector3(1,1,1) + v.normal) * 0.5f);
-
-
-				//----------------------------------------------------------------------
-				//差分
-
-				for (int boneIndex = 0; boneIndex < cpWeights[cpIndex].weights.size(); ++boneIndex) {
-					v.boneIndex[boneIndex] = cpWeights[cpIndex].weights[boneIndex].first;
-					v.weights[boneIndex] = cpWeights[cpIndex].weights[boneIndex].second;
-				}
-
-				//----------------------------------------------------------------------
-
-				//ポリゴンの所属するマテリアルのインデックスの取得
-				int materialIndex = materialIndexList ? (*materialIndexList)[polygonIndex] : 0;
-				Material<SkinnedVertex>& materialData = materials[materialIndex];
-
-				int size = relations[materialIndex][cpIndex].relatedIndex.size();
-				if (size == 0) {
-					int pushIndex = materialData.verteces.size();
-					materialData.indeces.push_back(pushIndex);
-					materialData.verteces.push_back(v);
-					relations[materialIndex][cpIndex].relatedIndex.push_back(pushIndex);
-				}
-				else {
-					bool isSame = false;
-					auto itr = relations[materialIndex][cpIndex].relatedIndex.begin();
-					for (; itr != relations[materialIndex][cpIndex].relatedIndex.end(); ++itr) {
-						SkinnedVertex& tmp = materialData.verteces[*itr];
-						if (tmp.color == v.color &&
-							tmp.texCoord == v.texCoord &&
-							tmp.normal == v.normal) {
-							isSame = true;
-							break;
-						}
-					}
-					if (isSame) {
-						materialData.indeces.push_back(*itr);
-					}
-					else {
-						int pushIndex = materialData.verteces.size();
-						materialData.indeces.push_back(pushIndex);
-						materialData.verteces.push_back(v);
-						relations[materialIndex][cpIndex].relatedIndex.push_back(pushIndex);
-					}
-				}
-				++polygonVertex;
-			}
+		const size_t cornerCount = static_cast<size_t>(polygonCount) * 3;
+		source.cpIndices.reserve(cornerCount);
+		if (hasColor) {
+			source.colors.reserve(cornerCount);
 		}
-	}
-
-
-	/**
-	* アニメーションをしないメッシュの読み込み
-	*
-	* @param   mesh    読み込むメッシュ
-	* @param   meshRef 読み込んだデータの格納先
-	*/
-	void Loader::LoadStaticeMesh(fbxsdk::FbxMesh* mesh, StaticMesh& meshRef) {
-		meshRef.name = mesh->GetNode()->GetName();
-
-		auto toVector4 = [](auto v) {
-			return mff::Vector4<float>(v[0], v[1], v[2], v[3]);
-		};
-
-		auto toVector3 = [](auto v) {
-			return mff::Vector3<float>(v[0], v[1], v[2]);
-		};
-
-		auto toVector2 = [](FbxVector2 v) {
-			return mff::Vector2<float>(v[0], v[1]);
-		};
-
-		//頂点数
-		int cpCount = mesh->GetControlPointsCount();
-		//頂点配列
-		FbxVector4* controlPoints = mesh->GetControlPoints();
-
-		FbxNode* meshNode = mesh->GetNode();
-
-		FbxAMatrix mat = meshNode->EvaluateGlobalTransform();
-		FbxAMatrix rot(FbxVector4(0, 0, 0), mat.GetR(), FbxVector4(1, 1, 1));
-
-		int materialCount = mesh->GetNode()->GetMaterialCount();
-		//            std::cout << "material num : " << materialCount << std::endl;
-		materialCount = materialCount ? materialCount : 1;
-
-		auto& materials = meshRef.materials;
-		materials.resize(materialCount);
-
-		//テクスチャ取得
-		for (int i = 0; i < materialCount; ++i) {
-			FbxSurfaceMaterial* material = meshNode->GetMaterial(i);
-			if (material) {
-				materials[i].name = material->GetName();
-				FbxProperty property = material->FindProperty(FbxSurfaceMaterial::sDiffuse);
-				int layerNum = property.GetSrcObjectCount<FbxLayeredTexture>();
-				if (0 < layerNum) {
-					for (int j = 0; j < layerNum; ++j) {
-						FbxLayeredTexture* layeredTexture = property.GetSrcObject<FbxLayeredTexture>(j);
-						int textureCount = layeredTexture->GetSrcObjectCount<FbxFileTexture>();
-						for (int textureIndex = 0; textureIndex < textureCount; ++textureIndex) {
-							FbxFileTexture* texture = layeredTexture->GetSrcObject<FbxFileTexture>(textureIndex);
-							if (texture) {
-								std::string textureName = texture->GetRelativeFileName();
-								//std::cout << textureName << std::endl;
-								materials[i].textureName.push_back(textureName);
-							}
-						}
-					}
-				}
-				else {
-					int fileTextureCount = property.GetSrcObjectCount<FbxFileTexture>();
-					if (0 < fileTextureCount) {
-						for (int j = 0; j < fileTextureCount; ++j) {
-							FbxFileTexture* texture = property.GetSrcObject<FbxFileTexture>(j);
-							if (texture) {
-								std::string textureName = texture->GetRelativeFileName();
-								materials[i].textureName.push_back(textureName);
-								std::string UVSetName = texture->UVSet.Get().Buffer();
-								//std::cout << textureName << std::endl;
-								//std::cout << UVSetName << std::endl;
-							}
-						}
-					}
-				}
-			}
+		if (hasTexCoord) {
+			source.texCoords.reserve(cornerCount);
 		}
-
-		// attribute取得
-		const bool hasColor = mesh->GetElementVertexColorCount() > 0;
-		const bool hasNormal = mesh->GetElementNormalCount() > 0;
-		const bool hasTexCoord = mesh->GetElementUVCount() > 0;
-		const bool hasTangent = mesh->GetElementTangentCount() > 0;
-
-		FbxStringList uvSetNameList;
-		mesh->GetUVSetNames(uvSetNameList);
-
-		FbxGeometryElement::EMappingMode colorMappingMode = FbxGeometryElement::EMappingMode::eNone;
-		bool isColorDirectRef = true;
-		const FbxLayerElementArrayTemplate<int>* colorIndexList = nullptr;
-		const FbxLayerElementArrayTemplate<FbxColor>* colorList = nullptr;
-		if (hasColor) {
-			const FbxGeometryElementVertexColor* fbxColorList = mesh->GetElementVertexColor();
-			colorMappingMode = fbxColorList->GetMappingMode();
-			isColorDirectRef = fbxColorList->GetReferenceMode() == FbxLayerElement::eDirect;
-			colorIndexList = &fbxColorList->GetIndexArray();
-			colorList = &fbxColorList->GetDirectArray();
+		if (hasNormal) {
+			source.normals.reserve(cornerCount);
 		}
-
-		FbxGeometryElement::EMappingMode tangentMappingMode = FbxGeometryElement::EMappingMode::eNone;
-		bool isTangentDirectRef = true;
-		const FbxLayerElementArrayTemplate<int>* tangentIndexList = nullptr;
-		const FbxLayerElementArrayTemplate<FbxVector4>* tangentList = nullptr;
-		FbxGeometryElement::EMappingMode binormalMappingMode = FbxGeometryElement::EMappingMode::eNone;
-		bool isBinormalDirectRef = true;
-		const FbxLayerElementArrayTemplate<int>* binormalIndexList = nullptr;
-		const FbxLayerElementArrayTemplate<FbxVector4>* binormalList = nullptr;
 		if (hasTangent) {
-			const FbxGeometryElementTangent* fbxTangentList = mesh->GetElementTangent();
-			tangentMappingMode = fbxTangentList->GetMappingMode();
-			isTangentDirectRef = fbxTangentList->GetReferenceMode() == FbxLayerElement::eDirect;
-			tangentIndexList = &fbxTangentList->GetIndexArray();
-			tangentList = &fbxTangentList->GetDirectArray();
-			const FbxGeometryElementBinormal* fbxBinormalList = mesh->GetElementBinormal();
-			binormalMappingMode = fbxBinormalList->GetMappingMode();
-			isBinormalDirectRef = fbxBinormalList->GetReferenceMode() == FbxLayerElement::eDirect;
-			binormalIndexList = &fbxBinormalList->GetIndexArray();
-			binormalList = &fbxBinormalList->GetDirectArray();
-		}
-
-		const FbxLayerElementArrayTemplate<int>* materialIndexList = nullptr;
-		if (FbxGeometryElementMaterial* fbxMaterialLayer = mesh->GetElementMaterial()) {
-			materialIndexList = &fbxMaterialLayer->GetIndexArray();
+			source.tangents.reserve(cornerCount);
 		}
-
-		//最適化用
-		//[マテリアルカウント][cpIndex]
-		std::vector<std::vector<Relation>> relations(materialCount);
-		for (auto& rel : relations) {
-			rel.resize(cpCount);
+		if (materialIndexList) {
+			source.materialIndices.resize(polygonCount);
 		}
 
-		const int polygonCount = mesh->GetPolygonCount();
-
 		int polygonVertex = 0;
 		for (int polygonIndex = 0; polygonIndex < polygonCount; ++polygonIndex) {
+			//ポリゴンの所属するマテリアルのインデックスの取得
+			if (materialIndexList) {
+				source.materialIndices[polygonIndex] = (*materialIndexList)[polygonIndex];
+			}
 			for (int pos = 0; pos < 3; ++pos) {
-
 				const int cpIndex = mesh->GetPolygonVertex(polygonIndex, pos);
-				StaticVertex v;
-				v.position = toVector3(mat.MultT(controlPoints[cpIndex]));
-				static float buf = 10.0f;
-				static int cou = 0;
-				cou++;
+				source.cpIndices.push_back(cpIndex);
 
 				if (hasColor) {
-					v.color = toVector4(GetElement(colorMappingMode, isColorDirectRef, colorIndexList, colorList, cpIndex, polygonVertex, FbxColor(1, 1, 1, 1)));
+					source.colors.push_back(toVector4(GetElement(colorMappingMode, isColorDirectRef, colorIndexList, colorList, cpIndex, polygonVertex, FbxColor(1, 1, 1, 1))));
 				}
 				if (hasTexCoord) {
 					FbxVector2 uv;
 					bool unmapped;
 					mesh->GetPolygonVertexUV(polygonIndex, pos, uvSetNameList[0], uv, unmapped);
-					v.texCoord = toVector2(uv);
+					source.texCoords.push_back(toVector2(uv));
 				}
 
+				mff::Vector3<float> normal;
 				if (hasNormal) {
 					FbxVector4 norm;
 					mesh->GetPolygonVertexNormal(polygonIndex, pos, norm);
-					v.normal = Normalize(toVector3(rot.MultT(norm)));
+					normal = mff::Normalize<float>(toVector3(rot.MultT(norm)));
+					source.normals.push_back(normal);
 				}
 
-				v.tangent = mff::Vector4<float>(1, 0, 0, 1);
 				if (hasTangent) {
 					mff::Vector3<float> binormal = toVector3
 					(rot.MultT(GetElement(binormalMappingMode, isBinormalDirectRef, binormalIndexList, binormalList,
@@ -724,48 +556,8 @@ namespace FbxLoader {
 					(rot.MultT(GetElement(tangentMappingMode, isTangentDirectRef, tangentIndexList, tangentList,
 						cpIndex, polygonVertex, FbxVector4(1, 0, 0, 1))));
 
-					v.tangent = mff::Vector4<float>(tangent, 1);
-
-					mff::Vector3<float> binormalTmp = Normalize(cross(v.normal, tangent));
-					if (dot(binormal, binormalTmp) < 0) {
-						v.tangent.w = -1;
-					}
-				}
-
-				//                    v.color = Vector4((Vector3(1,1,1) + v.normal) * 0.5f);
-
-				//ポリゴンの所属するマテリアルのインデックスの取得
-				int materialIndex = materialIndexList ? (*materialIndexList)[polygonIndex] : 0;
-				Material<StaticVertex>& materialData = materials[materialIndex];
-
-				int size = relations[materialIndex][cpIndex].relatedIndex.size();
-				if (size == 0) {
-					int pushIndex = materialData.verteces.size();
-					materialData.indeces.push_back(pushIndex);
-					materialData.verteces.push_back(v);
-					relations[materialIndex][cpIndex].relatedIndex.push_back(pushIndex);
-				}
-				else {
-					bool isSame = false;
-					auto itr = relations[materialIndex][cpIndex].relatedIndex.begin();
-					for (; itr != relations[materialIndex][cpIndex].relatedIndex.end(); ++itr) {
-						StaticVertex& tmp = materialData.verteces[*itr];
-						if (tmp.color == v.color &&
-							tmp.texCoord == v.texCoord &&
-							tmp.normal == v.normal) {
-							isSame = true;
-							break;
-						}
-					}
-					if (isSame) {
-						materialData.indeces.push_back(*itr);
-					}
-					else {
-						int pushIndex = materialData.verteces.size();
-						materialData.indeces.push_back(pushIndex);
-						materialData.verteces.push_back(v);
-						relations[materialIndex][cpIndex].relatedIndex.push_back(pushIndex);
-					}
+					//符号だけ見るので正規化は不要
+					source.tangents.push_back(mff::Vector4<float>(tangent, dot(binormal, cross(normal, tangent)) < 0 ? -1.0f : 1.0f));
 				}
 				++polygonVertex;
 			}
@@ -778,6 +570,10 @@ namespace FbxLoader {
 	* @param   animations  アニメーションデータの格納先
 	*/
 	void Loader::LoadAnimation(std::vector<Animation>& animations) {
+		if (cache.IsOpen()) {
+			cache.LoadAnimation(animations);
+			return;
+		}
 		if (!isBoneTreeInitialized) {
 			BoneTreeData tmp;
 			LoadBone(tmp);
@@ -844,7 +640,7 @@ namespace FbxLoader {
 					buf.animDatas.push_back
 					({
 						static_cast<float>((period * (keyframe)).GetSecondDouble()),
-						toMyMat(mat) * pData->baseInv
+						bakeBaseInv ? toMyMat(mat) * pData->baseInv : toMyMat(mat)
 						});
 				}
 				buf.animationTime = buf.animDatas.back().first;
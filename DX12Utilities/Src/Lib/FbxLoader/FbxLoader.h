@@ -3,6 +3,8 @@
 
 #include <fbxsdk.h>
 #include "FbxLoaderStructs.h"
+#include "MeshBuilder.h"
+#include "MeshCache.h"
 #include <string>
 #include <vector>
 
@@ -14,7 +16,29 @@ namespace FbxLoader {
 	public:
 		~Loader();
 		bool Initialize(const std::string& filename);
+		/*
+		cacheFilename のキャッシュが filename の内容と一致すれば FBX を読まずにキャッシュから読む
+		一致しなければ filename を読み込んで結果をキャッシュに書き出す
+		SetBoneBaseGetFromLink / SetBakeBaseInv / SetOptimizeVertexCache は結果が変わるのでこれより先に呼ぶこと
+		LoadStaticMesh はスキンのあるメッシュも含めて返し、これはキャッシュに入っていないので、
+		キャッシュから読んでいる時もこの呼び出しだけは filename を読む (他はキャッシュのまま)
+		*/
+		bool Initialize(const std::string& filename, const std::string& cacheFilename);
+		//キャッシュから読んでいる時は頂点とインデックスをコピーせずに使える (それ以外は nullptr)
+		const MeshCache* GetCache() const { return cache.IsOpen() ? &cache : nullptr; }
 		void SetBoneBaseGetFromLink(bool flag) { boneBaseGetFromLink = flag; }
+		//false にすると Animation の行列に baseInv を掛けずモデル空間のまま返す (パレットは mff::BuildPalette で作る)
+		void SetBakeBaseInv(bool flag) { bakeBaseInv = flag; }
+		//メッシュの構築に使うスレッド数 (既定 1、0以下でハードウェアスレッド数)。SDK からの読み出しは常に1スレッドで行う
+		void SetThreadCount(int count) { threadCount = count; }
+		//true にすると各マテリアルのインデックスを頂点変換後キャッシュに合わせて並べ替える (既定 false)
+		void SetOptimizeVertexCache(bool flag) { optimizeVertexCache = flag; }
+		/*
+		最後に構築したメッシュの OptimizeVertexCache 前後の統計 (Load*Mesh が返した順、static が先)
+		SetOptimizeVertexCache(true) の時のみ。キャッシュから読んだ呼び出しでは構築しないので変わらない
+		(キャッシュを書いた時は Initialize の中で構築した結果が入る)
+		*/
+		const std::vector<MeshVertexCacheReport>& GetVertexCacheReports() const { return vertexCacheReports; }
 		void LoadBone(BoneTreeData& boneTree);
 		void LoadAllMesh(std::vector<StaticMesh>& staticMeshes, std::vector<SkinnedMesh>& skinnedMeshes);
 		void LoadSkinnedMesh(std::vector<SkinnedMesh>& meshes);
@@ -25,12 +49,20 @@ namespace FbxLoader {
 
 		fbxsdk::FbxNode* FindRootBone(fbxsdk::FbxNode* node);
 		fbxsdk::FbxMesh* FindIncludedMesh(fbxsdk::FbxCluster* cluster);
-		void LoadSkinnedMesh(fbxsdk::FbxMesh* mesh, SkinnedMesh& meshRef);
-		void LoadStaticeMesh(fbxsdk::FbxMesh* mesh, StaticMesh& meshRef);
+		void ExtractMesh(fbxsdk::FbxMesh* mesh, bool isSkinned, MeshSource& source);
+		uint32_t GetCacheOptions() const;
+		bool ImportScene(const std::string& filename);
 
 
 		bool isBoneTreeInitialized = false;
+		//キャッシュから読んでいる時は LoadStaticMesh で初めて読み込む
+		std::string sourceFilename;
+		bool isSourceImported = false;
 		bool boneBaseGetFromLink = true;
+		bool bakeBaseInv = true;
+		int threadCount = 1;
+		bool optimizeVertexCache = false;
+		std::vector<MeshVertexCacheReport> vertexCacheReports;
 		BoneTreeData publicBoneTree;
 
 		fbxsdk::FbxManager* pManager = nullptr;
@@ -38,6 +70,7 @@ namespace FbxLoader {
 		fbxsdk::FbxScene* pScene = nullptr;
 
 		std::vector<fbxsdk::FbxMesh*> includedMeshes;
+		MeshCache cache;
 	};
 
 }// namespace FbxLoader
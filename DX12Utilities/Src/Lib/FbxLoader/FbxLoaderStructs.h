@@ -5,6 +5,8 @@
 #include "../../Math/Vector/Vector2.h"
 #include "../../Math/Vector/Vector2.h"
 #include "../../Math/Matrix/Matrix4x4.h"
+#include "../../Math/Batch/Hierarchy.h"
+#include <unordered_map>
 #include <vector>
 
 namespace FbxLoader {
@@ -40,8 +42,54 @@ namespace FbxLoader {
 		mff::Matrix4x4<float>  baseInv;
 	};
 
+	/*
+	BoneTreeData を親が子より前に来る順に並べ替えたSoA
+	hierarchy.sourceIndices[i] が BoneTreeData::data のインデックス
+	*/
+	struct FlatBoneTree {
+		mff::FlatHierarchy hierarchy;
+		std::vector<std::string> names;
+		std::vector<int> boneIds;
+		std::vector<mff::Matrix4x4<float> > baseInvs;
+	};
+
 	struct BoneTreeData {
 		std::vector<BoneData> data;
+
+		//parentId は boneId で引く (boneId が重複していれば先のもの)。範囲外の親や循環があれば false
+		bool Flatten(FlatBoneTree& dst) const {
+			std::unordered_map<int, int> boneIndices;
+			boneIndices.reserve(data.size());
+			for (size_t i = 0; i < data.size(); ++i) {
+				boneIndices.emplace(data[i].boneId, static_cast<int>(i));
+			}
+			std::vector<int> parents(data.size(), -1);
+			for (size_t i = 0; i < data.size(); ++i) {
+				if (data[i].parentId < 0) {
+					continue;
+				}
+				auto itr = boneIndices.find(data[i].parentId);
+				if (itr == boneIndices.end()) {
+					return false;
+				}
+				parents[i] = itr->second;
+			}
+			if (!mff::FlattenHierarchy(parents.data(), parents.size(), dst.hierarchy)) {
+				return false;
+			}
+			const size_t count = data.size();
+			dst.names.resize(count);
+			dst.boneIds.resize(count);
+			dst.baseInvs.resize(count);
+			for (size_t i = 0; i < count; ++i) {
+				const BoneData& bone = data[dst.hierarchy.sourceIndices[i]];
+				dst.names[i] = bone.name;
+				dst.boneIds[i] = bone.boneId;
+				dst.baseInvs[i] = bone.baseInv;
+			}
+			return true;
+		}
+
 		BoneData* FindBone(const std::string& name) {
 			for (auto itr = data.begin(); itr != data.end(); ++itr) {
 				if (itr->name == name) {
@@ -80,13 +128,6 @@ namespace FbxLoader {
 		std::vector<mff::Matrix4x4<float> > boneBaseInvs;
 	};
 
-	struct Relation {
-		/**
-		* インデックスバッファの値
-		*/
-		std::vector<int> relatedIndex;
-	};
-
 	struct BoneAnimationData {
 		typedef std::pair<float, mff::Matrix4x4<float> > TimeMatPair;
 		std::vector<std::pair<float, mff::Matrix4x4<float> >> animDatas;
@@ -149,7 +190,7 @@ namespace FbxLoader {
 			if (rate > 1 || rate < 0) {
 				std::cout << "irregular happened" << std::endl;
 			}
-			return animDatas[current].second * (1 - rate) + animDatas[next].second * rate;
+			return mff::Lerp(animDatas[current].second, animDatas[next].second, rate);
 		}
 
 		void Reset() {
@@ -0,0 +1,710 @@
+﻿#include "FbxScene.h"
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+
+namespace FbxLoader {
+	namespace fbx {
+		namespace {
+			enum class Kind {
+				Model,
+				Geometry,
+				Material,
+				Texture,
+				LayeredTexture,
+				NodeAttribute,
+				Skin,
+				Cluster,
+				AnimationStack,
+				AnimationLayer,
+				AnimationCurveNode,
+				AnimationCurve,
+			};
+
+			struct ObjectRef {
+				Kind kind;
+				int index;
+			};
+
+			//KeyAttrFlags
+			const int32_t interpolationConstant = 0x00000002;
+			const int32_t interpolationLinear = 0x00000004;
+			const int32_t interpolationCubic = 0x00000008;
+			const int32_t constantNext = 0x00000100;
+
+			const double pi = 3.14159265358979323846;
+
+			bool IsString(const Property* property, const char* str) {
+				return property && property->IsString() && strlen(str) == property->size && memcmp(property->data, str, property->size) == 0;
+			}
+
+			Matrix Translation(const Vector& v) {
+				Matrix ret;
+				ret.m[3] = v.x;
+				ret.m[7] = v.y;
+				ret.m[11] = v.z;
+				return ret;
+			}
+
+			Matrix Scaling(const Vector& v) {
+				Matrix ret;
+				ret.m[0] = v.x;
+				ret.m[5] = v.y;
+				ret.m[10] = v.z;
+				return ret;
+			}
+
+			Matrix RotationAxis(int axis, double degrees) {
+				const double rad = degrees * pi / 180.0;
+				const double c = cos(rad);
+				const double s = sin(rad);
+				const int a = (axis + 1) % 3;
+				const int b = (axis + 2) % 3;
+				Matrix ret;
+				ret[a][a] = c;
+				ret[a][b] = -s;
+				ret[b][a] = s;
+				ret[b][b] = c;
+				return ret;
+			}
+
+			/**
+			* Properties70 の P を読む
+			* 値は5番目のプロパティから並ぶ ("名前", "型", "ラベル", "フラグ", 値...)
+			*
+			* @param   func    void(const Node& p, const Property& name)
+			*/
+			template<typename Func>
+			void ForEachP(const Document& document, const Node& object, Func func) {
+				const Node* properties = document.FindChild(object, "Properties70");
+				if (!properties) {
+					return;
+				}
+				for (const Node* p = document.GetFirstChild(*properties); p; p = document.GetNextSibling(*p)) {
+					const Property* name = document.GetProperty(*p, 0);
+					if (p->Is("P") && name && name->IsString()) {
+						func(*p, *name);
+					}
+				}
+			}
+
+			double ReadDouble(const Document& document, const Node& p, uint32_t index, double defaultValue) {
+				const Property* property = document.GetProperty(p, index);
+				return property && !property->IsString() && !property->IsArray() ? property->AsDouble() : defaultValue;
+			}
+
+			Vector ReadVector(const Document& document, const Node& p) {
+				return Vector(ReadDouble(document, p, 4, 0), ReadDouble(document, p, 5, 0), ReadDouble(document, p, 6, 0));
+			}
+
+			double FrameRate(int timeMode, double customFrameRate) {
+				//FbxTime::EMode
+				const double rates[] = {
+					30, 120, 100, 60, 50, 48, 30, 30, 30000.0 / 1001.0, 30000.0 / 1001.0,
+					25, 24, 1000, 24000.0 / 1001.0, 0, 96, 72, 60000.0 / 1001.0, 120000.0 / 1001.0 };
+				if (timeMode == 14) {
+					return customFrameRate > 0 ? customFrameRate : 30;
+				}
+				if (timeMode < 0 || timeMode >= static_cast<int>(sizeof(rates) / sizeof(rates[0]))) {
+					return 30;
+				}
+				return rates[timeMode];
+			}
+
+			void ReadModelProperties(const Document& document, const Node& node, Model& model) {
+				ForEachP(document, node, [&](const Node& p, const Property& name) {
+					const std::string key = name.AsString();
+					if (key == "Lcl Translation") {
+						model.translation = ReadVector(document, p);
+					}
+					else if (key == "Lcl Rotation") {
+						model.rotation = ReadVector(document, p);
+					}
+					else if (key == "Lcl Scaling") {
+						model.scaling = ReadVector(document, p);
+					}
+					else if (key == "PreRotation") {
+						model.preRotation = ReadVector(document, p);
+					}
+					else if (key == "PostRotation") {
+						model.postRotation = ReadVector(document, p);
+					}
+					else if (key == "RotationOffset") {
+						model.rotationOffset = ReadVector(document, p);
+					}
+					else if (key == "RotationPivot") {
+						model.rotationPivot = ReadVector(document, p);
+					}
+					else if (key == "ScalingOffset") {
+						model.scalingOffset = ReadVector(document, p);
+					}
+					else if (key == "ScalingPivot") {
+						model.scalingPivot = ReadVector(document, p);
+					}
+					else if (key == "GeometricTranslation") {
+						model.geometricTranslation = ReadVector(document, p);
+					}
+					else if (key == "GeometricRotation") {
+						model.geometricRotation = ReadVector(document, p);
+					}
+					else if (key == "GeometricScaling") {
+						model.geometricScaling = ReadVector(document, p);
+					}
+					else if (key == "RotationOrder") {
+						model.rotationOrder = static_cast<int>(ReadDouble(document, p, 4, 0));
+					}
+				});
+			}
+
+			bool IsSkeletonType(const Property* type) {
+				return IsString(type, "LimbNode") || IsString(type, "Root") || IsString(type, "Limb");
+			}
+
+			/*
+			KeyTime は狭義単調増加、KeyValue はキーと同数
+			属性 (KeyAttrFlags, KeyAttrDataFloat は4要素ずつ, KeyAttrRefCount) はなくてもよいが、
+			あれば属性の数が揃っていて refCount の合計がキーの数と一致すること
+			*/
+			bool IsValidCurve(const std::vector<int64_t>& times, size_t valueCount, size_t flagCount, size_t dataCount,
+				const std::vector<int32_t>& refCounts) {
+				if (times.size() != valueCount) {
+					return false;
+				}
+				for (size_t i = 1; i < times.size(); ++i) {
+					if (times[i - 1] >= times[i]) {
+						return false;
+					}
+				}
+				if (!flagCount && !dataCount && refCounts.empty()) {
+					return true;
+				}
+				if (flagCount != refCounts.size() || dataCount != refCounts.size() * 4) {
+					return false;
+				}
+				uint64_t total = 0;
+				for (int32_t refCount : refCounts) {
+					if (refCount < 0) {
+						return false;
+					}
+					total += static_cast<uint64_t>(refCount);
+				}
+				return total == times.size();
+			}
+
+			void DecodeCurve(const Document& document, const AnimationCurve& curve, CurveKeys& keys) {
+				keys.defaultValue = curve.defaultValue;
+				if (!curve.node) {
+					return;
+				}
+				const Node& node = *curve.node;
+				auto readArray = [&](const char* name, auto& dst) {
+					const Node* child = document.FindChild(node, name);
+					const Property* property = child ? document.GetProperty(*child, 0) : nullptr;
+					if (!property || !document.ReadArray(*property, dst)) {
+						dst.clear();
+					}
+				};
+				readArray("KeyTime", keys.times);
+				readArray("KeyValueFloat", keys.values);
+				if (keys.values.empty()) {
+					readArray("KeyValueDouble", keys.values);
+				}
+				std::vector<int32_t> attrFlags;
+				std::vector<float> attrData;
+				std::vector<int32_t> refCounts;
+				readArray("KeyAttrFlags", attrFlags);
+				readArray("KeyAttrDataFloat", attrData);
+				readArray("KeyAttrRefCount", refCounts);
+
+				//壊れたカーブはキーなし (defaultValue) として扱う。Evaluate はキーが時間順であることを前提にする
+				if (!IsValidCurve(keys.times, keys.values.size(), attrFlags.size(), attrData.size(), refCounts)) {
+					keys.times.clear();
+					keys.values.clear();
+					return;
+				}
+				const size_t keyCount = keys.times.size();
+
+				//属性は連続するキーで共有されている (refCount 個ずつ)
+				keys.flags.assign(keyCount, interpolationLinear);
+				keys.rightSlopes.assign(keyCount, 0.0f);
+				keys.nextLeftSlopes.assign(keyCount, 0.0f);
+				size_t key = 0;
+				for (size_t attr = 0; attr < refCounts.size() && key < keyCount; ++attr) {
+					const int32_t flag = attrFlags[attr];
+					const float right = attrData[attr * 4];
+					const float nextLeft = attrData[attr * 4 + 1];
+					for (int32_t i = 0; i < refCounts[attr] && key < keyCount; ++i, ++key) {
+						keys.flags[key] = flag;
+						keys.rightSlopes[key] = right;
+						keys.nextLeftSlopes[key] = nextLeft;
+					}
+				}
+			}
+		}
+
+		/**
+		* カーブの評価
+		* 範囲外は端のキーの値、補間は一定・線形・3次 (エルミート, ウェイトは無視) に対応
+		* キーの時間は狭義単調増加 (DecodeCurve で確認済み)。差は int64 に収まらないことがあるので符号なしで取る
+		*/
+		double CurveKeys::Evaluate(int64_t time) const {
+			const size_t count = times.size();
+			if (!count) {
+				return defaultValue;
+			}
+			if (time <= times[0]) {
+				return values[0];
+			}
+			if (time >= times[count - 1]) {
+				return values[count - 1];
+			}
+			const size_t next = static_cast<size_t>(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+			const size_t cur = next - 1;
+			const double v0 = values[cur];
+			const double v1 = values[next];
+			const int32_t flag = flags[cur];
+			if (flag & interpolationConstant) {
+				return (flag & constantNext) ? v1 : v0;
+			}
+			const double duration = static_cast<double>(static_cast<uint64_t>(times[next]) - static_cast<uint64_t>(times[cur]));
+			const double t = static_cast<double>(static_cast<uint64_t>(time) - static_cast<uint64_t>(times[cur])) / duration;
+			if (!(flag & interpolationCubic)) {
+				return v0 + (v1 - v0) * t;
+			}
+			//接線は1秒あたりの変化量
+			const double seconds = duration / static_cast<double>(TimeSecond);
+			const double m0 = rightSlopes[cur] * seconds;
+			const double m1 = nextLeftSlopes[cur] * seconds;
+			const double t2 = t * t;
+			const double t3 = t2 * t;
+			return (2 * t3 - 3 * t2 + 1) * v0 + (t3 - 2 * t2 + t) * m0 + (-2 * t3 + 3 * t2) * v1 + (t3 - t2) * m1;
+		}
+
+		/**
+		* Objects と Connections からシーンを作る
+		* 大きな配列 (頂点やキー) はここでは展開しない
+		*
+		* @param   document    読み込み済みのFBX (Scene より長く保持すること)
+		*/
+		bool Scene::Build(const Document& document) {
+			*this = Scene();
+			this->document = &document;
+
+			const Node& root = document.GetRoot();
+			if (const Node* settings = document.FindChild(root, "GlobalSettings")) {
+				int timeMode = 0;
+				double customFrameRate = 0;
+				ForEachP(document, *settings, [&](const Node& p, const Property& name) {
+					if (IsString(&name, "TimeMode")) {
+						timeMode = static_cast<int>(ReadDouble(document, p, 4, 0));
+					}
+					else if (IsString(&name, "CustomFrameRate")) {
+						customFrameRate = ReadDouble(document, p, 4, 0);
+					}
+				});
+				frameRate = FrameRate(timeMode, customFrameRate);
+			}
+
+			const Node* objects = document.FindChild(root, "Objects");
+			if (!objects) {
+				return false;
+			}
+
+			std::unordered_map<int64_t, ObjectRef> objectMap;
+			std::vector<std::string> textureNames;
+			//[layeredTexture] 含まれるテクスチャ
+			std::vector<std::vector<int> > layeredTextures;
+			std::vector<bool> skeletonAttributes;
+			//[material] DiffuseColor につながったテクスチャ / 重ねたテクスチャ
+			std::vector<std::vector<int> > materialTextures;
+			std::vector<std::vector<int> > materialLayeredTextures;
+
+			for (const Node* object = document.GetFirstChild(*objects); object; object = document.GetNextSibling(*object)) {
+				const Property* idProperty = document.GetProperty(*object, 0);
+				if (!idProperty || idProperty->IsString() || idProperty->IsArray()) {
+					continue;
+				}
+				const int64_t id = idProperty->AsInt();
+				const Property* nameProperty = document.GetProperty(*object, 1);
+				const Property* type = document.GetProperty(*object, 2);
+				const std::string name = nameProperty ? ObjectName(*nameProperty) : std::string();
+
+				if (object->Is("Model")) {
+					Model model;
+					model.id = id;
+					model.name = name;
+					model.type = type ? type->AsString() : std::string();
+					model.isSkeleton = IsSkeletonType(type);
+					ReadModelProperties(document, *object, model);
+					objectMap[id] = { Kind::Model, static_cast<int>(models.size()) };
+					models.push_back(model);
+				}
+				else if (object->Is("Geometry")) {
+					if (!IsString(type, "Mesh")) {
+						continue;
+					}
+					Geometry geometry;
+					geometry.id = id;
+					geometry.node = object;
+					objectMap[id] = { Kind::Geometry, static_cast<int>(geometries.size()) };
+					geometries.push_back(geometry);
+				}
+				else if (object->Is("Material")) {
+					Material material;
+					material.id = id;
+					material.name = name;
+					objectMap[id] = { Kind::Material, static_cast<int>(materials.size()) };
+					materials.push_back(material);
+				}
+				else if (object->Is("Texture")) {
+					std::string fileName;
+					const Node* relative = document.FindChild(*object, "RelativeFilename");
+					const Property* relativeName = relative ? document.GetProperty(*relative, 0) : nullptr;
+					if (relativeName) {
+						fileName = relativeName->AsString();
+					}
+					if (fileName.empty()) {
+						const Node* absolute = document.FindChild(*object, "FileName");
+						const Property* absoluteName = absolute ? document.GetProperty(*absolute, 0) : nullptr;
+						if (absoluteName) {
+							fileName = absoluteName->AsString();
+						}
+					}
+					objectMap[id] = { Kind::Texture, static_cast<int>(textureNames.size()) };
+					textureNames.push_back(fileName);
+				}
+				else if (object->Is("LayeredTexture")) {
+					objectMap[id] = { Kind::LayeredTexture, static_cast<int>(layeredTextures.size()) };
+					layeredTextures.push_back({});
+				}
+				else if (object->Is("NodeAttribute")) {
+					objectMap[id] = { Kind::NodeAttribute, static_cast<int>(skeletonAttributes.size()) };
+					skeletonAttributes.push_back(IsSkeletonType(type));
+				}
+				else if (object->Is("Deformer")) {
+					if (IsString(type, "Skin")) {
+						Skin skin;
+						skin.id = id;
+						objectMap[id] = { Kind::Skin, static_cast<int>(skins.size()) };
+						skins.push_back(skin);
+					}
+					else if (IsString(type, "Cluster")) {
+						Cluster cluster;
+						cluster.id = id;
+						cluster.node = object;
+						objectMap[id] = { Kind::Cluster, static_cast<int>(clusters.size()) };
+						clusters.push_back(cluster);
+					}
+				}
+				else if (object->Is("AnimationStack")) {
+					AnimationStack stack;
+					stack.id = id;
+					stack.name = name;
+					bool hasLocal = false;
+					int64_t referenceStart = 0;
+					int64_t referenceStop = 0;
+					ForEachP(document, *object, [&](const Node& p, const Property& key) {
+						const Property* value = document.GetProperty(p, 4);
+						if (!value || value->IsString() || value->IsArray()) {
+							return;
+						}
+						if (IsString(&key, "LocalStart")) {
+							stack.localStart = value->AsInt();
+							hasLocal = true;
+						}
+						else if (IsString(&key, "LocalStop")) {
+							stack.localStop = value->AsInt();
+							hasLocal = true;
+						}
+						else if (IsString(&key, "ReferenceStart")) {
+							referenceStart = value->AsInt();
+						}
+						else if (IsString(&key, "ReferenceStop")) {
+							referenceStop = value->AsInt();
+						}
+					});
+					if (!hasLocal) {
+						stack.localStart = referenceStart;
+						stack.localStop = referenceStop;
+					}
+					objectMap[id] = { Kind::AnimationStack, static_cast<int>(stacks.size()) };
+					stacks.push_back(stack);
+				}
+				else if (object->Is("AnimationLayer")) {
+					AnimationLayer layer;
+					layer.id = id;
+					objectMap[id] = { Kind::AnimationLayer, static_cast<int>(layers.size()) };
+					layers.push_back(layer);
+				}
+				else if (object->Is("AnimationCurveNode")) {
+					AnimationCurveNode curveNode;
+					curveNode.id = id;
+					ForEachP(document, *object, [&](const Node& p, const Property& key) {
+						const char* axes[3] = { "d|X", "d|Y", "d|Z" };
+						for (int i = 0; i < 3; ++i) {
+							if (IsString(&key, axes[i])) {
+								curveNode.values[i] = ReadDouble(document, p, 4, 0);
+							}
+						}
+					});
+					objectMap[id] = { Kind::AnimationCurveNode, static_cast<int>(curveNodes.size()) };
+					curveNodes.push_back(curveNode);
+				}
+				else if (object->Is("AnimationCurve")) {
+					AnimationCurve curve;
+					curve.id = id;
+					curve.node = object;
+					if (const Node* defaultNode = document.FindChild(*object, "Default")) {
+						curve.defaultValue = ReadDouble(document, *defaultNode, 0, 0);
+					}
+					objectMap[id] = { Kind::AnimationCurve, static_cast<int>(curves.size()) };
+					curves.push_back(curve);
+				}
+			}
+
+			materialTextures.resize(materials.size());
+			materialLayeredTextures.resize(materials.size());
+
+			if (const Node* connections = document.FindChild(root, "Connections")) {
+				for (const Node* c = document.GetFirstChild(*connections); c; c = document.GetNextSibling(*c)) {
+					const Property* childId = document.GetProperty(*c, 1);
+					const Property* parentId = document.GetProperty(*c, 2);
+					if (!c->Is("C") || !childId || !parentId) {
+						continue;
+					}
+					const Property* propertyName = document.GetProperty(*c, 3);
+					auto childItr = objectMap.find(childId->AsInt());
+					if (childItr == objectMap.end()) {
+						continue;
+					}
+					const ObjectRef child = childItr->second;
+					auto parentItr = objectMap.find(parentId->AsInt());
+					if (parentItr == objectMap.end()) {
+						//0 はシーンのルート
+						if (child.kind == Kind::Model && parentId->AsInt() == 0) {
+							rootModels.push_back(child.index);
+						}
+						continue;
+					}
+					const ObjectRef parent = parentItr->second;
+
+					switch (child.kind) {
+					case Kind::Model:
+						if (parent.kind == Kind::Model && models[child.index].parent < 0) {
+							models[child.index].parent = parent.index;
+							models[parent.index].children.push_back(child.index);
+						}
+						else if (parent.kind == Kind::Cluster) {
+							clusters[parent.index].link = child.index;
+						}
+						break;
+					case Kind::Geometry:
+						if (parent.kind == Kind::Model && models[parent.index].geometry < 0) {
+							models[parent.index].geometry = child.index;
+							geometries[child.index].model = parent.index;
+						}
+						break;
+					case Kind::Material:
+						if (parent.kind == Kind::Model) {
+							models[parent.index].materials.push_back(child.index);
+						}
+						break;
+					case Kind::Texture:
+						if (parent.kind == Kind::Material && IsString(propertyName, "DiffuseColor")) {
+							materialTextures[parent.index].push_back(child.index);
+						}
+						else if (parent.kind == Kind::LayeredTexture) {
+							layeredTextures[parent.index].push_back(child.index);
+						}
+						break;
+					case Kind::LayeredTexture:
+						if (parent.kind == Kind::Material && IsString(propertyName, "DiffuseColor")) {
+							materialLayeredTextures[parent.index].push_back(child.index);
+						}
+						break;
+					case Kind::NodeAttribute:
+						if (parent.kind == Kind::Model && skeletonAttributes[child.index]) {
+							models[parent.index].isSkeleton = true;
+						}
+						break;
+					case Kind::Skin:
+						if (parent.kind == Kind::Geometry) {
+							skins[child.index].geometry = parent.index;
+							geometries[parent.index].skins.push_back(child.index);
+						}
+						break;
+					case Kind::Cluster:
+						if (parent.kind == Kind::Skin) {
+							clusters[child.index].skin = parent.index;
+							skins[parent.index].clusters.push_back(child.index);
+						}
+						break;
+					case Kind::AnimationLayer:
+						if (parent.kind == Kind::AnimationStack) {
+							stacks[parent.index].layers.push_back(child.index);
+						}
+						break;
+					case Kind::AnimationCurveNode:
+						if (parent.kind == Kind::AnimationLayer) {
+							layers[parent.index].curveNodes.push_back(child.index);
+						}
+						else if (parent.kind == Kind::Model) {
+							AnimationCurveNode& curveNode = curveNodes[child.index];
+							curveNode.model = parent.index;
+							if (IsString(propertyName, "Lcl Translation")) {
+								curveNode.channel = 0;
+							}
+							else if (IsString(propertyName, "Lcl Rotation")) {
+								curveNode.channel = 1;
+							}
+							else if (IsString(propertyName, "Lcl Scaling")) {
+								curveNode.channel = 2;
+							}
+						}
+						break;
+					case Kind::AnimationCurve:
+						if (parent.kind == Kind::AnimationCurveNode) {
+							const char* axes[3] = { "d|X", "d|Y", "d|Z" };
+							for (int i = 0; i < 3; ++i) {
+								if (IsString(propertyName, axes[i])) {
+									curveNodes[parent.index].curves[i] = child.index;
+								}
+							}
+						}
+						break;
+					default:
+						break;
+					}
+				}
+			}
+
+			//重ねたテクスチャがあればそちらを優先する (SDK版の Loader と同じ)
+			for (size_t i = 0; i < materials.size(); ++i) {
+				if (!materialLayeredTextures[i].empty()) {
+					for (int layered : materialLayeredTextures[i]) {
+						for (int texture : layeredTextures[layered]) {
+							materials[i].diffuseTextures.push_back(textureNames[texture]);
+						}
+					}
+				}
+				else {
+					for (int texture : materialTextures[i]) {
+						materials[i].diffuseTextures.push_back(textureNames[texture]);
+					}
+				}
+			}
+
+			curveKeys.resize(curves.size());
+			isCurveDecoded.assign(curves.size(), false);
+			return true;
+		}
+
+		/**
+		* 評価に使うアニメーションを切り替える
+		* スタックに含まれるカーブはここで展開する (複数レイヤーは後のレイヤーで上書き)
+		*/
+		void Scene::SetAnimationStack(int stack) {
+			channels.clear();
+			if (stack < 0 || stack >= static_cast<int>(stacks.size())) {
+				return;
+			}
+			channels.resize(models.size() * 3);
+			for (int layer : stacks[stack].layers) {
+				for (int curveNodeIndex : layers[layer].curveNodes) {
+					const AnimationCurveNode& curveNode = curveNodes[curveNodeIndex];
+					if (curveNode.model < 0 || curveNode.channel < 0) {
+						continue;
+					}
+					Channel& channel = channels[curveNode.model * 3 + curveNode.channel];
+					channel.curveNode = curveNodeIndex;
+					for (int i = 0; i < 3; ++i) {
+						const int curve = curveNode.curves[i];
+						channel.keys[i] = nullptr;
+						if (curve < 0) {
+							continue;
+						}
+						if (!isCurveDecoded[curve]) {
+							DecodeCurve(*document, curves[curve], curveKeys[curve]);
+							isCurveDecoded[curve] = true;
+						}
+						channel.keys[i] = &curveKeys[curve];
+					}
+				}
+			}
+		}
+
+		/**
+		* ローカル行列
+		* T * Roff * Rp * Rpre * R * Rpost^-1 * Rp^-1 * Soff * Sp * S * Sp^-1 (FBX SDK のドキュメントと同じ)
+		*/
+		Matrix Scene::EvaluateLocalTransform(int modelIndex, int64_t time) const {
+			const Model& model = models[modelIndex];
+			Vector values[3] = { model.translation, model.rotation, model.scaling };
+			if (!channels.empty()) {
+				for (int c = 0; c < 3; ++c) {
+					const Channel& channel = channels[modelIndex * 3 + c];
+					if (channel.curveNode < 0) {
+						continue;
+					}
+					for (int i = 0; i < 3; ++i) {
+						values[c].m[i] = channel.keys[i] ? channel.keys[i]->Evaluate(time) : curveNodes[channel.curveNode].values[i];
+					}
+				}
+			}
+
+			const Matrix rotationPivot = Translation(model.rotationPivot);
+			const Matrix scalingPivot = Translation(model.scalingPivot);
+			return Translation(values[0]) * Translation(model.rotationOffset) * rotationPivot
+				* EulerToMatrix(model.preRotation, 0) * EulerToMatrix(values[1], model.rotationOrder) * mff::Transpose(EulerToMatrix(model.postRotation, 0))
+				* Translation(Vector(0) - model.rotationPivot) * Translation(model.scalingOffset) * scalingPivot
+				* Scaling(values[2]) * Translation(Vector(0) - model.scalingPivot);
+		}
+
+		//親の行列はそのまま掛ける (InheritType は RSrs として扱う)
+		Matrix Scene::EvaluateGlobalTransform(int model, int64_t time) const {
+			Matrix ret = EvaluateLocalTransform(model, time);
+			for (int parent = models[model].parent; parent >= 0; parent = models[parent].parent) {
+				ret = EvaluateLocalTransform(parent, time) * ret;
+			}
+			return ret;
+		}
+
+		Matrix Scene::GetGeometricTransform(int modelIndex) const {
+			const Model& model = models[modelIndex];
+			return Translation(model.geometricTranslation) * EulerToMatrix(model.geometricRotation, 0) * Scaling(model.geometricScaling);
+		}
+
+		int64_t Scene::GetFramePeriod() const {
+			return static_cast<int64_t>(floor(static_cast<double>(TimeSecond) / frameRate + 0.5));
+		}
+
+		bool Scene::GetKeyTimeSpan(int64_t& start, int64_t& stop) const {
+			bool hasKey = false;
+			for (const Channel& channel : channels) {
+				for (const CurveKeys* keys : channel.keys) {
+					if (!keys || keys->times.empty()) {
+						continue;
+					}
+					start = hasKey ? (std::min)(start, keys->times.front()) : keys->times.front();
+					stop = hasKey ? (std::max)(stop, keys->times.back()) : keys->times.back();
+					hasKey = true;
+				}
+			}
+			return hasKey;
+		}
+
+		/**
+		* Euler角から回転行列
+		* rotationOrder は EFbxRotationOrder (XYZ なら X, Y, Z の順に回転する = Rz * Ry * Rx)
+		*/
+		Matrix EulerToMatrix(const Vector& degrees, int rotationOrder) {
+			//回転する軸の順番
+			const int orders[6][3] = {
+				{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 2, 0 }, { 1, 0, 2 }, { 2, 0, 1 }, { 2, 1, 0 } };
+			//6 (球面XYZ) 以降は XYZ
+			const int* order = orders[rotationOrder >= 0 && rotationOrder < 6 ? rotationOrder : 0];
+			return RotationAxis(order[2], degrees.m[order[2]]) * RotationAxis(order[1], degrees.m[order[1]]) * RotationAxis(order[0], degrees.m[order[0]]);
+		}
+	}// namespace fbx
+}// namespace FbxLoader
@@ -0,0 +1,163 @@
+﻿#ifndef FbxScene_h
+#define FbxScene_h
+
+#include "FbxDocument.h"
+#include "../../Math/Matrix/Matrix4x4.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace FbxLoader {
+	namespace fbx {
+		//行列は mat * vec の列ベクトル形式
+		typedef mff::Matrix4x4<double> Matrix;
+		typedef mff::Vector3<double> Vector;
+
+		/*
+		Objects 以下のオブジェクトを Connections でつないだもの
+		インデックスは各配列の添字 (-1 でなし)、並びはファイル内の順番
+		メッシュや配列の中身はノードを保持しておき、使う時に Document から読む
+		*/
+		struct Model {
+			int64_t id = 0;
+			std::string name;
+			//"Mesh", "LimbNode", "Null" など
+			std::string type;
+			bool isSkeleton = false;
+			int parent = -1;
+			std::vector<int> children;
+			int geometry = -1;
+			std::vector<int> materials;
+
+			Vector translation = Vector(0);
+			Vector rotation = Vector(0);
+			Vector scaling = Vector(1);
+			Vector preRotation = Vector(0);
+			Vector postRotation = Vector(0);
+			Vector rotationOffset = Vector(0);
+			Vector rotationPivot = Vector(0);
+			Vector scalingOffset = Vector(0);
+			Vector scalingPivot = Vector(0);
+			Vector geometricTranslation = Vector(0);
+			Vector geometricRotation = Vector(0);
+			Vector geometricScaling = Vector(1);
+			//EFbxRotationOrder (0 : XYZ)
+			int rotationOrder = 0;
+		};
+
+		struct Geometry {
+			int64_t id = 0;
+			const Node* node = nullptr;
+			int model = -1;
+			std::vector<int> skins;
+		};
+
+		struct Material {
+			int64_t id = 0;
+			std::string name;
+			//DiffuseColor につながったテクスチャの RelativeFilename
+			std::vector<std::string> diffuseTextures;
+		};
+
+		struct Skin {
+			int64_t id = 0;
+			int geometry = -1;
+			std::vector<int> clusters;
+		};
+
+		struct Cluster {
+			int64_t id = 0;
+			const Node* node = nullptr;
+			int skin = -1;
+			int link = -1;
+		};
+
+		struct AnimationCurve {
+			int64_t id = 0;
+			const Node* node = nullptr;
+			double defaultValue = 0;
+		};
+
+		//Lcl Translation / Lcl Rotation / Lcl Scaling の XYZ
+		struct AnimationCurveNode {
+			int64_t id = 0;
+			int model = -1;
+			//0 : 平行移動, 1 : 回転, 2 : スケール, -1 : それ以外
+			int channel = -1;
+			int curves[3] = { -1, -1, -1 };
+			double values[3] = { 0, 0, 0 };
+		};
+
+		struct AnimationLayer {
+			int64_t id = 0;
+			std::vector<int> curveNodes;
+		};
+
+		struct AnimationStack {
+			int64_t id = 0;
+			std::string name;
+			int64_t localStart = 0;
+			int64_t localStop = 0;
+			std::vector<int> layers;
+		};
+
+		//キーを展開したカーブ (時間は FBX の tick)
+		struct CurveKeys {
+			std::vector<int64_t> times;
+			std::vector<float> values;
+			//キーごとの補間 (KeyAttrFlags) と接線 (KeyAttrDataFloat の右接線, 次のキーの左接線)
+			std::vector<int32_t> flags;
+			std::vector<float> rightSlopes;
+			std::vector<float> nextLeftSlopes;
+			double defaultValue = 0;
+
+			double Evaluate(int64_t time) const;
+		};
+
+		class Scene {
+		public:
+			bool Build(const Document& document);
+
+			//-1 ならアニメーションなし (プロパティの値) で評価する
+			void SetAnimationStack(int stack);
+			Matrix EvaluateLocalTransform(int model, int64_t time) const;
+			Matrix EvaluateGlobalTransform(int model, int64_t time) const;
+			//GeometricTranslation / Rotation / Scaling
+			Matrix GetGeometricTransform(int model) const;
+			//1フレームの長さ (tick)
+			int64_t GetFramePeriod() const;
+			//SetAnimationStack したスタックのキーの範囲 (キーがなければ false)
+			bool GetKeyTimeSpan(int64_t& start, int64_t& stop) const;
+
+			const Document* document = nullptr;
+			std::vector<Model> models;
+			std::vector<Geometry> geometries;
+			std::vector<Material> materials;
+			std::vector<Skin> skins;
+			std::vector<Cluster> clusters;
+			std::vector<AnimationCurve> curves;
+			std::vector<AnimationCurveNode> curveNodes;
+			std::vector<AnimationLayer> layers;
+			std::vector<AnimationStack> stacks;
+			//親を持たないモデル (ルートノードの子)
+			std::vector<int> rootModels;
+			double frameRate = 30;
+
+		private:
+			struct Channel {
+				int curveNode = -1;
+				const CurveKeys* keys[3] = { nullptr, nullptr, nullptr };
+			};
+			//[model * 3 + channel]
+			std::vector<Channel> channels;
+			//[curve] SetAnimationStack で使うものだけ展開する
+			std::vector<CurveKeys> curveKeys;
+			std::vector<bool> isCurveDecoded;
+		};
+
+		//Euler角 (度) から回転行列
+		Matrix EulerToMatrix(const Vector& degrees, int rotationOrder);
+	}// namespace fbx
+}// namespace FbxLoader
+
+#endif /* FbxScene_h */
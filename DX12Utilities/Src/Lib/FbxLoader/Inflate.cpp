@@ -0,0 +1,390 @@
+﻿#include "Inflate.h"
+#include <stdint.h>
+#include <string.h>
+
+namespace FbxLoader {
+	namespace {
+		const int MaxCodeLength = 15;
+		//この長さ以下の符号は表引き1回で復号する
+		const int FastBits = 9;
+		const int FastMask = (1 << FastBits) - 1;
+
+		const uint16_t lengthBase[29] = {
+			3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+			35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		const uint8_t lengthExtra[29] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+			3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		const uint16_t distanceBase[30] = {
+			1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+			257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		const uint8_t distanceExtra[30] = {
+			0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+			7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+		const uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		/*
+		LSBから読むビット列
+		入力の終端を越えた分は0で埋め、読み過ぎていないかは IsOverrun で確認する
+		*/
+		struct BitReader {
+			const uint8_t* cur;
+			const uint8_t* end;
+			uint64_t bits = 0;
+			int count = 0;
+			size_t padding = 0;
+
+			void Refill() {
+				while (count <= 56) {
+					uint64_t byte = 0;
+					if (cur < end) {
+						byte = *cur++;
+					}
+					else {
+						++padding;
+					}
+					bits |= byte << count;
+					count += 8;
+				}
+			}
+
+			uint32_t Peek(int n) {
+				if (count < n) {
+					Refill();
+				}
+				return static_cast<uint32_t>(bits & ((1ull << n) - 1));
+			}
+
+			void Consume(int n) {
+				bits >>= n;
+				count -= n;
+			}
+
+			uint32_t Get(int n) {
+				if (n == 0) {
+					return 0;
+				}
+				uint32_t ret = Peek(n);
+				Consume(n);
+				return ret;
+			}
+
+			void AlignToByte() {
+				Consume(count & 7);
+			}
+
+			bool IsOverrun() const {
+				//埋めたバイトのうち、まだ読んでいない分を超えて消費していたら入力不足
+				return padding * 8 > static_cast<size_t>(count);
+			}
+		};
+
+		/*
+		正規ハフマン符号
+		fast[] は下位 FastBits ビット (ビット反転済み) から (長さ << 9 | シンボル) を引く
+		それより長い符号は count / symbols から1ビットずつ復号する
+		*/
+		struct Huffman {
+			uint16_t fast[1 << FastBits];
+			uint16_t count[MaxCodeLength + 1];
+			uint16_t symbols[288];
+
+			bool Build(const uint8_t* lengths, int symbolCount) {
+				memset(fast, 0, sizeof(fast));
+				memset(count, 0, sizeof(count));
+				for (int i = 0; i < symbolCount; ++i) {
+					++count[lengths[i]];
+				}
+				count[0] = 0;
+
+				//符号が多すぎないか (少ないのは距離符号が1つだけの場合などで許される)
+				int left = 1;
+				for (int len = 1; len <= MaxCodeLength; ++len) {
+					left <<= 1;
+					left -= count[len];
+					if (left < 0) {
+						return false;
+					}
+				}
+
+				uint16_t offsets[MaxCodeLength + 2];
+				offsets[1] = 0;
+				for (int len = 1; len <= MaxCodeLength; ++len) {
+					offsets[len + 1] = offsets[len] + count[len];
+				}
+				int nextCode[MaxCodeLength + 1];
+				int code = 0;
+				for (int len = 1; len <= MaxCodeLength; ++len) {
+					code = (code + count[len - 1]) << 1;
+					nextCode[len] = code;
+				}
+
+				for (int symbol = 0; symbol < symbolCount; ++symbol) {
+					const int len = lengths[symbol];
+					if (!len) {
+						continue;
+					}
+					symbols[offsets[len]++] = static_cast<uint16_t>(symbol);
+					const int c = nextCode[len]++;
+					if (len <= FastBits) {
+						int reversed = 0;
+						for (int i = 0; i < len; ++i) {
+							reversed |= ((c >> i) & 1) << (len - 1 - i);
+						}
+						const uint16_t entry = static_cast<uint16_t>((len << 9) | symbol);
+						for (int i = reversed; i < (1 << FastBits); i += 1 << len) {
+							fast[i] = entry;
+						}
+					}
+				}
+				return true;
+			}
+
+			//不正な符号なら -1
+			int Decode(BitReader& reader) const {
+				const uint16_t entry = fast[reader.Peek(MaxCodeLength) & FastMask];
+				if (entry) {
+					reader.Consume(entry >> 9);
+					return entry & 511;
+				}
+				int code = 0;
+				int first = 0;
+				int index = 0;
+				for (int len = 1; len <= MaxCodeLength; ++len) {
+					code |= static_cast<int>(reader.Get(1));
+					const int n = count[len];
+					if (code - first < n) {
+						return symbols[index + code - first];
+					}
+					index += n;
+					first = (first + n) << 1;
+					code <<= 1;
+				}
+				return -1;
+			}
+		};
+
+		uint32_t Adler32(const uint8_t* data, size_t size) {
+			uint32_t a = 1;
+			uint32_t b = 0;
+			while (size) {
+				//b が32bitであふれない最大ブロック長
+				size_t block = size < 5552 ? size : 5552;
+				size -= block;
+				while (block--) {
+					a += *data++;
+					b += a;
+				}
+				a %= 65521;
+				b %= 65521;
+			}
+			return (b << 16) | a;
+		}
+
+		class Inflater {
+		public:
+			Inflater(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) : out(dst), outCur(dst), outEnd(dst + dstSize) {
+				reader.cur = src;
+				reader.end = src + srcSize;
+			}
+
+			bool Run() {
+				const uint32_t cmf = reader.Get(8);
+				const uint32_t flg = reader.Get(8);
+				//deflate, 32KB窓以下, 辞書なし
+				if ((cmf & 15) != 8 || (cmf >> 4) > 7 || (flg & 32) || ((cmf << 8) | flg) % 31) {
+					return false;
+				}
+
+				bool isFinal = false;
+				while (!isFinal) {
+					isFinal = reader.Get(1) != 0;
+					const uint32_t type = reader.Get(2);
+					bool result = false;
+					switch (type) {
+					case 0:
+						result = Stored();
+						break;
+					case 1:
+						result = BuildFixed() && Block();
+						break;
+					case 2:
+						result = BuildDynamic() && Block();
+						break;
+					default:
+						break;
+					}
+					if (!result || reader.IsOverrun()) {
+						return false;
+					}
+				}
+
+				reader.AlignToByte();
+				uint32_t adler = 0;
+				for (int i = 0; i < 4; ++i) {
+					adler = (adler << 8) | reader.Get(8);
+				}
+				if (reader.IsOverrun() || outCur != outEnd) {
+					return false;
+				}
+				return adler == Adler32(out, static_cast<size_t>(outEnd - out));
+			}
+
+		private:
+			bool Stored() {
+				reader.AlignToByte();
+				const uint32_t length = reader.Get(16);
+				const uint32_t inverse = reader.Get(16);
+				if ((length ^ 0xffff) != inverse || length > static_cast<size_t>(outEnd - outCur)) {
+					return false;
+				}
+				uint32_t left = length;
+				//先読みしてあるバイトから使う
+				while (left && reader.count >= 8) {
+					*outCur++ = static_cast<uint8_t>(reader.Get(8));
+					--left;
+				}
+				if (left > static_cast<size_t>(reader.end - reader.cur)) {
+					return false;
+				}
+				memcpy(outCur, reader.cur, left);
+				outCur += left;
+				reader.cur += left;
+				return true;
+			}
+
+			bool BuildFixed() {
+				uint8_t lengths[288 + 32];
+				memset(lengths, 8, 144);
+				memset(lengths + 144, 9, 112);
+				memset(lengths + 256, 7, 24);
+				memset(lengths + 280, 8, 8);
+				memset(lengths + 288, 5, 32);
+				return literal.Build(lengths, 288) && distance.Build(lengths + 288, 32);
+			}
+
+			bool BuildDynamic() {
+				const int literalCount = static_cast<int>(reader.Get(5)) + 257;
+				const int distanceCount = static_cast<int>(reader.Get(5)) + 1;
+				const int codeLengthCount = static_cast<int>(reader.Get(4)) + 4;
+				if (literalCount > 286 || distanceCount > 30) {
+					return false;
+				}
+
+				uint8_t codeLengths[19] = {};
+				for (int i = 0; i < codeLengthCount; ++i) {
+					codeLengths[codeLengthOrder[i]] = static_cast<uint8_t>(reader.Get(3));
+				}
+				Huffman codeLength;
+				if (!codeLength.Build(codeLengths, 19)) {
+					return false;
+				}
+
+				uint8_t lengths[286 + 30];
+				const int total = literalCount + distanceCount;
+				int n = 0;
+				while (n < total) {
+					const int symbol = codeLength.Decode(reader);
+					if (symbol < 0) {
+						return false;
+					}
+					if (symbol < 16) {
+						lengths[n++] = static_cast<uint8_t>(symbol);
+						continue;
+					}
+					uint8_t value = 0;
+					int repeat = 0;
+					if (symbol == 16) {
+						if (n == 0) {
+							return false;
+						}
+						value = lengths[n - 1];
+						repeat = 3 + static_cast<int>(reader.Get(2));
+					}
+					else if (symbol == 17) {
+						repeat = 3 + static_cast<int>(reader.Get(3));
+					}
+					else {
+						repeat = 11 + static_cast<int>(reader.Get(7));
+					}
+					if (n + repeat > total) {
+						return false;
+					}
+					memset(lengths + n, value, repeat);
+					n += repeat;
+				}
+				//終端符号がないブロックは作れない
+				if (!lengths[256]) {
+					return false;
+				}
+				return literal.Build(lengths, literalCount) && distance.Build(lengths + literalCount, distanceCount);
+			}
+
+			bool Block() {
+				for (;;) {
+					const int symbol = literal.Decode(reader);
+					if (symbol < 0) {
+						return false;
+					}
+					if (symbol < 256) {
+						if (outCur == outEnd) {
+							return false;
+						}
+						*outCur++ = static_cast<uint8_t>(symbol);
+						continue;
+					}
+					if (symbol == 256) {
+						return true;
+					}
+
+					const int lengthCode = symbol - 257;
+					if (lengthCode >= 29) {
+						return false;
+					}
+					const size_t length = lengthBase[lengthCode] + reader.Get(lengthExtra[lengthCode]);
+					const int distanceCode = distance.Decode(reader);
+					if (distanceCode < 0 || distanceCode >= 30) {
+						return false;
+					}
+					const size_t dist = distanceBase[distanceCode] + reader.Get(distanceExtra[distanceCode]);
+					if (dist > static_cast<size_t>(outCur - out) || length > static_cast<size_t>(outEnd - outCur)) {
+						return false;
+					}
+
+					const uint8_t* from = outCur - dist;
+					if (dist >= 8) {
+						//8byteずつコピーしても読み出し元を上書きしない
+						size_t i = 0;
+						for (; i + 8 <= length; i += 8) {
+							memcpy(outCur + i, from + i, 8);
+						}
+						for (; i < length; ++i) {
+							outCur[i] = from[i];
+						}
+					}
+					else {
+						for (size_t i = 0; i < length; ++i) {
+							outCur[i] = from[i];
+						}
+					}
+					outCur += length;
+				}
+			}
+
+			BitReader reader;
+			Huffman literal;
+			Huffman distance;
+			uint8_t* out;
+			uint8_t* outCur;
+			uint8_t* outEnd;
+		};
+	}
+
+	bool Inflate(const void* src, size_t srcSize, void* dst, size_t dstSize) {
+		if (!src || (!dst && dstSize)) {
+			return false;
+		}
+		Inflater inflater(static_cast<const uint8_t*>(src), srcSize, static_cast<uint8_t*>(dst), dstSize);
+		return inflater.Run();
+	}
+}// namespace FbxLoader
@@ -0,0 +1,20 @@
+﻿#ifndef Inflate_h
+#define Inflate_h
+
+#include <stddef.h>
+
+namespace FbxLoader {
+	/*
+	zlib (RFC 1950 / RFC 1951) の展開
+	バイナリFBXの圧縮配列 (encoding == 1) 用なので、展開後のサイズが分かっている前提で dst に直接書き込む
+
+	@param  src     zlibストリーム (2byteのヘッダーから Adler-32 まで)
+	@param  srcSize src のバイト数
+	@param  dst     展開先
+	@param  dstSize 展開後のバイト数
+	@retval ちょうど dstSize バイトに展開でき、Adler-32 が一致すれば true
+	*/
+	bool Inflate(const void* src, size_t srcSize, void* dst, size_t dstSize);
+}// namespace FbxLoader
+
+#endif /* Inflate_h */
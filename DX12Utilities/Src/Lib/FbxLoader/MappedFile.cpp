@@ -0,0 +1,95 @@
+﻿#include "MappedFile.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace FbxLoader {
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	bool MappedFile::Open(const std::string& filename) {
+		Close();
+#if defined(_WIN32)
+		HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		file = fileHandle;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart <= 0) {
+			Close();
+			return false;
+		}
+		HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle) {
+			Close();
+			return false;
+		}
+		mapping = mappingHandle;
+		void* view = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+		if (!view) {
+			Close();
+			return false;
+		}
+		data = static_cast<const uint8_t*>(view);
+		size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		fd = open(filename.c_str(), O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+			Close();
+			return false;
+		}
+		void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view == MAP_FAILED) {
+			Close();
+			return false;
+		}
+		data = static_cast<const uint8_t*>(view);
+		size = static_cast<size_t>(st.st_size);
+#endif
+		return true;
+	}
+
+	void MappedFile::Close() {
+#if defined(_WIN32)
+		if (data) {
+			UnmapViewOfFile(data);
+		}
+		if (mapping) {
+			CloseHandle(static_cast<HANDLE>(mapping));
+			mapping = nullptr;
+		}
+		if (file) {
+			CloseHandle(static_cast<HANDLE>(file));
+			file = nullptr;
+		}
+#else
+		if (data) {
+			munmap(const_cast<uint8_t*>(data), size);
+		}
+		if (fd >= 0) {
+			close(fd);
+			fd = -1;
+		}
+#endif
+		data = nullptr;
+		size = 0;
+	}
+}// namespace FbxLoader
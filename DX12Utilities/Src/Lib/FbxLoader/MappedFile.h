@@ -0,0 +1,39 @@
+﻿#ifndef MappedFile_h
+#define MappedFile_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace FbxLoader {
+	/*
+	読み取り専用でメモリマップしたファイル
+	Data() の指す領域は Close するか破棄されるまで有効
+	*/
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		//空のファイルは開けない
+		bool Open(const std::string& filename);
+		void Close();
+
+		const uint8_t* Data() const { return data; }
+		size_t Size() const { return size; }
+
+	private:
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+#if defined(_WIN32)
+		void* file = nullptr;
+		void* mapping = nullptr;
+#else
+		int fd = -1;
+#endif
+	};
+}// namespace FbxLoader
+
+#endif /* MappedFile_h */
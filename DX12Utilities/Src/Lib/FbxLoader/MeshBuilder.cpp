@@ -0,0 +1,383 @@
+﻿#include "MeshBuilder.h"
+#include "../../Math/Batch/ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+
+namespace FbxLoader {
+	namespace {
+		//これより角の少ないメッシュは分割せずに1スレッドで構築する
+		const size_t parallelCornerCount = 1 << 17;
+
+		void SetWeights(const MeshSource&, int, StaticVertex&) {
+		}
+
+		void SetWeights(const MeshSource& source, int cpIndex, SkinnedVertex& v) {
+			if (source.cpWeights.empty()) {
+				return;
+			}
+			const auto& weights = source.cpWeights[cpIndex].weights;
+			for (size_t boneIndex = 0; boneIndex < weights.size(); ++boneIndex) {
+				v.boneIndex[boneIndex] = weights[boneIndex].first;
+				v.weights[boneIndex] = static_cast<float>(weights[boneIndex].second);
+			}
+		}
+
+		//角ごとの入力から頂点を作る
+		template<typename VertType>
+		class VertexEmitter {
+		public:
+			explicit VertexEmitter(const MeshSource& source)
+				: source(source),
+				materialCount(static_cast<int>(source.materials.size() ? source.materials.size() : 1)),
+				hasColor(!source.colors.empty()),
+				hasTexCoord(!source.texCoords.empty()),
+				hasNormal(!source.normals.empty()),
+				hasTangent(!source.tangents.empty()) {
+			}
+
+			VertType Emit(size_t corner) const {
+				const int cpIndex = source.cpIndices[corner];
+				VertType v;
+				v.position = source.positions[cpIndex];
+				if (hasColor) {
+					v.color = source.colors[corner];
+				}
+				if (hasTexCoord) {
+					v.texCoord = source.texCoords[corner];
+				}
+				if (hasNormal) {
+					v.normal = source.normals[corner];
+				}
+				v.tangent = hasTangent ? source.tangents[corner] : mff::Vector4<float>(1, 0, 0, 1);
+				SetWeights(source, cpIndex, v);
+				return v;
+			}
+
+			//ポリゴンの所属するマテリアルのインデックスの取得
+			int MaterialOf(size_t corner) const {
+				const int materialIndex = source.materialIndices.empty() ? 0 : source.materialIndices[corner / 3];
+				return materialIndex < 0 || materialIndex >= materialCount ? 0 : materialIndex;
+			}
+
+			const MeshSource& source;
+			const int materialCount;
+
+		private:
+			const bool hasColor;
+			const bool hasTexCoord;
+			const bool hasNormal;
+			const bool hasTangent;
+		};
+
+		template<typename VertType>
+		void Build(const MeshSource& source, std::vector<Material<VertType>>& materials) {
+			const VertexEmitter<VertType> emitter(source);
+			const size_t cornerCount = source.cpIndices.size() / 3 * 3;
+			//インデックスはマテリアルごとの角の数だけ先に確保する
+			std::vector<size_t> cornerCounts(materials.size(), 0);
+			for (size_t corner = 0; corner < cornerCount; corner += 3) {
+				cornerCounts[emitter.MaterialOf(corner)] += 3;
+			}
+			for (size_t m = 0; m < materials.size(); ++m) {
+				materials[m].indeces.reserve(cornerCounts[m]);
+			}
+			VertexWelder<VertType> welder(source.positions.size(), source.positions.size());
+			for (size_t corner = 0; corner < cornerCount; ++corner) {
+				const int materialIndex = emitter.MaterialOf(corner);
+				Material<VertType>& materialData = materials[materialIndex];
+				materialData.indeces.push_back(welder.Weld(materialIndex, source.cpIndices[corner], emitter.Emit(corner), materialData.verteces));
+			}
+		}
+
+		/*
+		1つのメッシュを並列に構築する (結果は Build と同じ)
+		VertexWelder の統合はコントロールポイントごとに独立しているので、コントロールポイントの範囲で分割する
+			1. 角をコントロールポイントごとにまとめる (角の順を保つ)
+			2. 範囲ごとに、属する角を順に頂点にして統合する。各範囲の統合結果は Build のものと同じ
+			3. 頂点を最初に使った角の順に並べれば Build と同じ頂点の順になるので、角の順の累積和で番号を振り直す
+			4. インデックスと頂点を書き込む
+		*/
+		template<typename VertType>
+		void BuildParallel(const MeshSource& source, std::vector<Material<VertType>>& materials, int threadCount) {
+			const VertexEmitter<VertType> emitter(source);
+			const size_t materialCount = static_cast<size_t>(emitter.materialCount);
+			const size_t cpCount = source.positions.size();
+			const size_t cornerCount = source.cpIndices.size() / 3 * 3;
+
+			//1. [cpStart[cp], cpStart[cp + 1]) が cp を使う角
+			std::vector<uint32_t> cpStart(cpCount + 1, 0);
+			for (size_t corner = 0; corner < cornerCount; ++corner) {
+				++cpStart[source.cpIndices[corner] + 1];
+			}
+			for (size_t cp = 0; cp < cpCount; ++cp) {
+				cpStart[cp + 1] += cpStart[cp];
+			}
+			std::vector<uint32_t> cornersByCp(cornerCount);
+			{
+				std::vector<uint32_t> fill(cpStart.begin(), cpStart.end() - 1);
+				for (size_t corner = 0; corner < cornerCount; ++corner) {
+					cornersByCp[fill[source.cpIndices[corner]]++] = static_cast<uint32_t>(corner);
+				}
+			}
+
+			//角の数がほぼ等しくなるようにコントロールポイントを範囲に分ける (スレッド数より多くして偏りを減らす)
+			const size_t rangeCount = std::max<size_t>(1, std::min(cpCount, static_cast<size_t>(threadCount) * 4));
+			std::vector<size_t> rangeBegin(rangeCount + 1, cpCount);
+			rangeBegin[0] = 0;
+			for (size_t range = 1, cp = 0; range < rangeCount; ++range) {
+				const size_t target = cornerCount * range / rangeCount;
+				while (cp < cpCount && cpStart[cp] < target) {
+					++cp;
+				}
+				rangeBegin[range] = cp;
+			}
+
+			//2. 範囲ごとの頂点 [range][material]
+			std::vector<std::vector<std::vector<VertType>>> rangeVerteces(rangeCount, std::vector<std::vector<VertType>>(materialCount));
+			//範囲内での頂点番号 (範囲ごと・マテリアルごとの通し番号)
+			std::vector<uint32_t> cornerVertex(cornerCount);
+			//頂点を最初に使った角
+			std::vector<uint8_t> isFirst(cornerCount, 0);
+			mff::ParallelFor(rangeCount, threadCount, 1, [&](size_t begin, size_t end) {
+				for (size_t range = begin; range < end; ++range) {
+					const size_t cpBegin = rangeBegin[range];
+					const size_t cpEnd = rangeBegin[range + 1];
+					auto& verteces = rangeVerteces[range];
+					VertexWelder<VertType> welder(cpEnd - cpBegin, cpEnd - cpBegin);
+					for (size_t cp = cpBegin; cp < cpEnd; ++cp) {
+						for (uint32_t i = cpStart[cp]; i < cpStart[cp + 1]; ++i) {
+							const uint32_t corner = cornersByCp[i];
+							const int materialIndex = emitter.MaterialOf(corner);
+							const size_t size = verteces[materialIndex].size();
+							cornerVertex[corner] = static_cast<uint32_t>(welder.Weld(materialIndex, static_cast<int>(cp - cpBegin), emitter.Emit(corner), verteces[materialIndex]));
+							isFirst[corner] = verteces[materialIndex].size() != size;
+						}
+					}
+				}
+			});
+
+			//範囲の頂点番号をマテリアルごとの通し番号にする
+			std::vector<std::vector<uint32_t>> rangeOffset(rangeCount, std::vector<uint32_t>(materialCount));
+			std::vector<size_t> vertexCount(materialCount, 0);
+			for (size_t range = 0; range < rangeCount; ++range) {
+				for (size_t m = 0; m < materialCount; ++m) {
+					rangeOffset[range][m] = static_cast<uint32_t>(vertexCount[m]);
+					vertexCount[m] += rangeVerteces[range][m].size();
+				}
+			}
+			auto rangeOf = [&](int cp) {
+				return static_cast<size_t>(std::upper_bound(rangeBegin.begin(), rangeBegin.end() - 1, static_cast<size_t>(cp)) - rangeBegin.begin()) - 1;
+			};
+
+			//3. 角の区間ごとに、マテリアルごとの角の数と頂点の数を数えて累積和を取る
+			const size_t chunkSize = 1 << 16;
+			const size_t chunkCount = (cornerCount + chunkSize - 1) / chunkSize;
+			std::vector<uint32_t> cornerBase(chunkCount * materialCount, 0);
+			std::vector<uint32_t> vertexBase(chunkCount * materialCount, 0);
+			mff::ParallelFor(chunkCount, threadCount, 1, [&](size_t begin, size_t end) {
+				for (size_t chunk = begin; chunk < end; ++chunk) {
+					const size_t last = std::min(cornerCount, (chunk + 1) * chunkSize);
+					for (size_t corner = chunk * chunkSize; corner < last; ++corner) {
+						const size_t m = static_cast<size_t>(emitter.MaterialOf(corner));
+						++cornerBase[chunk * materialCount + m];
+						vertexBase[chunk * materialCount + m] += isFirst[corner];
+					}
+				}
+			});
+			std::vector<uint32_t> cornerTotal(materialCount, 0);
+			std::vector<uint32_t> vertexTotal(materialCount, 0);
+			for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+				for (size_t m = 0; m < materialCount; ++m) {
+					const uint32_t corners = cornerBase[chunk * materialCount + m];
+					const uint32_t vertices = vertexBase[chunk * materialCount + m];
+					cornerBase[chunk * materialCount + m] = cornerTotal[m];
+					vertexBase[chunk * materialCount + m] = vertexTotal[m];
+					cornerTotal[m] += corners;
+					vertexTotal[m] += vertices;
+				}
+			}
+
+			//通し番号 -> 出力の頂点番号
+			std::vector<std::vector<uint32_t>> remap(materialCount);
+			for (size_t m = 0; m < materialCount; ++m) {
+				remap[m].resize(vertexCount[m]);
+				materials[m].verteces.resize(vertexCount[m]);
+				materials[m].indeces.resize(cornerTotal[m]);
+			}
+			mff::ParallelFor(chunkCount, threadCount, 1, [&](size_t begin, size_t end) {
+				std::vector<uint32_t> next(materialCount);
+				for (size_t chunk = begin; chunk < end; ++chunk) {
+					std::copy(vertexBase.begin() + chunk * materialCount, vertexBase.begin() + (chunk + 1) * materialCount, next.begin());
+					const size_t last = std::min(cornerCount, (chunk + 1) * chunkSize);
+					for (size_t corner = chunk * chunkSize; corner < last; ++corner) {
+						if (isFirst[corner]) {
+							const size_t m = static_cast<size_t>(emitter.MaterialOf(corner));
+							remap[m][rangeOffset[rangeOf(source.cpIndices[corner])][m] + cornerVertex[corner]] = next[m]++;
+						}
+					}
+				}
+			});
+
+			//4. インデックスは角の順、頂点は範囲ごとにコピーする
+			mff::ParallelFor(chunkCount, threadCount, 1, [&](size_t begin, size_t end) {
+				std::vector<uint32_t> next(materialCount);
+				for (size_t chunk = begin; chunk < end; ++chunk) {
+					std::copy(cornerBase.begin() + chunk * materialCount, cornerBase.begin() + (chunk + 1) * materialCount, next.begin());
+					const size_t last = std::min(cornerCount, (chunk + 1) * chunkSize);
+					for (size_t corner = chunk * chunkSize; corner < last; ++corner) {
+						const size_t m = static_cast<size_t>(emitter.MaterialOf(corner));
+						materials[m].indeces[next[m]++] = remap[m][rangeOffset[rangeOf(source.cpIndices[corner])][m] + cornerVertex[corner]];
+					}
+				}
+			});
+			mff::ParallelFor(rangeCount, threadCount, 1, [&](size_t begin, size_t end) {
+				for (size_t range = begin; range < end; ++range) {
+					for (size_t m = 0; m < materialCount; ++m) {
+						const auto& verteces = rangeVerteces[range][m];
+						for (size_t i = 0; i < verteces.size(); ++i) {
+							materials[m].verteces[remap[m][rangeOffset[range][m] + i]] = verteces[i];
+						}
+					}
+				}
+			});
+		}
+
+		template<typename VertType>
+		void Build(const MeshSource& source, std::vector<Material<VertType>>& materials, int threadCount) {
+			const size_t materialCount = source.materials.size() ? source.materials.size() : 1;
+			materials.resize(materialCount);
+			for (size_t i = 0; i < source.materials.size(); ++i) {
+				materials[i].name = source.materials[i].name;
+				materials[i].textureName = source.materials[i].textureName;
+			}
+
+			if (threadCount <= 0) {
+				threadCount = static_cast<int>(std::thread::hardware_concurrency());
+			}
+			//分割の手間に見合う大きさの時だけ並列にする
+			if (threadCount > 1 && source.cpIndices.size() >= parallelCornerCount) {
+				BuildParallel(source, materials, threadCount);
+			}
+			else {
+				Build(source, materials);
+			}
+		}
+
+		//各マテリアルを OptimizeVertexCache する (report が nullptr でなければ結果を入れる)
+		template<typename Mesh>
+		void OptimizeMaterials(Mesh& mesh, MeshVertexCacheReport* report) {
+			if (report) {
+				report->name = mesh.name;
+				report->materials.reserve(mesh.materials.size());
+			}
+			for (auto& material : mesh.materials) {
+				const VertexCacheReport materialReport = OptimizeVertexCache(material);
+				if (report) {
+					report->materials.push_back(materialReport);
+				}
+			}
+		}
+	}
+
+	void LimitWeights(std::vector<PerCpBoneIndexAndWeight>& cpWeights) {
+		for (auto& w : cpWeights) {
+			if (w.weights.size() > 4) {
+				std::sort(w.weights.begin(), w.weights.end(), [](const std::pair<int, double>& a, const std::pair<int, double>& b) { return a.second > b.second; });
+				w.weights.erase(w.weights.begin() + 4, w.weights.end());
+			}
+			double sum = 0;
+			for (auto& weight : w.weights) {
+				sum += weight.second;
+			}
+			for (auto& weight : w.weights) {
+				weight.second /= sum;
+			}
+		}
+	}
+
+	/**
+	* 三角形の並びから頂点とインデックスを作る
+	*
+	* @param   source      三角形化済みのメッシュ
+	* @param   mesh        読み込んだデータの格納先
+	* @param   threadCount 使用するスレッド数 (0以下でハードウェアスレッド数)
+	*/
+	void BuildMesh(const MeshSource& source, StaticMesh& mesh, int threadCount) {
+		mesh.name = source.name;
+		Build(source, mesh.materials, threadCount);
+	}
+
+	void BuildMesh(const MeshSource& source, SkinnedMesh& mesh, int threadCount) {
+		mesh.name = source.name;
+		Build(source, mesh.materials, threadCount);
+	}
+
+	/**
+	* 複数のメッシュを並列に構築する
+	*
+	* @param   staticSources   アニメーションをしないメッシュの入力 (構築後は空になる)
+	* @param   staticMeshes    staticSources の結果の追加先
+	* @param   skinnedSources  アニメーションをするメッシュの入力 (構築後は空になる)
+	* @param   skinnedMeshes   skinnedSources の結果の追加先
+	* @param   threadCount     使用するスレッド数 (0以下でハードウェアスレッド数)
+	* @param   optimizeVertexCache 各マテリアルのインデックスを OptimizeVertexCache で並べ替えるか
+	* @param   reports         並べ替え前後の統計の格納先 (nullptr なら捨てる)
+	*/
+	void BuildMeshes(std::vector<MeshSource>& staticSources, std::vector<StaticMesh>& staticMeshes,
+		std::vector<MeshSource>& skinnedSources, std::vector<SkinnedMesh>& skinnedMeshes, int threadCount,
+		bool optimizeVertexCache, std::vector<MeshVertexCacheReport>* reports) {
+		const size_t staticBase = staticMeshes.size();
+		const size_t skinnedBase = skinnedMeshes.size();
+		staticMeshes.resize(staticBase + staticSources.size());
+		skinnedMeshes.resize(skinnedBase + skinnedSources.size());
+
+		//[0, staticSources.size()) は static、それ以降は skinned
+		std::vector<size_t> order(staticSources.size() + skinnedSources.size());
+		if (reports) {
+			reports->assign(optimizeVertexCache ? order.size() : 0, MeshVertexCacheReport());
+		}
+		for (size_t i = 0; i < order.size(); ++i) {
+			order[i] = i;
+		}
+		auto sourceOf = [&](size_t job) -> MeshSource& {
+			return job < staticSources.size() ? staticSources[job] : skinnedSources[job - staticSources.size()];
+		};
+		//大きいものを先に始めて、最後に1つだけ残る時間を短くする
+		std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return sourceOf(a).cpIndices.size() > sourceOf(b).cpIndices.size();
+		});
+
+		//各スレッドは order の次のメッシュを取り出して構築する (結果の位置は決まっているので順序は変わらない)
+		const size_t totalCount = threadCount > 0 ? static_cast<size_t>(threadCount) : std::thread::hardware_concurrency();
+		const size_t workerCount = std::max<size_t>(1, std::min(totalCount, order.size()));
+		//メッシュがスレッドより少なければ、余ったスレッドはメッシュの中の並列化に回す
+		const int innerThreadCount = static_cast<int>(std::max<size_t>(1, totalCount / workerCount));
+		std::atomic<size_t> next(0);
+		mff::ParallelFor(workerCount, static_cast<int>(workerCount), 1, [&](size_t, size_t) {
+			for (size_t i = next++; i < order.size(); i = next++) {
+				const size_t job = order[i];
+				MeshSource& source = sourceOf(job);
+				//各スレッドは別の要素にだけ書き込む
+				MeshVertexCacheReport* report = reports && optimizeVertexCache ? &(*reports)[job] : nullptr;
+				if (job < staticSources.size()) {
+					StaticMesh& mesh = staticMeshes[staticBase + job];
+					BuildMesh(source, mesh, innerThreadCount);
+					if (optimizeVertexCache) {
+						OptimizeMaterials(mesh, report);
+					}
+				}
+				else {
+					SkinnedMesh& mesh = skinnedMeshes[skinnedBase + job - staticSources.size()];
+					BuildMesh(source, mesh, innerThreadCount);
+					if (optimizeVertexCache) {
+						OptimizeMaterials(mesh, report);
+						if (report) {
+							report->isSkinned = true;
+						}
+					}
+				}
+				source = MeshSource();
+			}
+		});
+	}
+}// namespace FbxLoader
@@ -0,0 +1,261 @@
+﻿#ifndef MeshBuilder_h
+#define MeshBuilder_h
+
+#include "FbxLoaderStructs.h"
+#include "../../Math/Batch/VertexCache.h"
+#include "../../Math/Batch/VertexCompare.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace FbxLoader {
+	struct MaterialSource {
+		std::string name;
+		std::vector<std::string> textureName;
+	};
+
+	/*
+	メッシュ構築の入力 (SDKやファイルから取り出した三角形化済みのデータ)
+	[cp] はコントロールポイントごと、[corner] は三角形の頂点ごと (三角形 i の頂点は 3i, 3i+1, 3i+2)
+	属性の配列は空なら頂点の既定値を使う
+	*/
+	struct MeshSource {
+		std::string name;
+		//1つ以上
+		std::vector<MaterialSource> materials;
+		//[cp] グローバル変換済み
+		std::vector<mff::Vector3<float>> positions;
+		//[corner]
+		std::vector<int> cpIndices;
+		//[triangle] 空なら全て0
+		std::vector<int> materialIndices;
+		//[corner]
+		std::vector<mff::Vector4<float>> colors;
+		std::vector<mff::Vector2<float>> texCoords;
+		std::vector<mff::Vector3<float>> normals;
+		//w は従法線の符号
+		std::vector<mff::Vector4<float>> tangents;
+		//[cp] SkinnedMesh のみ (LimitWeights 済み)
+		std::vector<PerCpBoneIndexAndWeight> cpWeights;
+	};
+
+	/*
+	color, texCoord, normal の9要素を4要素ずつまとめて比較する (各成分の判定は operator== と同じ)
+	比較する頂点は直前に成分ごとに書き込んだものなので、成分の境界をまたぐ16バイトの読み込みは
+	ストアフォワーディングに失敗して遅い。color だけをそのまま読み、残りは成分ごとに読んで並べる
+	*/
+	template <typename VertType>
+	bool IsSameAttribute(const VertType& a, const VertType& b) {
+		using namespace mff::simd;
+		const Float4 eps = Splat(static_cast<float>(MFF_FEPSILON));
+		const Float4 color = NearlyEqualMask(Load(a.color.m), Load(b.color.m), eps);
+		const Float4 texCoordNormal = NearlyEqualMask(Set(a.texCoord.x, a.texCoord.y, a.normal.x, a.normal.y),
+			Set(b.texCoord.x, b.texCoord.y, b.normal.x, b.normal.y), eps);
+		//4要素目は必ず成り立つ値で埋める
+		const Float4 normalZ = NearlyEqualMask(Set(a.normal.z, 0, 0, 0), Set(b.normal.z, 0, 0, 0), eps);
+		return MoveMask(And(And(color, texCoordNormal), normalZ)) == 0xf;
+	}
+
+	//IsSameAttribute で比べる9要素を同じ順に並べる (VertexWelder の量子化ハッシュのキー。メンバの並びには依存しない)
+	template <typename VertType>
+	void GetAttribute(const VertType& v, float (&attr)[9]) {
+		attr[0] = v.color.x;
+		attr[1] = v.color.y;
+		attr[2] = v.color.z;
+		attr[3] = v.color.w;
+		attr[4] = v.texCoord.x;
+		attr[5] = v.texCoord.y;
+		attr[6] = v.normal.x;
+		attr[7] = v.normal.y;
+		attr[8] = v.normal.z;
+	}
+
+	/*
+	重複頂点の統合 (同じマテリアル・コントロールポイントで IsSameAttribute が成り立つ頂点を1つにまとめる)
+	コントロールポイントごとに追加順の連結リストを持ち、先頭から maxChain 個までを比較する
+		リストの先頭のノードはコントロールポイントの配列に直接持ち、2つ目以降は1つの配列にまとめて確保する
+		(コントロールポイントごとの確保はしない。頂点が1つだけのコントロールポイントはノードを辿らずに比較できる)
+	maxChain を超えて分割されたコントロールポイントの頂点は、属性を量子化したハッシュをキーにした
+	オープンアドレス法の表で引く (フラットシェーディングの扇の中心などでも頂点1つあたり平均 O(1))
+		表ではキーが一致する頂点だけをまとめるので、誤差が格子の境界をまたぐと別の頂点のままになる
+		(誤ってまとめることはない)
+	*/
+	template<typename VertType>
+	class VertexWelder {
+	public:
+		//線形に比較する頂点数の上限 (コントロールポイントごと、全マテリアルの合計)
+		static const int maxChain = 8;
+
+		/**
+		* @param   cpCount             コントロールポイント数
+		* @param   expectedVertexCount 統合後の頂点数の見込み (予約するだけ)
+		*/
+		VertexWelder(size_t cpCount, size_t expectedVertexCount)
+			: heads(cpCount) {
+			nodes.reserve(expectedVertexCount > cpCount ? expectedVertexCount - cpCount : 0);
+		}
+
+		/**
+		* 同じ頂点があればそのインデックスを、なければ verteces に追加してそのインデックスを返す
+		*
+		* @param   materialIndex   マテリアルのインデックス
+		* @param   cpIndex         コントロールポイントのインデックス
+		* @param   v               追加する頂点
+		* @param   verteces        materialIndex のマテリアルの頂点配列 (呼び出しごとに同じものを渡すこと)
+		* @retval  verteces でのインデックス
+		*/
+		int Weld(int materialIndex, int cpIndex, const VertType& v, std::vector<VertType>& verteces) {
+			const int index = static_cast<int>(verteces.size());
+			Node* node = &heads[cpIndex];
+			if (node->index < 0) {
+				verteces.push_back(v);
+				*node = Node{ materialIndex, index, -1 };
+				return index;
+			}
+			int length = 1;
+			for (;;) {
+				if (node->material == materialIndex && IsSameAttribute(verteces[node->index], v)) {
+					return node->index;
+				}
+				if (node->next < 0 || length == maxChain) {
+					break;
+				}
+				node = &nodes[node->next];
+				++length;
+			}
+
+			if (length < maxChain) {
+				node->next = static_cast<int>(nodes.size());
+				nodes.push_back(Node{ materialIndex, index, -1 });
+			}
+			else {
+				if ((used + 1) * 2 > slots.size()) {
+					Grow();
+				}
+				const uint64_t cpKey = (static_cast<uint64_t>(static_cast<uint32_t>(materialIndex)) << 32) | static_cast<uint32_t>(cpIndex);
+				float attr[9];
+				GetAttribute(v, attr);
+				const uint64_t key = mff::hash::Finalize(mff::QuantizedHash(attr, 9, tolerance) ^ (cpKey * 0x9e3779b97f4a7c15ull));
+				const size_t mask = slots.size() - 1;
+				size_t i = key & mask;
+				for (; slots[i].index >= 0; i = (i + 1) & mask) {
+					const Slot& slot = slots[i];
+					if (slot.key == key && slot.material == materialIndex && slot.cp == cpIndex &&
+						IsSameAttribute(verteces[slot.index], v)) {
+						return slot.index;
+					}
+				}
+				slots[i] = Slot{ key, materialIndex, cpIndex, index };
+				++used;
+			}
+			verteces.push_back(v);
+			return index;
+		}
+
+	private:
+		struct Node {
+			int material = 0;
+			//-1 なら空
+			int index = -1;
+			//nodes での次のノード
+			int next = -1;
+		};
+
+		struct Slot {
+			uint64_t key;
+			int material;
+			int cp;
+			//-1 なら空
+			int index;
+		};
+
+		//IsSameAttribute の許容誤差。量子化の格子幅はこの半分なので、キーが同じなら必ず IsSameAttribute も成り立つ
+		static constexpr float tolerance = static_cast<float>(MFF_FEPSILON);
+
+		void Grow() {
+			std::vector<Slot> old(slots.empty() ? 64 : slots.size() * 2, Slot{ 0, 0, 0, -1 });
+			old.swap(slots);
+			const size_t mask = slots.size() - 1;
+			for (const Slot& slot : old) {
+				if (slot.index < 0) {
+					continue;
+				}
+				size_t i = slot.key & mask;
+				while (slots[i].index >= 0) {
+					i = (i + 1) & mask;
+				}
+				slots[i] = slot;
+			}
+		}
+
+		//[cpIndex] リストの先頭のノード
+		std::vector<Node> heads;
+		//リストの2つ目以降のノード
+		std::vector<Node> nodes;
+		//maxChain を超えた頂点の表 (要素数は2のべき乗)
+		std::vector<Slot> slots;
+		size_t used = 0;
+	};
+
+	//ウェイトを大きい順に4つに制限して正規化する
+	void LimitWeights(std::vector<PerCpBoneIndexAndWeight>& cpWeights);
+
+	/*
+	三角形の頂点を順に出力し、同じマテリアル・コントロールポイントで属性 (color, texCoord, normal) が等しい頂点をまとめる
+	threadCount が 1 以外で大きいメッシュはコントロールポイントの範囲ごとに並列に統合する
+	頂点・インデックスの内容と順序はスレッド数によらず1スレッドの時と同じ
+	*/
+	void BuildMesh(const MeshSource& source, StaticMesh& mesh, int threadCount = 1);
+	void BuildMesh(const MeshSource& source, SkinnedMesh& mesh, int threadCount = 1);
+
+	struct VertexCacheReport {
+		mff::VertexCacheStatistics before;
+		mff::VertexCacheStatistics after;
+	};
+
+	//BuildMeshes で構築したメッシュ1つ分の OptimizeVertexCache の結果
+	struct MeshVertexCacheReport {
+		std::string name;
+		bool isSkinned = false;
+		//[material]
+		std::vector<VertexCacheReport> materials;
+	};
+
+	/**
+	* マテリアルのインデックスを頂点変換後キャッシュに合わせて並べ替える (頂点配列はそのまま)
+	*
+	* @param   material    対象のマテリアル
+	* @param   cacheSize   想定するキャッシュの頂点数 (統計も同じ大きさで計算する)
+	* @retval  並べ替え前後の ACMR / ATVR
+	*/
+	template<typename VertType>
+	VertexCacheReport OptimizeVertexCache(Material<VertType>& material, int cacheSize = 16) {
+		static_assert(sizeof(unsigned int) == sizeof(uint32_t), "indeces must be 32bit");
+		VertexCacheReport report;
+		const size_t vertexCount = material.verteces.size();
+		report.before = mff::AnalyzeVertexCache(material.indeces.data(), material.indeces.size(), vertexCount, cacheSize);
+		std::vector<unsigned int> optimized(material.indeces.size());
+		if (mff::OptimizeVertexCache(optimized.data(), material.indeces.data(), material.indeces.size(), vertexCount, cacheSize)) {
+			material.indeces.swap(optimized);
+		}
+		report.after = mff::AnalyzeVertexCache(material.indeces.data(), material.indeces.size(), vertexCount, cacheSize);
+		return report;
+	}
+
+	/*
+	複数のメッシュをスレッドで並列に構築し、staticMeshes, skinnedMeshes の末尾に sources と同じ順で追加する
+	結果はスレッド数によらず、順に BuildMesh した時と同じ
+	各スレッドは三角形の多いメッシュから順に取り出して構築する。構築し終えた source は解放する
+	メッシュの数がスレッド数より少ない時は残りのスレッドで各メッシュの中を並列にする
+	threadCount : 0以下でハードウェアスレッド数、1なら呼び出したスレッドで順に構築する
+	optimizeVertexCache : true なら構築したメッシュの各マテリアルに OptimizeVertexCache を行う
+	reports : nullptr でなければ、optimizeVertexCache の時は各メッシュの並べ替え前後の統計で置き換える
+	          (staticSources, skinnedSources の順。optimizeVertexCache が false なら空にする)
+	*/
+	void BuildMeshes(std::vector<MeshSource>& staticSources, std::vector<StaticMesh>& staticMeshes,
+		std::vector<MeshSource>& skinnedSources, std::vector<SkinnedMesh>& skinnedMeshes, int threadCount,
+		bool optimizeVertexCache = false, std::vector<MeshVertexCacheReport>* reports = nullptr);
+}// namespace FbxLoader
+
+#endif /* MeshBuilder_h */
@@ -0,0 +1,798 @@
+﻿#include "MeshCache.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#endif
+
+namespace FbxLoader {
+	namespace {
+		const char cacheMagic[8] = { 'M', 'F', 'F', 'M', 'E', 'S', 'H', '\0' };
+		//各セクションの先頭 (頂点を SIMD で読めるように16byte境界)
+		const uint64_t sectionAlignment = 16;
+
+		struct CacheHeader {
+			char magic[8];
+			uint32_t formatVersion;
+			uint32_t options;
+			//途中で切れたファイルを弾く
+			uint64_t fileSize;
+			uint64_t sourceSize;
+			uint64_t sourceHash;
+			uint32_t sectionCount;
+			uint32_t reserved;
+		};
+
+		struct CacheSection {
+			uint32_t type;
+			uint32_t elementSize;
+			uint64_t offset;
+			uint64_t count;
+		};
+
+		enum SectionType : uint32_t {
+			SectionStrings,
+			SectionStaticMeshes,
+			SectionSkinnedMeshes,
+			SectionMaterials,
+			SectionTextureNames,
+			SectionStaticVertices,
+			SectionSkinnedVertices,
+			SectionIndices,
+			SectionMatrices,
+			SectionBones,
+			SectionBoneChildren,
+			SectionAnimations,
+			SectionTracks,
+			SectionKeys,
+			SectionCount,
+		};
+
+		//SectionStrings の範囲
+		struct StringRef {
+			uint32_t offset;
+			uint32_t size;
+		};
+
+		struct MeshRecord {
+			StringRef name;
+			uint32_t firstMaterial;
+			uint32_t materialCount;
+			//SectionMatrices の boneBaseInvs (スキンメッシュのみ)
+			uint32_t firstMatrix;
+			uint32_t matrixCount;
+		};
+
+		//頂点はメッシュの種類に合わせて SectionStaticVertices か SectionSkinnedVertices を指す
+		struct MaterialRecord {
+			StringRef name;
+			uint32_t firstTexture;
+			uint32_t textureCount;
+			uint32_t firstVertex;
+			uint32_t vertexCount;
+			uint32_t firstIndex;
+			uint32_t indexCount;
+		};
+
+		struct BoneRecord {
+			StringRef name;
+			int32_t boneId;
+			int32_t parentId;
+			uint32_t firstChild;
+			uint32_t childCount;
+			mff::Matrix4x4<float> baseInv;
+		};
+
+		struct AnimationRecord {
+			StringRef name;
+			float animationTime;
+			uint32_t firstTrack;
+			uint32_t trackCount;
+		};
+
+		//ボーン1本分のキー (BoneAnimationData)
+		struct TrackRecord {
+			uint32_t firstKey;
+			uint32_t keyCount;
+			float animationTime;
+			uint32_t reserved;
+		};
+
+		struct KeyRecord {
+			float time;
+			mff::Matrix4x4<float> matrix;
+		};
+
+		const uint32_t sectionElementSizes[SectionCount] = {
+			1,
+			sizeof(MeshRecord),
+			sizeof(MeshRecord),
+			sizeof(MaterialRecord),
+			sizeof(StringRef),
+			sizeof(StaticVertex),
+			sizeof(SkinnedVertex),
+			sizeof(unsigned int),
+			sizeof(mff::Matrix4x4<float>),
+			sizeof(BoneRecord),
+			sizeof(int32_t),
+			sizeof(AnimationRecord),
+			sizeof(TrackRecord),
+			sizeof(KeyRecord),
+		};
+
+		//マップした各セクションを型付きで見たもの
+		struct CacheData {
+			Span<char> strings;
+			Span<MeshRecord> staticMeshes;
+			Span<MeshRecord> skinnedMeshes;
+			Span<MaterialRecord> materials;
+			Span<StringRef> textureNames;
+			Span<StaticVertex> staticVertices;
+			Span<SkinnedVertex> skinnedVertices;
+			Span<unsigned int> indices;
+			Span<mff::Matrix4x4<float> > matrices;
+			Span<BoneRecord> bones;
+			Span<int32_t> boneChildren;
+			Span<AnimationRecord> animations;
+			Span<TrackRecord> tracks;
+			Span<KeyRecord> keys;
+
+			explicit CacheData(const std::vector<Span<char> >& sections) {
+				Cast(sections[SectionStrings], strings);
+				Cast(sections[SectionStaticMeshes], staticMeshes);
+				Cast(sections[SectionSkinnedMeshes], skinnedMeshes);
+				Cast(sections[SectionMaterials], materials);
+				Cast(sections[SectionTextureNames], textureNames);
+				Cast(sections[SectionStaticVertices], staticVertices);
+				Cast(sections[SectionSkinnedVertices], skinnedVertices);
+				Cast(sections[SectionIndices], indices);
+				Cast(sections[SectionMatrices], matrices);
+				Cast(sections[SectionBones], bones);
+				Cast(sections[SectionBoneChildren], boneChildren);
+				Cast(sections[SectionAnimations], animations);
+				Cast(sections[SectionTracks], tracks);
+				Cast(sections[SectionKeys], keys);
+			}
+
+			template<typename T>
+			static void Cast(const Span<char>& src, Span<T>& dst) {
+				dst = Span<T>(reinterpret_cast<const T*>(src.data()), src.size());
+			}
+
+			bool ReadString(const StringRef& ref, std::string& dst) const {
+				if (static_cast<uint64_t>(ref.offset) + ref.size > strings.size()) {
+					return false;
+				}
+				dst.assign(strings.data() + ref.offset, ref.size);
+				return true;
+			}
+		};
+
+		bool IsInRange(uint32_t first, uint32_t count, size_t size) {
+			return static_cast<uint64_t>(first) + count <= size;
+		}
+
+		/*
+		BoneAnimationData::GetMat が範囲外を読んだり止まらなくなったりしないかの確認
+		ローダーが書くキーは時間 0 から増えていき、最後のキーの時間が track.animationTime になる
+			キーの時間は有限で減らないこと、先頭は 0、末尾は animationTime
+			2つ以上キーがあれば animationTime > 0 (GetMat はこの長さずつ時間を巻き戻す)
+		*/
+		bool IsValidTrack(const TrackRecord& track, const Span<KeyRecord>& keys) {
+			if (!isfinite(track.animationTime)) {
+				return false;
+			}
+			if (!track.keyCount) {
+				return true;
+			}
+			const KeyRecord* first = keys.data() + track.firstKey;
+			if (first[0].time != 0.0f || first[track.keyCount - 1].time != track.animationTime) {
+				return false;
+			}
+			for (uint32_t k = 1; k < track.keyCount; ++k) {
+				if (!isfinite(first[k].time) || first[k].time < first[k - 1].time) {
+					return false;
+				}
+			}
+			return track.keyCount == 1 || track.animationTime > 0.0f;
+		}
+
+		uint64_t AlignSection(uint64_t offset) {
+			return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+		}
+
+		/**
+		* メッシュのマテリアルをマップした領域から組み立てる
+		* インデックスがマテリアルの頂点数を超えていないかもここで確認する
+		*/
+		template<typename VertType>
+		bool ReadMaterials(const CacheData& data, const MeshRecord& mesh, const Span<VertType>& vertices, std::vector<MaterialView<VertType>>& dst) {
+			if (!IsInRange(mesh.firstMaterial, mesh.materialCount, data.materials.size())) {
+				return false;
+			}
+			dst.resize(mesh.materialCount);
+			for (uint32_t i = 0; i < mesh.materialCount; ++i) {
+				const MaterialRecord& record = data.materials[mesh.firstMaterial + i];
+				MaterialView<VertType>& view = dst[i];
+				if (!data.ReadString(record.name, view.name) ||
+					!IsInRange(record.firstTexture, record.textureCount, data.textureNames.size()) ||
+					!IsInRange(record.firstVertex, record.vertexCount, vertices.size()) ||
+					!IsInRange(record.firstIndex, record.indexCount, data.indices.size())) {
+					return false;
+				}
+				view.verteces = Span<VertType>(vertices.data() + record.firstVertex, record.vertexCount);
+				view.indeces = Span<unsigned int>(data.indices.data() + record.firstIndex, record.indexCount);
+				for (unsigned int index : view.indeces) {
+					if (index >= record.vertexCount) {
+						return false;
+					}
+				}
+				view.textureName.resize(record.textureCount);
+				for (uint32_t t = 0; t < record.textureCount; ++t) {
+					if (!data.ReadString(data.textureNames[record.firstTexture + t], view.textureName[t])) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		template<typename VertType>
+		void CopyMaterials(const std::vector<MaterialView<VertType>>& src, std::vector<Material<VertType>>& dst) {
+			dst.resize(src.size());
+			for (size_t i = 0; i < src.size(); ++i) {
+				dst[i].name = src[i].name;
+				dst[i].indeces.assign(src[i].indeces.begin(), src[i].indeces.end());
+				dst[i].verteces.assign(src[i].verteces.begin(), src[i].verteces.end());
+				dst[i].textureName = src[i].textureName;
+			}
+		}
+
+		void CopyMesh(const StaticMeshView& src, StaticMesh& dst) {
+			dst.name = src.name;
+			CopyMaterials(src.materials, dst.materials);
+		}
+
+		void CopyMesh(const SkinnedMeshView& src, SkinnedMesh& dst) {
+			dst.name = src.name;
+			CopyMaterials(src.materials, dst.materials);
+			dst.boneBaseInvs.assign(src.boneBaseInvs.begin(), src.boneBaseInvs.end());
+		}
+
+		//書き込み用のレコードの組み立て
+		struct RecordBuilder {
+			std::string strings;
+			std::vector<MeshRecord> staticMeshes;
+			std::vector<MeshRecord> skinnedMeshes;
+			std::vector<MaterialRecord> materials;
+			std::vector<StringRef> textureNames;
+			uint64_t staticVertexCount = 0;
+			uint64_t skinnedVertexCount = 0;
+			uint64_t indexCount = 0;
+			std::vector<mff::Matrix4x4<float> > matrices;
+			std::vector<BoneRecord> bones;
+			std::vector<int32_t> boneChildren;
+			std::vector<AnimationRecord> animations;
+			std::vector<TrackRecord> tracks;
+			std::vector<KeyRecord> keys;
+
+			StringRef AddString(const std::string& str) {
+				StringRef ref;
+				ref.offset = static_cast<uint32_t>(strings.size());
+				ref.size = static_cast<uint32_t>(str.size());
+				strings += str;
+				return ref;
+			}
+
+			template<typename VertType>
+			MeshRecord AddMesh(const std::string& name, const std::vector<Material<VertType>>& src, uint64_t& vertexCount) {
+				MeshRecord mesh = {};
+				mesh.name = AddString(name);
+				mesh.firstMaterial = static_cast<uint32_t>(materials.size());
+				mesh.materialCount = static_cast<uint32_t>(src.size());
+				for (const auto& material : src) {
+					MaterialRecord record;
+					record.name = AddString(material.name);
+					record.firstTexture = static_cast<uint32_t>(textureNames.size());
+					record.textureCount = static_cast<uint32_t>(material.textureName.size());
+					for (const auto& texture : material.textureName) {
+						textureNames.push_back(AddString(texture));
+					}
+					record.firstVertex = static_cast<uint32_t>(vertexCount);
+					record.vertexCount = static_cast<uint32_t>(material.verteces.size());
+					record.firstIndex = static_cast<uint32_t>(indexCount);
+					record.indexCount = static_cast<uint32_t>(material.indeces.size());
+					vertexCount += material.verteces.size();
+					indexCount += material.indeces.size();
+					materials.push_back(record);
+				}
+				return mesh;
+			}
+
+			//レコードの添字が32bitに収まるか
+			bool IsValid() const {
+				const uint64_t limit = 0xFFFFFFFFu;
+				return strings.size() <= limit && staticVertexCount <= limit && skinnedVertexCount <= limit && indexCount <= limit &&
+					materials.size() <= limit && textureNames.size() <= limit && matrices.size() <= limit && boneChildren.size() <= limit &&
+					tracks.size() <= limit && keys.size() <= limit;
+			}
+		};
+
+		//先頭からの位置を数えながら書き込む
+		class FileWriter {
+		public:
+			explicit FileWriter(FILE* fp) : fp(fp) {}
+
+			void Write(const void* data, size_t size) {
+				if (size && isValid) {
+					isValid = fwrite(data, 1, size, fp) == size;
+					position += size;
+				}
+			}
+
+			void Seek(uint64_t offset) {
+				static const char zeros[sectionAlignment] = {};
+				while (position < offset && isValid) {
+					Write(zeros, static_cast<size_t>(offset - position < sectionAlignment ? offset - position : sectionAlignment));
+				}
+			}
+
+			bool IsValid() const { return isValid; }
+
+		private:
+			FILE* fp;
+			uint64_t position = 0;
+			bool isValid = true;
+		};
+
+		template<typename VertType>
+		void WriteVertices(FileWriter& writer, const std::vector<Material<VertType>>& materials) {
+			for (const auto& material : materials) {
+				writer.Write(material.verteces.data(), material.verteces.size() * sizeof(VertType));
+			}
+		}
+
+		template<typename VertType>
+		void WriteIndices(FileWriter& writer, const std::vector<Material<VertType>>& materials) {
+			for (const auto& material : materials) {
+				writer.Write(material.indeces.data(), material.indeces.size() * sizeof(unsigned int));
+			}
+		}
+
+		bool ReplaceFile(const std::string& src, const std::string& dst) {
+#if defined(_WIN32)
+			return MoveFileExA(src.c_str(), dst.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+			return rename(src.c_str(), dst.c_str()) == 0;
+#endif
+		}
+
+		const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+		const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+		const uint64_t prime3 = 0x165667B19E3779F9ull;
+		const uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+		const uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+		uint64_t RotateLeft(uint64_t value, int shift) {
+			return (value << shift) | (value >> (64 - shift));
+		}
+
+		uint64_t Read64(const uint8_t* p) {
+			uint64_t ret;
+			memcpy(&ret, p, sizeof(ret));
+			return ret;
+		}
+
+		uint32_t Read32(const uint8_t* p) {
+			uint32_t ret;
+			memcpy(&ret, p, sizeof(ret));
+			return ret;
+		}
+
+		uint64_t HashRound(uint64_t acc, uint64_t input) {
+			acc += input * prime2;
+			acc = RotateLeft(acc, 31);
+			return acc * prime1;
+		}
+
+		uint64_t HashMerge(uint64_t acc, uint64_t value) {
+			acc ^= HashRound(0, value);
+			return acc * prime1 + prime4;
+		}
+	}
+
+	/**
+	* キャッシュファイルを開く
+	* 元ファイルのハッシュ・サイズ、オプション、形式のバージョンのどれかが違えば開かない
+	*
+	* @param   filename    キャッシュファイル名
+	* @param   sourceHash  元ファイルの HashContent
+	* @param   sourceSize  元ファイルのサイズ
+	* @param   options     MeshCache::Option の組み合わせ
+	* @retval  true : 成功 false : ファイルがないか一致しない
+	*/
+	bool MeshCache::Open(const std::string& filename, uint64_t sourceHash, uint64_t sourceSize, uint32_t options) {
+		Close();
+		if (!file.Open(filename) || file.Size() < sizeof(CacheHeader)) {
+			Close();
+			return false;
+		}
+		CacheHeader header;
+		memcpy(&header, file.Data(), sizeof(header));
+		if (memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+			header.formatVersion != formatVersion ||
+			header.options != options ||
+			header.fileSize != file.Size() ||
+			header.sourceSize != sourceSize ||
+			header.sourceHash != sourceHash ||
+			!Parse()) {
+			Close();
+			return false;
+		}
+		isOpen = true;
+		return true;
+	}
+
+	void MeshCache::Close() {
+		isOpen = false;
+		sections.clear();
+		staticMeshes.clear();
+		skinnedMeshes.clear();
+		file.Close();
+	}
+
+	bool MeshCache::Parse() {
+		const char* base = reinterpret_cast<const char*>(file.Data());
+		const uint64_t size = file.Size();
+		CacheHeader header;
+		memcpy(&header, base, sizeof(header));
+		if (header.sectionCount > SectionCount || sizeof(CacheHeader) + static_cast<uint64_t>(header.sectionCount) * sizeof(CacheSection) > size) {
+			return false;
+		}
+
+		sections.assign(SectionCount, Span<char>());
+		for (uint32_t i = 0; i < header.sectionCount; ++i) {
+			CacheSection section;
+			memcpy(&section, base + sizeof(CacheHeader) + i * sizeof(CacheSection), sizeof(section));
+			if (section.type >= SectionCount || section.elementSize != sectionElementSizes[section.type] ||
+				section.offset % sectionAlignment != 0 || section.offset > size ||
+				section.count > (size - section.offset) / section.elementSize || sections[section.type].data()) {
+				return false;
+			}
+			sections[section.type] = Span<char>(base + section.offset, static_cast<size_t>(section.count));
+		}
+
+		const CacheData data(sections);
+		staticMeshes.resize(data.staticMeshes.size());
+		for (size_t i = 0; i < data.staticMeshes.size(); ++i) {
+			const MeshRecord& record = data.staticMeshes[i];
+			if (!data.ReadString(record.name, staticMeshes[i].name) ||
+				!ReadMaterials(data, record, data.staticVertices, staticMeshes[i].materials)) {
+				return false;
+			}
+		}
+		skinnedMeshes.resize(data.skinnedMeshes.size());
+		for (size_t i = 0; i < data.skinnedMeshes.size(); ++i) {
+			const MeshRecord& record = data.skinnedMeshes[i];
+			if (!data.ReadString(record.name, skinnedMeshes[i].name) ||
+				!ReadMaterials(data, record, data.skinnedVertices, skinnedMeshes[i].materials) ||
+				!IsInRange(record.firstMatrix, record.matrixCount, data.matrices.size())) {
+				return false;
+			}
+			skinnedMeshes[i].boneBaseInvs = Span<mff::Matrix4x4<float> >(data.matrices.data() + record.firstMatrix, record.matrixCount);
+		}
+
+		//ボーンとアニメーションは Load の時に確認せずに読めるようにここで見ておく
+		std::string tmp;
+		for (const BoneRecord& bone : data.bones) {
+			if (!data.ReadString(bone.name, tmp) || !IsInRange(bone.firstChild, bone.childCount, data.boneChildren.size())) {
+				return false;
+			}
+		}
+		//アニメーションは範囲に加えて時間も確認する (壊れていれば他の不一致と同じく読み直す)
+		for (const AnimationRecord& animation : data.animations) {
+			if (!data.ReadString(animation.name, tmp) || !IsInRange(animation.firstTrack, animation.trackCount, data.tracks.size()) ||
+				!isfinite(animation.animationTime) || animation.animationTime < 0.0f) {
+				return false;
+			}
+		}
+		for (const TrackRecord& track : data.tracks) {
+			if (!IsInRange(track.firstKey, track.keyCount, data.keys.size()) || !IsValidTrack(track, data.keys)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void MeshCache::LoadBone(BoneTreeData& boneTree) const {
+		boneTree.data.clear();
+		if (!isOpen) {
+			return;
+		}
+		const CacheData data(sections);
+		boneTree.data.resize(data.bones.size());
+		for (size_t i = 0; i < data.bones.size(); ++i) {
+			const BoneRecord& record = data.bones[i];
+			BoneData& bone = boneTree.data[i];
+			data.ReadString(record.name, bone.name);
+			bone.boneId = record.boneId;
+			bone.parentId = record.parentId;
+			bone.children.assign(data.boneChildren.data() + record.firstChild, data.boneChildren.data() + record.firstChild + record.childCount);
+			bone.baseInv = record.baseInv;
+		}
+	}
+
+	/**
+	* メッシュをコピーして追加する (Loader::LoadAllMesh と同じく末尾に追加)
+	* コピーせずに使う場合は GetStaticMeshes / GetSkinnedMeshes
+	*/
+	void MeshCache::LoadAllMesh(std::vector<StaticMesh>& staticMeshes, std::vector<SkinnedMesh>& skinnedMeshes) const {
+		LoadStaticMesh(staticMeshes);
+		LoadSkinnedMesh(skinnedMeshes);
+	}
+
+	void MeshCache::LoadSkinnedMesh(std::vector<SkinnedMesh>& meshes) const {
+		const size_t offset = meshes.size();
+		meshes.resize(offset + skinnedMeshes.size());
+		for (size_t i = 0; i < skinnedMeshes.size(); ++i) {
+			CopyMesh(skinnedMeshes[i], meshes[offset + i]);
+		}
+	}
+
+	void MeshCache::LoadStaticMesh(std::vector<StaticMesh>& meshes) const {
+		const size_t offset = meshes.size();
+		meshes.resize(offset + staticMeshes.size());
+		for (size_t i = 0; i < staticMeshes.size(); ++i) {
+			CopyMesh(staticMeshes[i], meshes[offset + i]);
+		}
+	}
+
+	void MeshCache::LoadAnimation(std::vector<Animation>& animations) const {
+		animations.clear();
+		if (!isOpen) {
+			return;
+		}
+		const CacheData data(sections);
+		animations.resize(data.animations.size());
+		for (size_t i = 0; i < data.animations.size(); ++i) {
+			const AnimationRecord& record = data.animations[i];
+			Animation& animation = animations[i];
+			data.ReadString(record.name, animation.name);
+			animation.animationTime = record.animationTime;
+			animation.boneAnimationData.resize(record.trackCount);
+			for (uint32_t t = 0; t < record.trackCount; ++t) {
+				const TrackRecord& track = data.tracks[record.firstTrack + t];
+				BoneAnimationData& bone = animation.boneAnimationData[t];
+				bone.animationTime = track.animationTime;
+				bone.animDatas.resize(track.keyCount);
+				for (uint32_t k = 0; k < track.keyCount; ++k) {
+					const KeyRecord& key = data.keys[track.firstKey + k];
+					bone.animDatas[k] = BoneAnimationData::TimeMatPair(key.time, key.matrix);
+				}
+			}
+		}
+	}
+
+	/**
+	* 読み込み結果をキャッシュファイルに書き出す
+	*
+	* @param   filename    キャッシュファイル名
+	* @param   sourceHash  元ファイルの HashContent
+	* @param   sourceSize  元ファイルのサイズ
+	* @param   options     MeshCache::Option の組み合わせ (Open と同じ値)
+	* @retval  true : 成功 false : 書き込みに失敗
+	*/
+	bool MeshCache::Write(const std::string& filename, uint64_t sourceHash, uint64_t sourceSize, uint32_t options,
+		const std::vector<StaticMesh>& staticMeshes, const std::vector<SkinnedMesh>& skinnedMeshes,
+		const BoneTreeData& boneTree, const std::vector<Animation>& animations) {
+		RecordBuilder builder;
+		for (const auto& mesh : staticMeshes) {
+			builder.staticMeshes.push_back(builder.AddMesh(mesh.name, mesh.materials, builder.staticVertexCount));
+		}
+		for (const auto& mesh : skinnedMeshes) {
+			MeshRecord record = builder.AddMesh(mesh.name, mesh.materials, builder.skinnedVertexCount);
+			record.firstMatrix = static_cast<uint32_t>(builder.matrices.size());
+			record.matrixCount = static_cast<uint32_t>(mesh.boneBaseInvs.size());
+			builder.matrices.insert(builder.matrices.end(), mesh.boneBaseInvs.begin(), mesh.boneBaseInvs.end());
+			builder.skinnedMeshes.push_back(record);
+		}
+		for (const auto& bone : boneTree.data) {
+			BoneRecord record;
+			record.name = builder.AddString(bone.name);
+			record.boneId = bone.boneId;
+			record.parentId = bone.parentId;
+			record.firstChild = static_cast<uint32_t>(builder.boneChildren.size());
+			record.childCount = static_cast<uint32_t>(bone.children.size());
+			record.baseInv = bone.baseInv;
+			builder.boneChildren.insert(builder.boneChildren.end(), bone.children.begin(), bone.children.end());
+			builder.bones.push_back(record);
+		}
+		for (const auto& animation : animations) {
+			AnimationRecord record;
+			record.name = builder.AddString(animation.name);
+			record.animationTime = animation.animationTime;
+			record.firstTrack = static_cast<uint32_t>(builder.tracks.size());
+			record.trackCount = static_cast<uint32_t>(animation.boneAnimationData.size());
+			for (const auto& bone : animation.boneAnimationData) {
+				TrackRecord track = {};
+				track.firstKey = static_cast<uint32_t>(builder.keys.size());
+				track.keyCount = static_cast<uint32_t>(bone.animDatas.size());
+				track.animationTime = bone.animationTime;
+				for (const auto& pair : bone.animDatas) {
+					KeyRecord key;
+					key.time = pair.first;
+					key.matrix = pair.second;
+					builder.keys.push_back(key);
+				}
+				builder.tracks.push_back(track);
+			}
+			builder.animations.push_back(record);
+		}
+		if (!builder.IsValid()) {
+			return false;
+		}
+
+		//配置を先に決めてからヘッダー、セクション表、各セクションの順に書く
+		const uint64_t counts[SectionCount] = {
+			builder.strings.size(),
+			builder.staticMeshes.size(),
+			builder.skinnedMeshes.size(),
+			builder.materials.size(),
+			builder.textureNames.size(),
+			builder.staticVertexCount,
+			builder.skinnedVertexCount,
+			builder.indexCount,
+			builder.matrices.size(),
+			builder.bones.size(),
+			builder.boneChildren.size(),
+			builder.animations.size(),
+			builder.tracks.size(),
+			builder.keys.size(),
+		};
+		CacheSection table[SectionCount];
+		uint64_t offset = AlignSection(sizeof(CacheHeader) + sizeof(table));
+		for (uint32_t i = 0; i < SectionCount; ++i) {
+			table[i].type = i;
+			table[i].elementSize = sectionElementSizes[i];
+			table[i].offset = offset;
+			table[i].count = counts[i];
+			offset = AlignSection(offset + counts[i] * sectionElementSizes[i]);
+		}
+		CacheHeader header = {};
+		memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+		header.formatVersion = formatVersion;
+		header.options = options;
+		header.fileSize = offset;
+		header.sourceSize = sourceSize;
+		header.sourceHash = sourceHash;
+		header.sectionCount = SectionCount;
+
+		const std::string tmpFilename = filename + ".tmp";
+		FILE* fp = fopen(tmpFilename.c_str(), "wb");
+		if (!fp) {
+			return false;
+		}
+		FileWriter writer(fp);
+		writer.Write(&header, sizeof(header));
+		writer.Write(table, sizeof(table));
+		writer.Seek(table[SectionStrings].offset);
+		writer.Write(builder.strings.data(), builder.strings.size());
+		writer.Seek(table[SectionStaticMeshes].offset);
+		writer.Write(builder.staticMeshes.data(), builder.staticMeshes.size() * sizeof(MeshRecord));
+		writer.Seek(table[SectionSkinnedMeshes].offset);
+		writer.Write(builder.skinnedMeshes.data(), builder.skinnedMeshes.size() * sizeof(MeshRecord));
+		writer.Seek(table[SectionMaterials].offset);
+		writer.Write(builder.materials.data(), builder.materials.size() * sizeof(MaterialRecord));
+		writer.Seek(table[SectionTextureNames].offset);
+		writer.Write(builder.textureNames.data(), builder.textureNames.size() * sizeof(StringRef));
+		writer.Seek(table[SectionStaticVertices].offset);
+		for (const auto& mesh : staticMeshes) {
+			WriteVertices(writer, mesh.materials);
+		}
+		writer.Seek(table[SectionSkinnedVertices].offset);
+		for (const auto& mesh : skinnedMeshes) {
+			WriteVertices(writer, mesh.materials);
+		}
+		//インデックスはマテリアルの追加順 (スタティック, スキン) に並べる
+		writer.Seek(table[SectionIndices].offset);
+		for (const auto& mesh : staticMeshes) {
+			WriteIndices(writer, mesh.materials);
+		}
+		for (const auto& mesh : skinnedMeshes) {
+			WriteIndices(writer, mesh.materials);
+		}
+		writer.Seek(table[SectionMatrices].offset);
+		writer.Write(builder.matrices.data(), builder.matrices.size() * sizeof(mff::Matrix4x4<float>));
+		writer.Seek(table[SectionBones].offset);
+		writer.Write(builder.bones.data(), builder.bones.size() * sizeof(BoneRecord));
+		writer.Seek(table[SectionBoneChildren].offset);
+		writer.Write(builder.boneChildren.data(), builder.boneChildren.size() * sizeof(int32_t));
+		writer.Seek(table[SectionAnimations].offset);
+		writer.Write(builder.animations.data(), builder.animations.size() * sizeof(AnimationRecord));
+		writer.Seek(table[SectionTracks].offset);
+		writer.Write(builder.tracks.data(), builder.tracks.size() * sizeof(TrackRecord));
+		writer.Seek(table[SectionKeys].offset);
+		writer.Write(builder.keys.data(), builder.keys.size() * sizeof(KeyRecord));
+		writer.Seek(header.fileSize);
+
+		const bool isWritten = writer.IsValid();
+		const bool isClosed = fclose(fp) == 0;
+		if (!isWritten || !isClosed || !ReplaceFile(tmpFilename, filename)) {
+			remove(tmpFilename.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	/**
+	* XXH64 (seed 0)
+	* 32byte ずつ4本のレーンで混ぜるので、マップしたファイルをそのまま数GB/sで読める
+	*/
+	uint64_t HashContent(const void* data, size_t size) {
+		const uint8_t* p = static_cast<const uint8_t*>(data);
+		const uint8_t* end = p + size;
+		uint64_t hash;
+		if (size >= 32) {
+			uint64_t v1 = prime1 + prime2;
+			uint64_t v2 = prime2;
+			uint64_t v3 = 0;
+			uint64_t v4 = 0 - prime1;
+			const uint8_t* limit = end - 32;
+			do {
+				v1 = HashRound(v1, Read64(p));
+				v2 = HashRound(v2, Read64(p + 8));
+				v3 = HashRound(v3, Read64(p + 16));
+				v4 = HashRound(v4, Read64(p + 24));
+				p += 32;
+			} while (p <= limit);
+			hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+			hash = HashMerge(hash, v1);
+			hash = HashMerge(hash, v2);
+			hash = HashMerge(hash, v3);
+			hash = HashMerge(hash, v4);
+		}
+		else {
+			hash = prime5;
+		}
+		hash += static_cast<uint64_t>(size);
+
+		for (; p + 8 <= end; p += 8) {
+			hash ^= HashRound(0, Read64(p));
+			hash = RotateLeft(hash, 27) * prime1 + prime4;
+		}
+		if (p + 4 <= end) {
+			hash ^= static_cast<uint64_t>(Read32(p)) * prime1;
+			hash = RotateLeft(hash, 23) * prime2 + prime3;
+			p += 4;
+		}
+		for (; p < end; ++p) {
+			hash ^= *p * prime5;
+			hash = RotateLeft(hash, 11) * prime1;
+		}
+
+		hash ^= hash >> 33;
+		hash *= prime2;
+		hash ^= hash >> 29;
+		hash *= prime3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	bool HashFile(const std::string& filename, uint64_t& hash, uint64_t& size) {
+		MappedFile source;
+		if (!source.Open(filename)) {
+			return false;
+		}
+		hash = HashContent(source.Data(), source.Size());
+		size = source.Size();
+		return true;
+	}
+}// namespace FbxLoader
@@ -0,0 +1,118 @@
+﻿#ifndef MeshCache_h
+#define MeshCache_h
+
+#include "FbxLoaderStructs.h"
+#include "MappedFile.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace FbxLoader {
+	/*
+	マップした領域の配列 (コピーしない)
+	MeshCache を閉じるまで有効
+	*/
+	template<typename T>
+	struct Span {
+		Span() {}
+		Span(const T* first, size_t count) : first(first), count(count) {}
+
+		const T* data() const { return first; }
+		size_t size() const { return count; }
+		const T* begin() const { return first; }
+		const T* end() const { return first + count; }
+		const T& operator[](size_t index) const { return first[index]; }
+		bool empty() const { return count == 0; }
+
+	private:
+		const T* first = nullptr;
+		size_t count = 0;
+	};
+
+	template<typename VertType>
+	struct MaterialView {
+		std::string name;
+		Span<unsigned int> indeces;
+		Span<VertType> verteces;
+		std::vector<std::string> textureName;
+	};
+
+	struct StaticMeshView {
+		std::string name;
+		std::vector<MaterialView<StaticVertex>> materials;
+	};
+
+	struct SkinnedMeshView {
+		std::string name;
+		std::vector<MaterialView<SkinnedVertex>> materials;
+		Span<mff::Matrix4x4<float> > boneBaseInvs;
+	};
+
+	/*
+	読み込み結果 (LoadAllMesh, LoadBone, LoadAnimation) のキャッシュファイル
+	元ファイルの内容のハッシュと読み込みオプションが一致する時だけ開ける
+
+	ファイルの構成 (リトルエンディアン)
+		CacheHeader
+		CacheSection[sectionCount]
+		各セクションの配列 (16byte境界)
+	頂点とインデックスはメモリマップした領域をそのまま Span で返す
+	頂点やレコードの構造を変えた時は formatVersion を上げること
+	*/
+	class MeshCache {
+	public:
+		//2: ボーンの children を格納するようにした (1 は常に空)
+		static const uint32_t formatVersion = 2;
+
+		//読み込み結果が変わるオプション (キャッシュのキーに含める)
+		enum Option : uint32_t {
+			OptionBoneBaseGetFromLink = 1 << 0,
+			OptionBakeBaseInv = 1 << 1,
+			//NativeLoader で作ったもの (三角形化が SDK と違う)
+			OptionNativeLoader = 1 << 2,
+			//インデックスを OptimizeVertexCache で並べ替えたもの
+			OptionOptimizeVertexCache = 1 << 3,
+		};
+
+		bool Open(const std::string& filename, uint64_t sourceHash, uint64_t sourceSize, uint32_t options);
+		void Close();
+		bool IsOpen() const { return isOpen; }
+
+		const std::vector<StaticMeshView>& GetStaticMeshes() const { return staticMeshes; }
+		const std::vector<SkinnedMeshView>& GetSkinnedMeshes() const { return skinnedMeshes; }
+
+		//Loader と同じ構造体にコピーする
+		void LoadBone(BoneTreeData& boneTree) const;
+		void LoadAllMesh(std::vector<StaticMesh>& staticMeshes, std::vector<SkinnedMesh>& skinnedMeshes) const;
+		void LoadSkinnedMesh(std::vector<SkinnedMesh>& meshes) const;
+		//LoadAllMesh の staticMeshes と同じくスキンのないメッシュだけ (Loader::LoadStaticMesh とは違う)
+		void LoadStaticMesh(std::vector<StaticMesh>& meshes) const;
+		void LoadAnimation(std::vector<Animation>& animations) const;
+
+		//一時ファイルに書いてから置き換えるので、途中で失敗しても壊れたキャッシュは残らない
+		static bool Write(const std::string& filename, uint64_t sourceHash, uint64_t sourceSize, uint32_t options,
+			const std::vector<StaticMesh>& staticMeshes, const std::vector<SkinnedMesh>& skinnedMeshes,
+			const BoneTreeData& boneTree, const std::vector<Animation>& animations);
+
+	private:
+		bool Parse();
+
+		MappedFile file;
+		bool isOpen = false;
+		//[セクションの種類] 先頭と要素数 (ボーンとアニメーションは Load で読む時に展開する)
+		std::vector<Span<char> > sections;
+		std::vector<StaticMeshView> staticMeshes;
+		std::vector<SkinnedMeshView> skinnedMeshes;
+	};
+
+	/*
+	ファイルの内容の64bitハッシュ (XXH64, seed 0)
+	キャッシュが元ファイルと一致するかの確認用
+	*/
+	uint64_t HashContent(const void* data, size_t size);
+	//ファイルを開けなければ false
+	bool HashFile(const std::string& filename, uint64_t& hash, uint64_t& size);
+}// namespace FbxLoader
+
+#endif /* MeshCache_h */
@@ -0,0 +1,634 @@
+﻿#include "NativeLoader.h"
+#include "../../Math/Batch/Transform.h"
+#include "../../Math/Matrix/TRS.h"
+#include <stdio.h>
+#include <algorithm>
+
+namespace FbxLoader {
+	namespace {
+		/*
+		Loader の toMyMat と同じ並び (FbxAMatrix は行ベクトル形式なので転置になる)
+		*/
+		mff::Matrix4x4<float> toMyMat(const fbx::Matrix& mat) {
+			mff::Matrix4x4<float> ret;
+			for (int row = 0; row < 4; ++row) {
+				for (int col = 0; col < 4; ++col) {
+					ret[row][col] = static_cast<float>(mat[col][row]);
+				}
+			}
+			return ret;
+		}
+
+		enum class Mapping {
+			None,
+			ByControlPoint,
+			ByPolygonVertex,
+			ByPolygon,
+			AllSame,
+		};
+
+		/*
+		LayerElement (法線, UV など) の中身
+		*/
+		struct LayerElement {
+			Mapping mapping = Mapping::None;
+			bool isDirectRef = true;
+			int stride = 0;
+			std::vector<double> direct;
+			std::vector<int32_t> indices;
+
+			//要素の先頭 (対応するデータがなければ nullptr)
+			const double* Get(int cpIndex, int polygonVertex, int polygon) const {
+				int index = -1;
+				switch (mapping) {
+				case Mapping::ByControlPoint:
+					index = cpIndex;
+					break;
+				case Mapping::ByPolygonVertex:
+					index = polygonVertex;
+					break;
+				case Mapping::ByPolygon:
+					index = polygon;
+					break;
+				case Mapping::AllSame:
+					index = 0;
+					break;
+				default:
+					return nullptr;
+				}
+				if (!isDirectRef) {
+					if (index < 0 || index >= static_cast<int>(indices.size())) {
+						return nullptr;
+					}
+					index = indices[index];
+				}
+				if (index < 0 || static_cast<size_t>(index + 1) * stride > direct.size()) {
+					return nullptr;
+				}
+				return direct.data() + static_cast<size_t>(index) * stride;
+			}
+		};
+
+		Mapping ToMapping(const std::string& str) {
+			if (str == "ByVertice" || str == "ByVertex" || str == "ByControlPoint") {
+				return Mapping::ByControlPoint;
+			}
+			if (str == "ByPolygonVertex") {
+				return Mapping::ByPolygonVertex;
+			}
+			if (str == "ByPolygon") {
+				return Mapping::ByPolygon;
+			}
+			if (str == "AllSame") {
+				return Mapping::AllSame;
+			}
+			return Mapping::None;
+		}
+
+		std::string ReadString(const fbx::Document& document, const fbx::Node& node, const char* name) {
+			const fbx::Node* child = document.FindChild(node, name);
+			const fbx::Property* property = child ? document.GetProperty(*child, 0) : nullptr;
+			return property ? property->AsString() : std::string();
+		}
+
+		template<typename T>
+		bool ReadArray(const fbx::Document& document, const fbx::Node& node, const char* name, std::vector<T>& dst) {
+			const fbx::Node* child = document.FindChild(node, name);
+			const fbx::Property* property = child ? document.GetProperty(*child, 0) : nullptr;
+			if (!property || !document.ReadArray(*property, dst)) {
+				dst.clear();
+				return false;
+			}
+			return true;
+		}
+
+		/**
+		* 最初の LayerElement を読む
+		*
+		* @param   elementName LayerElementNormal など
+		* @param   arrayName   Normals など (インデックスは arrayName + "Index")
+		*/
+		bool ReadLayerElement(const fbx::Document& document, const fbx::Node& geometry, const char* elementName, const char* arrayName, int stride, LayerElement& dst) {
+			const fbx::Node* element = document.FindChild(geometry, elementName);
+			if (!element) {
+				return false;
+			}
+			dst.mapping = ToMapping(ReadString(document, *element, "MappingInformationType"));
+			const std::string reference = ReadString(document, *element, "ReferenceInformationType");
+			dst.isDirectRef = reference != "IndexToDirect" && reference != "Index";
+			dst.stride = stride;
+			if (!ReadArray(document, *element, arrayName, dst.direct)) {
+				return false;
+			}
+			if (!dst.isDirectRef) {
+				const std::string indexName = std::string(arrayName) + "Index";
+				ReadArray(document, *element, indexName.c_str(), dst.indices);
+			}
+			return true;
+		}
+
+		mff::Vector3<float> ToVector3(const fbx::Matrix& mat, const double* v) {
+			return mff::Vector3<float>(
+				static_cast<float>(mat.m[0] * v[0] + mat.m[1] * v[1] + mat.m[2] * v[2]),
+				static_cast<float>(mat.m[4] * v[0] + mat.m[5] * v[1] + mat.m[6] * v[2]),
+				static_cast<float>(mat.m[8] * v[0] + mat.m[9] * v[1] + mat.m[10] * v[2]));
+		}
+	}
+
+	/**
+	* 初期化関数
+	*
+	* @param   filename    読み込むファイル名
+	* @retval  true : 初期化成功 false : 初期化に失敗
+	*/
+	bool NativeLoader::Initialize(const std::string& filename) {
+		cache.Close();
+		return OpenSource(filename);
+	}
+
+	/**
+	* FBX を開いてシーンを作る (キャッシュはそのまま)
+	*
+	* @param   filename    読み込むファイル名
+	* @retval  true : 成功 false : 失敗
+	*/
+	bool NativeLoader::OpenSource(const std::string& filename) {
+		sourceFilename = filename;
+		isSourceOpen = false;
+		if (!document.Open(filename)) {
+			printf("Failed to open %s as FBX 7.x.\n", filename.c_str());
+			return false;
+		}
+		if (!scene.Build(document)) {
+			printf("%s has no Objects.\n", filename.c_str());
+			return false;
+		}
+		isSourceOpen = true;
+		return true;
+	}
+
+	/**
+	* キャッシュを使う初期化関数
+	*
+	* @param   filename        読み込むファイル名
+	* @param   cacheFilename   キャッシュファイル名 (なければ作る)
+	* @retval  true : 初期化成功 false : 初期化に失敗
+	*/
+	bool NativeLoader::Initialize(const std::string& filename, const std::string& cacheFilename) {
+		uint64_t sourceHash, sourceSize;
+		if (!HashFile(filename, sourceHash, sourceSize)) {
+			printf("Failed to open %s.\n", filename.c_str());
+			return false;
+		}
+		if (cache.Open(cacheFilename, sourceHash, sourceSize, GetCacheOptions())) {
+			sourceFilename = filename;
+			isSourceOpen = false;
+			return true;
+		}
+		if (!Initialize(filename)) {
+			return false;
+		}
+		BoneTreeData boneTree;
+		std::vector<StaticMesh> staticMeshes;
+		std::vector<SkinnedMesh> skinnedMeshes;
+		std::vector<Animation> animations;
+		LoadBone(boneTree);
+		LoadAllMesh(staticMeshes, skinnedMeshes);
+		LoadAnimation(animations);
+		//書けなくても FBX から読んだ内容で続ける
+		if (!MeshCache::Write(cacheFilename, sourceHash, sourceSize, GetCacheOptions(), staticMeshes, skinnedMeshes, boneTree, animations) ||
+			!cache.Open(cacheFilename, sourceHash, sourceSize, GetCacheOptions())) {
+			printf("Failed to write cache %s.\n", cacheFilename.c_str());
+		}
+		return true;
+	}
+
+	uint32_t NativeLoader::GetCacheOptions() const {
+		return static_cast<uint32_t>(MeshCache::OptionNativeLoader) |
+			(boneBaseGetFromLink ? static_cast<uint32_t>(MeshCache::OptionBoneBaseGetFromLink) : 0u) |
+			(bakeBaseInv ? static_cast<uint32_t>(MeshCache::OptionBakeBaseInv) : 0u) |
+			(optimizeVertexCache ? static_cast<uint32_t>(MeshCache::OptionOptimizeVertexCache) : 0u);
+	}
+
+	/**
+	* ボーンのルートを探す (深さ優先で最初に見つかったスケルトン)
+	*
+	* @param model 検索対象 (-1 でシーンのルート)
+	*/
+	int NativeLoader::FindRootBone(int model) const {
+		const std::vector<int>& children = model < 0 ? scene.rootModels : scene.models[model].children;
+		if (model >= 0 && scene.models[model].isSkeleton) {
+			return model;
+		}
+		for (int child : children) {
+			int ret = FindRootBone(child);
+			if (ret >= 0) {
+				return ret;
+			}
+		}
+		return -1;
+	}
+
+	/**
+	* クラスターに影響を受けるメッシュのモデルの取得 (Loader と同じく最初のスキンだけを見る)
+	*
+	* @param cluster   メッシュを取得したいクラスター
+	*/
+	int NativeLoader::FindIncludedMeshModel(int cluster) const {
+		const int skin = scene.clusters[cluster].skin;
+		if (skin < 0) {
+			return -1;
+		}
+		const int geometry = scene.skins[skin].geometry;
+		if (geometry < 0 || scene.geometries[geometry].skins.front() != skin) {
+			return -1;
+		}
+		return scene.geometries[geometry].model;
+	}
+
+	//Transform / TransformLink (FbxAMatrix の並びの16要素) を列ベクトル形式で読む
+	bool NativeLoader::ReadMatrix(const fbx::Node& node, const char* name, fbx::Matrix& dst) const {
+		std::vector<double> values;
+		if (!ReadArray(document, node, name, values) || values.size() != 16) {
+			dst = fbx::Matrix();
+			return false;
+		}
+		for (int i = 0; i < 16; ++i) {
+			dst.m[i] = values[i];
+		}
+		dst = mff::Transpose(dst);
+		return true;
+	}
+
+	/**
+	* ボーンのデータを読み込む
+	*
+	* @param boneTree  データの保存先
+	* @tips    BoneのIndexを階層構造から決定する (Loader と同じ)
+	*/
+	void NativeLoader::LoadBone(BoneTreeData& boneTree) {
+		if (cache.IsOpen()) {
+			cache.LoadBone(boneTree);
+			return;
+		}
+		if (isBoneTreeInitialized) {
+			boneTree = publicBoneTree;
+			return;
+		}
+		const int rootBone = FindRootBone(-1);
+		if (rootBone < 0) {
+			return;
+		}
+		struct GetSkeleton {
+			static int Run(const fbx::Scene& scene, int model, BoneTreeData& boneTree, int parentId) {
+				if (!scene.models[model].isSkeleton) {
+					return -1;
+				}
+				BoneData boneData;
+				boneData.boneId = static_cast<int>(boneTree.data.size());
+				boneData.parentId = parentId;
+				boneData.name = scene.models[model].name;
+
+				boneTree.data.push_back(boneData);
+
+				//push_back で参照が無効になるので、子は集めてから格納済みの要素に入れる (スケルトン以外の子は含めない)
+				std::vector<int> children;
+				for (int child : scene.models[model].children) {
+					const int childId = Run(scene, child, boneTree, boneData.boneId);
+					if (childId >= 0) {
+						children.push_back(childId);
+					}
+				}
+				boneTree.data[boneData.boneId].children = std::move(children);
+				return boneData.boneId;
+			}
+		};
+
+		GetSkeleton::Run(scene, rootBone, boneTree, -1);
+		for (size_t clusterIndex = 0; clusterIndex < scene.clusters.size(); ++clusterIndex) {
+			const fbx::Cluster& cluster = scene.clusters[clusterIndex];
+			if (cluster.link < 0) {
+				continue;
+			}
+			BoneData* pData = boneTree.FindBone(scene.models[cluster.link].name);
+			if (!pData) {
+				continue;
+			}
+			fbx::Matrix link;
+			ReadMatrix(*cluster.node, "TransformLink", link);
+			const int meshModel = FindIncludedMeshModel(static_cast<int>(clusterIndex));
+			if (meshModel >= 0 && !boneBaseGetFromLink) {
+				fbx::Matrix transform;
+				ReadMatrix(*cluster.node, "Transform", transform);
+				pData->baseInv = toMyMat(mff::Inverse(link) * transform * scene.GetGeometricTransform(meshModel));
+			}
+			else {
+				pData->baseInv = toMyMat(mff::Inverse(link));
+			}
+		}
+		publicBoneTree = boneTree;
+		isBoneTreeInitialized = true;
+	}
+
+	/**
+	* ファイルに含まれているメッシュを読み込む
+	*
+	* @param   staticMeshes    アニメーションをしないメッシュの格納先
+	* @param   skinnedMeshes   アニメーションをするメッシュの格納先
+	*/
+	void NativeLoader::LoadAllMesh(std::vector<StaticMesh>& staticMeshes, std::vector<SkinnedMesh>& skinnedMeshes) {
+		if (cache.IsOpen()) {
+			cache.LoadAllMesh(staticMeshes, skinnedMeshes);
+			return;
+		}
+		//ファイルの読み出しは順に、頂点の構築は並列に行う
+		scene.SetAnimationStack(-1);
+		std::vector<MeshSource> staticSources;
+		std::vector<MeshSource> skinnedSources;
+		for (size_t i = 0; i < scene.geometries.size(); ++i) {
+			if (scene.geometries[i].model < 0) {
+				continue;
+			}
+			if (!scene.geometries[i].skins.empty()) {
+				skinnedSources.push_back({});
+				ExtractMesh(static_cast<int>(i), true, skinnedSources.back());
+			}
+			else {
+				staticSources.push_back({});
+				ExtractMesh(static_cast<int>(i), false, staticSources.back());
+			}
+		}
+		BuildMeshes(staticSources, staticMeshes, skinnedSources, skinnedMeshes, threadCount, optimizeVertexCache, &vertexCacheReports);
+	}
+
+	void NativeLoader::LoadSkinnedMesh(std::vector<SkinnedMesh>& meshes) {
+		if (cache.IsOpen()) {
+			cache.LoadSkinnedMesh(meshes);
+			return;
+		}
+		scene.SetAnimationStack(-1);
+		std::vector<MeshSource> staticSources;
+		std::vector<MeshSource> skinnedSources;
+		std::vector<StaticMesh> staticMeshes;
+		for (size_t i = 0; i < scene.geometries.size(); ++i) {
+			if (scene.geometries[i].model < 0 || scene.geometries[i].skins.empty()) {
+				continue;
+			}
+			skinnedSources.push_back({});
+			ExtractMesh(static_cast<int>(i), true, skinnedSources.back());
+		}
+		BuildMeshes(staticSources, staticMeshes, skinnedSources, meshes, threadCount, optimizeVertexCache, &vertexCacheReports);
+	}
+
+	void NativeLoader::LoadStaticMesh(std::vector<StaticMesh>& meshes) {
+		//キャッシュにはスキンのあるメッシュの静的メッシュ版がないので FBX から作る
+		if (!isSourceOpen && !OpenSource(sourceFilename)) {
+			return;
+		}
+		scene.SetAnimationStack(-1);
+		std::vector<MeshSource> staticSources;
+		std::vector<MeshSource> skinnedSources;
+		std::vector<SkinnedMesh> skinnedMeshes;
+		for (size_t i = 0; i < scene.geometries.size(); ++i) {
+			if (scene.geometries[i].model < 0) {
+				continue;
+			}
+			staticSources.push_back({});
+			ExtractMesh(static_cast<int>(i), false, staticSources.back());
+		}
+		meshes.clear();
+		BuildMeshes(staticSources, meshes, skinnedSources, skinnedMeshes, threadCount, optimizeVertexCache, &vertexCacheReports);
+	}
+
+	/**
+	* ジオメトリから三角形化したメッシュを取り出す
+	* 多角形は PolygonVertexIndex の負の値 (~index) で終わり、扇形に分割する
+	*
+	* @param   geometry    scene.geometries のインデックス
+	* @param   isSkinned   ウェイトを読むか
+	* @param   source      取り出したデータの格納先
+	*/
+	void NativeLoader::ExtractMesh(int geometry, bool isSkinned, MeshSource& source) {
+		const fbx::Geometry& geo = scene.geometries[geometry];
+		const fbx::Model& model = scene.models[geo.model];
+		const fbx::Node& node = *geo.node;
+		source.name = model.name;
+
+		//テクスチャ取得
+		for (int material : model.materials) {
+			source.materials.push_back({ scene.materials[material].name, scene.materials[material].diffuseTextures });
+		}
+		if (source.materials.empty()) {
+			source.materials.resize(1);
+		}
+
+		//コントロールポイントを一括で変換しておく
+		std::vector<double> vertices;
+		ReadArray(document, node, "Vertices", vertices);
+		const int cpCount = static_cast<int>(vertices.size() / 3);
+		source.positions.resize(cpCount);
+		for (int i = 0; i < cpCount; ++i) {
+			source.positions[i] = mff::Vector3<float>(static_cast<float>(vertices[i * 3]), static_cast<float>(vertices[i * 3 + 1]), static_cast<float>(vertices[i * 3 + 2]));
+		}
+		const fbx::Matrix mat = scene.EvaluateGlobalTransform(geo.model, 0);
+		mff::TransformPoints(mff::Transpose(toMyMat(mat)), source.positions.data(), source.positions.data(), source.positions.size());
+		//法線などは回転のみ
+		const fbx::Matrix rot = mff::ToMatrix4x4(mff::TRS<double>(fbx::Vector(0), mff::Decompose(mat).rotation, fbx::Vector(1)));
+
+		//三角形化 (角ごとにコントロールポイント, ポリゴン頂点番号, ポリゴン番号を持つ)
+		std::vector<int32_t> polygonVertexIndex;
+		ReadArray(document, node, "PolygonVertexIndex", polygonVertexIndex);
+		std::vector<int> polygonVertices;
+		std::vector<int> polygons;
+		int polygon = 0;
+		int polygonBegin = 0;
+		bool isValid = true;
+		for (int i = 0; i < static_cast<int>(polygonVertexIndex.size()); ++i) {
+			const int cpIndex = polygonVertexIndex[i] < 0 ? ~polygonVertexIndex[i] : polygonVertexIndex[i];
+			if (cpIndex >= cpCount) {
+				isValid = false;
+			}
+			if (polygonVertexIndex[i] >= 0) {
+				continue;
+			}
+			if (isValid) {
+				for (int corner = polygonBegin + 1; corner + 1 <= i; ++corner) {
+					const int triangle[3] = { polygonBegin, corner, corner + 1 };
+					for (int pv : triangle) {
+						const int cp = polygonVertexIndex[pv] < 0 ? ~polygonVertexIndex[pv] : polygonVertexIndex[pv];
+						source.cpIndices.push_back(cp);
+						polygonVertices.push_back(pv);
+					}
+					polygons.push_back(polygon);
+				}
+			}
+			isValid = true;
+			polygonBegin = i + 1;
+			++polygon;
+		}
+
+		// attribute取得
+		LayerElement colors, texCoords, normals, tangents, binormals;
+		const bool hasColor = ReadLayerElement(document, node, "LayerElementColor", "Colors", 4, colors);
+		const bool hasTexCoord = ReadLayerElement(document, node, "LayerElementUV", "UV", 2, texCoords);
+		const bool hasNormal = ReadLayerElement(document, node, "LayerElementNormal", "Normals", 3, normals);
+		const bool hasTangent = ReadLayerElement(document, node, "LayerElementTangent", "Tangents", 3, tangents);
+		if (hasTangent) {
+			ReadLayerElement(document, node, "LayerElementBinormal", "Binormals", 3, binormals);
+		}
+
+		//ポリゴンの所属するマテリアルのインデックスの取得
+		if (const fbx::Node* materialElement = document.FindChild(node, "LayerElementMaterial")) {
+			const Mapping mapping = ToMapping(ReadString(document, *materialElement, "MappingInformationType"));
+			std::vector<int32_t> materialIndices;
+			ReadArray(document, *materialElement, "Materials", materialIndices);
+			if (!materialIndices.empty()) {
+				source.materialIndices.resize(polygons.size());
+				for (size_t i = 0; i < polygons.size(); ++i) {
+					const size_t index = mapping == Mapping::ByPolygon ? static_cast<size_t>(polygons[i]) : 0;
+					source.materialIndices[i] = index < materialIndices.size() ? materialIndices[index] : 0;
+				}
+			}
+		}
+
+		const size_t cornerCount = source.cpIndices.size();
+		if (hasColor) {
+			source.colors.resize(cornerCount, mff::Vector4<float>(1, 1, 1, 1));
+		}
+		if (hasTexCoord) {
+			source.texCoords.resize(cornerCount);
+		}
+		if (hasNormal) {
+			source.normals.resize(cornerCount);
+		}
+		if (hasTangent) {
+			source.tangents.resize(cornerCount, mff::Vector4<float>(1, 0, 0, 1));
+		}
+		const double defaultTangent[3] = { 1, 0, 0 };
+		const double defaultBinormal[3] = { 0, 0, 0 };
+		for (size_t corner = 0; corner < cornerCount; ++corner) {
+			const int cpIndex = source.cpIndices[corner];
+			const int polygonVertex = polygonVertices[corner];
+			const int polygonIndex = polygons[corner / 3];
+			if (hasColor) {
+				if (const double* c = colors.Get(cpIndex, polygonVertex, polygonIndex)) {
+					source.colors[corner] = mff::Vector4<float>(static_cast<float>(c[0]), static_cast<float>(c[1]), static_cast<float>(c[2]), static_cast<float>(c[3]));
+				}
+			}
+			if (hasTexCoord) {
+				if (const double* uv = texCoords.Get(cpIndex, polygonVertex, polygonIndex)) {
+					source.texCoords[corner] = mff::Vector2<float>(static_cast<float>(uv[0]), static_cast<float>(uv[1]));
+				}
+			}
+			if (hasNormal) {
+				if (const double* n = normals.Get(cpIndex, polygonVertex, polygonIndex)) {
+					source.normals[corner] = mff::Normalize<float>(ToVector3(rot, n));
+				}
+			}
+			if (hasTangent) {
+				const double* t = tangents.Get(cpIndex, polygonVertex, polygonIndex);
+				const double* b = binormals.Get(cpIndex, polygonVertex, polygonIndex);
+				const mff::Vector3<float> tangent = ToVector3(rot, t ? t : defaultTangent);
+				const mff::Vector3<float> binormal = ToVector3(rot, b ? b : defaultBinormal);
+				const mff::Vector3<float> normal = hasNormal ? source.normals[corner] : mff::Vector3<float>();
+				//符号だけ見るので正規化は不要
+				source.tangents[corner] = mff::Vector4<float>(tangent, dot(binormal, cross(normal, tangent)) < 0 ? -1 : 1);
+			}
+		}
+
+		if (!isSkinned) {
+			return;
+		}
+
+		if (!isBoneTreeInitialized) {
+			BoneTreeData tmp;
+			LoadBone(tmp);
+		}
+
+		source.cpWeights.resize(cpCount);
+		for (int skin : geo.skins) {
+			const std::vector<int>& clusters = scene.skins[skin].clusters;
+			for (size_t clusterIndex = 0; clusterIndex < clusters.size(); ++clusterIndex) {
+				const fbx::Cluster& cluster = scene.clusters[clusters[clusterIndex]];
+				BoneData* pData = cluster.link >= 0 ? publicBoneTree.FindBone(scene.models[cluster.link].name) : nullptr;
+
+				//影響を与える頂点インデックス(ControlPointのIndex)とそのWeightの取得
+				std::vector<int32_t> relatedCpIndex;
+				std::vector<double> weights;
+				ReadArray(document, *cluster.node, "Indexes", relatedCpIndex);
+				ReadArray(document, *cluster.node, "Weights", weights);
+				const size_t relatedCpCount = (std::min)(relatedCpIndex.size(), weights.size());
+				for (size_t r = 0; r < relatedCpCount; ++r) {
+					if (relatedCpIndex[r] < 0 || relatedCpIndex[r] >= cpCount) {
+						continue;
+					}
+					source.cpWeights[relatedCpIndex[r]].weights.push_back({ pData ? pData->boneId : static_cast<int>(clusterIndex), weights[r] });
+				}
+			}
+		}
+		LimitWeights(source.cpWeights);
+	}
+
+	/**
+	* アニメーションデータの読み込み
+	*
+	* @param   animations  アニメーションデータの格納先
+	*/
+	void NativeLoader::LoadAnimation(std::vector<Animation>& animations) {
+		if (cache.IsOpen()) {
+			cache.LoadAnimation(animations);
+			return;
+		}
+		if (!isBoneTreeInitialized) {
+			BoneTreeData tmp;
+			LoadBone(tmp);
+		}
+		const int64_t period = scene.GetFramePeriod();
+
+		animations.resize(scene.stacks.size());
+		for (size_t animIndex = 0; animIndex < scene.stacks.size(); ++animIndex) {
+			const fbx::AnimationStack& stack = scene.stacks[animIndex];
+			scene.SetAnimationStack(static_cast<int>(animIndex));
+			int64_t start = stack.localStart;
+			int64_t stop = stack.localStop;
+			//LocalStart / LocalStop がなければキーの範囲
+			if (stop <= start && !scene.GetKeyTimeSpan(start, stop)) {
+				start = stop = 0;
+			}
+			const int64_t keyCount = (stop - start) / period;
+
+			animations[animIndex].animationTime = static_cast<float>(static_cast<double>(stop) / fbx::TimeSecond);
+			animations[animIndex].boneAnimationData.resize(publicBoneTree.data.size());
+			animations[animIndex].name = stack.name;
+
+			for (size_t clusterIndex = 0; clusterIndex < scene.clusters.size(); ++clusterIndex) {
+				const fbx::Cluster& cluster = scene.clusters[clusterIndex];
+				if (cluster.link < 0) {
+					continue;
+				}
+				const int meshModel = FindIncludedMeshModel(static_cast<int>(clusterIndex));
+				BoneData* pData = publicBoneTree.FindBone(scene.models[cluster.link].name);
+				if (!pData) {
+					continue;
+				}
+
+				auto& buf = animations[animIndex].boneAnimationData[pData->boneId];
+				for (int64_t keyframe = 0; keyframe <= keyCount; ++keyframe) {
+					const int64_t time = period * keyframe;
+					fbx::Matrix mat = scene.EvaluateGlobalTransform(cluster.link, time);
+					if (meshModel >= 0 && !boneBaseGetFromLink) {
+						const fbx::Matrix meshMat = scene.EvaluateGlobalTransform(meshModel, time);
+						mat = mff::Inverse(meshMat * scene.GetGeometricTransform(meshModel)) * mat;
+					}
+					buf.animDatas.push_back
+					({
+						static_cast<float>(static_cast<double>(time) / fbx::TimeSecond),
+						bakeBaseInv ? toMyMat(mat) * pData->baseInv : toMyMat(mat)
+						});
+				}
+				buf.animationTime = buf.animDatas.back().first;
+			}
+		}
+		scene.SetAnimationStack(-1);
+	}
+}// namespace FbxLoader
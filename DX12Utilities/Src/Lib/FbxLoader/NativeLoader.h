@@ -0,0 +1,81 @@
+﻿#ifndef NativeLoader_h
+#define NativeLoader_h
+
+#include "FbxLoaderStructs.h"
+#include "FbxDocument.h"
+#include "FbxScene.h"
+#include "MeshBuilder.h"
+#include "MeshCache.h"
+#include <string>
+#include <vector>
+
+namespace FbxLoader {
+	/*
+	FBX SDK を使わない Fbx読み込みクラス (FBX 7.x, バイナリ・アスキー)
+	Loader と同じ関数で同じデータを返す
+	アスキーは AsciiReader で必要なノードだけを読むので、ファイル全体をメモリに置かない
+
+	Loader との違い
+		多角形は扇形に三角形化する (凹多角形は SDK と分割が変わる)
+		アニメーションカーブの補間は一定・線形・3次 (ウェイトなし)
+		InheritType は RSrs (親の行列をそのまま掛ける) のみ
+	*/
+	class NativeLoader {
+	public:
+		bool Initialize(const std::string& filename);
+		/*
+		cacheFilename のキャッシュが filename の内容と一致すれば FBX を読まずにキャッシュから読む
+		一致しなければ filename を読み込んで結果をキャッシュに書き出す
+		SetBoneBaseGetFromLink / SetBakeBaseInv / SetOptimizeVertexCache は結果が変わるのでこれより先に呼ぶこと
+		LoadStaticMesh はスキンのあるメッシュも含めて返し、これはキャッシュに入っていないので、
+		キャッシュから読んでいる時もこの呼び出しだけは filename を読む (他はキャッシュのまま)
+		*/
+		bool Initialize(const std::string& filename, const std::string& cacheFilename);
+		//キャッシュから読んでいる時は頂点とインデックスをコピーせずに使える (それ以外は nullptr)
+		const MeshCache* GetCache() const { return cache.IsOpen() ? &cache : nullptr; }
+		void SetBoneBaseGetFromLink(bool flag) { boneBaseGetFromLink = flag; }
+		//false にすると Animation の行列に baseInv を掛けずモデル空間のまま返す (パレットは mff::BuildPalette で作る)
+		void SetBakeBaseInv(bool flag) { bakeBaseInv = flag; }
+		//メッシュの構築に使うスレッド数 (既定 1、0以下でハードウェアスレッド数)。結果は変わらない
+		void SetThreadCount(int count) { threadCount = count; }
+		//true にすると各マテリアルのインデックスを頂点変換後キャッシュに合わせて並べ替える (既定 false)
+		void SetOptimizeVertexCache(bool flag) { optimizeVertexCache = flag; }
+		/*
+		最後に構築したメッシュの OptimizeVertexCache 前後の統計 (Load*Mesh が返した順、static が先)
+		SetOptimizeVertexCache(true) の時のみ。キャッシュから読んだ呼び出しでは構築しないので変わらない
+		(キャッシュを書いた時は Initialize の中で構築した結果が入る)
+		*/
+		const std::vector<MeshVertexCacheReport>& GetVertexCacheReports() const { return vertexCacheReports; }
+		void LoadBone(BoneTreeData& boneTree);
+		void LoadAllMesh(std::vector<StaticMesh>& staticMeshes, std::vector<SkinnedMesh>& skinnedMeshes);
+		void LoadSkinnedMesh(std::vector<SkinnedMesh>& meshes);
+		void LoadStaticMesh(std::vector<StaticMesh>& meshes);
+		void LoadAnimation(std::vector<Animation>& animations);
+
+	private:
+		int FindRootBone(int model) const;
+		//クラスターの属するメッシュのモデル (なければ -1)
+		int FindIncludedMeshModel(int cluster) const;
+		bool ReadMatrix(const fbx::Node& node, const char* name, fbx::Matrix& dst) const;
+		void ExtractMesh(int geometry, bool isSkinned, MeshSource& source);
+		uint32_t GetCacheOptions() const;
+		bool OpenSource(const std::string& filename);
+
+		bool isBoneTreeInitialized = false;
+		//キャッシュから読んでいる時は LoadStaticMesh で初めて開く
+		std::string sourceFilename;
+		bool isSourceOpen = false;
+		bool boneBaseGetFromLink = true;
+		bool bakeBaseInv = true;
+		int threadCount = 1;
+		bool optimizeVertexCache = false;
+		std::vector<MeshVertexCacheReport> vertexCacheReports;
+		BoneTreeData publicBoneTree;
+
+		fbx::Document document;
+		fbx::Scene scene;
+		MeshCache cache;
+	};
+
+}// namespace FbxLoader
+#endif /* NativeLoader_h */
@@ -0,0 +1,144 @@
+﻿#include "Culling.h"
+#include "ParallelFor.h"
+#include "../Simd/Simd.h"
+
+namespace mff {
+	namespace {
+		using namespace simd;
+
+		//並列化する場合の1スレッドあたりの最小ワード数 (32要素/ワード)
+		const size_t ParallelMinWords = 1024;
+
+		struct PlaneLanes {
+			Float4 nx, ny, nz, d;
+			Float4 absX, absY, absZ;
+		};
+
+		struct FrustumLanes {
+			explicit FrustumLanes(const Frustum<float>& frustum) {
+				for (int i = 0; i < Frustum<float>::PlaneCount; ++i) {
+					const Plane<float>& p = frustum.planes[i];
+					planes[i] = {
+						Splat(p.normal.x), Splat(p.normal.y), Splat(p.normal.z), Splat(p.d),
+						Splat(fabsf(p.normal.x)), Splat(fabsf(p.normal.y)), Splat(fabsf(p.normal.z)),
+					};
+				}
+			}
+			PlaneLanes planes[Frustum<float>::PlaneCount];
+		};
+
+		inline Float4 Distance(const PlaneLanes& p, Float4 x, Float4 y, Float4 z) {
+			return MulAdd(p.nx, x, MulAdd(p.ny, y, MulAdd(p.nz, z, p.d)));
+		}
+
+		//4要素分の可視ビット
+		inline uint32_t SphereBits(const FrustumLanes& f, const Vec4Stream& s, size_t i) {
+			const Float4 x = Load(s.X() + i);
+			const Float4 y = Load(s.Y() + i);
+			const Float4 z = Load(s.Z() + i);
+			const Float4 negRadius = Neg(Load(s.W() + i));
+			Float4 outside = Zero();
+			for (const PlaneLanes& p : f.planes) {
+				outside = Or(outside, Less(Distance(p, x, y, z), negRadius));
+			}
+			return static_cast<uint32_t>(~MoveMask(outside) & 0xf);
+		}
+
+		inline uint32_t BoxBits(const FrustumLanes& f, const Vec3Stream& c, const Vec3Stream& e, size_t i) {
+			const Float4 x = Load(c.X() + i);
+			const Float4 y = Load(c.Y() + i);
+			const Float4 z = Load(c.Z() + i);
+			const Float4 ex = Load(e.X() + i);
+			const Float4 ey = Load(e.Y() + i);
+			const Float4 ez = Load(e.Z() + i);
+			Float4 outside = Zero();
+			for (const PlaneLanes& p : f.planes) {
+				const Float4 r = MulAdd(p.absX, ex, MulAdd(p.absY, ey, Mul(p.absZ, ez)));
+				outside = Or(outside, Less(Distance(p, x, y, z), Neg(r)));
+			}
+			return static_cast<uint32_t>(~MoveMask(outside) & 0xf);
+		}
+
+		inline size_t PopCount(uint32_t v) {
+			v = v - ((v >> 1) & 0x55555555u);
+			v = (v & 0x33333333u) + ((v >> 2) & 0x33333333u);
+			return static_cast<size_t>((((v + (v >> 4)) & 0x0f0f0f0fu) * 0x01010101u) >> 24);
+		}
+
+		/*
+		32要素ずつビットマスクを作る
+		bits(i) は i から4要素分の可視ビットを返す (i は Capacity() 未満)
+		*/
+		template<typename Func>
+		size_t Cull(size_t size, size_t capacity, uint32_t* visibleMask, int threadCount, Func bits) {
+			const size_t wordCount = (size + 31) / 32;
+			ParallelFor(wordCount, threadCount, ParallelMinWords, [&](size_t begin, size_t end) {
+				for (size_t w = begin; w < end; ++w) {
+					uint32_t mask = 0;
+					for (size_t g = 0; g < 8; ++g) {
+						const size_t i = w * 32 + g * 4;
+						if (i >= capacity) {
+							break;
+						}
+						mask |= bits(i) << (g * 4);
+					}
+					visibleMask[w] = mask;
+				}
+			});
+			//切り上げ分のビットを落とす
+			if (size % 32) {
+				visibleMask[wordCount - 1] &= (1u << (size % 32)) - 1;
+			}
+			size_t visible = 0;
+			for (size_t w = 0; w < wordCount; ++w) {
+				visible += PopCount(visibleMask[w]);
+			}
+			return visible;
+		}
+	} // namespace
+
+	size_t CullSpheres(const Frustum<float>& frustum, const Vec4Stream& spheres, uint32_t* visibleMask, int threadCount) {
+		const FrustumLanes f(frustum);
+		return Cull(spheres.Size(), spheres.Capacity(), visibleMask, threadCount, [&](size_t i) {
+			return SphereBits(f, spheres, i);
+		});
+	}
+
+	size_t CullBoxes(const Frustum<float>& frustum, const Vec3Stream& centers, const Vec3Stream& extents, uint32_t* visibleMask, int threadCount) {
+		const FrustumLanes f(frustum);
+		return Cull(centers.Size(), centers.Capacity(), visibleMask, threadCount, [&](size_t i) {
+			return BoxBits(f, centers, extents, i);
+		});
+	}
+
+	size_t CompactVisible(const uint32_t* visibleMask, size_t count, uint32_t* indices) {
+		size_t n = 0;
+		const size_t wordCount = (count + 31) / 32;
+		for (size_t w = 0; w < wordCount; ++w) {
+			uint32_t mask = visibleMask[w];
+			while (mask) {
+				//最下位ビットから順に取り出す
+				const uint32_t low = mask & (0u - mask);
+				indices[n++] = static_cast<uint32_t>(w * 32 + PopCount(low - 1));
+				mask ^= low;
+			}
+		}
+		return n;
+	}
+
+	void AssignBounds(const AABB<float>* boxes, size_t count, Vec3Stream& centers, Vec3Stream& extents) {
+		centers.Resize(count);
+		extents.Resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			centers.Set(i, boxes[i].Center());
+			extents.Set(i, boxes[i].Extents());
+		}
+	}
+
+	void AssignBounds(const BoundingSphere<float>* spheres, size_t count, Vec4Stream& dst) {
+		dst.Resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			dst.Set(i, Vector4<float>(spheres[i].center, spheres[i].radius));
+		}
+	}
+} // namespace mff
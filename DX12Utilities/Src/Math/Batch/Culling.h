@@ -0,0 +1,28 @@
+﻿#pragma once
+#include "../Bounds/Frustum.h"
+#include "../Vector/VectorStream.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+視錐台による一括カリング
+	判定は Intersects(const Frustum<float>&, ...) と同じ保守的な平面判定
+	visibleMask は (Size() + 31) / 32 個の uint32_t で、i番目の可視性は visibleMask[i / 32] の (i % 32) bit
+	Size() 以降のビットは0になる
+	戻り値は可視数
+	threadCount が 1 以外で要素数が十分大きい場合は区間を分割して並列に処理する (0でハードウェアスレッド数)
+*/
+namespace mff {
+	//spheres : xyz = 中心, w = 半径
+	size_t CullSpheres(const Frustum<float>& frustum, const Vec4Stream& spheres, uint32_t* visibleMask, int threadCount = 1);
+
+	//centers / extents : AABBの中心と各軸の半分の大きさ (同じ要素数)
+	size_t CullBoxes(const Frustum<float>& frustum, const Vec3Stream& centers, const Vec3Stream& extents, uint32_t* visibleMask, int threadCount = 1);
+
+	//ビットマスクから可視要素のインデックスを昇順に詰めて書き出す (indices は可視数以上必要)
+	size_t CompactVisible(const uint32_t* visibleMask, size_t count, uint32_t* indices);
+
+	//AABB配列をカリング用のSoAに変換する
+	void AssignBounds(const AABB<float>* boxes, size_t count, Vec3Stream& centers, Vec3Stream& extents);
+	void AssignBounds(const BoundingSphere<float>* spheres, size_t count, Vec4Stream& dst);
+} // namespace mff
@@ -0,0 +1,148 @@
+﻿#include "Hierarchy.h"
+#include "ParallelFor.h"
+#include <algorithm>
+
+namespace mff {
+	namespace {
+		//並列化する場合の1スレッドあたりの最小ボーン数
+		const size_t ParallelMinBones = 2048;
+
+		//[begin, end) を親が処理済みの前提で順に変換する
+		inline void Propagate(const int* parents, const Matrix4x4<float>* local, Matrix4x4<float>* world, const Matrix4x4<float>* root, size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				const int parent = parents[i];
+				if (parent >= 0) {
+					world[i] = world[parent] * local[i];
+				}
+				else {
+					world[i] = root ? *root * local[i] : local[i];
+				}
+			}
+		}
+	} // namespace
+
+	bool FlattenHierarchy(const int* parents, size_t count, FlatHierarchy& dst) {
+		const int n = static_cast<int>(count);
+		//子の一覧 (元の並びを保つ)
+		std::vector<int> childStart(n + 1, 0);
+		std::vector<int> roots;
+		for (int i = 0; i < n; ++i) {
+			const int parent = parents[i];
+			if (parent >= n || parent == i || parent < -1) {
+				return false;
+			}
+			if (parent < 0) {
+				roots.push_back(i);
+			}
+			else {
+				++childStart[parent + 1];
+			}
+		}
+		for (int i = 0; i < n; ++i) {
+			childStart[i + 1] += childStart[i];
+		}
+		std::vector<int> children(childStart[n]);
+		std::vector<int> fill(childStart.begin(), childStart.end() - 1);
+		for (int i = 0; i < n; ++i) {
+			if (parents[i] >= 0) {
+				children[fill[parents[i]]++] = i;
+			}
+		}
+
+		dst.parents.assign(n, -1);
+		dst.subtreeSizes.assign(n, 1);
+		dst.sourceIndices.clear();
+		dst.sourceIndices.reserve(n);
+		dst.flatIndices.assign(n, -1);
+		dst.trunk.clear();
+		dst.branches.clear();
+
+		std::vector<int> stack;
+		for (int root : roots) {
+			stack.push_back(root);
+			while (!stack.empty()) {
+				const int src = stack.back();
+				stack.pop_back();
+				const int flat = static_cast<int>(dst.sourceIndices.size());
+				dst.flatIndices[src] = flat;
+				dst.sourceIndices.push_back(src);
+				dst.parents[flat] = parents[src] >= 0 ? dst.flatIndices[parents[src]] : -1;
+				//先頭の子から取り出すよう逆順に積む
+				for (int c = childStart[src + 1] - 1; c >= childStart[src]; --c) {
+					stack.push_back(children[c]);
+				}
+			}
+		}
+		//ルートから辿れない要素がある = 循環
+		if (static_cast<int>(dst.sourceIndices.size()) != n) {
+			return false;
+		}
+		for (int i = n - 1; i > 0; --i) {
+			if (dst.parents[i] >= 0) {
+				dst.subtreeSizes[dst.parents[i]] += dst.subtreeSizes[i];
+			}
+		}
+		return true;
+	}
+
+	void SplitSubtrees(FlatHierarchy& hierarchy, size_t branchCount) {
+		hierarchy.trunk.clear();
+		hierarchy.branches.clear();
+		const int n = static_cast<int>(hierarchy.Size());
+		if (n == 0) {
+			return;
+		}
+		std::vector<std::pair<int, int> >& branches = hierarchy.branches;
+		for (int i = 0; i < n; i += hierarchy.subtreeSizes[i]) {
+			branches.push_back({ i, i + hierarchy.subtreeSizes[i] });
+		}
+		const size_t target = (static_cast<size_t>(n) + branchCount - 1) / (branchCount ? branchCount : 1);
+		while (branches.size() < branchCount) {
+			//最大の部分木の根を trunk に移し、子の部分木に分ける
+			auto largest = std::max_element(branches.begin(), branches.end(), [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+				return a.second - a.first < b.second - b.first;
+			});
+			const std::pair<int, int> range = *largest;
+			if (static_cast<size_t>(range.second - range.first) <= target || range.second - range.first == 1) {
+				break;
+			}
+			branches.erase(largest);
+			hierarchy.trunk.push_back(range.first);
+			for (int i = range.first + 1; i < range.second; i += hierarchy.subtreeSizes[i]) {
+				branches.push_back({ i, i + hierarchy.subtreeSizes[i] });
+			}
+		}
+		std::sort(hierarchy.trunk.begin(), hierarchy.trunk.end());
+		std::sort(branches.begin(), branches.end());
+	}
+
+	void LocalToWorld(const FlatHierarchy& hierarchy, const Matrix4x4<float>* local, Matrix4x4<float>* world,
+		size_t instanceCount, const Matrix4x4<float>* instanceRoots, int threadCount) {
+		const size_t boneCount = hierarchy.Size();
+		if (boneCount == 0) {
+			return;
+		}
+		const int* parents = hierarchy.parents.data();
+		if (instanceCount > 1 || hierarchy.branches.empty() || threadCount == 1) {
+			const size_t minInstances = (ParallelMinBones + boneCount - 1) / boneCount;
+			ParallelFor(instanceCount, threadCount, minInstances, [&](size_t begin, size_t end) {
+				for (size_t inst = begin; inst < end; ++inst) {
+					const size_t offset = inst * boneCount;
+					Propagate(parents, local + offset, world + offset, instanceRoots ? instanceRoots + inst : nullptr, 0, boneCount);
+				}
+			});
+			return;
+		}
+
+		for (int i : hierarchy.trunk) {
+			Propagate(parents, local, world, instanceRoots, i, i + 1);
+		}
+		const std::vector<std::pair<int, int> >& branches = hierarchy.branches;
+		const size_t minBranches = (ParallelMinBones * branches.size() + boneCount - 1) / boneCount;
+		ParallelFor(branches.size(), threadCount, minBranches, [&](size_t begin, size_t end) {
+			for (size_t b = begin; b < end; ++b) {
+				Propagate(parents, local, world, instanceRoots, branches[b].first, branches[b].second);
+			}
+		});
+	}
+} // namespace mff
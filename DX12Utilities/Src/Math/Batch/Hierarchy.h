@@ -0,0 +1,63 @@
+﻿#pragma once
+#include "../Matrix/Matrix4x4.h"
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+/*
+親子階層の平坦化とローカル -> ワールド変換の伝搬
+	深さ優先の前順に並び替え、親が必ず子より前 (parents[i] < i) になるようにする
+	部分木 i は連続区間 [i, i + subtreeSizes[i]) になる
+	world[i] = world[parents[i]] * local[i] (ルートは instanceRoots * local)
+*/
+namespace mff {
+	struct FlatHierarchy {
+		size_t Size() const { return parents.size(); }
+
+		//並び替え後のインデックス (ルートは -1)
+		std::vector<int> parents;
+		std::vector<int> subtreeSizes;
+		//並び替え後 -> 元, 元 -> 並び替え後
+		std::vector<int> sourceIndices;
+		std::vector<int> flatIndices;
+
+		//SplitSubtrees で作る部分木並列用の分割
+		//trunk を直列で処理した後、branches の各区間は互いに独立に処理できる
+		std::vector<int> trunk;
+		std::vector<std::pair<int, int> > branches;
+	};
+
+	/*
+	parents[i] は元の並びでの親インデックス (-1 でルート)
+	兄弟の順序と、ルート同士の順序は元の並びを保つ
+	範囲外の親や循環がある場合は false を返す
+	*/
+	bool FlattenHierarchy(const int* parents, size_t count, FlatHierarchy& dst);
+
+	//1インスタンスを最大 branchCount 程度の独立な部分木に分ける (要素数の大きい部分木から根を trunk に移して分割する)
+	void SplitSubtrees(FlatHierarchy& hierarchy, size_t branchCount);
+
+	//元の並びの配列を並び替え後の並びにする (src != dst)
+	template<typename T>
+	void ToFlatOrder(const FlatHierarchy& hierarchy, const T* src, T* dst) {
+		for (size_t i = 0; i < hierarchy.Size(); ++i) {
+			dst[i] = src[hierarchy.sourceIndices[i]];
+		}
+	}
+
+	template<typename T>
+	void ToSourceOrder(const FlatHierarchy& hierarchy, const T* src, T* dst) {
+		for (size_t i = 0; i < hierarchy.Size(); ++i) {
+			dst[hierarchy.sourceIndices[i]] = src[i];
+		}
+	}
+
+	/*
+	local / world は並び替え後の並びで [instance][bone] (instanceCount * Size() 個)
+	instanceRoots はインスタンスごとのルートの親行列 (nullptr で単位行列)
+	threadCount が 1 以外の場合、インスタンスが複数ならインスタンス単位で、
+	1つだけなら SplitSubtrees の分割で並列に処理する (0でハードウェアスレッド数)
+	*/
+	void LocalToWorld(const FlatHierarchy& hierarchy, const Matrix4x4<float>* local, Matrix4x4<float>* world,
+		size_t instanceCount = 1, const Matrix4x4<float>* instanceRoots = nullptr, int threadCount = 1);
+} // namespace mff
@@ -0,0 +1,74 @@
+﻿#include "MatrixBatch.h"
+#include "../Simd/Simd.h"
+
+namespace mff {
+	namespace {
+		using namespace simd;
+
+		//InverseElements 等の要素型として使うためのレーン型
+		struct Lane {
+			Lane() {}
+			Lane(float v) : v(Splat(v)) {}
+			Lane(Float4 v) : v(v) {}
+			Float4 v;
+		};
+
+		inline Lane operator+(Lane a, Lane b) { return Add(a.v, b.v); }
+		inline Lane operator-(Lane a, Lane b) { return Sub(a.v, b.v); }
+		inline Lane operator*(Lane a, Lane b) { return Mul(a.v, b.v); }
+		inline Lane operator/(Lane a, Lane b) { return Div(a.v, b.v); }
+
+		//count(4以下)個の行列を要素ごとのレーンに並べ替える (足りない分は単位行列)
+		inline void LoadLanes(const Matrix4x4<float>* src, size_t count, Lane* lanes) {
+			for (int row = 0; row < 4; ++row) {
+				const Float4 identityRow = Set(row == 0 ? 1.0f : 0.0f, row == 1 ? 1.0f : 0.0f, row == 2 ? 1.0f : 0.0f, row == 3 ? 1.0f : 0.0f);
+				Float4 r[4];
+				for (size_t k = 0; k < 4; ++k) {
+					r[k] = k < count ? Load(src[k].m + row * 4) : identityRow;
+				}
+				Transpose(r[0], r[1], r[2], r[3]);
+				for (int col = 0; col < 4; ++col) {
+					lanes[row * 4 + col] = r[col];
+				}
+			}
+		}
+
+		inline void StoreLanes(const Lane* lanes, size_t count, Matrix4x4<float>* dst) {
+			for (int row = 0; row < 4; ++row) {
+				Float4 r[4] = { lanes[row * 4 + 0].v, lanes[row * 4 + 1].v, lanes[row * 4 + 2].v, lanes[row * 4 + 3].v };
+				Transpose(r[0], r[1], r[2], r[3]);
+				for (size_t k = 0; k < count; ++k) {
+					Store(dst[k].m + row * 4, r[k]);
+				}
+			}
+		}
+
+		template<typename Func>
+		void ForEachBlock(const Matrix4x4<float>* src, Matrix4x4<float>* dst, size_t count, Func func) {
+			Lane in[16];
+			Lane out[16];
+			for (size_t i = 0; i < count; i += 4) {
+				size_t n = count - i < 4 ? count - i : 4;
+				LoadLanes(src + i, n, in);
+				func(in, out);
+				StoreLanes(out, n, dst + i);
+			}
+		}
+	} // namespace
+
+	void InverseMatrices(const Matrix4x4<float>* src, Matrix4x4<float>* dst, size_t count) {
+		ForEachBlock(src, dst, count, [](const Lane* in, Lane* out) {
+			InverseElements(in, out);
+		});
+	}
+
+	void AffineInverseMatrices(const Matrix4x4<float>* src, Matrix4x4<float>* dst, size_t count) {
+		ForEachBlock(src, dst, count, [](const Lane* in, Lane* out) {
+			AffineInverseElements(in, out);
+			out[12] = 0.0f;
+			out[13] = 0.0f;
+			out[14] = 0.0f;
+			out[15] = 1.0f;
+		});
+	}
+} // namespace mff
\ No newline at end of file
@@ -0,0 +1,13 @@
+﻿#pragma once
+#include "../Matrix/Matrix4x4.h"
+#include <stddef.h>
+
+/*
+行列配列の一括処理
+	4行列ずつ要素をSIMDレーンに並べて処理する
+	src == dst (in-place) を許可する
+*/
+namespace mff {
+	void InverseMatrices(const Matrix4x4<float>* src, Matrix4x4<float>* dst, size_t count);
+	void AffineInverseMatrices(const Matrix4x4<float>* src, Matrix4x4<float>* dst, size_t count);
+} // namespace mff
\ No newline at end of file
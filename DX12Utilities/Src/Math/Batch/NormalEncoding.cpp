@@ -0,0 +1,282 @@
+﻿#include "NormalEncoding.h"
+#include "../Simd/Simd.h"
+
+namespace mff {
+	namespace {
+		using namespace simd;
+
+		//一度に浮動小数点で組み立てて量子化する要素数 (4の倍数)
+		const size_t BlockSize = 64;
+
+		inline Float4 SignNotZero(Float4 v) {
+			return Select(Less(v, Zero()), Splat(-1.0f), Splat(1.0f));
+		}
+
+		//encoding::ToOctahedral と同じ手順を4要素で行う
+		inline void ToOctahedral(Float4 x, Float4 y, Float4 z, Float4& u, Float4& v) {
+			const Float4 one = Splat(1.0f);
+			const Float4 inv = Div(one, Add(Add(Abs(x), Abs(y)), Abs(z)));
+			u = Mul(x, inv);
+			v = Mul(y, inv);
+			const Float4 fold = Less(z, Zero());
+			const Float4 fu = Mul(Sub(one, Abs(v)), SignNotZero(u));
+			const Float4 fv = Mul(Sub(one, Abs(u)), SignNotZero(v));
+			u = Select(fold, fu, u);
+			v = Select(fold, fv, v);
+		}
+
+		//encoding::FromOctahedral と同じ手順を4要素で行う
+		inline void FromOctahedral(Float4 u, Float4 v, Float4& x, Float4& y, Float4& z) {
+			const Float4 one = Splat(1.0f);
+			z = Sub(Sub(one, Abs(u)), Abs(v));
+			const Float4 fold = Less(z, Zero());
+			x = Select(fold, Mul(Sub(one, Abs(v)), SignNotZero(u)), u);
+			y = Select(fold, Mul(Sub(one, Abs(u)), SignNotZero(v)), v);
+			const Float4 len = Sqrt(Add(Add(Mul(x, x), Mul(y, y)), Mul(z, z)));
+			x = Div(x, len);
+			y = Div(y, len);
+			z = Div(z, len);
+		}
+
+		/*
+		encoding::ToQTangent と同じ手順を4要素で行う
+		ToQuaternion の4つの分岐はすべて計算してレーンごとに選ぶ
+		*/
+		inline void ToQTangent(const Vector3<float>* normals, const Vector4<float>* tangents, float bias, Float4 q[4]) {
+			const Float4 one = Splat(1.0f);
+			const Float4 zero = Zero();
+
+			Float4 nx, ny, nz;
+			LoadXYZ(&normals[0].x, nx, ny, nz);
+			Float4 len = Sqrt(Add(Add(Mul(nx, nx), Mul(ny, ny)), Mul(nz, nz)));
+			nx = Div(nx, len);
+			ny = Div(ny, len);
+			nz = Div(nz, len);
+
+			Float4 tx = Load(&tangents[0].x);
+			Float4 ty = Load(&tangents[1].x);
+			Float4 tz = Load(&tangents[2].x);
+			Float4 tw = Load(&tangents[3].x);
+			Transpose(tx, ty, tz, tw);
+			const Float4 d = Add(Add(Mul(nx, tx), Mul(ny, ty)), Mul(nz, tz));
+			tx = Sub(tx, Mul(nx, d));
+			ty = Sub(ty, Mul(ny, d));
+			tz = Sub(tz, Mul(nz, d));
+			len = Sqrt(Add(Add(Mul(tx, tx), Mul(ty, ty)), Mul(tz, tz)));
+			tx = Div(tx, len);
+			ty = Div(ty, len);
+			tz = Div(tz, len);
+
+			const Float4 bx = Sub(Mul(ny, tz), Mul(nz, ty));
+			const Float4 by = Sub(Mul(nz, tx), Mul(nx, tz));
+			const Float4 bz = Sub(Mul(nx, ty), Mul(ny, tx));
+
+			//列が (t, b, n) の回転行列 : m00 = tx, m11 = by, m22 = nz
+			const Float4 trace = Add(Add(tx, by), nz);
+			const Float4 caseA = Greater(trace, zero);
+			const Float4 caseB = And(Greater(tx, by), Greater(tx, nz));
+			const Float4 caseC = Greater(by, nz);
+			const Float4 radicand = Select(caseA, Add(trace, one),
+				Select(caseB, Sub(Sub(Add(one, tx), by), nz),
+				Select(caseC, Sub(Sub(Add(one, by), tx), nz),
+				Sub(Sub(Add(one, nz), tx), by))));
+			const Float4 s = Mul(Sqrt(radicand), Splat(2.0f));
+			const Float4 quarter = Mul(s, Splat(0.25f));
+			const Float4 d21 = Div(Sub(bz, ny), s);
+			const Float4 d02 = Div(Sub(nx, tz), s);
+			const Float4 d10 = Div(Sub(ty, bx), s);
+			const Float4 s01 = Div(Add(bx, ty), s);
+			const Float4 s02 = Div(Add(nx, tz), s);
+			const Float4 s12 = Div(Add(ny, bz), s);
+
+			Float4 x = Select(caseA, d21, Select(caseB, quarter, Select(caseC, s01, s02)));
+			Float4 y = Select(caseA, d02, Select(caseB, s01, Select(caseC, quarter, s12)));
+			Float4 z = Select(caseA, d10, Select(caseB, s02, Select(caseC, s12, quarter)));
+			Float4 w = Select(caseA, quarter, Select(caseB, d21, Select(caseC, d02, d10)));
+
+			//encoding::ApplyQTangentSign
+			const Float4 negative = Less(w, zero);
+			x = Select(negative, Neg(x), x);
+			y = Select(negative, Neg(y), y);
+			z = Select(negative, Neg(z), z);
+			w = Select(negative, Neg(w), w);
+			const Float4 biasV = Splat(bias);
+			const Float4 low = Less(w, biasV);
+			const Float4 scale = Splat(sqrtf(1.0f - bias * bias));
+			x = Select(low, Mul(x, scale), x);
+			y = Select(low, Mul(y, scale), y);
+			z = Select(low, Mul(z, scale), z);
+			w = Select(low, biasV, w);
+			const Float4 flip = Less(tw, zero);
+			q[0] = Select(flip, Neg(x), x);
+			q[1] = Select(flip, Neg(y), y);
+			q[2] = Select(flip, Neg(z), z);
+			q[3] = Select(flip, Neg(w), w);
+		}
+
+		//encoding::FromQTangent と同じ手順を4要素で行う (q は要素ごとの xyzw)
+		inline void FromQTangent(const float* q, Vector3<float>* normals, Vector4<float>* tangents) {
+			const Float4 one = Splat(1.0f);
+			const Float4 two = Splat(2.0f);
+			Float4 x = Load(q);
+			Float4 y = Load(q + 4);
+			Float4 z = Load(q + 8);
+			Float4 w = Load(q + 12);
+			Transpose(x, y, z, w);
+			Float4 sign = SignNotZero(w);
+			const Float4 len = Sqrt(Add(Add(Add(Mul(x, x), Mul(y, y)), Mul(z, z)), Mul(w, w)));
+			x = Div(x, len);
+			y = Div(y, len);
+			z = Div(z, len);
+			w = Div(w, len);
+			const Float4 xx = Mul(x, x), yy = Mul(y, y), zz = Mul(z, z);
+			const Float4 xy = Mul(x, y), xz = Mul(x, z), yz = Mul(y, z);
+			const Float4 wx = Mul(w, x), wy = Mul(w, y), wz = Mul(w, z);
+			StoreXYZ(&normals[0].x,
+				Mul(two, Add(xz, wy)),
+				Mul(two, Sub(yz, wx)),
+				Sub(one, Mul(two, Add(xx, yy))));
+			Float4 tx = Sub(one, Mul(two, Add(yy, zz)));
+			Float4 ty = Mul(two, Add(xy, wz));
+			Float4 tz = Mul(two, Sub(xz, wy));
+			Transpose(tx, ty, tz, sign);
+			Store(&tangents[0].x, tx);
+			Store(&tangents[1].x, ty);
+			Store(&tangents[2].x, tz);
+			Store(&tangents[3].x, sign);
+		}
+
+		template<typename Snorm>
+		void EncodeOctahedralBlocks(const Vector3<float>* src, Snorm* dst, size_t count, void(*quantize)(const float*, Snorm*, size_t)) {
+			float uv[BlockSize * 2];
+			const size_t simdCount = count & ~static_cast<size_t>(3);
+			for (size_t begin = 0; begin < simdCount; begin += BlockSize) {
+				const size_t n = simdCount - begin < BlockSize ? simdCount - begin : BlockSize;
+				for (size_t i = 0; i < n; i += 4) {
+					Float4 x, y, z, u, v;
+					LoadXYZ(&src[begin + i].x, x, y, z);
+					ToOctahedral(x, y, z, u, v);
+					float us[4], vs[4];
+					Store(us, u);
+					Store(vs, v);
+					for (int k = 0; k < 4; ++k) {
+						uv[(i + k) * 2 + 0] = us[k];
+						uv[(i + k) * 2 + 1] = vs[k];
+					}
+				}
+				quantize(uv, dst + begin * 2, n * 2);
+			}
+			for (size_t i = simdCount; i < count; ++i) {
+				EncodeOctahedral(src[i], dst + i * 2);
+			}
+		}
+
+		template<typename Snorm>
+		void DecodeOctahedralBlocks(const Snorm* src, Vector3<float>* dst, size_t count, void(*dequantize)(const Snorm*, float*, size_t)) {
+			float uv[BlockSize * 2];
+			const size_t simdCount = count & ~static_cast<size_t>(3);
+			for (size_t begin = 0; begin < simdCount; begin += BlockSize) {
+				const size_t n = simdCount - begin < BlockSize ? simdCount - begin : BlockSize;
+				dequantize(src + begin * 2, uv, n * 2);
+				for (size_t i = 0; i < n; i += 4) {
+					const float* p = uv + i * 2;
+					Float4 x, y, z;
+					FromOctahedral(Set(p[0], p[2], p[4], p[6]), Set(p[1], p[3], p[5], p[7]), x, y, z);
+					StoreXYZ(&dst[begin + i].x, x, y, z);
+				}
+			}
+			for (size_t i = simdCount; i < count; ++i) {
+				dst[i] = DecodeOctahedral(src + i * 2);
+			}
+		}
+
+		template<typename Snorm>
+		void EncodeQTangentBlocks(const Vector3<float>* normals, const Vector4<float>* tangents, Snorm* dst, size_t count, float bias, void(*quantize)(const float*, Snorm*, size_t)) {
+			float q[BlockSize * 4];
+			const size_t simdCount = count & ~static_cast<size_t>(3);
+			for (size_t begin = 0; begin < simdCount; begin += BlockSize) {
+				const size_t n = simdCount - begin < BlockSize ? simdCount - begin : BlockSize;
+				for (size_t i = 0; i < n; i += 4) {
+					Float4 lanes[4];
+					ToQTangent(normals + begin + i, tangents + begin + i, bias, lanes);
+					Transpose(lanes[0], lanes[1], lanes[2], lanes[3]);
+					for (int k = 0; k < 4; ++k) {
+						Store(q + (i + k) * 4, lanes[k]);
+					}
+				}
+				quantize(q, dst + begin * 4, n * 4);
+			}
+			for (size_t i = simdCount; i < count; ++i) {
+				EncodeQTangent(normals[i], tangents[i], dst + i * 4);
+			}
+		}
+
+		template<typename Snorm>
+		void DecodeQTangentBlocks(const Snorm* src, Vector3<float>* normals, Vector4<float>* tangents, size_t count, void(*dequantize)(const Snorm*, float*, size_t)) {
+			float q[BlockSize * 4];
+			const size_t simdCount = count & ~static_cast<size_t>(3);
+			for (size_t begin = 0; begin < simdCount; begin += BlockSize) {
+				const size_t n = simdCount - begin < BlockSize ? simdCount - begin : BlockSize;
+				dequantize(src + begin * 4, q, n * 4);
+				for (size_t i = 0; i < n; i += 4) {
+					FromQTangent(q + i * 4, normals + begin + i, tangents + begin + i);
+				}
+			}
+			for (size_t i = simdCount; i < count; ++i) {
+				DecodeQTangent(src + i * 4, normals[i], tangents[i]);
+			}
+		}
+	} // namespace
+
+	void EncodeOctahedral(const Vector3<float>* src, int16_t* dst, size_t count) {
+		EncodeOctahedralBlocks<int16_t>(src, dst, count, &FloatToSnorm16);
+	}
+
+	void EncodeOctahedral(const Vector3<float>* src, int8_t* dst, size_t count) {
+		EncodeOctahedralBlocks<int8_t>(src, dst, count, &FloatToSnorm8);
+	}
+
+	void DecodeOctahedral(const int16_t* src, Vector3<float>* dst, size_t count) {
+		DecodeOctahedralBlocks<int16_t>(src, dst, count, &Snorm16ToFloat);
+	}
+
+	void DecodeOctahedral(const int8_t* src, Vector3<float>* dst, size_t count) {
+		DecodeOctahedralBlocks<int8_t>(src, dst, count, &Snorm8ToFloat);
+	}
+
+	void EncodeQTangent(const Vector3<float>* normals, const Vector4<float>* tangents, int16_t* dst, size_t count) {
+		EncodeQTangentBlocks<int16_t>(normals, tangents, dst, count, encoding::QTangentBias16, &FloatToSnorm16);
+	}
+
+	void EncodeQTangent(const Vector3<float>* normals, const Vector4<float>* tangents, int8_t* dst, size_t count) {
+		EncodeQTangentBlocks<int8_t>(normals, tangents, dst, count, encoding::QTangentBias8, &FloatToSnorm8);
+	}
+
+	void DecodeQTangent(const int16_t* src, Vector3<float>* normals, Vector4<float>* tangents, size_t count) {
+		DecodeQTangentBlocks<int16_t>(src, normals, tangents, count, &Snorm16ToFloat);
+	}
+
+	void DecodeQTangent(const int8_t* src, Vector3<float>* normals, Vector4<float>* tangents, size_t count) {
+		DecodeQTangentBlocks<int8_t>(src, normals, tangents, count, &Snorm8ToFloat);
+	}
+
+	AngularError MeasureAngularError(const Vector3<float>* expected, const Vector3<float>* actual, size_t count) {
+		AngularError ret;
+		if (count == 0) {
+			return ret;
+		}
+		//acos は 0 付近で精度が落ちるので atan2(|a x b|, a・b) で求める
+		double sum = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const Vector3<double> a(expected[i].x, expected[i].y, expected[i].z);
+			const Vector3<double> b(actual[i].x, actual[i].y, actual[i].z);
+			const double angle = atan2(cross(a, b).Length(), dot(a, b));
+			sum += angle;
+			if (angle > ret.max) {
+				ret.max = static_cast<float>(angle);
+			}
+		}
+		ret.mean = static_cast<float>(sum / static_cast<double>(count));
+		return ret;
+	}
+} // namespace mff
@@ -0,0 +1,160 @@
+﻿#pragma once
+#include "Pack.h"
+#include "../Vector/Vector3.h"
+#include "../Vector/Vector4.h"
+#include "../Quaternion/Quaternion.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+法線・接空間の圧縮
+	Octahedral : 単位ベクトルを八面体に投影して2成分にする (snorm16x2 = 4byte, snorm8x2 = 2byte)
+	QTangent   : 法線・接線・従法線の回転をクォータニオン1つで表す (snorm16x4 = 8byte, snorm8x4 = 4byte)
+	             従法線の符号 (tangent.w) はクォータニオンの符号に入れる (w < 0 なら -1)
+	             w が0に量子化されると符号が失われるため、|w| は1量子化幅以上に保つ
+
+	接線は法線に対してグラム・シュミットで直交化してから符号化する
+	従法線は cross(normal, tangent) * tangent.w (FbxLoader と同じ定義)
+
+	単位球面上の100万点 (接線は法線に直交する乱数方向) で測った角度誤差 (度)
+		Octahedral snorm16 : 最大 0.0037, 平均 0.0013
+		Octahedral snorm8  : 最大 0.95,   平均 0.34
+		QTangent snorm16   : 法線 最大 0.0036, 平均 0.0013 / 接線 最大 0.022, 平均 0.0013
+		QTangent snorm8    : 法線 最大 1.07,   平均 0.34   / 接線 最大 1.08,  平均 0.34
+	データごとの誤差は MeasureAngularError で測れる
+
+	配列版は4要素ずつSIMDで処理し、単体版と同じ結果を返す
+*/
+namespace mff {
+	namespace encoding {
+		inline float SignNotZero(float v) {
+			return v < 0.0f ? -1.0f : 1.0f;
+		}
+
+		//単位ベクトル -> [-1, 1]^2
+		inline void ToOctahedral(const Vector3<float>& n, float& u, float& v) {
+			const float inv = 1.0f / (fabsf(n.x) + fabsf(n.y) + fabsf(n.z));
+			u = n.x * inv;
+			v = n.y * inv;
+			if (n.z < 0.0f) {
+				const float fu = (1.0f - fabsf(v)) * SignNotZero(u);
+				const float fv = (1.0f - fabsf(u)) * SignNotZero(v);
+				u = fu;
+				v = fv;
+			}
+		}
+
+		inline Vector3<float> FromOctahedral(float u, float v) {
+			Vector3<float> n(u, v, 1.0f - fabsf(u) - fabsf(v));
+			if (n.z < 0.0f) {
+				n.x = (1.0f - fabsf(v)) * SignNotZero(u);
+				n.y = (1.0f - fabsf(u)) * SignNotZero(v);
+			}
+			return Normalize(n);
+		}
+
+		//|w| の下限 (符号を残すため) を適用し、tangentSign < 0 なら反転する
+		inline Quaternion<float> ApplyQTangentSign(Quaternion<float> q, float tangentSign, float bias) {
+			if (q.w < 0.0f) {
+				q = -q;
+			}
+			if (q.w < bias) {
+				const float scale = sqrtf(1.0f - bias * bias);
+				q = Quaternion<float>(q.x * scale, q.y * scale, q.z * scale, bias);
+			}
+			return tangentSign < 0.0f ? -q : q;
+		}
+
+		inline Quaternion<float> ToQTangent(const Vector3<float>& normal, const Vector4<float>& tangent, float bias) {
+			const Vector3<float> n = Normalize(normal);
+			const Vector3<float> t3(tangent.x, tangent.y, tangent.z);
+			const Vector3<float> t = Normalize(t3 - n * dot(n, t3));
+			const Vector3<float> b = cross(n, t);
+			//列が (t, b, n) の回転行列
+			const Matrix4x4<float> frame(
+				Vector4<float>(t.x, b.x, n.x, 0),
+				Vector4<float>(t.y, b.y, n.y, 0),
+				Vector4<float>(t.z, b.z, n.z, 0),
+				Vector4<float>(0, 0, 0, 1));
+			return ApplyQTangentSign(ToQuaternion(frame), tangent.w, bias);
+		}
+
+		inline void FromQTangent(Quaternion<float> q, Vector3<float>& normal, Vector4<float>& tangent) {
+			const float sign = q.w < 0.0f ? -1.0f : 1.0f;
+			q = Normalize(q);
+			const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+			const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+			const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+			normal = Vector3<float>(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+			tangent = Vector4<float>(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), sign);
+		}
+
+		const float QTangentBias16 = 1.0f / 32767.0f;
+		const float QTangentBias8 = 1.0f / 127.0f;
+	} // namespace encoding
+
+	inline void EncodeOctahedral(const Vector3<float>& normal, int16_t out[2]) {
+		float u, v;
+		encoding::ToOctahedral(normal, u, v);
+		out[0] = FloatToSnorm16(u);
+		out[1] = FloatToSnorm16(v);
+	}
+
+	inline void EncodeOctahedral(const Vector3<float>& normal, int8_t out[2]) {
+		float u, v;
+		encoding::ToOctahedral(normal, u, v);
+		out[0] = FloatToSnorm8(u);
+		out[1] = FloatToSnorm8(v);
+	}
+
+	inline Vector3<float> DecodeOctahedral(const int16_t in[2]) {
+		return encoding::FromOctahedral(Snorm16ToFloat(in[0]), Snorm16ToFloat(in[1]));
+	}
+
+	inline Vector3<float> DecodeOctahedral(const int8_t in[2]) {
+		return encoding::FromOctahedral(Snorm8ToFloat(in[0]), Snorm8ToFloat(in[1]));
+	}
+
+	//tangent.w は従法線の符号 (+1 / -1)
+	inline void EncodeQTangent(const Vector3<float>& normal, const Vector4<float>& tangent, int16_t out[4]) {
+		const Quaternion<float> q = encoding::ToQTangent(normal, tangent, encoding::QTangentBias16);
+		for (int i = 0; i < 4; ++i) {
+			out[i] = FloatToSnorm16(q.m[i]);
+		}
+	}
+
+	inline void EncodeQTangent(const Vector3<float>& normal, const Vector4<float>& tangent, int8_t out[4]) {
+		const Quaternion<float> q = encoding::ToQTangent(normal, tangent, encoding::QTangentBias8);
+		for (int i = 0; i < 4; ++i) {
+			out[i] = FloatToSnorm8(q.m[i]);
+		}
+	}
+
+	inline void DecodeQTangent(const int16_t in[4], Vector3<float>& normal, Vector4<float>& tangent) {
+		encoding::FromQTangent(Quaternion<float>(Snorm16ToFloat(in[0]), Snorm16ToFloat(in[1]), Snorm16ToFloat(in[2]), Snorm16ToFloat(in[3])), normal, tangent);
+	}
+
+	inline void DecodeQTangent(const int8_t in[4], Vector3<float>& normal, Vector4<float>& tangent) {
+		encoding::FromQTangent(Quaternion<float>(Snorm8ToFloat(in[0]), Snorm8ToFloat(in[1]), Snorm8ToFloat(in[2]), Snorm8ToFloat(in[3])), normal, tangent);
+	}
+
+	//配列版 (dst は要素あたり2個 / 4個)
+	void EncodeOctahedral(const Vector3<float>* src, int16_t* dst, size_t count);
+	void EncodeOctahedral(const Vector3<float>* src, int8_t* dst, size_t count);
+	void DecodeOctahedral(const int16_t* src, Vector3<float>* dst, size_t count);
+	void DecodeOctahedral(const int8_t* src, Vector3<float>* dst, size_t count);
+
+	void EncodeQTangent(const Vector3<float>* normals, const Vector4<float>* tangents, int16_t* dst, size_t count);
+	void EncodeQTangent(const Vector3<float>* normals, const Vector4<float>* tangents, int8_t* dst, size_t count);
+	void DecodeQTangent(const int16_t* src, Vector3<float>* normals, Vector4<float>* tangents, size_t count);
+	void DecodeQTangent(const int8_t* src, Vector3<float>* normals, Vector4<float>* tangents, size_t count);
+
+	struct AngularError {
+		//ラジアン
+		float max = 0;
+		float mean = 0;
+	};
+
+	//expected と actual の各組の角度誤差 (どちらも正規化されていなくてよい)
+	AngularError MeasureAngularError(const Vector3<float>* expected, const Vector3<float>* actual, size_t count);
+} // namespace mff
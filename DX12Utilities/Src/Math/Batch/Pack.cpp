@@ -0,0 +1,281 @@
+﻿#include "Pack.h"
+#include "../Simd/Simd.h"
+
+namespace mff {
+#if defined(MFF_SIMD_SSE)
+	namespace {
+		//FloatToHalf(float) と同じ手順を4要素で行う (結果は各レーンの下位16bit)
+		inline __m128i FloatToHalf4(__m128 f) {
+			const __m128i f16Max = _mm_set1_epi32((127 + 16) << 23);
+			const __m128i minNormal = _mm_set1_epi32(113 << 23);
+			const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+			const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+			const __m128 sign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(0x80000000u))));
+			const __m128 absF = _mm_xor_ps(f, sign);
+			const __m128i absBits = _mm_castps_si128(absF);
+
+			const __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absF, absF));
+			const __m128i isRegular = _mm_cmpgt_epi32(f16Max, absBits);
+			const __m128i infOrNan = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+			const __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absBits);
+			const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absF, _mm_castsi128_ps(denormMagic))), denormMagic);
+
+			const __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+			const __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, normalBias), mantissaOdd), 13);
+
+			const __m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+			const __m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNan));
+			//符号は算術シフトで上位16bitごと立てる (_mm_packs_epi32 で下位16bitがそのまま残る)
+			return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+		}
+
+		//HalfToFloat(uint16_t) と同じ結果を4要素で返す (h は各レーンの下位16bit)
+		inline __m128 HalfToFloat4(__m128i h) {
+			const __m128i expMantissa = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+			const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expMantissa), 16);
+			const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)), _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+			const __m128i wasInfNan = _mm_cmpgt_epi32(expMantissa, _mm_set1_epi32(0x7bff));
+			const __m128 infNanExp = _mm_and_ps(_mm_castsi128_ps(wasInfNan), _mm_castsi128_ps(_mm_set1_epi32(255 << 23)));
+			return _mm_or_ps(scaled, _mm_or_ps(_mm_castsi128_ps(sign), infNanExp));
+		}
+
+		//NaN を 0 にしてから [lo, hi] にクランプし、scale 倍して最近接偶数に丸める
+		inline __m128i Quantize4(__m128 v, __m128 lo, __m128 hi, __m128 scale) {
+			v = _mm_and_ps(v, _mm_cmpeq_ps(v, v));
+			return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v, lo), hi), scale));
+		}
+
+		inline __m128 Dequantize4(__m128i v, __m128 scale) {
+			return _mm_div_ps(_mm_cvtepi32_ps(v), scale);
+		}
+
+		inline __m128i LoadInt(const void* p) {
+			return _mm_loadu_si128(static_cast<const __m128i*>(p));
+		}
+
+		inline void StoreInt(void* p, __m128i v) {
+			_mm_storeu_si128(static_cast<__m128i*>(p), v);
+		}
+	} // namespace
+#endif
+
+	void FloatToHalf(const float* src, uint16_t* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		for (; i + 8 <= count; i += 8) {
+			StoreInt(dst + i, _mm_packs_epi32(FloatToHalf4(_mm_loadu_ps(src + i)), FloatToHalf4(_mm_loadu_ps(src + i + 4))));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = FloatToHalf(src[i]);
+		}
+	}
+
+	void HalfToFloat(const uint16_t* src, float* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 8 <= count; i += 8) {
+			const __m128i h = LoadInt(src + i);
+			_mm_storeu_ps(dst + i, HalfToFloat4(_mm_unpacklo_epi16(h, zero)));
+			_mm_storeu_ps(dst + i + 4, HalfToFloat4(_mm_unpackhi_epi16(h, zero)));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = HalfToFloat(src[i]);
+		}
+	}
+
+	void FloatToSnorm8(const float* src, int8_t* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 lo = _mm_set1_ps(-1.0f);
+		const __m128 hi = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(127.0f);
+		for (; i + 16 <= count; i += 16) {
+			const __m128i a = _mm_packs_epi32(Quantize4(_mm_loadu_ps(src + i), lo, hi, scale), Quantize4(_mm_loadu_ps(src + i + 4), lo, hi, scale));
+			const __m128i b = _mm_packs_epi32(Quantize4(_mm_loadu_ps(src + i + 8), lo, hi, scale), Quantize4(_mm_loadu_ps(src + i + 12), lo, hi, scale));
+			StoreInt(dst + i, _mm_packs_epi16(a, b));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = FloatToSnorm8(src[i]);
+		}
+	}
+
+	void Snorm8ToFloat(const int8_t* src, float* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 scale = _mm_set1_ps(127.0f);
+		const __m128 lo = _mm_set1_ps(-1.0f);
+		for (; i + 16 <= count; i += 16) {
+			const __m128i v = LoadInt(src + i);
+			//符号拡張 8bit -> 16bit -> 32bit
+			const __m128i v16[2] = { _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8), _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8) };
+			for (int k = 0; k < 2; ++k) {
+				const __m128i v32lo = _mm_srai_epi32(_mm_unpacklo_epi16(v16[k], v16[k]), 16);
+				const __m128i v32hi = _mm_srai_epi32(_mm_unpackhi_epi16(v16[k], v16[k]), 16);
+				_mm_storeu_ps(dst + i + k * 8, _mm_max_ps(Dequantize4(v32lo, scale), lo));
+				_mm_storeu_ps(dst + i + k * 8 + 4, _mm_max_ps(Dequantize4(v32hi, scale), lo));
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = Snorm8ToFloat(src[i]);
+		}
+	}
+
+	void FloatToSnorm16(const float* src, int16_t* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 lo = _mm_set1_ps(-1.0f);
+		const __m128 hi = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(32767.0f);
+		for (; i + 8 <= count; i += 8) {
+			StoreInt(dst + i, _mm_packs_epi32(Quantize4(_mm_loadu_ps(src + i), lo, hi, scale), Quantize4(_mm_loadu_ps(src + i + 4), lo, hi, scale)));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = FloatToSnorm16(src[i]);
+		}
+	}
+
+	void Snorm16ToFloat(const int16_t* src, float* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 scale = _mm_set1_ps(32767.0f);
+		const __m128 lo = _mm_set1_ps(-1.0f);
+		for (; i + 8 <= count; i += 8) {
+			const __m128i v = LoadInt(src + i);
+			_mm_storeu_ps(dst + i, _mm_max_ps(Dequantize4(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), scale), lo));
+			_mm_storeu_ps(dst + i + 4, _mm_max_ps(Dequantize4(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), scale), lo));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = Snorm16ToFloat(src[i]);
+		}
+	}
+
+	void FloatToUnorm8(const float* src, uint8_t* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 lo = _mm_setzero_ps();
+		const __m128 hi = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(255.0f);
+		for (; i + 16 <= count; i += 16) {
+			const __m128i a = _mm_packs_epi32(Quantize4(_mm_loadu_ps(src + i), lo, hi, scale), Quantize4(_mm_loadu_ps(src + i + 4), lo, hi, scale));
+			const __m128i b = _mm_packs_epi32(Quantize4(_mm_loadu_ps(src + i + 8), lo, hi, scale), Quantize4(_mm_loadu_ps(src + i + 12), lo, hi, scale));
+			StoreInt(dst + i, _mm_packus_epi16(a, b));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = FloatToUnorm8(src[i]);
+		}
+	}
+
+	void Unorm8ToFloat(const uint8_t* src, float* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 scale = _mm_set1_ps(255.0f);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= count; i += 16) {
+			const __m128i v = LoadInt(src + i);
+			const __m128i v16[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+			for (int k = 0; k < 2; ++k) {
+				_mm_storeu_ps(dst + i + k * 8, Dequantize4(_mm_unpacklo_epi16(v16[k], zero), scale));
+				_mm_storeu_ps(dst + i + k * 8 + 4, Dequantize4(_mm_unpackhi_epi16(v16[k], zero), scale));
+			}
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = Unorm8ToFloat(src[i]);
+		}
+	}
+
+	void FloatToUnorm16(const float* src, uint16_t* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 lo = _mm_setzero_ps();
+		const __m128 hi = _mm_set1_ps(1.0f);
+		const __m128 scale = _mm_set1_ps(65535.0f);
+		//SSE2には符号なし飽和パックが無いので、-32768 ずらして符号付きでパックし最上位ビットを戻す
+		const __m128i bias32 = _mm_set1_epi32(32768);
+		const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+		for (; i + 8 <= count; i += 8) {
+			const __m128i a = _mm_sub_epi32(Quantize4(_mm_loadu_ps(src + i), lo, hi, scale), bias32);
+			const __m128i b = _mm_sub_epi32(Quantize4(_mm_loadu_ps(src + i + 4), lo, hi, scale), bias32);
+			StoreInt(dst + i, _mm_xor_si128(_mm_packs_epi32(a, b), bias16));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = FloatToUnorm16(src[i]);
+		}
+	}
+
+	void Unorm16ToFloat(const uint16_t* src, float* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 scale = _mm_set1_ps(65535.0f);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 8 <= count; i += 8) {
+			const __m128i v = LoadInt(src + i);
+			_mm_storeu_ps(dst + i, Dequantize4(_mm_unpacklo_epi16(v, zero), scale));
+			_mm_storeu_ps(dst + i + 4, Dequantize4(_mm_unpackhi_epi16(v, zero), scale));
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = Unorm16ToFloat(src[i]);
+		}
+	}
+
+	void PackUnorm1010102(const Vector4<float>* src, uint32_t* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128 lo = _mm_setzero_ps();
+		const __m128 hi = _mm_set1_ps(1.0f);
+		const __m128 scaleRgb = _mm_set1_ps(1023.0f);
+		const __m128 scaleA = _mm_set1_ps(3.0f);
+		for (; i + 4 <= count; i += 4) {
+			__m128 r = _mm_loadu_ps(src[i + 0].m);
+			__m128 g = _mm_loadu_ps(src[i + 1].m);
+			__m128 b = _mm_loadu_ps(src[i + 2].m);
+			__m128 a = _mm_loadu_ps(src[i + 3].m);
+			simd::Transpose(r, g, b, a);
+			__m128i packed = Quantize4(r, lo, hi, scaleRgb);
+			packed = _mm_or_si128(packed, _mm_slli_epi32(Quantize4(g, lo, hi, scaleRgb), 10));
+			packed = _mm_or_si128(packed, _mm_slli_epi32(Quantize4(b, lo, hi, scaleRgb), 20));
+			packed = _mm_or_si128(packed, _mm_slli_epi32(Quantize4(a, lo, hi, scaleA), 30));
+			StoreInt(dst + i, packed);
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = PackUnorm1010102(src[i]);
+		}
+	}
+
+	void UnpackUnorm1010102(const uint32_t* src, Vector4<float>* dst, size_t count) {
+		size_t i = 0;
+#if defined(MFF_SIMD_SSE)
+		const __m128i mask = _mm_set1_epi32(0x3ff);
+		const __m128 scaleRgb = _mm_set1_ps(1023.0f);
+		const __m128 scaleA = _mm_set1_ps(3.0f);
+		for (; i + 4 <= count; i += 4) {
+			const __m128i v = LoadInt(src + i);
+			__m128 r = Dequantize4(_mm_and_si128(v, mask), scaleRgb);
+			__m128 g = Dequantize4(_mm_and_si128(_mm_srli_epi32(v, 10), mask), scaleRgb);
+			__m128 b = Dequantize4(_mm_and_si128(_mm_srli_epi32(v, 20), mask), scaleRgb);
+			__m128 a = Dequantize4(_mm_srli_epi32(v, 30), scaleA);
+			simd::Transpose(r, g, b, a);
+			_mm_storeu_ps(dst[i + 0].m, r);
+			_mm_storeu_ps(dst[i + 1].m, g);
+			_mm_storeu_ps(dst[i + 2].m, b);
+			_mm_storeu_ps(dst[i + 3].m, a);
+		}
+#endif
+		for (; i < count; ++i) {
+			dst[i] = UnpackUnorm1010102(src[i]);
+		}
+	}
+} // namespace mff
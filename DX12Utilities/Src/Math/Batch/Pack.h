@@ -0,0 +1,148 @@
+﻿#pragma once
+#include "../Vector/Vector4.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+頂点・テクスチャデータの圧縮フォーマット変換
+	half      : IEEE 754 binary16 (最近接偶数丸め、非正規化数・Inf・NaN対応)
+	snorm8/16 : [-1, 1] を [-127, 127] / [-32767, 32767] に対応させる (-128, -32768 は -1 として読む)
+	unorm8/16 : [0, 1] を [0, 255] / [0, 65535] に対応させる
+	R10G10B10A2 : unorm10 x3 + unorm2 (DXGI_FORMAT_R10G10B10A2_UNORM と同じビット配置)
+	float -> 整数 は範囲外をクランプし、NaN は 0 にする。丸めは最近接偶数
+	配列版はSSE2で処理し、単体版と同じ結果を返す
+*/
+namespace mff {
+	namespace pack {
+		inline uint32_t ToBits(float v) {
+			uint32_t ret;
+			memcpy(&ret, &v, sizeof(ret));
+			return ret;
+		}
+
+		inline float FromBits(uint32_t v) {
+			float ret;
+			memcpy(&ret, &v, sizeof(ret));
+			return ret;
+		}
+
+		//NaN を 0 にしてから [lo, hi] にクランプ
+		inline float Saturate(float v, float lo, float hi) {
+			if (!(v == v)) {
+				return 0.0f;
+			}
+			return v < lo ? lo : (v > hi ? hi : v);
+		}
+	} // namespace pack
+
+	inline uint16_t FloatToHalf(float v) {
+		const uint32_t f16Max = (127 + 16) << 23;
+		const uint32_t f32Infinity = 255 << 23;
+		const uint32_t denormMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+		uint32_t bits = pack::ToBits(v);
+		const uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint32_t ret;
+		if (bits >= f16Max) {
+			//Inf か NaN (NaN は quiet NaN にする)
+			ret = bits > f32Infinity ? 0x7e00 : 0x7c00;
+		}
+		else if (bits < (113u << 23)) {
+			//非正規化数か0 : 加算で仮数部を丸める
+			ret = pack::ToBits(pack::FromBits(bits) + pack::FromBits(denormMagic)) - denormMagic;
+		}
+		else {
+			const uint32_t mantissaOdd = (bits >> 13) & 1;
+			bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xfff;
+			bits += mantissaOdd;
+			ret = bits >> 13;
+		}
+		return static_cast<uint16_t>(ret | (sign >> 16));
+	}
+
+	inline float HalfToFloat(uint16_t v) {
+		const uint32_t shiftedExp = 0x7c00 << 13;
+		uint32_t bits = (v & 0x7fffu) << 13;
+		const uint32_t exp = bits & shiftedExp;
+		bits += (127 - 15) << 23;
+		if (exp == shiftedExp) {
+			bits += (128 - 16) << 23;
+		}
+		else if (exp == 0) {
+			bits += 1 << 23;
+			bits = pack::ToBits(pack::FromBits(bits) - pack::FromBits(113 << 23));
+		}
+		return pack::FromBits(bits | (static_cast<uint32_t>(v & 0x8000u) << 16));
+	}
+
+	inline int8_t FloatToSnorm8(float v) {
+		return static_cast<int8_t>(nearbyintf(pack::Saturate(v, -1.0f, 1.0f) * 127.0f));
+	}
+
+	inline float Snorm8ToFloat(int8_t v) {
+		float ret = static_cast<float>(v) / 127.0f;
+		return ret < -1.0f ? -1.0f : ret;
+	}
+
+	inline int16_t FloatToSnorm16(float v) {
+		return static_cast<int16_t>(nearbyintf(pack::Saturate(v, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	inline float Snorm16ToFloat(int16_t v) {
+		float ret = static_cast<float>(v) / 32767.0f;
+		return ret < -1.0f ? -1.0f : ret;
+	}
+
+	inline uint8_t FloatToUnorm8(float v) {
+		return static_cast<uint8_t>(nearbyintf(pack::Saturate(v, 0.0f, 1.0f) * 255.0f));
+	}
+
+	inline float Unorm8ToFloat(uint8_t v) {
+		return static_cast<float>(v) / 255.0f;
+	}
+
+	inline uint16_t FloatToUnorm16(float v) {
+		return static_cast<uint16_t>(nearbyintf(pack::Saturate(v, 0.0f, 1.0f) * 65535.0f));
+	}
+
+	inline float Unorm16ToFloat(uint16_t v) {
+		return static_cast<float>(v) / 65535.0f;
+	}
+
+	inline uint32_t PackUnorm1010102(const Vector4<float>& v) {
+		const uint32_t r = static_cast<uint32_t>(nearbyintf(pack::Saturate(v.x, 0.0f, 1.0f) * 1023.0f));
+		const uint32_t g = static_cast<uint32_t>(nearbyintf(pack::Saturate(v.y, 0.0f, 1.0f) * 1023.0f));
+		const uint32_t b = static_cast<uint32_t>(nearbyintf(pack::Saturate(v.z, 0.0f, 1.0f) * 1023.0f));
+		const uint32_t a = static_cast<uint32_t>(nearbyintf(pack::Saturate(v.w, 0.0f, 1.0f) * 3.0f));
+		return r | (g << 10) | (b << 20) | (a << 30);
+	}
+
+	inline Vector4<float> UnpackUnorm1010102(uint32_t v) {
+		return Vector4<float>(
+			static_cast<float>(v & 0x3ff) / 1023.0f,
+			static_cast<float>((v >> 10) & 0x3ff) / 1023.0f,
+			static_cast<float>((v >> 20) & 0x3ff) / 1023.0f,
+			static_cast<float>(v >> 30) / 3.0f
+			);
+	}
+
+	//配列版 (src と dst は重ならないこと)
+	void FloatToHalf(const float* src, uint16_t* dst, size_t count);
+	void HalfToFloat(const uint16_t* src, float* dst, size_t count);
+
+	void FloatToSnorm8(const float* src, int8_t* dst, size_t count);
+	void Snorm8ToFloat(const int8_t* src, float* dst, size_t count);
+	void FloatToSnorm16(const float* src, int16_t* dst, size_t count);
+	void Snorm16ToFloat(const int16_t* src, float* dst, size_t count);
+
+	void FloatToUnorm8(const float* src, uint8_t* dst, size_t count);
+	void Unorm8ToFloat(const uint8_t* src, float* dst, size_t count);
+	void FloatToUnorm16(const float* src, uint16_t* dst, size_t count);
+	void Unorm16ToFloat(const uint16_t* src, float* dst, size_t count);
+
+	void PackUnorm1010102(const Vector4<float>* src, uint32_t* dst, size_t count);
+	void UnpackUnorm1010102(const uint32_t* src, Vector4<float>* dst, size_t count);
+} // namespace mff
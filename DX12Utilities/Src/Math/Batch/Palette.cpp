@@ -0,0 +1,73 @@
+﻿#include "Palette.h"
+#include "ParallelFor.h"
+#include "../Simd/Simd.h"
+#include <string.h>
+
+namespace mff {
+	namespace {
+		//並列化する場合の1スレッドあたりの最小ボーン数
+		const size_t ParallelMinBones = 4096;
+
+		//lhs * rhs の上 rowCount 行を out に書き込む
+		template<int rowCount>
+		inline void MulRows(const Matrix4x4<float>& lhs, const Matrix4x4<float>& rhs, float* out) {
+			const simd::Float4 r0 = simd::Load(rhs.m + 0);
+			const simd::Float4 r1 = simd::Load(rhs.m + 4);
+			const simd::Float4 r2 = simd::Load(rhs.m + 8);
+			const simd::Float4 r3 = simd::Load(rhs.m + 12);
+			for (int row = 0; row < rowCount; ++row) {
+				simd::Store(out + row * 4, simd::MulRow(simd::Load(lhs.m + row * 4), r0, r1, r2, r3));
+			}
+		}
+
+		template<int rowCount>
+		void BuildRows(const Matrix4x4<float>* world, const Matrix4x4<float>* baseInv, size_t boneCount, void* dst) {
+			float* out = static_cast<float*>(dst);
+			for (size_t i = 0; i < boneCount; ++i) {
+				MulRows<rowCount>(world[i], baseInv[i], out);
+				out += rowCount * 4;
+			}
+		}
+	} // namespace
+
+	void PackPalette(const Matrix4x4<float>* src, size_t count, void* dst) {
+		float* out = static_cast<float*>(dst);
+		for (size_t i = 0; i < count; ++i) {
+			const float* in = src[i].m;
+			simd::Store(out + 0, simd::Load(in + 0));
+			simd::Store(out + 4, simd::Load(in + 4));
+			simd::Store(out + 8, simd::Load(in + 8));
+			out += 12;
+		}
+	}
+
+	void PackPalette(const Matrix4x3<float>* src, size_t count, void* dst) {
+		memcpy(dst, src, sizeof(Matrix4x3<float>) * count);
+	}
+
+	void ToMatrix4x3(const Matrix4x4<float>* src, Matrix4x3<float>* dst, size_t count) {
+		PackPalette(src, count, dst);
+	}
+
+	void BuildPalette(const Matrix4x4<float>* world, const Matrix4x4<float>* baseInv, size_t boneCount, void* dst, PaletteLayout layout) {
+		if (layout == PaletteLayout4x4) {
+			BuildRows<4>(world, baseInv, boneCount, dst);
+		}
+		else {
+			BuildRows<3>(world, baseInv, boneCount, dst);
+		}
+	}
+
+	void BuildPalettes(const PaletteJob* jobs, size_t jobCount, PaletteLayout layout, int threadCount) {
+		size_t totalBones = 0;
+		for (size_t i = 0; i < jobCount; ++i) {
+			totalBones += jobs[i].boneCount;
+		}
+		const size_t minJobs = totalBones ? (ParallelMinBones * jobCount + totalBones - 1) / totalBones : jobCount;
+		ParallelFor(jobCount, threadCount, minJobs, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				BuildPalette(jobs[i].world, jobs[i].baseInv, jobs[i].boneCount, jobs[i].dst, layout);
+			}
+		});
+	}
+} // namespace mff
\ No newline at end of file
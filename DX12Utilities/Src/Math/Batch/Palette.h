@@ -0,0 +1,42 @@
+﻿#pragma once
+#include "../Matrix/Matrix4x4.h"
+#include "../Matrix/Matrix4x3.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ボーン・インスタンス行列のパレット書き込み
+	行列の上3行(3x4, 48byte)だけを dst に連続して書き込む
+	dst はMapしたアップロードバッファを想定しているため読み戻しは行わない
+	(シェーダー側は float3x4 / row_major float4x3 として受け取る)
+*/
+namespace mff {
+	void PackPalette(const Matrix4x4<float>* src, size_t count, void* dst);
+	void PackPalette(const Matrix4x3<float>* src, size_t count, void* dst);
+
+	void ToMatrix4x3(const Matrix4x4<float>* src, Matrix4x3<float>* dst, size_t count);
+
+	/*
+	スキニングパレットの作成
+		palette[i] = world[i] * baseInv[i]
+		world はモデル空間のボーン行列 (ブレンドやリターゲット後)、baseInv は BoneData::baseInv
+		PaletteLayout3x4 は上3行 (48byte)、PaletteLayout4x4 は4行すべて (64byte) を dst に連続して書き込む
+	*/
+	enum PaletteLayout {
+		PaletteLayout3x4,
+		PaletteLayout4x4,
+	};
+
+	void BuildPalette(const Matrix4x4<float>* world, const Matrix4x4<float>* baseInv, size_t boneCount, void* dst, PaletteLayout layout = PaletteLayout3x4);
+
+	//複数スケルトン分をまとめて作る (dst はスケルトンごとに別の領域、CBの256byte境界などは呼び出し側で合わせる)
+	struct PaletteJob {
+		const Matrix4x4<float>* world = nullptr;
+		const Matrix4x4<float>* baseInv = nullptr;
+		size_t boneCount = 0;
+		void* dst = nullptr;
+	};
+
+	//threadCount が 1 以外でボーン数の合計が十分大きい場合はスケルトン単位で並列に処理する (0でハードウェアスレッド数)
+	void BuildPalettes(const PaletteJob* jobs, size_t jobCount, PaletteLayout layout = PaletteLayout3x4, int threadCount = 1);
+} // namespace mff
\ No newline at end of file
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+namespace mff {
+	/*
+	[0, count) を連続した区間に分割して func(begin, end) を並列に実行する
+
+	@param count       要素数
+	@param threadCount 使用するスレッド数 (0以下でハードウェアスレッド数)
+	@param minChunk    1スレッドが受け持つ最小要素数 (これより小さい分割はしない)
+	@param func        void(size_t begin, size_t end)
+	*/
+	template<typename Func>
+	void ParallelFor(size_t count, int threadCount, size_t minChunk, Func func) {
+		if (threadCount <= 0) {
+			threadCount = static_cast<int>(std::thread::hardware_concurrency());
+		}
+		if (minChunk == 0) {
+			minChunk = 1;
+		}
+		size_t maxThreads = (count + minChunk - 1) / minChunk;
+		size_t n = static_cast<size_t>(threadCount > 1 ? threadCount : 1);
+		n = n < maxThreads ? n : maxThreads;
+		if (n <= 1) {
+			if (count) {
+				func(static_cast<size_t>(0), count);
+			}
+			return;
+		}
+
+		size_t chunk = (count + n - 1) / n;
+		std::vector<std::thread> threads;
+		threads.reserve(n - 1);
+		for (size_t begin = chunk; begin < count; begin += chunk) {
+			size_t end = begin + chunk < count ? begin + chunk : count;
+			threads.emplace_back(func, begin, end);
+		}
+		func(static_cast<size_t>(0), chunk);
+		for (auto& t : threads) {
+			t.join();
+		}
+	}
+} // namespace mff
\ No newline at end of file
@@ -0,0 +1,186 @@
+﻿#include "QuaternionBatch.h"
+#include "../Simd/Simd.h"
+
+namespace mff {
+	namespace {
+		using namespace simd;
+
+		struct QuaternionLanes {
+			Float4 x, y, z, w;
+		};
+
+		//count(4以下)個を読み込み、足りない分は単位クォータニオンで埋める
+		inline QuaternionLanes LoadLanes(const Quaternion<float>* q, size_t count) {
+			Float4 r[4] = { Set(0, 0, 0, 1), Set(0, 0, 0, 1), Set(0, 0, 0, 1), Set(0, 0, 0, 1) };
+			for (size_t i = 0; i < count; ++i) {
+				r[i] = Load(q[i].m);
+			}
+			Transpose(r[0], r[1], r[2], r[3]);
+			return { r[0], r[1], r[2], r[3] };
+		}
+
+		inline void StoreLanes(Quaternion<float>* q, size_t count, const QuaternionLanes& lanes) {
+			Float4 r[4] = { lanes.x, lanes.y, lanes.z, lanes.w };
+			Transpose(r[0], r[1], r[2], r[3]);
+			for (size_t i = 0; i < count; ++i) {
+				Store(q[i].m, r[i]);
+			}
+		}
+
+		inline Float4 LoadT(const float* t, size_t count) {
+			float tmp[4] = {};
+			for (size_t i = 0; i < count; ++i) {
+				tmp[i] = t[i];
+			}
+			return Load(tmp);
+		}
+
+		inline Float4 DotLanes(const QuaternionLanes& a, const QuaternionLanes& b) {
+			return MulAdd(a.x, b.x, MulAdd(a.y, b.y, MulAdd(a.z, b.z, Mul(a.w, b.w))));
+		}
+
+		inline QuaternionLanes Blend(const QuaternionLanes& a, Float4 ta, const QuaternionLanes& b, Float4 tb) {
+			return {
+				MulAdd(a.x, ta, Mul(b.x, tb)),
+				MulAdd(a.y, ta, Mul(b.y, tb)),
+				MulAdd(a.z, ta, Mul(b.z, tb)),
+				MulAdd(a.w, ta, Mul(b.w, tb)),
+			};
+		}
+
+		inline QuaternionLanes MultiplyLanes(const QuaternionLanes& l, const QuaternionLanes& r) {
+			return {
+				Sub(MulAdd(l.w, r.x, MulAdd(l.x, r.w, Mul(l.y, r.z))), Mul(l.z, r.y)),
+				Sub(MulAdd(l.w, r.y, MulAdd(l.y, r.w, Mul(l.z, r.x))), Mul(l.x, r.z)),
+				Sub(MulAdd(l.w, r.z, MulAdd(l.x, r.y, Mul(l.z, r.w))), Mul(l.y, r.x)),
+				Sub(Mul(l.w, r.w), MulAdd(l.x, r.x, MulAdd(l.y, r.y, Mul(l.z, r.z)))),
+			};
+		}
+
+		inline QuaternionLanes NlerpLanes(const QuaternionLanes& a, const QuaternionLanes& b, Float4 t) {
+			Float4 negative = Less(DotLanes(a, b), Zero());
+			Float4 tb = Select(negative, Neg(t), t);
+			QuaternionLanes q = Blend(a, Sub(Splat(1.0f), t), b, tb);
+			Float4 len = Sqrt(DotLanes(q, q));
+			return { Div(q.x, len), Div(q.y, len), Div(q.z, len), Div(q.w, len) };
+		}
+
+		/*
+		多項式近似によるSlerp
+		D. Eberly, "A Fast and Accurate Algorithm for Computing SLERP"
+		sin(tθ)/sin(θ) を (cosθ - 1) の級数で展開し、12項目で打ち切る
+		最終項の補正係数は [0,1]x[0,1] で最大誤差が最小になるよう求めた値 (最大誤差 約7e-7)
+		*/
+		const int SlerpTermCount = 12;
+		const float SlerpOnePlusMu = 1.89372f;
+
+		struct SlerpCoefficients {
+			SlerpCoefficients() {
+				for (int i = 1; i <= SlerpTermCount; ++i) {
+					float correction = i == SlerpTermCount ? SlerpOnePlusMu : 1.0f;
+					u[i - 1] = correction / static_cast<float>(i * (2 * i + 1));
+					v[i - 1] = correction * static_cast<float>(i) / static_cast<float>(2 * i + 1);
+				}
+			}
+			float u[SlerpTermCount];
+			float v[SlerpTermCount];
+		};
+		const SlerpCoefficients slerpCoefficients;
+
+		inline QuaternionLanes SlerpLanes(const QuaternionLanes& a, const QuaternionLanes& b, Float4 t) {
+			const float* u = slerpCoefficients.u;
+			const float* v = slerpCoefficients.v;
+			const Float4 one = Splat(1.0f);
+			Float4 cosTheta = DotLanes(a, b);
+			Float4 negative = Less(cosTheta, Zero());
+			Float4 xm1 = Sub(Abs(cosTheta), one);
+			Float4 d = Sub(one, t);
+			Float4 sqrT = Mul(t, t);
+			Float4 sqrD = Mul(d, d);
+
+			Float4 polyT = one;
+			Float4 polyD = one;
+			for (int i = SlerpTermCount - 1; i >= 0; --i) {
+				Float4 bT = Mul(Sub(Mul(Splat(u[i]), sqrT), Splat(v[i])), xm1);
+				Float4 bD = Mul(Sub(Mul(Splat(u[i]), sqrD), Splat(v[i])), xm1);
+				polyT = MulAdd(bT, polyT, one);
+				polyD = MulAdd(bD, polyD, one);
+			}
+			Float4 cT = Mul(t, polyT);
+			Float4 cD = Mul(d, polyD);
+			cT = Select(negative, Neg(cT), cT);
+			return Blend(a, cD, b, cT);
+		}
+
+		template<typename Func>
+		void ForEachBlock(size_t count, Func func) {
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) {
+				func(i, static_cast<size_t>(4));
+			}
+			if (i < count) {
+				func(i, count - i);
+			}
+		}
+	} // namespace
+
+	void MultiplyQuaternions(const Quaternion<float>* lhs, const Quaternion<float>* rhs, Quaternion<float>* dst, size_t count) {
+		ForEachBlock(count, [&](size_t i, size_t n) {
+			StoreLanes(dst + i, n, MultiplyLanes(LoadLanes(lhs + i, n), LoadLanes(rhs + i, n)));
+		});
+	}
+
+	void NlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, float t, Quaternion<float>* dst, size_t count) {
+		const Float4 tt = Splat(t);
+		ForEachBlock(count, [&](size_t i, size_t n) {
+			StoreLanes(dst + i, n, NlerpLanes(LoadLanes(a + i, n), LoadLanes(b + i, n), tt));
+		});
+	}
+
+	void NlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, const float* t, Quaternion<float>* dst, size_t count) {
+		ForEachBlock(count, [&](size_t i, size_t n) {
+			StoreLanes(dst + i, n, NlerpLanes(LoadLanes(a + i, n), LoadLanes(b + i, n), LoadT(t + i, n)));
+		});
+	}
+
+	void SlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, float t, Quaternion<float>* dst, size_t count) {
+		const Float4 tt = Splat(t);
+		ForEachBlock(count, [&](size_t i, size_t n) {
+			StoreLanes(dst + i, n, SlerpLanes(LoadLanes(a + i, n), LoadLanes(b + i, n), tt));
+		});
+	}
+
+	void SlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, const float* t, Quaternion<float>* dst, size_t count) {
+		ForEachBlock(count, [&](size_t i, size_t n) {
+			StoreLanes(dst + i, n, SlerpLanes(LoadLanes(a + i, n), LoadLanes(b + i, n), LoadT(t + i, n)));
+		});
+	}
+
+	void QuaternionsToMatrices(const Quaternion<float>* src, Matrix4x4<float>* dst, size_t count) {
+		const Float4 one = Splat(1.0f);
+		const Float4 two = Splat(2.0f);
+		const Float4 lastRow = Set(0, 0, 0, 1);
+		ForEachBlock(count, [&](size_t i, size_t n) {
+			QuaternionLanes q = LoadLanes(src + i, n);
+			Float4 xx = Mul(q.x, q.x), yy = Mul(q.y, q.y), zz = Mul(q.z, q.z);
+			Float4 xy = Mul(q.x, q.y), xz = Mul(q.x, q.z), yz = Mul(q.y, q.z);
+			Float4 wx = Mul(q.w, q.x), wy = Mul(q.w, q.y), wz = Mul(q.w, q.z);
+
+			Float4 rows[3][4] = {
+				{ Sub(one, Mul(two, Add(yy, zz))), Mul(two, Sub(xy, wz)), Mul(two, Add(xz, wy)), Zero() },
+				{ Mul(two, Add(xy, wz)), Sub(one, Mul(two, Add(xx, zz))), Mul(two, Sub(yz, wx)), Zero() },
+				{ Mul(two, Sub(xz, wy)), Mul(two, Add(yz, wx)), Sub(one, Mul(two, Add(xx, yy))), Zero() },
+			};
+			for (int row = 0; row < 3; ++row) {
+				Transpose(rows[row][0], rows[row][1], rows[row][2], rows[row][3]);
+			}
+			for (size_t k = 0; k < n; ++k) {
+				Matrix4x4<float>& mat = dst[i + k];
+				Store(mat.m + 0, rows[0][k]);
+				Store(mat.m + 4, rows[1][k]);
+				Store(mat.m + 8, rows[2][k]);
+				Store(mat.m + 12, lastRow);
+			}
+		});
+	}
+} // namespace mff
\ No newline at end of file
@@ -0,0 +1,23 @@
+﻿#pragma once
+#include "../Quaternion/Quaternion.h"
+#include "../Matrix/Matrix4x4.h"
+#include <stddef.h>
+
+/*
+クォータニオン配列の一括処理
+	4個ずつSIMDレーンに並べて処理する
+	Slerp は acos/sin を使わない多項式近似 (最大誤差 約1e-6) で計算するため、
+	Slerp(const Quaternion<T>&...) の結果とは最下位ビットが一致しないことがある
+*/
+namespace mff {
+	void MultiplyQuaternions(const Quaternion<float>* lhs, const Quaternion<float>* rhs, Quaternion<float>* dst, size_t count);
+
+	void NlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, float t, Quaternion<float>* dst, size_t count);
+	void NlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, const float* t, Quaternion<float>* dst, size_t count);
+
+	void SlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, float t, Quaternion<float>* dst, size_t count);
+	void SlerpQuaternions(const Quaternion<float>* a, const Quaternion<float>* b, const float* t, Quaternion<float>* dst, size_t count);
+
+	//回転行列への変換 (平行移動は0)
+	void QuaternionsToMatrices(const Quaternion<float>* src, Matrix4x4<float>* dst, size_t count);
+} // namespace mff
\ No newline at end of file
@@ -0,0 +1,154 @@
+﻿#include "TRSBatch.h"
+#include "../Simd/Simd.h"
+
+namespace mff {
+	namespace {
+		using namespace simd;
+
+		struct Vec3Lanes {
+			Float4 x, y, z;
+		};
+
+		inline Float4 LengthLanes(const Vec3Lanes& v) {
+			return Sqrt(Add(Add(Mul(v.x, v.x), Mul(v.y, v.y)), Mul(v.z, v.z)));
+		}
+
+		inline Float4 DotLanes(const Vec3Lanes& a, const Vec3Lanes& b) {
+			return Add(Add(Mul(a.x, b.x), Mul(a.y, b.y)), Mul(a.z, b.z));
+		}
+
+		//Decompose の通常経路を4行列同時に行う。戻り値は Decompose で処理し直す要素のビット
+		int DecomposeLanes(const Matrix4x4<float>* src, TRS<float>* dst) {
+			Float4 rows[3][4];
+			for (int r = 0; r < 3; ++r) {
+				for (int i = 0; i < 4; ++i) {
+					rows[r][i] = Load(src[i].m + r * 4);
+				}
+				//rows[r][c] のレーン i が src[i] の (r, c)
+				Transpose(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+			}
+			const Vec3Lanes c0 = { rows[0][0], rows[1][0], rows[2][0] };
+			const Vec3Lanes c1 = { rows[0][1], rows[1][1], rows[2][1] };
+			const Vec3Lanes c2 = { rows[0][2], rows[1][2], rows[2][2] };
+
+			const Float4 l0 = LengthLanes(c0);
+			const Float4 l1 = LengthLanes(c1);
+			const Float4 l2 = LengthLanes(c2);
+			const Float4 maxLength = Select(Greater(l0, l1), Select(Greater(l0, l2), l0, l2), Select(Greater(l1, l2), l1, l2));
+			const Float4 tolerance = Mul(Mul(maxLength, Splat(std::numeric_limits<float>::epsilon())), Splat(8.0f));
+
+			const Vec3Lanes a0 = { Div(c0.x, l0), Div(c0.y, l0), Div(c0.z, l0) };
+			const Float4 d = DotLanes(a0, c1);
+			const Vec3Lanes r1 = { Sub(c1.x, Mul(a0.x, d)), Sub(c1.y, Mul(a0.y, d)), Sub(c1.z, Mul(a0.z, d)) };
+			const Float4 lr1 = LengthLanes(r1);
+			const Vec3Lanes a1 = { Div(r1.x, lr1), Div(r1.y, lr1), Div(r1.z, lr1) };
+			const Vec3Lanes a2 = {
+				Sub(Mul(a0.y, a1.z), Mul(a0.z, a1.y)),
+				Sub(Mul(a0.z, a1.x), Mul(a0.x, a1.z)),
+				Sub(Mul(a0.x, a1.y), Mul(a0.y, a1.x)),
+			};
+			const int regular = MoveMask(And(And(Greater(maxLength, Zero()), Greater(l0, tolerance)), Greater(lr1, tolerance)));
+
+			//ToQuaternion の4つの分岐をすべて計算してレーンごとに選ぶ (m00 = a0.x, m11 = a1.y, m22 = a2.z)
+			const Float4 one = Splat(1.0f);
+			const Float4 trace = Add(Add(a0.x, a1.y), a2.z);
+			const Float4 caseA = Greater(trace, Zero());
+			const Float4 caseB = And(Greater(a0.x, a1.y), Greater(a0.x, a2.z));
+			const Float4 caseC = Greater(a1.y, a2.z);
+			const Float4 radicand = Select(caseA, Add(trace, one),
+				Select(caseB, Sub(Sub(Add(one, a0.x), a1.y), a2.z),
+				Select(caseC, Sub(Sub(Add(one, a1.y), a0.x), a2.z),
+				Sub(Sub(Add(one, a2.z), a0.x), a1.y))));
+			const Float4 s = Mul(Sqrt(radicand), Splat(2.0f));
+			const Float4 quarter = Mul(s, Splat(0.25f));
+			const Float4 d21 = Div(Sub(a1.z, a2.y), s);
+			const Float4 d02 = Div(Sub(a2.x, a0.z), s);
+			const Float4 d10 = Div(Sub(a0.y, a1.x), s);
+			const Float4 s01 = Div(Add(a1.x, a0.y), s);
+			const Float4 s02 = Div(Add(a2.x, a0.z), s);
+			const Float4 s12 = Div(Add(a2.y, a1.z), s);
+			Float4 qx = Select(caseA, d21, Select(caseB, quarter, Select(caseC, s01, s02)));
+			Float4 qy = Select(caseA, d02, Select(caseB, s01, Select(caseC, quarter, s12)));
+			Float4 qz = Select(caseA, d10, Select(caseB, s02, Select(caseC, s12, quarter)));
+			Float4 qw = Select(caseA, quarter, Select(caseB, d21, Select(caseC, d02, d10)));
+			const Float4 qLength = Sqrt(Add(Add(Add(Mul(qx, qx), Mul(qy, qy)), Mul(qz, qz)), Mul(qw, qw)));
+			qx = Div(qx, qLength);
+			qy = Div(qy, qLength);
+			qz = Div(qz, qLength);
+			qw = Div(qw, qLength);
+
+			//要素ごとに書き出す
+			Float4 rot[4] = { qx, qy, qz, qw };
+			Transpose(rot[0], rot[1], rot[2], rot[3]);
+			float tx[4], ty[4], tz[4], sx[4], sy[4], sz[4];
+			Store(tx, rows[0][3]);
+			Store(ty, rows[1][3]);
+			Store(tz, rows[2][3]);
+			Store(sx, DotLanes(a0, c0));
+			Store(sy, DotLanes(a1, c1));
+			Store(sz, DotLanes(a2, c2));
+			for (int i = 0; i < 4; ++i) {
+				dst[i].translation = Vector3<float>(tx[i], ty[i], tz[i]);
+				Store(dst[i].rotation.m, rot[i]);
+				dst[i].scale = Vector3<float>(sx[i], sy[i], sz[i]);
+			}
+			return ~regular & 0xf;
+		}
+
+		void ComposeLanes(const TRS<float>* src, Matrix4x4<float>* dst) {
+			const Float4 one = Splat(1.0f);
+			const Float4 two = Splat(2.0f);
+			Float4 q[4] = { Load(src[0].rotation.m), Load(src[1].rotation.m), Load(src[2].rotation.m), Load(src[3].rotation.m) };
+			Transpose(q[0], q[1], q[2], q[3]);
+			const Float4 sx = Set(src[0].scale.x, src[1].scale.x, src[2].scale.x, src[3].scale.x);
+			const Float4 sy = Set(src[0].scale.y, src[1].scale.y, src[2].scale.y, src[3].scale.y);
+			const Float4 sz = Set(src[0].scale.z, src[1].scale.z, src[2].scale.z, src[3].scale.z);
+			const Float4 xx = Mul(q[0], q[0]), yy = Mul(q[1], q[1]), zz = Mul(q[2], q[2]);
+			const Float4 xy = Mul(q[0], q[1]), xz = Mul(q[0], q[2]), yz = Mul(q[1], q[2]);
+			const Float4 wx = Mul(q[3], q[0]), wy = Mul(q[3], q[1]), wz = Mul(q[3], q[2]);
+			Float4 rows[3][4] = {
+				{ Mul(Sub(one, Mul(two, Add(yy, zz))), sx), Mul(Mul(two, Sub(xy, wz)), sy), Mul(Mul(two, Add(xz, wy)), sz),
+					Set(src[0].translation.x, src[1].translation.x, src[2].translation.x, src[3].translation.x) },
+				{ Mul(Mul(two, Add(xy, wz)), sx), Mul(Sub(one, Mul(two, Add(xx, zz))), sy), Mul(Mul(two, Sub(yz, wx)), sz),
+					Set(src[0].translation.y, src[1].translation.y, src[2].translation.y, src[3].translation.y) },
+				{ Mul(Mul(two, Sub(xz, wy)), sx), Mul(Mul(two, Add(yz, wx)), sy), Mul(Sub(one, Mul(two, Add(xx, yy))), sz),
+					Set(src[0].translation.z, src[1].translation.z, src[2].translation.z, src[3].translation.z) },
+			};
+			const Float4 lastRow = Set(0, 0, 0, 1);
+			for (int r = 0; r < 3; ++r) {
+				Transpose(rows[r][0], rows[r][1], rows[r][2], rows[r][3]);
+				for (int i = 0; i < 4; ++i) {
+					Store(dst[i].m + r * 4, rows[r][i]);
+				}
+			}
+			for (int i = 0; i < 4; ++i) {
+				Store(dst[i].m + 12, lastRow);
+			}
+		}
+	} // namespace
+
+	void DecomposeMatrices(const Matrix4x4<float>* src, TRS<float>* dst, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const int irregular = DecomposeLanes(src + i, dst + i);
+			for (int k = 0; k < 4; ++k) {
+				if (irregular >> k & 1) {
+					dst[i + k] = Decompose(src[i + k]);
+				}
+			}
+		}
+		for (; i < count; ++i) {
+			dst[i] = Decompose(src[i]);
+		}
+	}
+
+	void TRSToMatrices(const TRS<float>* src, Matrix4x4<float>* dst, size_t count) {
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			ComposeLanes(src + i, dst + i);
+		}
+		for (; i < count; ++i) {
+			dst[i] = ToMatrix4x4(src[i]);
+		}
+	}
+} // namespace mff
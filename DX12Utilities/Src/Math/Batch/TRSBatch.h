@@ -0,0 +1,14 @@
+﻿#pragma once
+#include "../Matrix/TRS.h"
+#include <stddef.h>
+
+/*
+TRS と行列の一括変換
+	4個ずつSIMDレーンに並べて処理し、Decompose / ToMatrix4x4 と同じ結果を返す
+	長さ0の軸を含む行列はその要素だけ Decompose で処理する
+	src == dst にはできない (型が異なるため)
+*/
+namespace mff {
+	void DecomposeMatrices(const Matrix4x4<float>* src, TRS<float>* dst, size_t count);
+	void TRSToMatrices(const TRS<float>* src, Matrix4x4<float>* dst, size_t count);
+} // namespace mff
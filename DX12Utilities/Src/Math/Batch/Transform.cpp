@@ -0,0 +1,227 @@
+﻿#include "Transform.h"
+#include "ParallelFor.h"
+#include "../Simd/Simd.h"
+
+namespace mff {
+	namespace {
+		using namespace simd;
+
+		//これ以下の要素数は分割しない
+		const size_t ParallelMinChunk = 16384;
+
+		enum TransformMode {
+			TransformMode_Point,
+			TransformMode_Direction,
+			TransformMode_Normal,
+		};
+
+		//行列の各要素を全レーンに複製したもの
+		struct SplatMatrix {
+			explicit SplatMatrix(const Matrix4x4<float>& mat) {
+				for (int i = 0; i < 16; ++i) {
+					m[i] = Splat(mat.m[i]);
+				}
+			}
+			Float4 m[16];
+		};
+
+		//4要素分の x, y, z を同時に変換する
+		template<TransformMode Mode>
+		inline void TransformLanes(const SplatMatrix& s, Float4& x, Float4& y, Float4& z) {
+			Float4 ox = MulAdd(s.m[0], x, MulAdd(s.m[1], y, Mul(s.m[2], z)));
+			Float4 oy = MulAdd(s.m[4], x, MulAdd(s.m[5], y, Mul(s.m[6], z)));
+			Float4 oz = MulAdd(s.m[8], x, MulAdd(s.m[9], y, Mul(s.m[10], z)));
+			if (Mode == TransformMode_Point) {
+				ox = Add(ox, s.m[3]);
+				oy = Add(oy, s.m[7]);
+				oz = Add(oz, s.m[11]);
+			}
+			if (Mode == TransformMode_Normal) {
+				Float4 len = Sqrt(MulAdd(ox, ox, MulAdd(oy, oy, Mul(oz, oz))));
+				ox = Div(ox, len);
+				oy = Div(oy, len);
+				oz = Div(oz, len);
+			}
+			x = ox;
+			y = oy;
+			z = oz;
+		}
+
+		inline void TransformLanes4(const SplatMatrix& s, Float4& x, Float4& y, Float4& z, Float4& w) {
+			Float4 ox = MulAdd(s.m[0], x, MulAdd(s.m[1], y, MulAdd(s.m[2], z, Mul(s.m[3], w))));
+			Float4 oy = MulAdd(s.m[4], x, MulAdd(s.m[5], y, MulAdd(s.m[6], z, Mul(s.m[7], w))));
+			Float4 oz = MulAdd(s.m[8], x, MulAdd(s.m[9], y, MulAdd(s.m[10], z, Mul(s.m[11], w))));
+			Float4 ow = MulAdd(s.m[12], x, MulAdd(s.m[13], y, MulAdd(s.m[14], z, Mul(s.m[15], w))));
+			x = ox;
+			y = oy;
+			z = oz;
+			w = ow;
+		}
+
+		template<TransformMode Mode>
+		void TransformVector3Range(const SplatMatrix& s, const Vector3<float>* src, Vector3<float>* dst, size_t begin, size_t end) {
+			Float4 x, y, z;
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4) {
+				LoadXYZ(src[i].m, x, y, z);
+				TransformLanes<Mode>(s, x, y, z);
+				StoreXYZ(dst[i].m, x, y, z);
+			}
+			if (i < end) {
+				float tmp[12] = {};
+				const size_t rest = end - i;
+				for (size_t r = 0; r < rest; ++r) {
+					tmp[r * 3 + 0] = src[i + r].x;
+					tmp[r * 3 + 1] = src[i + r].y;
+					tmp[r * 3 + 2] = src[i + r].z;
+				}
+				LoadXYZ(tmp, x, y, z);
+				TransformLanes<Mode>(s, x, y, z);
+				StoreXYZ(tmp, x, y, z);
+				for (size_t r = 0; r < rest; ++r) {
+					dst[i + r] = Vector3<float>(tmp[r * 3 + 0], tmp[r * 3 + 1], tmp[r * 3 + 2]);
+				}
+			}
+		}
+
+		template<TransformMode Mode>
+		inline void TransformVector4Block(const SplatMatrix& s, Float4& r0, Float4& r1, Float4& r2, Float4& r3) {
+			Transpose(r0, r1, r2, r3);
+			if (Mode == TransformMode_Point) {
+				TransformLanes4(s, r0, r1, r2, r3);
+			}
+			else {
+				TransformLanes<Mode>(s, r0, r1, r2);
+			}
+			Transpose(r0, r1, r2, r3);
+		}
+
+		template<TransformMode Mode>
+		void TransformVector4Range(const SplatMatrix& s, const Vector4<float>* src, Vector4<float>* dst, size_t begin, size_t end) {
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4) {
+				Float4 r0 = Load(src[i + 0].m);
+				Float4 r1 = Load(src[i + 1].m);
+				Float4 r2 = Load(src[i + 2].m);
+				Float4 r3 = Load(src[i + 3].m);
+				TransformVector4Block<Mode>(s, r0, r1, r2, r3);
+				Store(dst[i + 0].m, r0);
+				Store(dst[i + 1].m, r1);
+				Store(dst[i + 2].m, r2);
+				Store(dst[i + 3].m, r3);
+			}
+			if (i < end) {
+				const size_t rest = end - i;
+				Float4 r[4] = { Zero(), Zero(), Zero(), Zero() };
+				for (size_t k = 0; k < rest; ++k) {
+					r[k] = Load(src[i + k].m);
+				}
+				TransformVector4Block<Mode>(s, r[0], r[1], r[2], r[3]);
+				for (size_t k = 0; k < rest; ++k) {
+					Store(dst[i + k].m, r[k]);
+				}
+			}
+		}
+
+		template<TransformMode Mode>
+		void TransformSoARange(const SplatMatrix& s, const float* x, const float* y, const float* z,
+			float* outX, float* outY, float* outZ, size_t begin, size_t end) {
+			Float4 vx, vy, vz;
+			size_t i = begin;
+			for (; i + 4 <= end; i += 4) {
+				vx = Load(x + i);
+				vy = Load(y + i);
+				vz = Load(z + i);
+				TransformLanes<Mode>(s, vx, vy, vz);
+				Store(outX + i, vx);
+				Store(outY + i, vy);
+				Store(outZ + i, vz);
+			}
+			if (i < end) {
+				float tx[4] = {}, ty[4] = {}, tz[4] = {};
+				const size_t rest = end - i;
+				for (size_t r = 0; r < rest; ++r) {
+					tx[r] = x[i + r];
+					ty[r] = y[i + r];
+					tz[r] = z[i + r];
+				}
+				vx = Load(tx);
+				vy = Load(ty);
+				vz = Load(tz);
+				TransformLanes<Mode>(s, vx, vy, vz);
+				Store(tx, vx);
+				Store(ty, vy);
+				Store(tz, vz);
+				for (size_t r = 0; r < rest; ++r) {
+					outX[i + r] = tx[r];
+					outY[i + r] = ty[r];
+					outZ[i + r] = tz[r];
+				}
+			}
+		}
+
+		template<TransformMode Mode>
+		void TransformVector3(const Matrix4x4<float>& mat, const Vector3<float>* src, Vector3<float>* dst, size_t count, int threadCount) {
+			const SplatMatrix s(mat);
+			ParallelFor(count, threadCount, ParallelMinChunk, [&](size_t begin, size_t end) {
+				TransformVector3Range<Mode>(s, src, dst, begin, end);
+			});
+		}
+
+		template<TransformMode Mode>
+		void TransformVector4(const Matrix4x4<float>& mat, const Vector4<float>* src, Vector4<float>* dst, size_t count, int threadCount) {
+			const SplatMatrix s(mat);
+			ParallelFor(count, threadCount, ParallelMinChunk, [&](size_t begin, size_t end) {
+				TransformVector4Range<Mode>(s, src, dst, begin, end);
+			});
+		}
+
+		template<TransformMode Mode>
+		void TransformSoA(const Matrix4x4<float>& mat, const float* x, const float* y, const float* z,
+			float* outX, float* outY, float* outZ, size_t count, int threadCount) {
+			const SplatMatrix s(mat);
+			ParallelFor(count, threadCount, ParallelMinChunk, [&](size_t begin, size_t end) {
+				TransformSoARange<Mode>(s, x, y, z, outX, outY, outZ, begin, end);
+			});
+		}
+	} // namespace
+
+	void TransformPoints(const Matrix4x4<float>& mat, const Vector3<float>* src, Vector3<float>* dst, size_t count, int threadCount) {
+		TransformVector3<TransformMode_Point>(mat, src, dst, count, threadCount);
+	}
+
+	void TransformDirections(const Matrix4x4<float>& mat, const Vector3<float>* src, Vector3<float>* dst, size_t count, int threadCount) {
+		TransformVector3<TransformMode_Direction>(mat, src, dst, count, threadCount);
+	}
+
+	void TransformNormals(const Matrix4x4<float>& mat, const Vector3<float>* src, Vector3<float>* dst, size_t count, int threadCount) {
+		TransformVector3<TransformMode_Normal>(mat, src, dst, count, threadCount);
+	}
+
+	void TransformPoints(const Matrix4x4<float>& mat, const Vector4<float>* src, Vector4<float>* dst, size_t count, int threadCount) {
+		TransformVector4<TransformMode_Point>(mat, src, dst, count, threadCount);
+	}
+
+	void TransformDirections(const Matrix4x4<float>& mat, const Vector4<float>* src, Vector4<float>* dst, size_t count, int threadCount) {
+		TransformVector4<TransformMode_Direction>(mat, src, dst, count, threadCount);
+	}
+
+	void TransformNormals(const Matrix4x4<float>& mat, const Vector4<float>* src, Vector4<float>* dst, size_t count, int threadCount) {
+		TransformVector4<TransformMode_Normal>(mat, src, dst, count, threadCount);
+	}
+
+	void TransformPoints(const Matrix4x4<float>& mat, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, size_t count, int threadCount) {
+		TransformSoA<TransformMode_Point>(mat, x, y, z, outX, outY, outZ, count, threadCount);
+	}
+
+	void TransformDirections(const Matrix4x4<float>& mat, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, size_t count, int threadCount) {
+		TransformSoA<TransformMode_Direction>(mat, x, y, z, outX, outY, outZ, count, threadCount);
+	}
+
+	void TransformNormals(const Matrix4x4<float>& mat, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, size_t count, int threadCount) {
+		TransformSoA<TransformMode_Normal>(mat, x, y, z, outX, outY, outZ, count, threadCount);
+	}
+} // namespace mff
\ No newline at end of file
@@ -0,0 +1,35 @@
+﻿#pragma once
+#include "../Vector/Vector3.h"
+#include "../Vector/Vector4.h"
+#include "../Matrix/Matrix4x4.h"
+#include <stddef.h>
+
+/*
+配列の一括変換
+	Point     : mat * (x, y, z, 1)
+	Direction : 平行移動を除いた3x3部分のみ適用
+	Normal    : Directionの結果を正規化 (法線用の行列は呼び出し側で用意すること)
+
+	Vector4版の Point は (x, y, z, w) 全体に行列を掛ける
+	Vector4版の Direction / Normal は w をそのまま残す (tangentの符号など)
+
+	src == dst (in-place) を許可する
+	threadCount が 1 以外で要素数が十分大きい場合は区間を分割して並列に処理する (0でハードウェアスレッド数)
+*/
+namespace mff {
+	void TransformPoints(const Matrix4x4<float>& mat, const Vector3<float>* src, Vector3<float>* dst, size_t count, int threadCount = 1);
+	void TransformDirections(const Matrix4x4<float>& mat, const Vector3<float>* src, Vector3<float>* dst, size_t count, int threadCount = 1);
+	void TransformNormals(const Matrix4x4<float>& mat, const Vector3<float>* src, Vector3<float>* dst, size_t count, int threadCount = 1);
+
+	void TransformPoints(const Matrix4x4<float>& mat, const Vector4<float>* src, Vector4<float>* dst, size_t count, int threadCount = 1);
+	void TransformDirections(const Matrix4x4<float>& mat, const Vector4<float>* src, Vector4<float>* dst, size_t count, int threadCount = 1);
+	void TransformNormals(const Matrix4x4<float>& mat, const Vector4<float>* src, Vector4<float>* dst, size_t count, int threadCount = 1);
+
+	//SoA (x[], y[], z[]) 版
+	void TransformPoints(const Matrix4x4<float>& mat, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, size_t count, int threadCount = 1);
+	void TransformDirections(const Matrix4x4<float>& mat, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, size_t count, int threadCount = 1);
+	void TransformNormals(const Matrix4x4<float>& mat, const float* x, const float* y, const float* z,
+		float* outX, float* outY, float* outZ, size_t count, int threadCount = 1);
+} // namespace mff
\ No newline at end of file
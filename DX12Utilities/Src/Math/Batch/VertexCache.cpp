@@ -0,0 +1,144 @@
+﻿#include "VertexCache.h"
+#include <string.h>
+#include <vector>
+
+namespace mff {
+	VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize) {
+		VertexCacheStatistics stats;
+		const size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return stats;
+		}
+		//[vertex] キャッシュに入れた時の transformCount (0 は未使用)
+		//FIFO なので、入れてから cacheSize 回以上ミスが起きていれば追い出されている
+		std::vector<size_t> inserted(vertexCount);
+		const size_t size = cacheSize > 0 ? static_cast<size_t>(cacheSize) : 0;
+		for (size_t i = 0; i < triangleCount * 3; ++i) {
+			const uint32_t v = indices[i];
+			if (v >= vertexCount) {
+				++stats.transformCount;
+				continue;
+			}
+			if (inserted[v] == 0 || stats.transformCount - inserted[v] >= size) {
+				++stats.transformCount;
+				inserted[v] = stats.transformCount;
+			}
+		}
+		stats.acmr = static_cast<float>(stats.transformCount) / triangleCount;
+		stats.atvr = vertexCount > 0 ? static_cast<float>(stats.transformCount) / vertexCount : 0;
+		return stats;
+	}
+
+	bool OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize) {
+		const size_t triangleCount = indexCount / 3;
+		const size_t cornerCount = triangleCount * 3;
+		//端数はそのまま
+		if (indexCount > cornerCount) {
+			memcpy(dst + cornerCount, indices + cornerCount, (indexCount - cornerCount) * sizeof(uint32_t));
+		}
+		for (size_t i = 0; i < cornerCount; ++i) {
+			if (indices[i] >= vertexCount) {
+				memcpy(dst, indices, cornerCount * sizeof(uint32_t));
+				return false;
+			}
+		}
+		if (triangleCount == 0) {
+			return true;
+		}
+
+		//[vertex] 隣接三角形 (CSR)。縮退三角形は同じ頂点に重複して入る
+		std::vector<uint32_t> adjacencyStart(vertexCount + 1);
+		for (size_t i = 0; i < cornerCount; ++i) {
+			++adjacencyStart[indices[i] + 1];
+		}
+		for (size_t v = 0; v < vertexCount; ++v) {
+			adjacencyStart[v + 1] += adjacencyStart[v];
+		}
+		std::vector<uint32_t> adjacency(cornerCount);
+		{
+			std::vector<uint32_t> fill(adjacencyStart.begin(), adjacencyStart.end() - 1);
+			for (size_t i = 0; i < cornerCount; ++i) {
+				adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		}
+		//[vertex] まだ出力していない隣接三角形の数
+		std::vector<uint32_t> liveCount(vertexCount);
+		for (size_t v = 0; v < vertexCount; ++v) {
+			liveCount[v] = adjacencyStart[v + 1] - adjacencyStart[v];
+		}
+		//[vertex] キャッシュに入った時刻。time - cacheTime[v] > k なら追い出されている
+		const size_t k = cacheSize > 0 ? static_cast<size_t>(cacheSize) : 0;
+		std::vector<size_t> cacheTime(vertexCount);
+		size_t time = k + 1;
+		std::vector<bool> emitted(triangleCount);
+		//行き止まりで戻る候補 (出力した頂点を順に積む)
+		std::vector<uint32_t> deadEnd;
+		deadEnd.reserve(cornerCount);
+		//次の扇の候補 (直前の扇で出力した頂点)
+		std::vector<uint32_t> candidates;
+		size_t cursor = 0;
+		size_t written = 0;
+
+		size_t fan = indices[0];
+		for (;;) {
+			candidates.clear();
+			for (uint32_t a = adjacencyStart[fan]; a < adjacencyStart[fan + 1]; ++a) {
+				const uint32_t t = adjacency[a];
+				if (emitted[t]) {
+					continue;
+				}
+				emitted[t] = true;
+				for (int c = 0; c < 3; ++c) {
+					const uint32_t v = indices[t * 3 + c];
+					dst[written++] = v;
+					deadEnd.push_back(v);
+					candidates.push_back(v);
+					--liveCount[v];
+					if (time - cacheTime[v] > k) {
+						cacheTime[v] = time++;
+					}
+				}
+			}
+
+			//キャッシュに残っていて、扇を出し切ってもまだ残りそうな頂点のうち一番古いものを選ぶ
+			ptrdiff_t next = -1;
+			size_t bestPriority = 0;
+			for (uint32_t v : candidates) {
+				if (liveCount[v] == 0) {
+					continue;
+				}
+				size_t priority = 0;
+				//扇で新しく入る頂点は高々 2 * liveCount
+				if (time - cacheTime[v] + 2 * liveCount[v] <= k) {
+					priority = time - cacheTime[v];
+				}
+				if (next < 0 || priority > bestPriority) {
+					next = v;
+					bestPriority = priority;
+				}
+			}
+			if (next < 0) {
+				//直前に出力した頂点から戻り、なければ頂点番号順に探す
+				while (!deadEnd.empty()) {
+					const uint32_t v = deadEnd.back();
+					deadEnd.pop_back();
+					if (liveCount[v] > 0) {
+						next = v;
+						break;
+					}
+				}
+				while (next < 0 && cursor < vertexCount) {
+					if (liveCount[cursor] > 0) {
+						next = static_cast<ptrdiff_t>(cursor);
+					}
+					++cursor;
+				}
+				if (next < 0) {
+					break;
+				}
+			}
+			fan = static_cast<size_t>(next);
+		}
+		return true;
+	}
+} // namespace mff
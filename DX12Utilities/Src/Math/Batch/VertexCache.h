@@ -0,0 +1,45 @@
+﻿#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+頂点変換後キャッシュ (post-transform vertex cache) に合わせた三角形の並べ替え
+	インデックス列は三角形リスト (3つで1三角形)。端数のインデックスはそのまま末尾に残す
+	AnalyzeVertexCache  : cacheSize 個の FIFO キャッシュを通した時の変換回数を数える
+		ACMR = 変換回数 / 三角形数 (理想は 0.5 前後、最悪 3)
+		ATVR = 変換回数 / 頂点数 (理想は 1)
+	OptimizeVertexCache : Tipsify (Sander et al. 2007) で三角形の順序を並べ替える
+		頂点から扇状に三角形を出力し、次の頂点をキャッシュに残っている隣接頂点から選ぶ
+		三角形数・頂点数に対して線形時間 (頂点の次数や cacheSize によらない)
+		三角形ごとの頂点の順序 (表裏) と三角形の集合は変えない。頂点配列は並べ替えない
+*/
+namespace mff {
+	struct VertexCacheStatistics {
+		//キャッシュミスで頂点シェーダーを実行した回数
+		size_t transformCount = 0;
+		float acmr = 0;
+		float atvr = 0;
+	};
+
+	/**
+	* FIFO キャッシュの変換回数と ACMR / ATVR
+	*
+	* @param   indices     インデックス列
+	* @param   indexCount  インデックス数
+	* @param   vertexCount 頂点数 (ATVR の分母)。範囲外のインデックスは毎回ミスとして数える
+	* @param   cacheSize   キャッシュの頂点数
+	*/
+	VertexCacheStatistics AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize = 16);
+
+	/**
+	* 三角形の順序を並べ替える
+	*
+	* @param   dst         出力先 (indexCount 個。indices と同じ領域は不可)
+	* @param   indices     インデックス列
+	* @param   indexCount  インデックス数
+	* @param   vertexCount 頂点数
+	* @param   cacheSize   想定するキャッシュの頂点数
+	* @retval  false       vertexCount 以上のインデックスがある (dst には indices をそのまま写す)
+	*/
+	bool OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, size_t indexCount, size_t vertexCount, int cacheSize = 16);
+} // namespace mff
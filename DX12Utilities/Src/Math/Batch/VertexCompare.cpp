@@ -0,0 +1,10 @@
+﻿#include "VertexCompare.h"
+
+namespace mff {
+	void QuantizedHashes(const void* vertices, size_t stride, size_t offset, size_t floatCount, size_t vertexCount, float tolerance, uint64_t* dst) {
+		const unsigned char* base = static_cast<const unsigned char*>(vertices) + offset;
+		for (size_t i = 0; i < vertexCount; ++i) {
+			dst[i] = QuantizedHash(reinterpret_cast<const float*>(base + i * stride), floatCount, tolerance);
+		}
+	}
+} // namespace mff
@@ -0,0 +1,133 @@
+﻿#pragma once
+#include "../MathFunctions.h"
+#include "../Simd/Simd.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+頂点の許容誤差付き比較と量子化ハッシュ (重複頂点の統合・キャッシュ用)
+	NearlyEqual : float 列を4要素ずつ分岐なしで比較する。各成分の判定は FloatEqual と同じ
+	              (|a - b| < epsilon または |a - b| < max(|a|, |b|) * epsilon)
+	Quantize    : 各成分を tolerance / 2 幅の格子で切り下げた値をキーにする
+	              キーが一致する2値の差は tolerance 未満なので、有限値ならキー一致で NearlyEqual(.., tolerance) も成り立つ
+	              逆は成り立たない (許容誤差内でも格子の境界をまたぐと別キーになる)。
+	              統合漏れにはなるが誤って統合することはない。ビットが同じ値は必ず同じキーになる
+	              -0 と +0 は同じキーにする。NaN はビット列がそのままキーになる
+	HashKeys    : キー列の64bitハッシュ (FNV-1a + 最終撹拌)。環境によらず同じ値を返す
+*/
+namespace mff {
+	namespace simd {
+		//切り下げ。|v| >= 2^23 (整数・Inf・NaN) はそのまま返す
+		inline Float4 Floor(Float4 v) {
+			const Float4 magic = Splat(8388608.0f);
+			//|v| を最近接に丸めて符号を戻す
+			const Float4 rounded = Or(Sub(Add(Abs(v), magic), magic), And(v, Splat(-0.0f)));
+			const Float4 floored = Sub(rounded, And(Greater(rounded, v), Splat(1.0f)));
+			return Select(Less(Abs(v), magic), floored, v);
+		}
+
+		//NearlyEqual の成分ごとの判定 (成立で全ビット1)
+		inline Float4 NearlyEqualMask(Float4 a, Float4 b, Float4 epsilon) {
+			const Float4 relative = Mul(Max(Abs(a), Abs(b)), epsilon);
+			return Less(Abs(Sub(a, b)), Max(epsilon, relative));
+		}
+	} // namespace simd
+
+	inline bool NearlyEqual(const float* a, const float* b, size_t count, float epsilon = static_cast<float>(MFF_FEPSILON)) {
+#if defined(MFF_SIMD_SCALAR)
+		bool ret = true;
+		for (size_t i = 0; i < count; ++i) {
+			ret &= NearlyEqual(a[i], b[i], epsilon);
+		}
+		return ret;
+#else
+		const simd::Float4 eps = simd::Splat(epsilon);
+		simd::Float4 all = simd::Less(simd::Zero(), simd::Splat(1.0f));
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			all = simd::And(all, simd::NearlyEqualMask(simd::Load(a + i), simd::Load(b + i), eps));
+		}
+		if (i < count) {
+			//端数は0で埋める (epsilon > 0 なら一致扱い、epsilon <= 0 ならそもそも全体が不一致)
+			float ta[4] = {}, tb[4] = {};
+			memcpy(ta, a + i, (count - i) * sizeof(float));
+			memcpy(tb, b + i, (count - i) * sizeof(float));
+			all = simd::And(all, simd::NearlyEqualMask(simd::Load(ta), simd::Load(tb), eps));
+		}
+		return simd::MoveMask(all) == 0xf;
+#endif
+	}
+
+	//Quantize に渡す格子幅の逆数
+	inline float QuantizeScale(float tolerance) {
+		return 2.0f / tolerance;
+	}
+
+	//単体版 (Quantize と同じ結果)
+	inline uint32_t QuantizeKey(float v, float scale) {
+		const float key = floorf(v * scale) + 0.0f;
+		uint32_t ret;
+		memcpy(&ret, &key, sizeof(ret));
+		return ret;
+	}
+
+	//keys[i] = QuantizeKey(src[i], QuantizeScale(tolerance))
+	inline void Quantize(const float* src, size_t count, float tolerance, uint32_t* keys) {
+		const float scale = QuantizeScale(tolerance);
+		const simd::Float4 s = simd::Splat(scale);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			float tmp[4];
+			simd::Store(tmp, simd::Add(simd::Floor(simd::Mul(simd::Load(src + i), s)), simd::Zero()));
+			memcpy(keys + i, tmp, sizeof(tmp));
+		}
+		for (; i < count; ++i) {
+			keys[i] = QuantizeKey(src[i], scale);
+		}
+	}
+
+	namespace hash {
+		const uint64_t Seed = 0xcbf29ce484222325ull;
+
+		inline uint64_t Accumulate(uint64_t h, const uint32_t* keys, size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				h = (h ^ keys[i]) * 0x100000001b3ull;
+			}
+			return h;
+		}
+
+		//下位ビットをテーブルのインデックスに使えるように撹拌する
+		inline uint64_t Finalize(uint64_t h) {
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			h *= 0xc4ceb9fe1a85ec53ull;
+			h ^= h >> 33;
+			return h;
+		}
+	} // namespace hash
+
+	inline uint64_t HashKeys(const uint32_t* keys, size_t count) {
+		return hash::Finalize(hash::Accumulate(hash::Seed, keys, count));
+	}
+
+	//HashKeys(Quantize(src)) と同じ値
+	inline uint64_t QuantizedHash(const float* src, size_t count, float tolerance) {
+		uint32_t keys[16];
+		uint64_t h = hash::Seed;
+		for (size_t i = 0; i < count; i += 16) {
+			const size_t n = count - i < 16 ? count - i : 16;
+			Quantize(src + i, n, tolerance, keys);
+			h = hash::Accumulate(h, keys, n);
+		}
+		return hash::Finalize(h);
+	}
+
+	/*
+	頂点配列の一括ハッシュ
+		各頂点の先頭から offset バイトの位置にある floatCount 個の float を QuantizedHash する
+		stride は頂点のバイト数
+	*/
+	void QuantizedHashes(const void* vertices, size_t stride, size_t offset, size_t floatCount, size_t vertexCount, float tolerance, uint64_t* dst);
+} // namespace mff
@@ -0,0 +1,79 @@
+﻿#pragma once
+#include "../Vector/Vector3.h"
+#include "../Vector/Vector4.h"
+#include "../Matrix/Matrix4x4.h"
+#include <stddef.h>
+#include <limits>
+
+namespace mff {
+	/*
+	軸並行境界ボックス
+	デフォルトは空の箱 (lower > upper) で、Merge で広げていく
+	*/
+	template<typename T>
+	struct AABB {
+		constexpr AABB() : lower((std::numeric_limits<T>::max)()), upper((std::numeric_limits<T>::lowest)()) {}
+		constexpr AABB(const Vector3<T>& lower, const Vector3<T>& upper) : lower(lower), upper(upper) {}
+
+		constexpr bool IsEmpty() const {
+			return lower.x > upper.x || lower.y > upper.y || lower.z > upper.z;
+		}
+
+		constexpr Vector3<T> Center() const {
+			return (lower + upper) * static_cast<T>(0.5);
+		}
+
+		//各軸の半分の大きさ
+		constexpr Vector3<T> Extents() const {
+			return (upper - lower) * static_cast<T>(0.5);
+		}
+
+		constexpr void Merge(const Vector3<T>& p) {
+			lower = Vector3<T>(p.x < lower.x ? p.x : lower.x, p.y < lower.y ? p.y : lower.y, p.z < lower.z ? p.z : lower.z);
+			upper = Vector3<T>(p.x > upper.x ? p.x : upper.x, p.y > upper.y ? p.y : upper.y, p.z > upper.z ? p.z : upper.z);
+		}
+
+		constexpr void Merge(const AABB& box) {
+			Merge(box.lower);
+			Merge(box.upper);
+		}
+
+		Vector3<T> lower;
+		Vector3<T> upper;
+	};
+
+	template<typename T>
+	AABB<T> ToAABB(const Vector3<T>* points, size_t count) {
+		AABB<T> ret;
+		for (size_t i = 0; i < count; ++i) {
+			ret.Merge(points[i]);
+		}
+		return ret;
+	}
+
+	template<typename T>
+	constexpr bool Contains(const AABB<T>& box, const Vector3<T>& p) {
+		return p.x >= box.lower.x && p.y >= box.lower.y && p.z >= box.lower.z
+			&& p.x <= box.upper.x && p.y <= box.upper.y && p.z <= box.upper.z;
+	}
+
+	template<typename T>
+	constexpr bool Intersects(const AABB<T>& a, const AABB<T>& b) {
+		return a.lower.x <= b.upper.x && a.lower.y <= b.upper.y && a.lower.z <= b.upper.z
+			&& b.lower.x <= a.upper.x && b.lower.y <= a.upper.y && b.lower.z <= a.upper.z;
+	}
+
+	//変換後の箱を包むAABB (中心を変換し、半分の大きさに |M| を掛ける)
+	template<typename T>
+	AABB<T> Transform(const Matrix4x4<T>& mat, const AABB<T>& box) {
+		const Vector3<T> c = box.Center();
+		const Vector3<T> e = box.Extents();
+		Vector3<T> center, extents;
+		for (int row = 0; row < 3; ++row) {
+			const Vector4<T>& r = mat.v[row];
+			center.m[row] = r.x * c.x + r.y * c.y + r.z * c.z + r.w;
+			extents.m[row] = static_cast<T>(fabs(r.x)) * e.x + static_cast<T>(fabs(r.y)) * e.y + static_cast<T>(fabs(r.z)) * e.z;
+		}
+		return AABB<T>(center - extents, center + extents);
+	}
+} // namespace mff
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include "AABB.h"
+
+namespace mff {
+	template<typename T>
+	struct BoundingSphere {
+		constexpr BoundingSphere() : center(0), radius(0) {}
+		constexpr BoundingSphere(const Vector3<T>& center, T radius) : center(center), radius(radius) {}
+
+		Vector3<T> center;
+		T radius;
+	};
+
+	//AABBを包む球
+	template<typename T>
+	BoundingSphere<T> ToBoundingSphere(const AABB<T>& box) {
+		return BoundingSphere<T>(box.Center(), box.Extents().Length());
+	}
+
+	//点群を包む球 (AABBの中心からの最大距離、最小球ではない)
+	template<typename T>
+	BoundingSphere<T> ToBoundingSphere(const Vector3<T>* points, size_t count) {
+		const Vector3<T> center = ToAABB(points, count).Center();
+		T sqrRadius = 0;
+		for (size_t i = 0; i < count; ++i) {
+			const Vector3<T> d = points[i] - center;
+			const T sqrLength = dot(d, d);
+			sqrRadius = sqrLength > sqrRadius ? sqrLength : sqrRadius;
+		}
+		return BoundingSphere<T>(center, static_cast<T>(sqrt(sqrRadius)));
+	}
+
+	template<typename T>
+	constexpr bool Contains(const BoundingSphere<T>& sphere, const Vector3<T>& p) {
+		return (p - sphere.center).LengthSq() <= sphere.radius * sphere.radius;
+	}
+
+	template<typename T>
+	constexpr bool Intersects(const BoundingSphere<T>& a, const BoundingSphere<T>& b) {
+		return (a.center - b.center).LengthSq() <= (a.radius + b.radius) * (a.radius + b.radius);
+	}
+
+	template<typename T>
+	constexpr bool Intersects(const BoundingSphere<T>& sphere, const AABB<T>& box) {
+		const Vector3<T> closest(
+			sphere.center.x < box.lower.x ? box.lower.x : (sphere.center.x > box.upper.x ? box.upper.x : sphere.center.x),
+			sphere.center.y < box.lower.y ? box.lower.y : (sphere.center.y > box.upper.y ? box.upper.y : sphere.center.y),
+			sphere.center.z < box.lower.z ? box.lower.z : (sphere.center.z > box.upper.z ? box.upper.z : sphere.center.z));
+		return (closest - sphere.center).LengthSq() <= sphere.radius * sphere.radius;
+	}
+
+	template<typename T>
+	constexpr bool Intersects(const AABB<T>& box, const BoundingSphere<T>& sphere) {
+		return Intersects(sphere, box);
+	}
+
+	//変換後の球 (半径は3軸のうち最大の拡大率で拡大する)
+	template<typename T>
+	BoundingSphere<T> Transform(const Matrix4x4<T>& mat, const BoundingSphere<T>& sphere) {
+		const Vector4<T> c = mat * Vector4<T>(sphere.center, 1);
+		T sqrScale = 0;
+		for (int column = 0; column < 3; ++column) {
+			const Vector3<T> axis(mat.v[0].m[column], mat.v[1].m[column], mat.v[2].m[column]);
+			const T s = axis.LengthSq();
+			sqrScale = s > sqrScale ? s : sqrScale;
+		}
+		return BoundingSphere<T>(Vector3<T>(c.x, c.y, c.z), sphere.radius * static_cast<T>(sqrt(sqrScale)));
+	}
+} // namespace mff
@@ -0,0 +1,121 @@
+﻿#pragma once
+#include "AABB.h"
+#include "BoundingSphere.h"
+#include "OBB.h"
+
+namespace mff {
+	//dot(normal, p) + d = 0 の平面
+	template<typename T>
+	struct Plane {
+		constexpr Plane() : normal(0, 1, 0), d(0) {}
+		constexpr Plane(const Vector3<T>& normal, T d) : normal(normal), d(d) {}
+
+		//符号付き距離 (normal が正規化されている場合)
+		constexpr T Distance(const Vector3<T>& p) const {
+			return dot(normal, p) + d;
+		}
+
+		Vector3<T> normal;
+		T d;
+	};
+
+	template<typename T>
+	Plane<T> Normalize(const Plane<T>& plane) {
+		const T inv = static_cast<T>(1) / plane.normal.Length();
+		return Plane<T>(plane.normal * inv, plane.d * inv);
+	}
+
+	/*
+	視錐台 (6平面、法線は内向き)
+	各判定は平面ごとに外側かどうかを調べる保守的な判定で、
+	角付近の外側にあるものを可視と判定することがある
+	*/
+	template<typename T>
+	struct Frustum {
+		enum {
+			Left,
+			Right,
+			Bottom,
+			Top,
+			Near,
+			Far,
+			PlaneCount,
+		};
+
+		Plane<T> planes[PlaneCount];
+	};
+
+	/*
+	ビュー・プロジェクション行列から視錐台を作る
+		clip = viewProj * (x, y, z, 1) の列ベクトル形式
+		深度範囲は D3D と同じ 0 <= z <= w
+	*/
+	template<typename T>
+	Frustum<T> ToFrustum(const Matrix4x4<T>& viewProj) {
+		const Vector4<T>& r0 = viewProj.v[0];
+		const Vector4<T>& r1 = viewProj.v[1];
+		const Vector4<T>& r2 = viewProj.v[2];
+		const Vector4<T>& r3 = viewProj.v[3];
+		const Vector4<T> planes[Frustum<T>::PlaneCount] = {
+			r3 + r0,
+			r3 - r0,
+			r3 + r1,
+			r3 - r1,
+			r2,
+			r3 - r2,
+		};
+		Frustum<T> ret;
+		for (int i = 0; i < Frustum<T>::PlaneCount; ++i) {
+			ret.planes[i] = Normalize(Plane<T>(Vector3<T>(planes[i].x, planes[i].y, planes[i].z), planes[i].w));
+		}
+		return ret;
+	}
+
+	template<typename T>
+	bool Intersects(const Frustum<T>& frustum, const Vector3<T>& p) {
+		for (const Plane<T>& plane : frustum.planes) {
+			if (plane.Distance(p) < 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename T>
+	bool Intersects(const Frustum<T>& frustum, const BoundingSphere<T>& sphere) {
+		for (const Plane<T>& plane : frustum.planes) {
+			if (plane.Distance(sphere.center) < -sphere.radius) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename T>
+	bool Intersects(const Frustum<T>& frustum, const AABB<T>& box) {
+		const Vector3<T> c = box.Center();
+		const Vector3<T> e = box.Extents();
+		for (const Plane<T>& plane : frustum.planes) {
+			const Vector3<T>& n = plane.normal;
+			const T r = static_cast<T>(fabs(n.x)) * e.x + static_cast<T>(fabs(n.y)) * e.y + static_cast<T>(fabs(n.z)) * e.z;
+			if (plane.Distance(c) < -r) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename T>
+	bool Intersects(const Frustum<T>& frustum, const OBB<T>& box) {
+		for (const Plane<T>& plane : frustum.planes) {
+			const Vector3<T>& n = plane.normal;
+			const T r = static_cast<T>(fabs(dot(n, box.axis[0]))) * box.extents.x
+				+ static_cast<T>(fabs(dot(n, box.axis[1]))) * box.extents.y
+				+ static_cast<T>(fabs(dot(n, box.axis[2]))) * box.extents.z;
+			if (plane.Distance(box.center) < -r) {
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace mff
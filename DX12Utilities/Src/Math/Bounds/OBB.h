@@ -0,0 +1,60 @@
+﻿#pragma once
+#include "AABB.h"
+
+namespace mff {
+	/*
+	有向境界ボックス
+	axis は正規直交基底、extents は各軸方向の半分の大きさ
+	*/
+	template<typename T>
+	struct OBB {
+		constexpr OBB() : center(0), axis{ Vector3<T>(1, 0, 0), Vector3<T>(0, 1, 0), Vector3<T>(0, 0, 1) }, extents(0) {}
+		constexpr OBB(const Vector3<T>& center, const Vector3<T>& axisX, const Vector3<T>& axisY, const Vector3<T>& axisZ, const Vector3<T>& extents)
+			: center(center), axis{ axisX, axisY, axisZ }, extents(extents) {}
+
+		Vector3<T> center;
+		Vector3<T> axis[3];
+		Vector3<T> extents;
+	};
+
+	//AABB を mat (回転・スケール・平行移動、せん断なし) で変換したOBB
+	template<typename T>
+	OBB<T> ToOBB(const Matrix4x4<T>& mat, const AABB<T>& box) {
+		const Vector3<T> c = box.Center();
+		const Vector3<T> e = box.Extents();
+		OBB<T> ret;
+		for (int row = 0; row < 3; ++row) {
+			const Vector4<T>& r = mat.v[row];
+			ret.center.m[row] = r.x * c.x + r.y * c.y + r.z * c.z + r.w;
+		}
+		for (int column = 0; column < 3; ++column) {
+			const Vector3<T> axis(mat.v[0].m[column], mat.v[1].m[column], mat.v[2].m[column]);
+			const T length = axis.Length();
+			ret.axis[column] = length > 0 ? axis / length : ret.axis[column];
+			ret.extents.m[column] = e.m[column] * length;
+		}
+		return ret;
+	}
+
+	template<typename T>
+	AABB<T> ToAABB(const OBB<T>& box) {
+		Vector3<T> extents;
+		for (int i = 0; i < 3; ++i) {
+			extents.m[i] = static_cast<T>(fabs(box.axis[0].m[i])) * box.extents.x
+				+ static_cast<T>(fabs(box.axis[1].m[i])) * box.extents.y
+				+ static_cast<T>(fabs(box.axis[2].m[i])) * box.extents.z;
+		}
+		return AABB<T>(box.center - extents, box.center + extents);
+	}
+
+	template<typename T>
+	bool Contains(const OBB<T>& box, const Vector3<T>& p) {
+		const Vector3<T> d = p - box.center;
+		for (int i = 0; i < 3; ++i) {
+			if (static_cast<T>(fabs(dot(d, box.axis[i]))) > box.extents.m[i]) {
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace mff
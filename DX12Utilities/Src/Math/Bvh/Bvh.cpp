@@ -0,0 +1,517 @@
+﻿#include "Bvh.h"
+#include "../Batch/ParallelFor.h"
+#include "../Simd/Simd.h"
+#include <algorithm>
+#include <mutex>
+#include <string.h>
+
+namespace mff {
+	namespace {
+		using namespace simd;
+
+		//葉の最大三角形数 (TrianglePacket 1つ分)
+		const uint32_t LeafSize = 4;
+		const int BinCount = 16;
+		//これより深い2分木ノードは中央で分割する (走査スタックの上限を保証するため)
+		const int MaxSahDepth = 48;
+		//ビン分けを並列化する最小三角形数
+		const size_t ParallelMinTriangles = 1 << 16;
+		//部分木を別タスクで構築する最小三角形数
+		const size_t TaskMinTriangles = 4096;
+		const int StackSize = 512;
+
+		float Area(const AABB<float>& box) {
+			if (box.IsEmpty()) {
+				return 0;
+			}
+			const Vector3<float> d = box.upper - box.lower;
+			return d.x * d.y + d.y * d.z + d.z * d.x;
+		}
+
+		struct BuildNode {
+			bool IsLeaf() const { return left < 0; }
+
+			AABB<float> box;
+			int left = -1;
+			int right = -1;
+			uint32_t begin = 0;
+			uint32_t end = 0;
+		};
+
+		struct Bin {
+			AABB<float> box;
+			uint32_t count = 0;
+		};
+
+		struct BuildTask {
+			uint32_t begin;
+			uint32_t end;
+			int depth;
+			int node;
+		};
+
+		//範囲の境界と重心の境界
+		struct RangeBounds {
+			AABB<float> box;
+			AABB<float> centers;
+		};
+
+		class Builder {
+		public:
+			Builder(const std::vector<AABB<float> >& boxes, const std::vector<Vector3<float> >& centers, std::vector<uint32_t>& refs, int threadCount)
+				: boxes(boxes), centers(centers), refs(refs), threadCount(threadCount) {}
+
+			//tasks が nullptr でなければ taskSize 以下の部分木は構築せずタスクとして積む
+			int Build(uint32_t begin, uint32_t end, int depth, std::vector<BuildNode>& out, std::vector<BuildTask>* tasks, size_t taskSize) {
+				const int index = static_cast<int>(out.size());
+				out.push_back(BuildNode());
+				const RangeBounds bounds = ComputeBounds(begin, end);
+				out[index].box = bounds.box;
+				out[index].begin = begin;
+				out[index].end = end;
+				const uint32_t count = end - begin;
+				if (count <= LeafSize) {
+					return index;
+				}
+				if (tasks && count <= taskSize) {
+					tasks->push_back({ begin, end, depth, index });
+					return index;
+				}
+				const uint32_t mid = Split(begin, end, depth, bounds);
+				const int left = Build(begin, mid, depth + 1, out, tasks, taskSize);
+				const int right = Build(mid, end, depth + 1, out, tasks, taskSize);
+				out[index].left = left;
+				out[index].right = right;
+				return index;
+			}
+
+		private:
+			template<typename Func>
+			void ForRange(uint32_t begin, uint32_t end, Func func) {
+				if (end - begin < ParallelMinTriangles || threadCount == 1) {
+					func(begin, end);
+					return;
+				}
+				ParallelFor(end - begin, threadCount, ParallelMinTriangles, [&](size_t b, size_t e) {
+					func(begin + static_cast<uint32_t>(b), begin + static_cast<uint32_t>(e));
+				});
+			}
+
+			RangeBounds ComputeBounds(uint32_t begin, uint32_t end) {
+				RangeBounds ret;
+				std::mutex mutex;
+				ForRange(begin, end, [&](uint32_t b, uint32_t e) {
+					RangeBounds local;
+					for (uint32_t i = b; i < e; ++i) {
+						local.box.Merge(boxes[refs[i]]);
+						local.centers.Merge(centers[refs[i]]);
+					}
+					std::lock_guard<std::mutex> lock(mutex);
+					ret.box.Merge(local.box);
+					ret.centers.Merge(local.centers);
+				});
+				return ret;
+			}
+
+			static int ToBin(float c, float lower, float scale) {
+				const int bin = static_cast<int>((c - lower) * scale);
+				return bin < 0 ? 0 : (bin < BinCount ? bin : BinCount - 1);
+			}
+
+			//SAHで分割位置を決めて refs を並べ替え、右側の先頭を返す
+			uint32_t Split(uint32_t begin, uint32_t end, int depth, const RangeBounds& bounds) {
+				const uint32_t mid = begin + (end - begin) / 2;
+				if (depth >= MaxSahDepth) {
+					return SplitMedian(begin, end, mid, bounds);
+				}
+				float scale[3];
+				for (int axis = 0; axis < 3; ++axis) {
+					const float extent = bounds.centers.upper.m[axis] - bounds.centers.lower.m[axis];
+					scale[axis] = extent > 0 ? BinCount * (1.0f - 1e-6f) / extent : 0.0f;
+				}
+
+				Bin bins[3][BinCount];
+				std::mutex mutex;
+				ForRange(begin, end, [&](uint32_t b, uint32_t e) {
+					Bin local[3][BinCount];
+					for (uint32_t i = b; i < e; ++i) {
+						const uint32_t ref = refs[i];
+						for (int axis = 0; axis < 3; ++axis) {
+							Bin& bin = local[axis][ToBin(centers[ref].m[axis], bounds.centers.lower.m[axis], scale[axis])];
+							bin.box.Merge(boxes[ref]);
+							++bin.count;
+						}
+					}
+					std::lock_guard<std::mutex> lock(mutex);
+					for (int axis = 0; axis < 3; ++axis) {
+						for (int k = 0; k < BinCount; ++k) {
+							bins[axis][k].box.Merge(local[axis][k].box);
+							bins[axis][k].count += local[axis][k].count;
+						}
+					}
+				});
+
+				float bestCost = (std::numeric_limits<float>::max)();
+				int bestAxis = -1;
+				int bestSplit = 0;
+				for (int axis = 0; axis < 3; ++axis) {
+					if (scale[axis] == 0.0f) {
+						continue;
+					}
+					//右から累積した面積と個数
+					float rightArea[BinCount];
+					uint32_t rightCount[BinCount];
+					AABB<float> box;
+					uint32_t count = 0;
+					for (int k = BinCount - 1; k > 0; --k) {
+						box.Merge(bins[axis][k].box);
+						count += bins[axis][k].count;
+						rightArea[k] = Area(box);
+						rightCount[k] = count;
+					}
+					box = AABB<float>();
+					count = 0;
+					//bin k 以降を右にする
+					for (int k = 1; k < BinCount; ++k) {
+						box.Merge(bins[axis][k - 1].box);
+						count += bins[axis][k - 1].count;
+						if (count == 0 || rightCount[k] == 0) {
+							continue;
+						}
+						const float cost = Area(box) * count + rightArea[k] * rightCount[k];
+						if (cost < bestCost) {
+							bestCost = cost;
+							bestAxis = axis;
+							bestSplit = k;
+						}
+					}
+				}
+				if (bestAxis < 0) {
+					return SplitMedian(begin, end, mid, bounds);
+				}
+				const float lower = bounds.centers.lower.m[bestAxis];
+				const float axisScale = scale[bestAxis];
+				uint32_t* split = std::partition(refs.data() + begin, refs.data() + end, [&](uint32_t ref) {
+					return ToBin(centers[ref].m[bestAxis], lower, axisScale) < bestSplit;
+				});
+				return static_cast<uint32_t>(split - refs.data());
+			}
+
+			//重心の最も広い軸で個数を半分に分ける
+			uint32_t SplitMedian(uint32_t begin, uint32_t end, uint32_t mid, const RangeBounds& bounds) {
+				const Vector3<float> extent = bounds.centers.upper - bounds.centers.lower;
+				const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+				std::nth_element(refs.data() + begin, refs.data() + mid, refs.data() + end, [&](uint32_t a, uint32_t b) {
+					return centers[a].m[axis] < centers[b].m[axis];
+				});
+				return mid;
+			}
+
+			const std::vector<AABB<float> >& boxes;
+			const std::vector<Vector3<float> >& centers;
+			std::vector<uint32_t>& refs;
+			int threadCount;
+		};
+
+		//タスクで作った部分木を out に繋ぐ (部分木の根は local[0])
+		void Attach(std::vector<BuildNode>& out, int node, const std::vector<BuildNode>& local) {
+			const int offset = static_cast<int>(out.size()) - 1;
+			auto relocate = [offset](BuildNode n) {
+				if (!n.IsLeaf()) {
+					n.left += offset;
+					n.right += offset;
+				}
+				return n;
+			};
+			out[node] = relocate(local[0]);
+			for (size_t i = 1; i < local.size(); ++i) {
+				out.push_back(relocate(local[i]));
+			}
+		}
+	} // namespace
+
+	bool Bvh::AddTriangles(const void* positions, size_t stride, size_t vertexCount,
+		const uint32_t* indices, size_t indexCount, uint32_t geometryId) {
+		for (size_t i = 0; i < indexCount; ++i) {
+			if (indices[i] >= vertexCount) {
+				return false;
+			}
+		}
+		const char* base = static_cast<const char*>(positions);
+		auto position = [&](uint32_t index) {
+			Vector3<float> p;
+			memcpy(&p, base + stride * index, sizeof(p));
+			return p;
+		};
+		for (size_t i = 0; i + 2 < indexCount; i += 3) {
+			triangles.push_back({ position(indices[i]), position(indices[i + 1]), position(indices[i + 2]), geometryId, static_cast<uint32_t>(i / 3) });
+		}
+		return true;
+	}
+
+	void Bvh::Clear() {
+		triangles.clear();
+		nodes.clear();
+		packets.clear();
+		bounds = AABB<float>();
+	}
+
+	void Bvh::Build(int threadCount) {
+		nodes.clear();
+		packets.clear();
+		bounds = AABB<float>();
+		const uint32_t count = static_cast<uint32_t>(triangles.size());
+		if (count == 0) {
+			return;
+		}
+		if (threadCount <= 0) {
+			threadCount = static_cast<int>(std::thread::hardware_concurrency());
+		}
+
+		std::vector<AABB<float> > boxes(count);
+		std::vector<Vector3<float> > centers(count);
+		std::vector<uint32_t> refs(count);
+		ParallelFor(count, threadCount, ParallelMinTriangles, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				const Triangle& tri = triangles[i];
+				boxes[i] = AABB<float>();
+				boxes[i].Merge(tri.v0);
+				boxes[i].Merge(tri.v1);
+				boxes[i].Merge(tri.v2);
+				centers[i] = boxes[i].Center();
+				refs[i] = static_cast<uint32_t>(i);
+			}
+		});
+
+		//上位はビン分けを並列に行い、下位の部分木はタスクとして並列に構築する
+		Builder builder(boxes, centers, refs, threadCount);
+		std::vector<BuildNode> tree;
+		std::vector<BuildTask> tasks;
+		const size_t taskSize = (std::max)(TaskMinTriangles, static_cast<size_t>(count) / (static_cast<size_t>(threadCount) * 4));
+		builder.Build(0, count, 0, tree, threadCount > 1 ? &tasks : nullptr, taskSize);
+		if (!tasks.empty()) {
+			std::vector<std::vector<BuildNode> > subtrees(tasks.size());
+			ParallelFor(tasks.size(), threadCount, 1, [&](size_t begin, size_t end) {
+				Builder local(boxes, centers, refs, 1);
+				for (size_t i = begin; i < end; ++i) {
+					local.Build(tasks[i].begin, tasks[i].end, tasks[i].depth, subtrees[i], nullptr, 0);
+				}
+			});
+			for (size_t i = 0; i < tasks.size(); ++i) {
+				Attach(tree, tasks[i].node, subtrees[i]);
+			}
+		}
+		bounds = tree[0].box;
+
+		//4分木に畳み込む
+		auto makePacket = [&](const BuildNode& leaf) {
+			TrianglePacket packet;
+			memset(&packet, 0, sizeof(packet));
+			for (uint32_t i = leaf.begin; i < leaf.end; ++i) {
+				const Triangle& tri = triangles[refs[i]];
+				const int k = static_cast<int>(i - leaf.begin);
+				const Vector3<float> e1 = tri.v1 - tri.v0;
+				const Vector3<float> e2 = tri.v2 - tri.v0;
+				packet.v0x[k] = tri.v0.x;
+				packet.v0y[k] = tri.v0.y;
+				packet.v0z[k] = tri.v0.z;
+				packet.e1x[k] = e1.x;
+				packet.e1y[k] = e1.y;
+				packet.e1z[k] = e1.z;
+				packet.e2x[k] = e2.x;
+				packet.e2y[k] = e2.y;
+				packet.e2z[k] = e2.z;
+				packet.geometry[k] = tri.geometry;
+				packet.primitive[k] = tri.primitive;
+			}
+			packets.push_back(packet);
+			return ~static_cast<int32_t>(packets.size() - 1);
+		};
+		struct Collapse {
+			static int32_t Run(const std::vector<BuildNode>& tree, int index, decltype(makePacket)& makePacket, NodeArray& nodes) {
+				int children[4] = { index, -1, -1, -1 };
+				int childCount = 1;
+				if (!tree[index].IsLeaf()) {
+					children[0] = tree[index].left;
+					children[1] = tree[index].right;
+					childCount = 2;
+				}
+				//面積の大きい内部ノードを子に展開して4つまで増やす
+				while (childCount < 4) {
+					int best = -1;
+					float bestArea = -1;
+					for (int k = 0; k < childCount; ++k) {
+						const BuildNode& n = tree[children[k]];
+						if (!n.IsLeaf() && Area(n.box) > bestArea) {
+							best = k;
+							bestArea = Area(n.box);
+						}
+					}
+					if (best < 0) {
+						break;
+					}
+					const BuildNode& n = tree[children[best]];
+					children[best] = n.left;
+					children[childCount++] = n.right;
+				}
+
+				const int32_t nodeIndex = static_cast<int32_t>(nodes.size());
+				nodes.push_back(Node());
+				int32_t childIndex[4] = { 0, 0, 0, 0 };
+				for (int k = 0; k < childCount; ++k) {
+					const BuildNode& n = tree[children[k]];
+					childIndex[k] = n.IsLeaf() ? makePacket(n) : Run(tree, children[k], makePacket, nodes);
+				}
+				Node& node = nodes[nodeIndex];
+				const float inf = std::numeric_limits<float>::infinity();
+				for (int k = 0; k < 4; ++k) {
+					//空きは lower > upper で必ず外れる
+					const bool used = k < childCount;
+					const AABB<float> box = used ? tree[children[k]].box : AABB<float>(Vector3<float>(inf), Vector3<float>(-inf));
+					node.lowerX[k] = box.lower.x;
+					node.lowerY[k] = box.lower.y;
+					node.lowerZ[k] = box.lower.z;
+					node.upperX[k] = box.upper.x;
+					node.upperY[k] = box.upper.y;
+					node.upperZ[k] = box.upper.z;
+					node.child[k] = childIndex[k];
+				}
+				return nodeIndex;
+			}
+		};
+		Collapse::Run(tree, 0, makePacket, nodes);
+	}
+
+	template<bool anyHit>
+	bool Bvh::Traverse(const Ray& ray, RayHit* hit) const {
+		if (nodes.empty()) {
+			return false;
+		}
+		const float invX = 1.0f / ray.direction.x;
+		const float invY = 1.0f / ray.direction.y;
+		const float invZ = 1.0f / ray.direction.z;
+		//方向の符号で手前側の面を選ぶ
+		const size_t nearX = invX < 0 ? offsetof(Node, upperX) : offsetof(Node, lowerX);
+		const size_t farX = invX < 0 ? offsetof(Node, lowerX) : offsetof(Node, upperX);
+		const size_t nearY = invY < 0 ? offsetof(Node, upperY) : offsetof(Node, lowerY);
+		const size_t farY = invY < 0 ? offsetof(Node, lowerY) : offsetof(Node, upperY);
+		const size_t nearZ = invZ < 0 ? offsetof(Node, upperZ) : offsetof(Node, lowerZ);
+		const size_t farZ = invZ < 0 ? offsetof(Node, lowerZ) : offsetof(Node, upperZ);
+
+		const Float4 ox = Splat(ray.origin.x);
+		const Float4 oy = Splat(ray.origin.y);
+		const Float4 oz = Splat(ray.origin.z);
+		const Float4 dx = Splat(ray.direction.x);
+		const Float4 dy = Splat(ray.direction.y);
+		const Float4 dz = Splat(ray.direction.z);
+		const Float4 ix = Splat(invX);
+		const Float4 iy = Splat(invY);
+		const Float4 iz = Splat(invZ);
+		const Float4 tMin = Splat(ray.tMin);
+		const Float4 zero = Zero();
+		const Float4 one = Splat(1.0f);
+		float tMax = ray.tMax;
+		bool found = false;
+
+		struct Entry {
+			int32_t child;
+			float tNear;
+		};
+		Entry stack[StackSize];
+		int sp = 0;
+		stack[sp++] = { 0, ray.tMin };
+		while (sp) {
+			const Entry entry = stack[--sp];
+			if (entry.tNear > tMax) {
+				continue;
+			}
+			if (entry.child < 0) {
+				//Moller-Trumbore を4三角形同時に
+				const TrianglePacket& p = packets[~entry.child];
+				const Float4 e1x = Load(p.e1x), e1y = Load(p.e1y), e1z = Load(p.e1z);
+				const Float4 e2x = Load(p.e2x), e2y = Load(p.e2y), e2z = Load(p.e2z);
+				const Float4 px = Sub(Mul(dy, e2z), Mul(dz, e2y));
+				const Float4 py = Sub(Mul(dz, e2x), Mul(dx, e2z));
+				const Float4 pz = Sub(Mul(dx, e2y), Mul(dy, e2x));
+				const Float4 det = Add(Add(Mul(e1x, px), Mul(e1y, py)), Mul(e1z, pz));
+				const Float4 invDet = Div(one, det);
+				const Float4 sx = Sub(ox, Load(p.v0x));
+				const Float4 sy = Sub(oy, Load(p.v0y));
+				const Float4 sz = Sub(oz, Load(p.v0z));
+				const Float4 u = Mul(Add(Add(Mul(sx, px), Mul(sy, py)), Mul(sz, pz)), invDet);
+				const Float4 qx = Sub(Mul(sy, e1z), Mul(sz, e1y));
+				const Float4 qy = Sub(Mul(sz, e1x), Mul(sx, e1z));
+				const Float4 qz = Sub(Mul(sx, e1y), Mul(sy, e1x));
+				const Float4 v = Mul(Add(Add(Mul(dx, qx), Mul(dy, qy)), Mul(dz, qz)), invDet);
+				const Float4 t = Mul(Add(Add(Mul(e2x, qx), Mul(e2y, qy)), Mul(e2z, qz)), invDet);
+				const Float4 miss = Or(Or(Or(Less(u, zero), Less(v, zero)), Greater(Add(u, v), one)),
+					Or(Less(t, tMin), Greater(t, Splat(tMax))));
+				const int bits = MoveMask(Greater(Abs(det), zero)) & ~MoveMask(miss);
+				if (!bits) {
+					continue;
+				}
+				if (anyHit) {
+					return true;
+				}
+				float ts[4], us[4], vs[4];
+				Store(ts, t);
+				Store(us, u);
+				Store(vs, v);
+				for (int k = 0; k < 4; ++k) {
+					if ((bits >> k & 1) && ts[k] <= tMax) {
+						tMax = ts[k];
+						hit->t = ts[k];
+						hit->u = us[k];
+						hit->v = vs[k];
+						hit->geometry = p.geometry[k];
+						hit->primitive = p.primitive[k];
+						found = true;
+					}
+				}
+				continue;
+			}
+
+			//4つの子のAABBとのスラブ判定
+			const char* node = reinterpret_cast<const char*>(&nodes[entry.child]);
+			const Float4 tx0 = Mul(Sub(Load(reinterpret_cast<const float*>(node + nearX)), ox), ix);
+			const Float4 tx1 = Mul(Sub(Load(reinterpret_cast<const float*>(node + farX)), ox), ix);
+			const Float4 ty0 = Mul(Sub(Load(reinterpret_cast<const float*>(node + nearY)), oy), iy);
+			const Float4 ty1 = Mul(Sub(Load(reinterpret_cast<const float*>(node + farY)), oy), iy);
+			const Float4 tz0 = Mul(Sub(Load(reinterpret_cast<const float*>(node + nearZ)), oz), iz);
+			const Float4 tz1 = Mul(Sub(Load(reinterpret_cast<const float*>(node + farZ)), oz), iz);
+			const Float4 tNear = Max(Max(tx0, ty0), Max(tz0, tMin));
+			const Float4 tFar = Min(Min(tx1, ty1), Min(tz1, Splat(tMax)));
+			const int bits = ~MoveMask(Greater(tNear, tFar)) & 0xf;
+			if (!bits) {
+				continue;
+			}
+			float nears[4];
+			Store(nears, tNear);
+			const int32_t* child = reinterpret_cast<const Node*>(node)->child;
+			//遠い順に積んで近いものから取り出す
+			Entry hits[4];
+			int hitCount = 0;
+			for (int k = 0; k < 4; ++k) {
+				if (bits >> k & 1) {
+					int j = hitCount++;
+					for (; j > 0 && hits[j - 1].tNear < nears[k]; --j) {
+						hits[j] = hits[j - 1];
+					}
+					hits[j] = { child[k], nears[k] };
+				}
+			}
+			for (int k = 0; k < hitCount; ++k) {
+				stack[sp++] = hits[k];
+			}
+		}
+		return found;
+	}
+
+	bool Bvh::Intersect(const Ray& ray, RayHit& hit) const {
+		return Traverse<false>(ray, &hit);
+	}
+
+	bool Bvh::Occluded(const Ray& ray) const {
+		return Traverse<true>(ray, nullptr);
+	}
+} // namespace mff
@@ -0,0 +1,121 @@
+﻿#pragma once
+#include "../Bounds/AABB.h"
+#include "../Vector/Vector3.h"
+#include "../Simd/AlignedAllocator.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <limits>
+#include <vector>
+
+/*
+三角形メッシュのBVH (CPUでのレイ判定用)
+	SAH (ビン分割) で2分木を作り、4分木に畳み込む
+	ノードは4つの子のAABBをSoAで持ち、1回のSIMD判定で4つ同時に調べる
+	葉は最大4三角形で、1回のSIMD判定で4三角形同時に調べる
+
+	使い方
+		Bvh bvh;
+		for (size_t i = 0; i < mesh.materials.size(); ++i) {
+			bvh.AddTriangles(mesh.materials[i].verteces, mesh.materials[i].indeces, static_cast<uint32_t>(i));
+		}
+		bvh.Build();
+		RayHit hit;
+		if (bvh.Intersect(Ray(origin, direction), hit)) { ... }
+*/
+namespace mff {
+	//origin + direction * t (tMin <= t <= tMax)
+	struct Ray {
+		Ray() = default;
+		Ray(const Vector3<float>& origin, const Vector3<float>& direction,
+			float tMin = 0, float tMax = (std::numeric_limits<float>::max)())
+			: origin(origin), direction(direction), tMin(tMin), tMax(tMax) {}
+
+		Vector3<float> origin;
+		Vector3<float> direction;
+		float tMin = 0;
+		float tMax = (std::numeric_limits<float>::max)();
+	};
+
+	//a から b への線分 (t は 0 ~ 1)
+	inline Ray ToSegment(const Vector3<float>& a, const Vector3<float>& b) {
+		return Ray(a, b - a, 0, 1);
+	}
+
+	struct RayHit {
+		float t = 0;
+		//重心座標 (位置 = v0 * (1 - u - v) + v1 * u + v2 * v)
+		float u = 0;
+		float v = 0;
+		//AddTriangles の geometryId と、その中での三角形番号 (indices / 3)
+		uint32_t geometry = 0;
+		uint32_t primitive = 0;
+	};
+
+	class Bvh {
+	public:
+		/*
+		三角形を追加する (Build を呼ぶまでは反映されない)
+		positions は stride byte 間隔の Vector3<float>
+		範囲外のインデックスがあれば何も追加せず false を返す
+		*/
+		bool AddTriangles(const void* positions, size_t stride, size_t vertexCount,
+			const uint32_t* indices, size_t indexCount, uint32_t geometryId);
+
+		//position メンバーを持つ頂点配列 (FbxLoader の Material など)
+		template<typename Vertex>
+		bool AddTriangles(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, uint32_t geometryId) {
+			if (vertices.empty()) {
+				return indices.empty();
+			}
+			return AddTriangles(&vertices[0].position, sizeof(Vertex), vertices.size(), indices.data(), indices.size(), geometryId);
+		}
+
+		//threadCount が 1 以外で三角形数が十分大きい場合は並列に構築する (0でハードウェアスレッド数)
+		void Build(int threadCount = 1);
+		void Clear();
+
+		//最も近い交差 (見つからなければ false で hit は変更しない)
+		bool Intersect(const Ray& ray, RayHit& hit) const;
+		//いずれかの三角形と交差するか (遮蔽判定)
+		bool Occluded(const Ray& ray) const;
+
+		size_t TriangleCount() const { return triangles.size(); }
+		size_t NodeCount() const { return nodes.size(); }
+		AABB<float> Bounds() const { return bounds; }
+
+		//4分木ノード : child >= 0 は子ノード、child < 0 は葉 (~child が packets のインデックス)
+		struct Node {
+			float lowerX[4], upperX[4];
+			float lowerY[4], upperY[4];
+			float lowerZ[4], upperZ[4];
+			int32_t child[4];
+		};
+
+		//4三角形分をSoAで持つ (v0 と2辺、空きは辺が0で交差しない)
+		struct TrianglePacket {
+			float v0x[4], v0y[4], v0z[4];
+			float e1x[4], e1y[4], e1z[4];
+			float e2x[4], e2y[4], e2z[4];
+			uint32_t geometry[4];
+			uint32_t primitive[4];
+		};
+
+	private:
+		struct Triangle {
+			Vector3<float> v0, v1, v2;
+			uint32_t geometry;
+			uint32_t primitive;
+		};
+
+		typedef std::vector<Node, AlignedAllocator<Node, 64> > NodeArray;
+		typedef std::vector<TrianglePacket, AlignedAllocator<TrianglePacket, 64> > PacketArray;
+
+		template<bool anyHit>
+		bool Traverse(const Ray& ray, RayHit* hit) const;
+
+		std::vector<Triangle> triangles;
+		NodeArray nodes;
+		PacketArray packets;
+		AABB<float> bounds;
+	};
+} // namespace mff
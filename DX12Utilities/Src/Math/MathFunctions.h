@@ -1,6 +1,64 @@
 #pragma once
+#include <math.h>
+#include <limits>
+#include <type_traits>
 
 #define MFF_FEPSILON 0.00001
 #define MFF_DEPSILON 0.00000001
 bool FloatEqual(float a, float b, float epsilon = MFF_FEPSILON);
-bool DoubleEqual(double a, double b, double epsilon = MFF_DEPSILON);
\ No newline at end of file
+bool DoubleEqual(double a, double b, double epsilon = MFF_DEPSILON);
+
+//constant evaluation detection, used to keep SIMD specializations usable in constexpr
+#if defined(__cpp_lib_is_constant_evaluated)
+#define MFF_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif (defined(_MSC_VER) && _MSC_VER >= 1925) || (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9)
+#define MFF_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define MFF_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+#if defined(MFF_IS_CONSTANT_EVALUATED)
+#define MFF_CONSTEXPR_DISPATCH constexpr
+#else
+#define MFF_CONSTEXPR_DISPATCH
+#define MFF_IS_CONSTANT_EVALUATED() false
+#endif
+
+namespace mff {
+	//Newton's method, starts above the root so it decreases monotonically
+	template<typename T>
+	constexpr T ConstexprSqrt(T x) {
+		if (!(x >= static_cast<T>(0))) {
+			return std::numeric_limits<T>::quiet_NaN();
+		}
+		if (x == static_cast<T>(0) || x == std::numeric_limits<T>::infinity()) {
+			return x;
+		}
+		T cur = x > static_cast<T>(1) ? x : static_cast<T>(1);
+		for (int i = 0; i < 256; ++i) {
+			T next = (cur + x / cur) * static_cast<T>(0.5);
+			if (!(next < cur)) {
+				break;
+			}
+			cur = next;
+		}
+		return cur;
+	}
+
+	template<typename T>
+	MFF_CONSTEXPR_DISPATCH T Sqrt(T x) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return ConstexprSqrt(x);
+		}
+		return static_cast<T>(sqrt(x));
+	}
+
+	//same result as FloatEqual without branches: diff < epsilon || diff < max(|a|, |b|) * epsilon
+	inline bool NearlyEqual(float a, float b, float epsilon = static_cast<float>(MFF_FEPSILON)) {
+		const float diff = fabsf(a - b);
+		const float relative = (fabsf(a) > fabsf(b) ? fabsf(a) : fabsf(b)) * epsilon;
+		return diff < (epsilon > relative ? epsilon : relative);
+	}
+} // namespace mff
\ No newline at end of file
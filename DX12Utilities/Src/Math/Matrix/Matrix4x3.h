@@ -1,50 +1,60 @@
 #pragma once
 #include "../Vector/Vector3.h"
 #include "../Vector/Vector4.h"
+#include "Matrix4x4.h"
 namespace mff {
+	template<typename T>
+	struct Matrix4x3;
+
+	template<typename T>
+	constexpr Matrix4x3<T> operator*(const Matrix4x3<T>& lhs, const Matrix4x3<T>& rhs);
+
 	template<typename T>
 	struct Matrix4x3 {
-		Matrix4x3(T v = static_cast<T>(1)) {
-			m[0] = v;
-			m[5] = v;
-			m[10] = v;
-		}
+		constexpr Matrix4x3(T v = static_cast<T>(1)) : v{ Vector4<T>(v, 0, 0, 0),Vector4<T>(0, v, 0, 0),Vector4<T>(0, 0, v, 0) } {}
 
-		Matrix4x3(const Vector4<T>& v1, const Vector4<T>& v2, const Vector4<T>& v3) {
-			v[0] = v1;
-			v[1] = v2;
-			v[2] = v3;
-		}
+		constexpr Matrix4x3(const Vector4<T>& v1, const Vector4<T>& v2, const Vector4<T>& v3) : v{ v1, v2, v3 } {}
 
-		Matrix4x3& operator+=(const Matrix4x3& arg) {
+		constexpr explicit Matrix4x3(const Matrix4x4<T>& mat) : v{ mat.v[0], mat.v[1], mat.v[2] } {}
+
+		constexpr Matrix4x3& operator+=(const Matrix4x3& arg) {
 			v[0] += arg.v[0];
 			v[1] += arg.v[1];
 			v[2] += arg.v[2];
+			return *this;
 		}
 
-		Matrix4x3& operator-=(const Matrix4x3& arg) {
+		constexpr Matrix4x3& operator-=(const Matrix4x3& arg) {
 			v[0] -= arg.v[0];
 			v[1] -= arg.v[1];
 			v[2] -= arg.v[2];
+			return *this;
 		}
 
-		Matrix4x3& operator*=(T scaler) {
+		constexpr Matrix4x3& operator*=(const Matrix4x3& arg) {
+			*this = *this * arg;
+			return *this;
+		}
+
+		constexpr Matrix4x3& operator*=(T scaler) {
 			v[0] *= scaler;
 			v[1] *= scaler;
 			v[2] *= scaler;
+			return *this;
 		}
 
-		Matrix4x3& operator/=(T scaler) {
+		constexpr Matrix4x3& operator/=(T scaler) {
 			v[0] /= scaler;
 			v[1] /= scaler;
 			v[2] /= scaler;
+			return *this;
 		}
 
-		Vector4<T>& operator[](int idx) {
+		constexpr Vector4<T>& operator[](int idx) {
 			return v[idx];
 		}
 
-		const Vector4<T>& operator[](int idx) {
+		constexpr const Vector4<T>& operator[](int idx) const {
 			return v[idx];
 		}
 
@@ -55,27 +65,82 @@ namespace mff {
 	};
 
 	template<typename T>
-	Matrix4x3<T> operator+(const Matrix4x3<T>& lhs, const Matrix4x3<T>& rhs) {
+	constexpr Matrix4x3<T> operator+(const Matrix4x3<T>& lhs, const Matrix4x3<T>& rhs) {
 		return Matrix4x3<T>(lhs.v[0] + rhs.v[0], lhs.v[1] + rhs.v[1], lhs.v[2] + rhs.v[2]);
 	}
 
 	template<typename T>
-	Matrix4x3<T> operator-(const Matrix4x3<T>& lhs, const Matrix4x3<T>& rhs) {
+	constexpr Matrix4x3<T> operator-(const Matrix4x3<T>& lhs, const Matrix4x3<T>& rhs) {
 		return Matrix4x3<T>(lhs.v[0] - rhs.v[0], lhs.v[1] - rhs.v[1], lhs.v[2] - rhs.v[2]);
 	}
 
 	template<typename T>
-	Matrix4x3<T> operator*(const Matrix4x3<T>& mat, T scaler) {
+	constexpr Matrix4x3<T> operator*(const Matrix4x3<T>& mat, T scaler) {
 		return Matrix4x3<T>(mat.v[0] * scaler, mat.v[1] * scaler, mat.v[2] * scaler);
 	}
 
 	template<typename T>
-	Matrix4x3<T> operator*(T scaler, const Matrix4x3<T>& mat) {
+	constexpr Matrix4x3<T> operator*(T scaler, const Matrix4x3<T>& mat) {
 		return Matrix4x3<T>(scaler * mat.v[0], scaler * mat.v[1], scaler * mat.v[2]);
 	}
 
 	template<typename T>
-	Vector3<T> operator*(const Matrix4x3<T>& mat, const Vector4<T>& vec) {
+	constexpr Vector3<T> operator*(const Matrix4x3<T>& mat, const Vector4<T>& vec) {
 		return Vector3<T>(dot(mat.v[0], vec), dot(mat.v[1], vec), dot(mat.v[2],vec));
 	}
+
+	template<typename T>
+	constexpr Matrix4x3<T> operator*(const Matrix4x3<T>& lhs, const Matrix4x3<T>& rhs) {
+		Matrix4x3<T> ret(static_cast<T>(0));
+		for (int row = 0; row < 3; ++row) {
+			ret.v[row] = lhs.v[row].x * rhs.v[0] + lhs.v[row].y * rhs.v[1] + lhs.v[row].z * rhs.v[2];
+			ret.v[row].w += lhs.v[row].w;
+		}
+		return ret;
+	}
+
+	template<typename T>
+	constexpr Vector3<T> TransformPoint(const Matrix4x3<T>& mat, const Vector3<T>& vec) {
+		return mat * Vector4<T>(vec.x, vec.y, vec.z, static_cast<T>(1));
+	}
+
+	template<typename T>
+	constexpr Vector3<T> TransformVector(const Matrix4x3<T>& mat, const Vector3<T>& vec) {
+		return mat * Vector4<T>(vec.x, vec.y, vec.z, static_cast<T>(0));
+	}
+
+	template<typename T>
+	constexpr Matrix4x4<T> ToMatrix4x4(const Matrix4x3<T>& mat) {
+		return Matrix4x4<T>(mat.v[0], mat.v[1], mat.v[2], Vector4<T>(0, 0, 0, 1));
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Matrix4x3<float> operator*(const Matrix4x3<float>& lhs, const Matrix4x3<float>& rhs) {
+		Matrix4x3<float> ret;
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			for (int row = 0; row < 3; ++row) {
+				ret.v[row] = lhs.v[row].x * rhs.v[0] + lhs.v[row].y * rhs.v[1] + lhs.v[row].z * rhs.v[2];
+				ret.v[row].w += lhs.v[row].w;
+			}
+			return ret;
+		}
+		const simd::Float4 r0 = simd::Load(rhs.m + 0);
+		const simd::Float4 r1 = simd::Load(rhs.m + 4);
+		const simd::Float4 r2 = simd::Load(rhs.m + 8);
+		const simd::Float4 r3 = simd::Set(0, 0, 0, 1);
+		for (int row = 0; row < 3; ++row) {
+			simd::Store(ret.m + row * 4, simd::MulRow(simd::Load(lhs.m + row * 4), r0, r1, r2, r3));
+		}
+		return ret;
+	}
+
+	template<typename T>
+	void print(const Matrix4x3<T>& mat) {
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				std::cout << "m[" << i * 4 + j << "] = " << mat[i][j] << " ";
+			}
+			std::cout << std::endl;
+		}
+	}
 } // namespace mff
\ No newline at end of file
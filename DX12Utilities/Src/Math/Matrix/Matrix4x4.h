@@ -11,49 +11,43 @@
 	 0,  0,  0, 1
 */
 namespace mff {
+	template<typename T>
+	struct Matrix4x4;
+
+	template<typename T>
+	constexpr Matrix4x4<T> operator*(const Matrix4x4<T>& lhs, const Matrix4x4<T>& rhs);
+
 	template<typename T>
 	struct Matrix4x4 {
-		Matrix4x4(T v = static_cast<T>(1)) : v{ Vector4<T>(0),Vector4<T>(0),Vector4<T>(0),Vector4<T>(0) } {
-			m[0] = v;
-			m[5] = v;
-			m[10] = v;
-			m[15] = v;
-		}
-		Matrix4x4(const Vector4<T>& v1, const Vector4<T>& v2, const Vector4<T>& v3, const Vector4<T>& v4) {
-			v[0] = v1;
-			v[1] = v2;
-			v[2] = v3;
-			v[3] = v4;
-		}
+		constexpr Matrix4x4(T v = static_cast<T>(1)) : v{ Vector4<T>(v, 0, 0, 0),Vector4<T>(0, v, 0, 0),Vector4<T>(0, 0, v, 0),Vector4<T>(0, 0, 0, v) } {}
+		constexpr Matrix4x4(const Vector4<T>& v1, const Vector4<T>& v2, const Vector4<T>& v3, const Vector4<T>& v4) : v{ v1, v2, v3, v4 } {}
 
-		Matrix4x4& operator+=(const Matrix4x4& arg) {
+		constexpr Matrix4x4& operator+=(const Matrix4x4& arg) {
 			v[0] += arg.v[0];
 			v[1] += arg.v[1];
 			v[2] += arg.v[2];
 			v[3] += arg.v[3];
+			return *this;
 		}
 
-		Matrix4x4& operator-=(const Matrix4x4& arg) {
+		constexpr Matrix4x4& operator-=(const Matrix4x4& arg) {
 			v[0] -= arg.v[0];
 			v[1] -= arg.v[1];
 			v[2] -= arg.v[2];
 			v[3] -= arg.v[3];
+			return *this;
 		}
 
-		Matrix4x4& operator*=(const Matrix4x4& arg) {
-			for (int i = 0; i < 4; ++i) {
-				Vector4<T> tmp(arg[0][i],arg[1][i],arg[2][i],arg[3][i]);
-				for (int j = 0; j < 4; ++j) {
-					v[j][i] = dot(v[j], tmp);
-				}
-			}
+		constexpr Matrix4x4& operator*=(const Matrix4x4& arg) {
+			*this = *this * arg;
+			return *this;
 		}
 
-		Vector4<T>& operator[](int idx) {
+		constexpr Vector4<T>& operator[](int idx) {
 			return v[idx];
 		}
 
-		const Vector4<T>& operator[](int idx) const {
+		constexpr const Vector4<T>& operator[](int idx) const {
 			return v[idx];
 		}
 
@@ -64,25 +58,29 @@ namespace mff {
 	};
 
 	template<typename T>
-	Matrix4x4<T> operator+(const Matrix4x4<T>& lhs, const Matrix4x4<T>& rhs) {
+	constexpr Matrix4x4<T> operator+(const Matrix4x4<T>& lhs, const Matrix4x4<T>& rhs) {
 		return Matrix4x4<T>(lhs.v[0] + rhs.v[0], lhs.v[1] + rhs.v[1], lhs.v[2] + rhs.v[2], lhs.v[3] + rhs.v[3]);
 	}
 
 	template<typename T>
-	Matrix4x4<T> operator-(const Matrix4x4<T>& lhs, const Matrix4x4<T>& rhs) {
+	constexpr Matrix4x4<T> operator-(const Matrix4x4<T>& lhs, const Matrix4x4<T>& rhs) {
 		return Matrix4x4<T>(lhs.v[0] - rhs.v[0], lhs.v[1] - rhs.v[1], lhs.v[2] - rhs.v[2], lhs.v[3] - rhs.v[3]);
 	}
 	
+	//sxNg * s
 	template<typename T>
-	Matrix4x4<T> operator*(const Matrix4x4<T>& lhs, const Matrix4x4<T>& rhs) {
-		Matrix4x4<T> ret(static_cast<T>(0));
-		for (int column = 0; column < 4; ++column) {
-			Vector4<T> tmp(rhs.v[0][column], rhs.v[1][column], rhs.v[2][column], rhs.v[3][column]);
-			for (int row = 0; row < 4; ++row) {
-				ret[row][column] = dot(lhs[row], tmp);
-			}
-		}
-		return ret;
+	constexpr Vector4<T> MulRow(const Vector4<T>& row, const Matrix4x4<T>& mat) {
+		return Vector4<T>(
+			row.x * mat.v[0].x + row.y * mat.v[1].x + row.z * mat.v[2].x + row.w * mat.v[3].x,
+			row.x * mat.v[0].y + row.y * mat.v[1].y + row.z * mat.v[2].y + row.w * mat.v[3].y,
+			row.x * mat.v[0].z + row.y * mat.v[1].z + row.z * mat.v[2].z + row.w * mat.v[3].z,
+			row.x * mat.v[0].w + row.y * mat.v[1].w + row.z * mat.v[2].w + row.w * mat.v[3].w
+			);
+	}
+
+	template<typename T>
+	constexpr Matrix4x4<T> operator*(const Matrix4x4<T>& lhs, const Matrix4x4<T>& rhs) {
+		return Matrix4x4<T>(MulRow(lhs.v[0], rhs), MulRow(lhs.v[1], rhs), MulRow(lhs.v[2], rhs), MulRow(lhs.v[3], rhs));
 	}
 
 	//template<typename T>
@@ -96,7 +94,7 @@ namespace mff {
 	//}
 
 	template<typename T>
-	Vector4<T> operator*(const Matrix4x4<T>& mat, const Vector4<T>& vec) {
+	constexpr Vector4<T> operator*(const Matrix4x4<T>& mat, const Vector4<T>& vec) {
 		return Vector4<T>(
 			dot(mat[0], vec),
 			dot(mat[1], vec),
@@ -106,15 +104,238 @@ namespace mff {
 	}
 
 	template<typename T>
-	Matrix4x4<T> operator*(const Matrix4x4<T>& mat, T scaler){
+	constexpr Matrix4x4<T> operator*(const Matrix4x4<T>& mat, T scaler){
 		return Matrix4x4<T>(mat[0] * scaler, mat[1] * scaler, mat[2] * scaler, mat[3] * scaler);
 	}
 
 	template<typename T>
-	Matrix4x4<T> operator*(T scaler, const Matrix4x4<T>& mat) {
+	constexpr Matrix4x4<T> operator*(T scaler, const Matrix4x4<T>& mat) {
 		return Matrix4x4<T>(scaler * mat[0], scaler * mat[1], scaler * mat[2], scaler * mat[3]);
 	}
 
+	//a * (1 - t) + b * t ꎞs炸ɌvZ
+	template<typename T>
+	constexpr Matrix4x4<T> Lerp(const Matrix4x4<T>& a, const Matrix4x4<T>& b, T t) {
+		return Matrix4x4<T>(Lerp(a[0], b[0], t), Lerp(a[1], b[1], t), Lerp(a[2], b[2], t), Lerp(a[3], b[3], t));
+	}
+
+	//a + b * scaler
+	template<typename T>
+	constexpr Matrix4x4<T> ScaledAdd(const Matrix4x4<T>& a, const Matrix4x4<T>& b, T scaler) {
+		return Matrix4x4<T>(ScaledAdd(a[0], b[0], scaler), ScaledAdd(a[1], b[1], scaler), ScaledAdd(a[2], b[2], scaler), ScaledAdd(a[3], b[3], scaler));
+	}
+
+	template<typename T>
+	constexpr Matrix4x4<T> Transpose(const Matrix4x4<T>& mat) {
+		return Matrix4x4<T>(
+			Vector4<T>(mat.v[0].x, mat.v[1].x, mat.v[2].x, mat.v[3].x),
+			Vector4<T>(mat.v[0].y, mat.v[1].y, mat.v[2].y, mat.v[3].y),
+			Vector4<T>(mat.v[0].z, mat.v[1].z, mat.v[2].z, mat.v[3].z),
+			Vector4<T>(mat.v[0].w, mat.v[1].w, mat.v[2].w, mat.v[3].w)
+			);
+	}
+
+	/*
+	ts̗vfvZ (a, out ͂ꂼ16vfEsD)
+	ob`łSIMD[^̂܂܎g悤vf^ev[gɂĂ
+
+	@retval s
+	*/
+	template<typename T>
+	T InverseElements(const T* a, T* out) {
+		const T s0 = a[0] * a[5] - a[4] * a[1];
+		const T s1 = a[0] * a[6] - a[4] * a[2];
+		const T s2 = a[0] * a[7] - a[4] * a[3];
+		const T s3 = a[1] * a[6] - a[5] * a[2];
+		const T s4 = a[1] * a[7] - a[5] * a[3];
+		const T s5 = a[2] * a[7] - a[6] * a[3];
+
+		const T c5 = a[10] * a[15] - a[14] * a[11];
+		const T c4 = a[9] * a[15] - a[13] * a[11];
+		const T c3 = a[9] * a[14] - a[13] * a[10];
+		const T c2 = a[8] * a[15] - a[12] * a[11];
+		const T c1 = a[8] * a[14] - a[12] * a[10];
+		const T c0 = a[8] * a[13] - a[12] * a[9];
+
+		const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+		const T invDet = T(1) / det;
+
+		out[0] = (a[5] * c5 - a[6] * c4 + a[7] * c3) * invDet;
+		out[1] = (a[2] * c4 - a[1] * c5 - a[3] * c3) * invDet;
+		out[2] = (a[13] * s5 - a[14] * s4 + a[15] * s3) * invDet;
+		out[3] = (a[10] * s4 - a[9] * s5 - a[11] * s3) * invDet;
+
+		out[4] = (a[6] * c2 - a[4] * c5 - a[7] * c1) * invDet;
+		out[5] = (a[0] * c5 - a[2] * c2 + a[3] * c1) * invDet;
+		out[6] = (a[14] * s2 - a[12] * s5 - a[15] * s1) * invDet;
+		out[7] = (a[8] * s5 - a[10] * s2 + a[11] * s1) * invDet;
+
+		out[8] = (a[4] * c4 - a[5] * c2 + a[7] * c0) * invDet;
+		out[9] = (a[1] * c2 - a[0] * c4 - a[3] * c0) * invDet;
+		out[10] = (a[12] * s4 - a[13] * s2 + a[15] * s0) * invDet;
+		out[11] = (a[9] * s2 - a[8] * s4 - a[11] * s0) * invDet;
+
+		out[12] = (a[5] * c1 - a[4] * c3 - a[6] * c0) * invDet;
+		out[13] = (a[0] * c3 - a[1] * c1 + a[2] * c0) * invDet;
+		out[14] = (a[13] * s1 - a[12] * s3 - a[14] * s0) * invDet;
+		out[15] = (a[8] * s3 - a[9] * s1 + a[10] * s0) * invDet;
+		return det;
+	}
+
+	/*
+	AtBϊ(ŉs 0,0,0,1)̋ts̗vfvZ
+	out ̍ŉs͏܂Ȃ
+
+	@retval 3x3̍s
+	*/
+	template<typename T>
+	T AffineInverseElements(const T* a, T* out) {
+		//3x3̗]q
+		const T c00 = a[5] * a[10] - a[6] * a[9];
+		const T c01 = a[6] * a[8] - a[4] * a[10];
+		const T c02 = a[4] * a[9] - a[5] * a[8];
+		const T c10 = a[2] * a[9] - a[1] * a[10];
+		const T c11 = a[0] * a[10] - a[2] * a[8];
+		const T c12 = a[1] * a[8] - a[0] * a[9];
+		const T c20 = a[1] * a[6] - a[2] * a[5];
+		const T c21 = a[2] * a[4] - a[0] * a[6];
+		const T c22 = a[0] * a[5] - a[1] * a[4];
+
+		const T det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+		const T invDet = T(1) / det;
+
+		out[0] = c00 * invDet;
+		out[1] = c10 * invDet;
+		out[2] = c20 * invDet;
+		out[4] = c01 * invDet;
+		out[5] = c11 * invDet;
+		out[6] = c21 * invDet;
+		out[8] = c02 * invDet;
+		out[9] = c12 * invDet;
+		out[10] = c22 * invDet;
+
+		//-A^-1 * t
+		out[3] = T(0) - (out[0] * a[3] + out[1] * a[7] + out[2] * a[11]);
+		out[7] = T(0) - (out[4] * a[3] + out[5] * a[7] + out[6] * a[11]);
+		out[11] = T(0) - (out[8] * a[3] + out[9] * a[7] + out[10] * a[11]);
+		return det;
+	}
+
+	template<typename T>
+	T Determinant(const Matrix4x4<T>& mat) {
+		const T* a = mat.m;
+		const T s0 = a[0] * a[5] - a[4] * a[1];
+		const T s1 = a[0] * a[6] - a[4] * a[2];
+		const T s2 = a[0] * a[7] - a[4] * a[3];
+		const T s3 = a[1] * a[6] - a[5] * a[2];
+		const T s4 = a[1] * a[7] - a[5] * a[3];
+		const T s5 = a[2] * a[7] - a[6] * a[3];
+		const T c5 = a[10] * a[15] - a[14] * a[11];
+		const T c4 = a[9] * a[15] - a[13] * a[11];
+		const T c3 = a[9] * a[14] - a[13] * a[10];
+		const T c2 = a[8] * a[15] - a[12] * a[11];
+		const T c1 = a[8] * a[14] - a[12] * a[10];
+		const T c0 = a[8] * a[13] - a[12] * a[9];
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	}
+
+	//ʂ̋ts (łȂꍇ̌ʂ͕s)
+	template<typename T>
+	Matrix4x4<T> Inverse(const Matrix4x4<T>& mat) {
+		Matrix4x4<T> ret;
+		InverseElements(mat.m, ret.m);
+		return ret;
+	}
+
+	//]EXP[ + sړ݂̂̍s̋ts
+	template<typename T>
+	Matrix4x4<T> AffineInverse(const Matrix4x4<T>& mat) {
+		Matrix4x4<T> ret;
+		AffineInverseElements(mat.m, ret.m);
+		return ret;
+	}
+
+	namespace simd {
+		//row * mat (rows r0..r3)
+		inline Float4 MulRow(Float4 row, Float4 r0, Float4 r1, Float4 r2, Float4 r3) {
+			Float4 ret = Mul(Broadcast<0>(row), r0);
+			ret = MulAdd(Broadcast<1>(row), r1, ret);
+			ret = MulAdd(Broadcast<2>(row), r2, ret);
+			return MulAdd(Broadcast<3>(row), r3, ret);
+		}
+	} // namespace simd
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Matrix4x4<float> operator*(const Matrix4x4<float>& lhs, const Matrix4x4<float>& rhs) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return Matrix4x4<float>(MulRow(lhs.v[0], rhs), MulRow(lhs.v[1], rhs), MulRow(lhs.v[2], rhs), MulRow(lhs.v[3], rhs));
+		}
+		Matrix4x4<float> ret;
+#if defined(MFF_SIMD_AVX)
+		const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs.m + 0));
+		const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs.m + 4));
+		const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs.m + 8));
+		const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(rhs.m + 12));
+		for (int row = 0; row < 4; row += 2) {
+			const __m256 a = _mm256_loadu_ps(lhs.m + row * 4);
+			__m256 r = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), b0);
+			r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x55), b1), r);
+			r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xaa), b2), r);
+			r = _mm256_add_ps(_mm256_mul_ps(_mm256_shuffle_ps(a, a, 0xff), b3), r);
+			_mm256_storeu_ps(ret.m + row * 4, r);
+		}
+#else
+		const simd::Float4 r0 = simd::Load(rhs.m + 0);
+		const simd::Float4 r1 = simd::Load(rhs.m + 4);
+		const simd::Float4 r2 = simd::Load(rhs.m + 8);
+		const simd::Float4 r3 = simd::Load(rhs.m + 12);
+		for (int row = 0; row < 4; ++row) {
+			simd::Store(ret.m + row * 4, simd::MulRow(simd::Load(lhs.m + row * 4), r0, r1, r2, r3));
+		}
+#endif
+		return ret;
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Matrix4x4<float> Lerp(const Matrix4x4<float>& a, const Matrix4x4<float>& b, float t) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return Matrix4x4<float>(Lerp(a.v[0], b.v[0], t), Lerp(a.v[1], b.v[1], t), Lerp(a.v[2], b.v[2], t), Lerp(a.v[3], b.v[3], t));
+		}
+		const simd::Float4 s = simd::Splat(1.0f - t);
+		const simd::Float4 tt = simd::Splat(t);
+		Matrix4x4<float> ret;
+		for (int row = 0; row < 4; ++row) {
+			simd::Store(ret.m + row * 4, simd::MulAdd(simd::Load(a.m + row * 4), s, simd::Mul(simd::Load(b.m + row * 4), tt)));
+		}
+		return ret;
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Matrix4x4<float> ScaledAdd(const Matrix4x4<float>& a, const Matrix4x4<float>& b, float scaler) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return Matrix4x4<float>(ScaledAdd(a.v[0], b.v[0], scaler), ScaledAdd(a.v[1], b.v[1], scaler), ScaledAdd(a.v[2], b.v[2], scaler), ScaledAdd(a.v[3], b.v[3], scaler));
+		}
+		const simd::Float4 s = simd::Splat(scaler);
+		Matrix4x4<float> ret;
+		for (int row = 0; row < 4; ++row) {
+			simd::Store(ret.m + row * 4, simd::MulAdd(simd::Load(b.m + row * 4), s, simd::Load(a.m + row * 4)));
+		}
+		return ret;
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Vector4<float> operator*(const Matrix4x4<float>& mat, const Vector4<float>& vec) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return Vector4<float>(dot(mat.v[0], vec), dot(mat.v[1], vec), dot(mat.v[2], vec), dot(mat.v[3], vec));
+		}
+		simd::Float4 c0 = simd::Load(mat.m + 0);
+		simd::Float4 c1 = simd::Load(mat.m + 4);
+		simd::Float4 c2 = simd::Load(mat.m + 8);
+		simd::Float4 c3 = simd::Load(mat.m + 12);
+		simd::Transpose(c0, c1, c2, c3);
+		return simd::ToVector4(simd::MulRow(simd::Load(vec), c0, c1, c2, c3));
+	}
+
 	template<typename T>
 	void print(const Matrix4x4<T>& mat) {
 		for (int i = 0; i < 4; ++i) {
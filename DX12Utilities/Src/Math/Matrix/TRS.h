@@ -0,0 +1,114 @@
+﻿#pragma once
+#include "../Vector/Vector3.h"
+#include "../Quaternion/Quaternion.h"
+#include "Matrix4x4.h"
+#include <limits>
+
+/*
+平行移動・回転・スケール (10要素) と行列の相互変換
+	行列は mat * vec の列ベクトル形式で M = T * R * S
+	せん断を含む行列は列をグラム・シュミットで直交化した回転に分解する (せん断成分は失われる)
+	反転 (行列式が負) は scale.z の符号で表す
+	長さ0の軸は他の軸から補って回転を作り、その軸の scale を0にする
+*/
+namespace mff {
+	template<typename T>
+	struct TRS {
+		constexpr TRS() : translation(0), rotation(), scale(1) {}
+		constexpr TRS(const Vector3<T>& translation, const Quaternion<T>& rotation, const Vector3<T>& scale)
+			: translation(translation), rotation(rotation), scale(scale) {}
+
+		Vector3<T> translation;
+		Quaternion<T> rotation;
+		Vector3<T> scale;
+	};
+
+	template<typename T>
+	Matrix4x4<T> ToMatrix4x4(const TRS<T>& trs) {
+		const T one = static_cast<T>(1);
+		const T two = static_cast<T>(2);
+		const Quaternion<T>& q = trs.rotation;
+		const Vector3<T>& s = trs.scale;
+		const Vector3<T>& t = trs.translation;
+		T xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		T xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		T wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		return Matrix4x4<T>(
+			Vector4<T>((one - two * (yy + zz)) * s.x, two * (xy - wz) * s.y, two * (xz + wy) * s.z, t.x),
+			Vector4<T>(two * (xy + wz) * s.x, (one - two * (xx + zz)) * s.y, two * (yz - wx) * s.z, t.y),
+			Vector4<T>(two * (xz - wy) * s.x, two * (yz + wx) * s.y, (one - two * (xx + yy)) * s.z, t.z),
+			Vector4<T>(0, 0, 0, one)
+			);
+	}
+
+	//v に直交する単位ベクトル (v は単位ベクトル)
+	template<typename T>
+	Vector3<T> AnyPerpendicular(const Vector3<T>& v) {
+		const Vector3<T> axis = fabs(v.x) < static_cast<T>(0.9) ? Vector3<T>(1, 0, 0) : Vector3<T>(0, 1, 0);
+		return Normalize(cross(v, axis));
+	}
+
+	template<typename T>
+	TRS<T> Decompose(const Matrix4x4<T>& mat) {
+		const Vector3<T> c0(mat.v[0].x, mat.v[1].x, mat.v[2].x);
+		const Vector3<T> c1(mat.v[0].y, mat.v[1].y, mat.v[2].y);
+		const Vector3<T> c2(mat.v[0].z, mat.v[1].z, mat.v[2].z);
+		TRS<T> ret;
+		ret.translation = Vector3<T>(mat.v[0].w, mat.v[1].w, mat.v[2].w);
+
+		const T l0 = c0.Length();
+		const T l1 = c1.Length();
+		const T l2 = c2.Length();
+		const T maxLength = l0 > l1 ? (l0 > l2 ? l0 : l2) : (l1 > l2 ? l1 : l2);
+		if (!(maxLength > 0)) {
+			ret.scale = Vector3<T>(0);
+			return ret;
+		}
+		//これ以下の長さは0とみなす
+		const T tolerance = maxLength * std::numeric_limits<T>::epsilon() * 8;
+
+		Vector3<T> a0;
+		if (l0 > tolerance) {
+			a0 = c0 / l0;
+		}
+		else {
+			const Vector3<T> n = cross(c1, c2);
+			const T length = n.Length();
+			if (length > tolerance * maxLength) {
+				a0 = n / length;
+			}
+			else {
+				a0 = AnyPerpendicular(l1 > tolerance ? c1 / l1 : (l2 > tolerance ? c2 / l2 : Vector3<T>(0, 0, 1)));
+			}
+		}
+
+		const Vector3<T> r1 = c1 - a0 * dot(a0, c1);
+		const T lr1 = r1.Length();
+		Vector3<T> a1;
+		if (lr1 > tolerance) {
+			a1 = r1 / lr1;
+		}
+		else {
+			//c2 が a0 と a1 の外積側に来るように選ぶ
+			const Vector3<T> n = cross(c2, a0);
+			const T length = n.Length();
+			a1 = length > tolerance ? n / length : AnyPerpendicular(a0);
+		}
+		const Vector3<T> a2 = cross(a0, a1);
+
+		ret.scale = Vector3<T>(dot(a0, c0), dot(a1, c1), dot(a2, c2));
+		const Matrix4x4<T> rotation(
+			Vector4<T>(a0.x, a1.x, a2.x, 0),
+			Vector4<T>(a0.y, a1.y, a2.y, 0),
+			Vector4<T>(a0.z, a1.z, a2.z, 0),
+			Vector4<T>(0, 0, 0, 1));
+		ret.rotation = Normalize(ToQuaternion(rotation));
+		return ret;
+	}
+
+	//平行移動とスケールは線形補間、回転は最短経路側で Nlerp
+	template<typename T>
+	TRS<T> Lerp(const TRS<T>& a, const TRS<T>& b, T t) {
+		return TRS<T>(Lerp(a.translation, b.translation, t), Nlerp(a.rotation, b.rotation, t), Lerp(a.scale, b.scale, t));
+	}
+} // namespace mff
@@ -0,0 +1,203 @@
+﻿#pragma once
+#include "../Vector/Vector3.h"
+#include "../Vector/Vector4.h"
+#include "../Matrix/Matrix4x4.h"
+#include "../MathFunctions.h"
+#include <iostream>
+
+namespace mff {
+	template<typename T>
+	struct Quaternion {
+		constexpr Quaternion() : x(0), y(0), z(0), w(1) {}
+		constexpr Quaternion(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+		Quaternion(const Vector3<T>& axis, T angle) {
+			T s = static_cast<T>(sin(angle * static_cast<T>(0.5)));
+			x = axis.x * s;
+			y = axis.y * s;
+			z = axis.z * s;
+			w = static_cast<T>(cos(angle * static_cast<T>(0.5)));
+		}
+
+		Quaternion& operator*=(const Quaternion& arg) {
+			*this = *this * arg;
+			return *this;
+		}
+
+		T& operator[](int idx) {
+			return m[idx];
+		}
+
+		const T& operator[](int idx) const {
+			return m[idx];
+		}
+
+		union {
+			T m[4];
+			struct { T x, y, z, w; };
+		};
+	};
+
+	template<typename T>
+	constexpr Quaternion<T> operator*(const Quaternion<T>& lhs, const Quaternion<T>& rhs) {
+		return Quaternion<T>(
+			lhs.w * rhs.x + lhs.x * rhs.w + lhs.y * rhs.z - lhs.z * rhs.y,
+			lhs.w * rhs.y - lhs.x * rhs.z + lhs.y * rhs.w + lhs.z * rhs.x,
+			lhs.w * rhs.z + lhs.x * rhs.y - lhs.y * rhs.x + lhs.z * rhs.w,
+			lhs.w * rhs.w - lhs.x * rhs.x - lhs.y * rhs.y - lhs.z * rhs.z
+			);
+	}
+
+	template<typename T>
+	constexpr Quaternion<T> operator+(const Quaternion<T>& lhs, const Quaternion<T>& rhs) {
+		return Quaternion<T>(lhs.x + rhs.x, lhs.y + rhs.y, lhs.z + rhs.z, lhs.w + rhs.w);
+	}
+
+	template<typename T>
+	constexpr Quaternion<T> operator-(const Quaternion<T>& lhs, const Quaternion<T>& rhs) {
+		return Quaternion<T>(lhs.x - rhs.x, lhs.y - rhs.y, lhs.z - rhs.z, lhs.w - rhs.w);
+	}
+
+	template<typename T>
+	constexpr Quaternion<T> operator-(const Quaternion<T>& arg) {
+		return Quaternion<T>(-arg.x, -arg.y, -arg.z, -arg.w);
+	}
+
+	template<typename T>
+	constexpr Quaternion<T> operator*(const Quaternion<T>& q, T scaler) {
+		return Quaternion<T>(q.x * scaler, q.y * scaler, q.z * scaler, q.w * scaler);
+	}
+
+	template<typename T>
+	constexpr Quaternion<T> operator*(T scaler, const Quaternion<T>& q) {
+		return Quaternion<T>(q.x * scaler, q.y * scaler, q.z * scaler, q.w * scaler);
+	}
+
+	template<typename T>
+	bool operator==(const Quaternion<T>& lhs, const Quaternion<T>& rhs) {
+		return (lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z && lhs.w == rhs.w);
+	}
+
+	template<>
+	inline bool operator==(const Quaternion<float>& lhs, const Quaternion<float>& rhs) {
+		return (FloatEqual(lhs.x, rhs.x) && FloatEqual(lhs.y, rhs.y) && FloatEqual(lhs.z, rhs.z) && FloatEqual(lhs.w, rhs.w));
+	}
+
+	template<>
+	inline bool operator==(const Quaternion<double>& lhs, const Quaternion<double>& rhs) {
+		return (DoubleEqual(lhs.x, rhs.x) && DoubleEqual(lhs.y, rhs.y) && DoubleEqual(lhs.z, rhs.z) && DoubleEqual(lhs.w, rhs.w));
+	}
+
+	template<typename T>
+	void print(const Quaternion<T>& q) {
+		std::cout << "x = " << q.x << ", y = " << q.y << ", z = " << q.z << ", w = " << q.w << std::endl;
+	}
+
+	template<typename T>
+	constexpr T dot(const Quaternion<T>& lhs, const Quaternion<T>& rhs) {
+		return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+	}
+
+	template<typename T>
+	constexpr Quaternion<T> Conjugate(const Quaternion<T>& q) {
+		return Quaternion<T>(-q.x, -q.y, -q.z, q.w);
+	}
+
+	template<typename T>
+	Quaternion<T> Inverse(const Quaternion<T>& q) {
+		T inv = static_cast<T>(1) / dot(q, q);
+		return Quaternion<T>(-q.x * inv, -q.y * inv, -q.z * inv, q.w * inv);
+	}
+
+	template<typename T>
+	Quaternion<T> Normalize(const Quaternion<T>& q) {
+		T len = static_cast<T>(sqrt(dot(q, q)));
+		return Quaternion<T>(q.x / len, q.y / len, q.z / len, q.w / len);
+	}
+
+	template<typename T>
+	Vector3<T> Rotate(const Quaternion<T>& q, const Vector3<T>& v) {
+		//v + 2w(u x v) + 2u x (u x v)
+		Vector3<T> u(q.x, q.y, q.z);
+		Vector3<T> t = cross(u, v) * static_cast<T>(2);
+		return v + t * q.w + cross(u, t);
+	}
+
+	//最短経路側で線形補間して正規化
+	template<typename T>
+	Quaternion<T> Nlerp(const Quaternion<T>& a, const Quaternion<T>& b, T t) {
+		T sign = dot(a, b) < 0 ? static_cast<T>(-1) : static_cast<T>(1);
+		return Normalize(a * (static_cast<T>(1) - t) + b * (t * sign));
+	}
+
+	template<typename T>
+	Quaternion<T> Slerp(const Quaternion<T>& a, const Quaternion<T>& b, T t) {
+		T cosTheta = dot(a, b);
+		T sign = static_cast<T>(1);
+		if (cosTheta < 0) {
+			cosTheta = -cosTheta;
+			sign = static_cast<T>(-1);
+		}
+		//ほぼ同じ向きの場合はNlerpで代用
+		if (cosTheta > static_cast<T>(0.9995)) {
+			return Normalize(a * (static_cast<T>(1) - t) + b * (t * sign));
+		}
+		T theta = static_cast<T>(acos(cosTheta));
+		T invSin = static_cast<T>(1) / static_cast<T>(sin(theta));
+		T s0 = static_cast<T>(sin((static_cast<T>(1) - t) * theta)) * invSin;
+		T s1 = static_cast<T>(sin(t * theta)) * invSin * sign;
+		return a * s0 + b * s1;
+	}
+
+	//回転行列への変換 (mat * vec の列ベクトル形式)
+	template<typename T>
+	Matrix4x4<T> ToMatrix4x4(const Quaternion<T>& q) {
+		const T one = static_cast<T>(1);
+		const T two = static_cast<T>(2);
+		T xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+		T xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+		T wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+		return Matrix4x4<T>(
+			Vector4<T>(one - two * (yy + zz), two * (xy - wz), two * (xz + wy), 0),
+			Vector4<T>(two * (xy + wz), one - two * (xx + zz), two * (yz - wx), 0),
+			Vector4<T>(two * (xz - wy), two * (yz + wx), one - two * (xx + yy), 0),
+			Vector4<T>(0, 0, 0, one)
+			);
+	}
+
+	//回転行列(スケールなし)からの変換
+	template<typename T>
+	Quaternion<T> ToQuaternion(const Matrix4x4<T>& mat) {
+		const T one = static_cast<T>(1);
+		T trace = mat[0][0] + mat[1][1] + mat[2][2];
+		Quaternion<T> ret;
+		if (trace > 0) {
+			T s = static_cast<T>(sqrt(trace + one)) * 2;
+			ret.w = s * static_cast<T>(0.25);
+			ret.x = (mat[2][1] - mat[1][2]) / s;
+			ret.y = (mat[0][2] - mat[2][0]) / s;
+			ret.z = (mat[1][0] - mat[0][1]) / s;
+		}
+		else if (mat[0][0] > mat[1][1] && mat[0][0] > mat[2][2]) {
+			T s = static_cast<T>(sqrt(one + mat[0][0] - mat[1][1] - mat[2][2])) * 2;
+			ret.w = (mat[2][1] - mat[1][2]) / s;
+			ret.x = s * static_cast<T>(0.25);
+			ret.y = (mat[0][1] + mat[1][0]) / s;
+			ret.z = (mat[0][2] + mat[2][0]) / s;
+		}
+		else if (mat[1][1] > mat[2][2]) {
+			T s = static_cast<T>(sqrt(one + mat[1][1] - mat[0][0] - mat[2][2])) * 2;
+			ret.w = (mat[0][2] - mat[2][0]) / s;
+			ret.x = (mat[0][1] + mat[1][0]) / s;
+			ret.y = s * static_cast<T>(0.25);
+			ret.z = (mat[1][2] + mat[2][1]) / s;
+		}
+		else {
+			T s = static_cast<T>(sqrt(one + mat[2][2] - mat[0][0] - mat[1][1])) * 2;
+			ret.w = (mat[1][0] - mat[0][1]) / s;
+			ret.x = (mat[0][2] + mat[2][0]) / s;
+			ret.y = (mat[1][2] + mat[2][1]) / s;
+			ret.z = s * static_cast<T>(0.25);
+		}
+		return ret;
+	}
+} // namespace mff
\ No newline at end of file
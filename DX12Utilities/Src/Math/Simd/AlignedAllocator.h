@@ -0,0 +1,52 @@
+﻿#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+
+namespace mff {
+	/*
+	Alignバイト境界に揃えてメモリを確保するアロケーター
+	std::vector<float, AlignedAllocator<float, 16>> のように使う
+	*/
+	template<typename T, size_t Align>
+	struct AlignedAllocator {
+		using value_type = T;
+
+		template<typename U>
+		struct rebind {
+			using other = AlignedAllocator<U, Align>;
+		};
+
+		AlignedAllocator() {}
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+		T* allocate(size_t n) {
+			//先頭の直前に元のポインタを保存しておく
+			void* raw = malloc(n * sizeof(T) + Align + sizeof(void*));
+			if (!raw) {
+				throw std::bad_alloc();
+			}
+			uintptr_t p = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + Align - 1) & ~static_cast<uintptr_t>(Align - 1);
+			reinterpret_cast<void**>(p)[-1] = raw;
+			return reinterpret_cast<T*>(p);
+		}
+
+		void deallocate(T* p, size_t) {
+			if (p) {
+				free(reinterpret_cast<void**>(p)[-1]);
+			}
+		}
+	};
+
+	template<typename T, typename U, size_t Align>
+	bool operator==(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) {
+		return true;
+	}
+
+	template<typename T, typename U, size_t Align>
+	bool operator!=(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&) {
+		return false;
+	}
+} // namespace mff
\ No newline at end of file
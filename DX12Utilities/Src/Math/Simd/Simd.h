@@ -0,0 +1,325 @@
+﻿#pragma once
+#include <math.h>
+
+//SIMD命令セットの選択(コンパイル時)
+//MFF_SIMD_DISABLE を定義するとスカラー実装を強制する
+#if !defined(MFF_SIMD_DISABLE)
+#if defined(__AVX__)
+#define MFF_SIMD_AVX 1
+#endif
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define MFF_SIMD_SSE41 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MFF_SIMD_SSE 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define MFF_SIMD_NEON 1
+#endif
+#endif
+
+#if defined(MFF_SIMD_SSE)
+#include <emmintrin.h>
+#if defined(MFF_SIMD_SSE41)
+#include <smmintrin.h>
+#endif
+#if defined(MFF_SIMD_AVX)
+#include <immintrin.h>
+#endif
+#elif defined(MFF_SIMD_NEON)
+#include <arm_neon.h>
+#else
+#define MFF_SIMD_SCALAR 1
+#include <string.h>
+#endif
+
+namespace mff {
+	namespace simd {
+		/*
+		4要素floatレジスタ
+		ロード/ストアはアラインメントを要求しない(頂点構造体内のVector4<float>を直接扱うため)
+		*/
+#if defined(MFF_SIMD_SSE)
+		using Float4 = __m128;
+
+		inline Float4 Load(const float* p) { return _mm_loadu_ps(p); }
+		inline void Store(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+		inline Float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+		inline Float4 Splat(float v) { return _mm_set1_ps(v); }
+		inline Float4 Zero() { return _mm_setzero_ps(); }
+		inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+		inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+		inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+		inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+		inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+		inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+		inline Float4 Sqrt(Float4 a) { return _mm_sqrt_ps(a); }
+		inline Float4 Neg(Float4 a) { return _mm_sub_ps(_mm_setzero_ps(), a); }
+		//a * b + c
+		inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+		template<int I>
+		inline Float4 Broadcast(Float4 v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I, I, I, I)); }
+
+		inline float GetX(Float4 v) { return _mm_cvtss_f32(v); }
+
+		//比較結果は全ビット1/0のマスク
+		inline Float4 Less(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+		inline Float4 Greater(Float4 a, Float4 b) { return _mm_cmpgt_ps(a, b); }
+		inline Float4 And(Float4 a, Float4 b) { return _mm_and_ps(a, b); }
+		inline Float4 Or(Float4 a, Float4 b) { return _mm_or_ps(a, b); }
+		inline Float4 Xor(Float4 a, Float4 b) { return _mm_xor_ps(a, b); }
+		inline Float4 Abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+		//mask ? a : b
+		inline Float4 Select(Float4 mask, Float4 a, Float4 b) {
+#if defined(MFF_SIMD_SSE41)
+			return _mm_blendv_ps(b, a, mask);
+#else
+			return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#endif
+		}
+		//各要素の符号ビットを下位4bitに集める
+		inline int MoveMask(Float4 a) { return _mm_movemask_ps(a); }
+
+		//内積を全要素に複製して返す
+		inline Float4 Dot4(Float4 a, Float4 b) {
+#if defined(MFF_SIMD_SSE41)
+			return _mm_dp_ps(a, b, 0xff);
+#else
+			Float4 m = _mm_mul_ps(a, b);
+			Float4 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+			return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+#endif
+		}
+
+		inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) {
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		}
+
+		//xyzxyz... 12要素 → x,y,z 各4要素
+		inline void LoadXYZ(const float* p, Float4& x, Float4& y, Float4& z) {
+			const Float4 a = _mm_loadu_ps(p);
+			const Float4 b = _mm_loadu_ps(p + 4);
+			const Float4 c = _mm_loadu_ps(p + 8);
+			x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+			y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+			z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+		}
+
+		//x,y,z 各4要素 → xyzxyz... 12要素
+		inline void StoreXYZ(float* p, Float4 x, Float4 y, Float4 z) {
+			const Float4 xyLo = _mm_unpacklo_ps(x, y);
+			const Float4 xyHi = _mm_unpackhi_ps(x, y);
+			_mm_storeu_ps(p, _mm_shuffle_ps(xyLo, _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)));
+			_mm_storeu_ps(p + 4, _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), xyHi, _MM_SHUFFLE(1, 0, 2, 0)));
+			_mm_storeu_ps(p + 8, _mm_shuffle_ps(_mm_shuffle_ps(z, xyHi, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+
+#elif defined(MFF_SIMD_NEON)
+		using Float4 = float32x4_t;
+
+		inline Float4 Load(const float* p) { return vld1q_f32(p); }
+		inline void Store(float* p, Float4 v) { vst1q_f32(p, v); }
+		inline Float4 Set(float x, float y, float z, float w) {
+			const float tmp[4] = { x, y, z, w };
+			return vld1q_f32(tmp);
+		}
+		inline Float4 Splat(float v) { return vdupq_n_f32(v); }
+		inline Float4 Zero() { return vdupq_n_f32(0.0f); }
+		inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+		inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+		inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+		inline Float4 Min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+		inline Float4 Max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+		inline Float4 Neg(Float4 a) { return vnegq_f32(a); }
+		inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return vmlaq_f32(c, a, b); }
+#if defined(__aarch64__) || defined(_M_ARM64)
+		inline Float4 Div(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+		inline Float4 Sqrt(Float4 a) { return vsqrtq_f32(a); }
+#else
+		inline Float4 Div(Float4 a, Float4 b) {
+			Float4 r = vrecpeq_f32(b);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			r = vmulq_f32(vrecpsq_f32(b, r), r);
+			return vmulq_f32(a, r);
+		}
+		inline Float4 Sqrt(Float4 a) {
+			float tmp[4];
+			vst1q_f32(tmp, a);
+			return Set(sqrtf(tmp[0]), sqrtf(tmp[1]), sqrtf(tmp[2]), sqrtf(tmp[3]));
+		}
+#endif
+
+		template<int I>
+		inline Float4 Broadcast(Float4 v) { return vdupq_n_f32(vgetq_lane_f32(v, I)); }
+
+		inline float GetX(Float4 v) { return vgetq_lane_f32(v, 0); }
+
+		inline Float4 Less(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcltq_f32(a, b)); }
+		inline Float4 Greater(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+		inline Float4 And(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline Float4 Or(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline Float4 Xor(Float4 a, Float4 b) { return vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+		inline Float4 Abs(Float4 a) { return vabsq_f32(a); }
+		inline Float4 Select(Float4 mask, Float4 a, Float4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+		inline int MoveMask(Float4 a) {
+			uint32x4_t u = vshrq_n_u32(vreinterpretq_u32_f32(a), 31);
+			return static_cast<int>(vgetq_lane_u32(u, 0) | (vgetq_lane_u32(u, 1) << 1) | (vgetq_lane_u32(u, 2) << 2) | (vgetq_lane_u32(u, 3) << 3));
+		}
+
+		inline Float4 Dot4(Float4 a, Float4 b) {
+			Float4 m = vmulq_f32(a, b);
+			float32x2_t s = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+			s = vpadd_f32(s, s);
+			return vcombine_f32(s, s);
+		}
+
+		inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) {
+			float32x4x2_t t01 = vtrnq_f32(r0, r1);
+			float32x4x2_t t23 = vtrnq_f32(r2, r3);
+			r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+			r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+			r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+			r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+		}
+
+		inline void LoadXYZ(const float* p, Float4& x, Float4& y, Float4& z) {
+			const float32x4x3_t v = vld3q_f32(p);
+			x = v.val[0];
+			y = v.val[1];
+			z = v.val[2];
+		}
+
+		inline void StoreXYZ(float* p, Float4 x, Float4 y, Float4 z) {
+			float32x4x3_t v;
+			v.val[0] = x;
+			v.val[1] = y;
+			v.val[2] = z;
+			vst3q_f32(p, v);
+		}
+
+#else
+		struct Float4 {
+			float m[4];
+		};
+
+		inline Float4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+		inline void Store(float* p, Float4 v) {
+			p[0] = v.m[0];
+			p[1] = v.m[1];
+			p[2] = v.m[2];
+			p[3] = v.m[3];
+		}
+		inline Float4 Set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+		inline Float4 Splat(float v) { return { { v, v, v, v } }; }
+		inline Float4 Zero() { return Splat(0.0f); }
+
+#define MFF_SIMD_SCALAR_BINARY(name, expr)\
+inline Float4 name(Float4 a, Float4 b){\
+	Float4 r;\
+	for (int i = 0; i < 4; ++i) {\
+		const float x = a.m[i];\
+		const float y = b.m[i];\
+		r.m[i] = (expr);\
+	}\
+	return r;\
+}
+		MFF_SIMD_SCALAR_BINARY(Add, x + y);
+		MFF_SIMD_SCALAR_BINARY(Sub, x - y);
+		MFF_SIMD_SCALAR_BINARY(Mul, x * y);
+		MFF_SIMD_SCALAR_BINARY(Div, x / y);
+		MFF_SIMD_SCALAR_BINARY(Min, x < y ? x : y);
+		MFF_SIMD_SCALAR_BINARY(Max, x > y ? x : y);
+#undef MFF_SIMD_SCALAR_BINARY
+
+		inline Float4 Sqrt(Float4 a) { return { { sqrtf(a.m[0]), sqrtf(a.m[1]), sqrtf(a.m[2]), sqrtf(a.m[3]) } }; }
+		inline Float4 Neg(Float4 a) { return { { -a.m[0], -a.m[1], -a.m[2], -a.m[3] } }; }
+		inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return Add(Mul(a, b), c); }
+
+		template<int I>
+		inline Float4 Broadcast(Float4 v) { return Splat(v.m[I]); }
+
+		inline float GetX(Float4 v) { return v.m[0]; }
+
+		inline unsigned int ToBits(float v) {
+			unsigned int ret;
+			memcpy(&ret, &v, sizeof(ret));
+			return ret;
+		}
+		inline float FromBits(unsigned int v) {
+			float ret;
+			memcpy(&ret, &v, sizeof(ret));
+			return ret;
+		}
+
+#define MFF_SIMD_SCALAR_BITS(name, expr)\
+inline Float4 name(Float4 a, Float4 b){\
+	Float4 r;\
+	for (int i = 0; i < 4; ++i) {\
+		const unsigned int x = ToBits(a.m[i]);\
+		const unsigned int y = ToBits(b.m[i]);\
+		r.m[i] = FromBits(expr);\
+	}\
+	return r;\
+}
+		MFF_SIMD_SCALAR_BITS(And, x & y);
+		MFF_SIMD_SCALAR_BITS(Or, x | y);
+		MFF_SIMD_SCALAR_BITS(Xor, x ^ y);
+#undef MFF_SIMD_SCALAR_BITS
+
+		inline Float4 Less(Float4 a, Float4 b) {
+			Float4 r;
+			for (int i = 0; i < 4; ++i) {
+				r.m[i] = FromBits(a.m[i] < b.m[i] ? 0xffffffffu : 0u);
+			}
+			return r;
+		}
+		inline Float4 Greater(Float4 a, Float4 b) { return Less(b, a); }
+		inline Float4 Abs(Float4 a) { return { { fabsf(a.m[0]), fabsf(a.m[1]), fabsf(a.m[2]), fabsf(a.m[3]) } }; }
+		inline Float4 Select(Float4 mask, Float4 a, Float4 b) {
+			Float4 r;
+			for (int i = 0; i < 4; ++i) {
+				r.m[i] = (ToBits(mask.m[i]) & 0x80000000u) ? a.m[i] : b.m[i];
+			}
+			return r;
+		}
+		inline int MoveMask(Float4 a) {
+			int ret = 0;
+			for (int i = 0; i < 4; ++i) {
+				ret |= static_cast<int>(ToBits(a.m[i]) >> 31) << i;
+			}
+			return ret;
+		}
+
+		inline Float4 Dot4(Float4 a, Float4 b) {
+			return Splat(a.m[0] * b.m[0] + a.m[1] * b.m[1] + a.m[2] * b.m[2] + a.m[3] * b.m[3]);
+		}
+
+		inline void Transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) {
+			Float4* r[4] = { &r0, &r1, &r2, &r3 };
+			for (int i = 0; i < 4; ++i) {
+				for (int j = i + 1; j < 4; ++j) {
+					float tmp = r[i]->m[j];
+					r[i]->m[j] = r[j]->m[i];
+					r[j]->m[i] = tmp;
+				}
+			}
+		}
+
+		inline void LoadXYZ(const float* p, Float4& x, Float4& y, Float4& z) {
+			for (int i = 0; i < 4; ++i) {
+				x.m[i] = p[i * 3 + 0];
+				y.m[i] = p[i * 3 + 1];
+				z.m[i] = p[i * 3 + 2];
+			}
+		}
+
+		inline void StoreXYZ(float* p, Float4 x, Float4 y, Float4 z) {
+			for (int i = 0; i < 4; ++i) {
+				p[i * 3 + 0] = x.m[i];
+				p[i * 3 + 1] = y.m[i];
+				p[i * 3 + 2] = z.m[i];
+			}
+		}
+#endif
+	} // namespace simd
+} // namespace mff
\ No newline at end of file
@@ -5,35 +5,34 @@
 
 namespace mff {
 #define VEC2_ONE_ARG_OPERATOR(op) \
-Vector2& operator op (const Vector2& arg){ \
-	m[0] op arg.m[0];\
-	m[1] op arg.m[1];\
+constexpr Vector2& operator op (const Vector2& arg){ \
+	x op arg.x;\
+	y op arg.y;\
 	return *this;\
 }
 
 #define VEC2_ONE_ARG_OTHRES_OPERATOR(op)\
 template<typename U>\
-Vector2& operator op (const Vector2<U>& arg){\
-	m[0] op static_cast<T>(arg.m[0]);\
-	m[1] op static_cast<T>(arg.m[1]);\
+constexpr Vector2& operator op (const Vector2<U>& arg){\
+	x op static_cast<T>(arg.x);\
+	y op static_cast<T>(arg.y);\
 	return *this;\
 }
 
 #define VEC2_TWO_ARG_OPERATOR(op)\
 template<typename T>\
-Vector2<T> operator op (const Vector2<T>& lhs, const Vector2<T>& rhs){\
+constexpr Vector2<T> operator op (const Vector2<T>& lhs, const Vector2<T>& rhs){\
 	return Vector2<T>(lhs.x op rhs.x,lhs.y op rhs.y);\
 }
 
 	template<typename T>
 	struct Vector2 {
 		using type = T;
-		Vector2(T v = 0) : x(v), y(v) {}
-		Vector2(T x, T y) : x(x), y(y) {}
+		constexpr Vector2(T v = 0) : x(v), y(v) {}
+		constexpr Vector2(T x, T y) : x(x), y(y) {}
 
 		template<typename U>
-		Vector2& operator=(const Vector2<U>& arg) {
-			printf("template operator\n");
+		constexpr Vector2& operator=(const Vector2<U>& arg) {
 			x = static_cast<T>(arg.x);
 			y = static_cast<T>(arg.y);
 			return *this;
@@ -49,13 +48,13 @@ Vector2<T> operator op (const Vector2<T>& lhs, const Vector2<T>& rhs){\
 		VEC2_ONE_ARG_OTHRES_OPERATOR(*= );
 		VEC2_ONE_ARG_OTHRES_OPERATOR(/= );
 
-		Vector2& operator *= (T scaler) {
+		constexpr Vector2& operator *= (T scaler) {
 			x *= scaler;
 			y *= scaler;
 			return *this;
 		}
 
-		Vector2& operator /= (T scaler) {
+		constexpr Vector2& operator /= (T scaler) {
 			x /= scaler;
 			y /= scaler;
 			return *this;
@@ -82,42 +81,42 @@ Vector2<T> operator op (const Vector2<T>& lhs, const Vector2<T>& rhs){\
 	VEC2_TWO_ARG_OPERATOR(/ );
 
 	template<typename T>
-	Vector2<T> operator - (const Vector2<T>& arg) {
+	constexpr Vector2<T> operator - (const Vector2<T>& arg) {
 		return Vector2<T>(-arg.x, -arg.y);
 	}
 
 	template<typename T>
-	Vector2<T> operator * (const Vector2<T>& vec, T scaler) {
+	constexpr Vector2<T> operator * (const Vector2<T>& vec, T scaler) {
 		return Vector2<T>(vec.x * scaler, vec.y * scaler);
 	}
 	template<typename T>
-	Vector2<T> operator * (T scaler, const Vector2<T>& vec) {
+	constexpr Vector2<T> operator * (T scaler, const Vector2<T>& vec) {
 		return Vector2<T>(vec.x * scaler, vec.y * scaler);
 	}
 
 	template<typename T>
-	Vector2<T> operator / (const Vector2<T>& vec, T scaler) {
+	constexpr Vector2<T> operator / (const Vector2<T>& vec, T scaler) {
 		return Vector2<T>(vec.x / scaler, vec.y / scaler);
 	}
 	template<typename T>
-	Vector2<T> operator / (T scaler, const Vector2<T>& vec) {
+	constexpr Vector2<T> operator / (T scaler, const Vector2<T>& vec) {
 		return Vector2<T>(scaler / vec.x, scaler / vec.y);
 	}
 
 #define VEC2_TWO_ARG_OTHERS_OPERATOR(op)\
 template<typename T, typename U>\
-Vector2<typename HighAccuracy<T,U>::type> operator op (const Vector2<T>& lhs, const Vector2<U>& rhs){\
-	return Vector2<typename HighAccuracy<T,U>::type>(lhs.x op rhs.x, lhs.y op rhs.y);\
+constexpr Vector2<PrecisionType<T,U>> operator op (const Vector2<T>& lhs, const Vector2<U>& rhs){\
+	return Vector2<PrecisionType<T,U>>(lhs.x op rhs.x, lhs.y op rhs.y);\
 }
 
 #define VEC2_OTHER_SCALER_OPERATION(op)\
 template<typename T, typename U>\
-Vector2<typename HighAccuracy<T,U>::type> operator op (const Vector2<T>& vec, U scaler){\
-	return Vector2<typename HighAccuracy<T,U>::type>(vec.x op scaler, vec.y op scaler);\
+constexpr Vector2<PrecisionType<T,U>> operator op (const Vector2<T>& vec, U scaler){\
+	return Vector2<PrecisionType<T,U>>(vec.x op scaler, vec.y op scaler);\
 }\
 template<typename T, typename U>\
-Vector2<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector2<T>& vec) {\
-	return Vector2<typename HighAccuracy<T,U>::type>(scaler op vec.x, scaler op vec.y);\
+constexpr Vector2<PrecisionType<T,U>> operator op (U scaler, const Vector2<T>& vec) {\
+	return Vector2<PrecisionType<T,U>>(scaler op vec.x, scaler op vec.y);\
 }
 
 	VEC2_TWO_ARG_OTHERS_OPERATOR(+);
@@ -135,7 +134,7 @@ Vector2<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector2<T
 
 	template<>
 	inline bool operator==(const Vector2<float>& lhs, const Vector2<float>& rhs) {
-		return (FloatEqual(lhs.x, rhs.x) && FloatEqual(lhs.x, rhs.x));
+		return NearlyEqual(lhs.x, rhs.x) & NearlyEqual(lhs.y, rhs.y);
 	}
 
 	template<>
@@ -149,17 +148,36 @@ Vector2<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector2<T
 	}
 
 	template<typename T>
-	T dot(const Vector2<T>& lhs, const Vector2<T>& rhs) {
+	constexpr T dot(const Vector2<T>& lhs, const Vector2<T>& rhs) {
 		return lhs.x * rhs.x + lhs.y * rhs.y;
 	}
 
 	template<typename T>
-	T cross(const Vector2<T>& lhs, const Vector2<T>& rhs) {
+	constexpr T cross(const Vector2<T>& lhs, const Vector2<T>& rhs) {
 		return lhs.x * rhs.y - lhs.y * rhs.x;
 	}
 
 	template<typename T>
-	Vector2<T> Normalize(const Vector2<T>& vec) {
-		return vec / sqrt(vec.x * vec.x + vec.y * vec.y);
+	MFF_CONSTEXPR_DISPATCH Vector2<T> Normalize(const Vector2<T>& vec) {
+		return vec / Sqrt(vec.x * vec.x + vec.y * vec.y);
+	}
+
+	//a * (1 - t) + b * t
+	template<typename T>
+	constexpr Vector2<T> Lerp(const Vector2<T>& a, const Vector2<T>& b, T t) {
+		T s = static_cast<T>(1) - t;
+		return Vector2<T>(a.x * s + b.x * t, a.y * s + b.y * t);
+	}
+
+	//a * b + c
+	template<typename T>
+	constexpr Vector2<T> MulAdd(const Vector2<T>& a, const Vector2<T>& b, const Vector2<T>& c) {
+		return Vector2<T>(a.x * b.x + c.x, a.y * b.y + c.y);
+	}
+
+	//a + b * scaler
+	template<typename T>
+	constexpr Vector2<T> ScaledAdd(const Vector2<T>& a, const Vector2<T>& b, T scaler) {
+		return Vector2<T>(a.x + b.x * scaler, a.y + b.y * scaler);
 	}
 } // namespace mff
\ No newline at end of file
@@ -6,7 +6,7 @@
 namespace mff {
 
 #define VEC3_ONE_ARG_OPERATOR(op)\
-Vector3& operator op (const Vector3& arg){\
+constexpr Vector3& operator op (const Vector3& arg){\
 	x op arg.x;\
 	y op arg.y;\
 	z op arg.z;\
@@ -15,7 +15,7 @@ Vector3& operator op (const Vector3& arg){\
 
 #define VEC3_ONE_ARG_OTHER_OPERATOR(op)\
 template<typename U>\
-Vector3& operator op (const Vector3<U>& arg){\
+constexpr Vector3& operator op (const Vector3<U>& arg){\
 	x op static_cast<T>(arg.x);\
 	y op static_cast<T>(arg.y);\
 	z op static_cast<T>(arg.z);\
@@ -24,21 +24,21 @@ Vector3& operator op (const Vector3<U>& arg){\
 
 	template<typename T>
 	struct Vector3 {
-		Vector3(T v = 0) :x(v), y(v), z(v) {}
-		Vector3(T x, T y, T z) : x(x), y(y), z(z) {}
+		constexpr Vector3(T v = 0) :x(v), y(v), z(v) {}
+		constexpr Vector3(T x, T y, T z) : x(x), y(y), z(z) {}
 
 		template<typename U>
-		Vector3<T>& operator=(const Vector3<U>& arg) {
+		constexpr Vector3<T>& operator=(const Vector3<U>& arg) {
 			x = static_cast<T>(arg.x);
 			y = static_cast<T>(arg.y);
 			z = static_cast<T>(arg.z);
 			return *this;
 		}
 
-		T Length() const {
-			return sqrt(x * x + y * y + z * z);
+		MFF_CONSTEXPR_DISPATCH T Length() const {
+			return Sqrt(x * x + y * y + z * z);
 		}
-		T LengthSq() const {
+		constexpr T LengthSq() const {
 			return dot(*this, *this);
 		}
 		VEC3_ONE_ARG_OPERATOR(+= );
@@ -51,14 +51,14 @@ Vector3& operator op (const Vector3<U>& arg){\
 		VEC3_ONE_ARG_OTHER_OPERATOR(*= );
 		VEC3_ONE_ARG_OTHER_OPERATOR(/= );
 
-		Vector3& operator *= (T scaler) {
+		constexpr Vector3& operator *= (T scaler) {
 			x *= scaler;
 			y *= scaler;
 			z *= scaler;
 			return *this;
 		}
 
-		Vector3& operator /= (T scaler) {
+		constexpr Vector3& operator /= (T scaler) {
 			x /= scaler;
 			y /= scaler;
 			z /= scaler;
@@ -75,32 +75,32 @@ Vector3& operator op (const Vector3<U>& arg){\
 
 #define VEC3_TWO_ARG_OPERATOR(op)\
 template<typename T>\
-Vector3<T> operator op (const Vector3<T>& lhs, const Vector3<T>& rhs){\
+constexpr Vector3<T> operator op (const Vector3<T>& lhs, const Vector3<T>& rhs){\
 	return Vector3<T>(lhs.x op rhs.x, lhs.y op rhs.y, lhs.z op rhs.z);\
 }
 #define VEC3_TWO_ARG_OTHERS_OPERATOR(op)\
 template<typename T, typename U>\
-Vector3<typename HighAccuracy<T,U>::type> operator op (const Vector3<T>& lhs, const Vector3<U>& rhs){\
-	return Vector3<typename HighAccuracy<T,U>::type>(lhs.x op rhs.x,lhs.y op rhs.y,lhs.z op rhs.z);\
+constexpr Vector3<PrecisionType<T,U>> operator op (const Vector3<T>& lhs, const Vector3<U>& rhs){\
+	return Vector3<PrecisionType<T,U>>(lhs.x op rhs.x,lhs.y op rhs.y,lhs.z op rhs.z);\
 }
 #define VEC3_SCALER_OPERATION(op)\
 template<typename T>\
-Vector3<T> operator op (const Vector3<T>& vec, T scaler){\
+constexpr Vector3<T> operator op (const Vector3<T>& vec, T scaler){\
 	return Vector3<T>(vec.x op scaler, vec.y op scaler, vec.z op scaler);\
 }\
 template<typename T>\
-Vector3<T> operator op (T scaler, const Vector3<T>& vec){\
+constexpr Vector3<T> operator op (T scaler, const Vector3<T>& vec){\
 	return Vector3<T>(scaler op vec.x, scaler op vec.y, scaler op vec.z);\
 }
 
 #define VEC3_OTHER_SCALER_OPERATION(op)\
 template<typename T, typename U>\
-Vector3<typename HighAccuracy<T,U>::type> operator op (const Vector3<T>& vec, U scaler){\
-	return Vector3<typename HighAccuracy<T,U>::type>(vec.x op scaler, vec.y op scaler, vec.z op scaler);\
+constexpr Vector3<PrecisionType<T,U>> operator op (const Vector3<T>& vec, U scaler){\
+	return Vector3<PrecisionType<T,U>>(vec.x op scaler, vec.y op scaler, vec.z op scaler);\
 }\
 template<typename T, typename U>\
-Vector3<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector3<T>& vec) {\
-	return Vector3<typename HighAccuracy<T,U>::type>(scaler op vec.x, scaler op vec.y, scaler op vec.z);\
+constexpr Vector3<PrecisionType<T,U>> operator op (U scaler, const Vector3<T>& vec) {\
+	return Vector3<PrecisionType<T,U>>(scaler op vec.x, scaler op vec.y, scaler op vec.z);\
 }
 
 	VEC3_TWO_ARG_OPERATOR(+);
@@ -126,7 +126,7 @@ Vector3<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector3<T
 
 	template<>
 	inline bool operator==(const Vector3<float>& lhs, const Vector3<float>& rhs) {
-		return (FloatEqual(lhs.x, rhs.x) && FloatEqual(lhs.y, rhs.y) && FloatEqual(lhs.z, rhs.z));
+		return NearlyEqual(lhs.x, rhs.x) & NearlyEqual(lhs.y, rhs.y) & NearlyEqual(lhs.z, rhs.z);
 	}
 
 	template<>
@@ -140,17 +140,36 @@ Vector3<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector3<T
 	}
 
 	template<typename T>
-	T dot(const Vector3<T>& lhs, const Vector3<T>& rhs) {
+	constexpr T dot(const Vector3<T>& lhs, const Vector3<T>& rhs) {
 		return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z;
 	}
 
 	template<typename T>
-	Vector3<T> cross(const Vector3<T>& lhs, const Vector3<T>& rhs) {
+	constexpr Vector3<T> cross(const Vector3<T>& lhs, const Vector3<T>& rhs) {
 		return Vector3<T>(lhs.y * rhs.z - lhs.z * rhs.y, lhs.z * rhs.x - lhs.x * rhs.z, lhs.x * rhs.y - lhs.y * rhs.x);
 	}
 
 	template<typename T>
-	Vector3<T> Normalize(const Vector3<T>& vec) {
-		return vec / sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z);
+	MFF_CONSTEXPR_DISPATCH Vector3<T> Normalize(const Vector3<T>& vec) {
+		return vec / Sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z);
+	}
+
+	//a * (1 - t) + b * t
+	template<typename T>
+	constexpr Vector3<T> Lerp(const Vector3<T>& a, const Vector3<T>& b, T t) {
+		T s = static_cast<T>(1) - t;
+		return Vector3<T>(a.x * s + b.x * t, a.y * s + b.y * t, a.z * s + b.z * t);
+	}
+
+	//a * b + c
+	template<typename T>
+	constexpr Vector3<T> MulAdd(const Vector3<T>& a, const Vector3<T>& b, const Vector3<T>& c) {
+		return Vector3<T>(a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z);
+	}
+
+	//a + b * scaler
+	template<typename T>
+	constexpr Vector3<T> ScaledAdd(const Vector3<T>& a, const Vector3<T>& b, T scaler) {
+		return Vector3<T>(a.x + b.x * scaler, a.y + b.y * scaler, a.z + b.z * scaler);
 	}
 } // namespace mff
\ No newline at end of file
@@ -2,13 +2,14 @@
 #include "VectorAccuracy.h"
 #include "Vector3.h"
 #include "../MathFunctions.h"
+#include "../Simd/Simd.h"
 #include <iostream>
 
 namespace mff {
 
 
 #define VEC4_ONE_ARG_OPERATOR(op)\
-Vector4& operator op (const Vector4& arg){\
+constexpr Vector4& operator op (const Vector4& arg){\
 	x op arg.x;\
 	y op arg.y;\
 	z op arg.z;\
@@ -18,7 +19,7 @@ Vector4& operator op (const Vector4& arg){\
 
 #define VEC4_ONE_ARG_OTHER_OPERATOR(op)\
 template<typename U>\
-Vector4& operator op (const Vector4<U>& arg) {\
+constexpr Vector4& operator op (const Vector4<U>& arg) {\
 	x op static_cast<T>(arg.x);\
 	y op static_cast<T>(arg.y);\
 	z op static_cast<T>(arg.z);\
@@ -28,15 +29,15 @@ Vector4& operator op (const Vector4<U>& arg) {\
 
 	template<typename T>
 	struct Vector4 {
-		Vector4() :x(0), y(0), z(0), w(1) {}
-		Vector4(T v) : x(v), y(v), z(v), w(v) {}
-		Vector4(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+		constexpr Vector4() :x(0), y(0), z(0), w(1) {}
+		constexpr Vector4(T v) : x(v), y(v), z(v), w(v) {}
+		constexpr Vector4(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
 
 		template<typename U>
-		Vector4(const Vector3<T>& v, U w = 0) : x(v.x), y(v.y), z(v.z), w(static_cast<T>(w)) {}
+		constexpr Vector4(const Vector3<T>& v, U w = 0) : x(v.x), y(v.y), z(v.z), w(static_cast<T>(w)) {}
 
 		template<typename U>
-		Vector4<T>& operator=(const Vector4<U>& arg) {
+		constexpr Vector4<T>& operator=(const Vector4<U>& arg) {
 			x = static_cast<T>(arg.x);
 			y = static_cast<T>(arg.y);
 			z = static_cast<T>(arg.z);
@@ -54,14 +55,14 @@ Vector4& operator op (const Vector4<U>& arg) {\
 		VEC4_ONE_ARG_OTHER_OPERATOR(*= );
 		VEC4_ONE_ARG_OTHER_OPERATOR(/= );
 
-		Vector4& operator *= (T scaler) {
+		constexpr Vector4& operator *= (T scaler) {
 			x *= scaler;
 			y *= scaler;
 			z *= scaler;
 			w *= scaler;
 			return *this;
 		}
-		Vector4& operator /= (T scaler) {
+		constexpr Vector4& operator /= (T scaler) {
 			x /= scaler;
 			y /= scaler;
 			z /= scaler;
@@ -87,33 +88,33 @@ Vector4& operator op (const Vector4<U>& arg) {\
 
 #define VEC4_TWO_ARG_OPERATOR(op)\
 template<typename T>\
-Vector4<T> operator op (const Vector4<T>& lhs, const Vector4<T>& rhs){\
+constexpr Vector4<T> operator op (const Vector4<T>& lhs, const Vector4<T>& rhs){\
 	return Vector4<T>(lhs.x op rhs.x, lhs.y op rhs.y, lhs.z op rhs.z, lhs.w op rhs.w);\
 }
 #define VEC4_TWO_ARG_OTHERS_OPERATOR(op)\
 template<typename T, typename U>\
-Vector4<typename HighAccuracy<T,U>::type> operator op (const Vector4<T>& lhs, const Vector4<U>& rhs){\
-	return Vector4<typename HighAccuracy<T,U>::type>(lhs.x op rhs.x, lhs.y op rhs.y, lhs.z op rhs.z, lhs.w op rhs.w);\
+constexpr Vector4<PrecisionType<T,U>> operator op (const Vector4<T>& lhs, const Vector4<U>& rhs){\
+	return Vector4<PrecisionType<T,U>>(lhs.x op rhs.x, lhs.y op rhs.y, lhs.z op rhs.z, lhs.w op rhs.w);\
 }
 
 #define VEC4_SCALER_OPERATION(op)\
 template<typename T>\
-Vector4<T> operator op (const Vector4<T>& vec, T scaler){\
+constexpr Vector4<T> operator op (const Vector4<T>& vec, T scaler){\
 	return Vector4<T>(vec.x op scaler, vec.y op scaler, vec.z op scaler, vec.w op scaler);\
 }\
 template<typename T>\
-Vector4<T> operator op (T scaler, const Vector4<T>& vec){\
+constexpr Vector4<T> operator op (T scaler, const Vector4<T>& vec){\
 	return Vector4<T>(scaler op vec.x, scaler op vec.y, scaler op vec.z, scaler op vec.w);\
 }
 
 #define VEC4_OTHER_SCALER_OPERATION(op)\
 template<typename T, typename U>\
-Vector4<typename HighAccuracy<T,U>::type> operator op (const Vector4<T>& vec, U scaler){\
-	return Vector4<typename HighAccuracy<T,U>::type>(vec.x op scaler, vec.y op scaler, vec.z op scaler, vec.w op scaler);\
+constexpr Vector4<PrecisionType<T,U>> operator op (const Vector4<T>& vec, U scaler){\
+	return Vector4<PrecisionType<T,U>>(vec.x op scaler, vec.y op scaler, vec.z op scaler, vec.w op scaler);\
 }\
 template<typename T, typename U>\
-Vector4<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector4<T>& vec) {\
-	return Vector4<typename HighAccuracy<T,U>::type>(scaler op vec.x, scaler op vec.y, scaler op vec.z, scaler op vec.w);\
+constexpr Vector4<PrecisionType<T,U>> operator op (U scaler, const Vector4<T>& vec) {\
+	return Vector4<PrecisionType<T,U>>(scaler op vec.x, scaler op vec.y, scaler op vec.z, scaler op vec.w);\
 }
 
 	VEC4_TWO_ARG_OPERATOR(+);
@@ -139,7 +140,12 @@ Vector4<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector4<T
 
 	template<>
 	inline bool operator==(const Vector4<float>& lhs, const Vector4<float>& rhs) {
-		return (FloatEqual(lhs.x, rhs.x) && FloatEqual(lhs.y, rhs.y) && FloatEqual(lhs.z, rhs.z) && FloatEqual(lhs.w, rhs.w));
+		//NearlyEqual on all four components at once
+		const simd::Float4 a = simd::Load(lhs.m);
+		const simd::Float4 b = simd::Load(rhs.m);
+		const simd::Float4 epsilon = simd::Splat(static_cast<float>(MFF_FEPSILON));
+		const simd::Float4 relative = simd::Mul(simd::Max(simd::Abs(a), simd::Abs(b)), epsilon);
+		return simd::MoveMask(simd::Less(simd::Abs(simd::Sub(a, b)), simd::Max(epsilon, relative))) == 0xf;
 	}
 
 	template<>
@@ -153,12 +159,159 @@ Vector4<typename HighAccuracy<T,U>::type> operator op (U scaler, const Vector4<T
 	}
 
 	template<typename T>
-	T dot(const Vector4<T>& lhs, const Vector4<T>& rhs) {
+	constexpr T dot(const Vector4<T>& lhs, const Vector4<T>& rhs) {
 		return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
 	}
 
 	template<typename T>
-	Vector4<T> Normalize(const Vector4<T>& vec) {
-		return vec / sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z + vec.w * vec.w);
+	MFF_CONSTEXPR_DISPATCH Vector4<T> Normalize(const Vector4<T>& vec) {
+		return vec / Sqrt(vec.x * vec.x + vec.y * vec.y + vec.z * vec.z + vec.w * vec.w);
+	}
+
+	//a * (1 - t) + b * t
+	template<typename T>
+	constexpr Vector4<T> Lerp(const Vector4<T>& a, const Vector4<T>& b, T t) {
+		T s = static_cast<T>(1) - t;
+		return Vector4<T>(a.x * s + b.x * t, a.y * s + b.y * t, a.z * s + b.z * t, a.w * s + b.w * t);
+	}
+
+	//a * b + c
+	template<typename T>
+	constexpr Vector4<T> MulAdd(const Vector4<T>& a, const Vector4<T>& b, const Vector4<T>& c) {
+		return Vector4<T>(a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z, a.w * b.w + c.w);
+	}
+
+	//a + b * scaler
+	template<typename T>
+	constexpr Vector4<T> ScaledAdd(const Vector4<T>& a, const Vector4<T>& b, T scaler) {
+		return Vector4<T>(a.x + b.x * scaler, a.y + b.y * scaler, a.z + b.z * scaler, a.w + b.w * scaler);
+	}
+
+	namespace simd {
+		inline Float4 Load(const Vector4<float>& v) { return Load(v.m); }
+		inline Vector4<float> ToVector4(Float4 v) {
+			Vector4<float> ret;
+			Store(ret.m, v);
+			return ret;
+		}
+	} // namespace simd
+
+#define VEC4_SIMD_ONE_ARG_OPERATOR(op, func)\
+template<>\
+inline MFF_CONSTEXPR_DISPATCH Vector4<float>& Vector4<float>::operator op (const Vector4<float>& arg){\
+	if (MFF_IS_CONSTANT_EVALUATED()) {\
+		x op arg.x;\
+		y op arg.y;\
+		z op arg.z;\
+		w op arg.w;\
+		return *this;\
+	}\
+	simd::Store(m, simd::func(simd::Load(m), simd::Load(arg.m)));\
+	return *this;\
+}
+
+#define VEC4_SIMD_TWO_ARG_OPERATOR(op, func)\
+template<>\
+inline MFF_CONSTEXPR_DISPATCH Vector4<float> operator op (const Vector4<float>& lhs, const Vector4<float>& rhs){\
+	if (MFF_IS_CONSTANT_EVALUATED()) {\
+		return Vector4<float>(lhs.x op rhs.x, lhs.y op rhs.y, lhs.z op rhs.z, lhs.w op rhs.w);\
+	}\
+	return simd::ToVector4(simd::func(simd::Load(lhs), simd::Load(rhs)));\
+}
+
+#define VEC4_SIMD_SCALER_OPERATION(op, func)\
+template<>\
+inline MFF_CONSTEXPR_DISPATCH Vector4<float> operator op (const Vector4<float>& vec, float scaler){\
+	if (MFF_IS_CONSTANT_EVALUATED()) {\
+		return Vector4<float>(vec.x op scaler, vec.y op scaler, vec.z op scaler, vec.w op scaler);\
+	}\
+	return simd::ToVector4(simd::func(simd::Load(vec), simd::Splat(scaler)));\
+}\
+template<>\
+inline MFF_CONSTEXPR_DISPATCH Vector4<float> operator op (float scaler, const Vector4<float>& vec){\
+	if (MFF_IS_CONSTANT_EVALUATED()) {\
+		return Vector4<float>(scaler op vec.x, scaler op vec.y, scaler op vec.z, scaler op vec.w);\
+	}\
+	return simd::ToVector4(simd::func(simd::Splat(scaler), simd::Load(vec)));\
+}
+
+	VEC4_SIMD_ONE_ARG_OPERATOR(+=, Add);
+	VEC4_SIMD_ONE_ARG_OPERATOR(-=, Sub);
+	VEC4_SIMD_ONE_ARG_OPERATOR(*=, Mul);
+	VEC4_SIMD_ONE_ARG_OPERATOR(/=, Div);
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Vector4<float>& Vector4<float>::operator *= (float scaler) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			x *= scaler;
+			y *= scaler;
+			z *= scaler;
+			w *= scaler;
+			return *this;
+		}
+		simd::Store(m, simd::Mul(simd::Load(m), simd::Splat(scaler)));
+		return *this;
+	}
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Vector4<float>& Vector4<float>::operator /= (float scaler) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			x /= scaler;
+			y /= scaler;
+			z /= scaler;
+			w /= scaler;
+			return *this;
+		}
+		simd::Store(m, simd::Div(simd::Load(m), simd::Splat(scaler)));
+		return *this;
+	}
+
+	VEC4_SIMD_TWO_ARG_OPERATOR(+, Add);
+	VEC4_SIMD_TWO_ARG_OPERATOR(-, Sub);
+	VEC4_SIMD_TWO_ARG_OPERATOR(*, Mul);
+	VEC4_SIMD_TWO_ARG_OPERATOR(/, Div);
+
+	VEC4_SIMD_SCALER_OPERATION(*, Mul);
+	VEC4_SIMD_SCALER_OPERATION(/, Div);
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH float dot(const Vector4<float>& lhs, const Vector4<float>& rhs) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return lhs.x * rhs.x + lhs.y * rhs.y + lhs.z * rhs.z + lhs.w * rhs.w;
+		}
+		return simd::GetX(simd::Dot4(simd::Load(lhs), simd::Load(rhs)));
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Vector4<float> Normalize(const Vector4<float>& vec) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return vec / ConstexprSqrt(dot(vec, vec));
+		}
+		simd::Float4 v = simd::Load(vec);
+		return simd::ToVector4(simd::Div(v, simd::Sqrt(simd::Dot4(v, v))));
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Vector4<float> Lerp(const Vector4<float>& a, const Vector4<float>& b, float t) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			float s = 1.0f - t;
+			return Vector4<float>(a.x * s + b.x * t, a.y * s + b.y * t, a.z * s + b.z * t, a.w * s + b.w * t);
+		}
+		return simd::ToVector4(simd::MulAdd(simd::Load(a), simd::Splat(1.0f - t), simd::Mul(simd::Load(b), simd::Splat(t))));
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Vector4<float> MulAdd(const Vector4<float>& a, const Vector4<float>& b, const Vector4<float>& c) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return Vector4<float>(a.x * b.x + c.x, a.y * b.y + c.y, a.z * b.z + c.z, a.w * b.w + c.w);
+		}
+		return simd::ToVector4(simd::MulAdd(simd::Load(a), simd::Load(b), simd::Load(c)));
+	}
+
+	template<>
+	inline MFF_CONSTEXPR_DISPATCH Vector4<float> ScaledAdd(const Vector4<float>& a, const Vector4<float>& b, float scaler) {
+		if (MFF_IS_CONSTANT_EVALUATED()) {
+			return Vector4<float>(a.x + b.x * scaler, a.y + b.y * scaler, a.z + b.z * scaler, a.w + b.w * scaler);
+		}
+		return simd::ToVector4(simd::MulAdd(simd::Load(b), simd::Splat(scaler), simd::Load(a)));
 	}
 } // namespace mff
\ No newline at end of file
@@ -1,5 +1,6 @@
-#pragma once
+﻿#pragma once
 #include <math.h>
+#include <type_traits>
 namespace mff {
 	struct CharType {
 		using type = char;
@@ -15,8 +16,16 @@ namespace mff {
 	};
 
 
+	template<typename T>
+	struct SameType {
+		using type = T;
+	};
+
+	//HighAccuracy に登録されていない組み合わせ (double にする)
+	struct UnregisteredAccuracy : DoubleType {};
+
 	template<typename T, typename U>
-	struct HighAccuracy : DoubleType {};
+	struct HighAccuracy : UnregisteredAccuracy {};
 
 #define DECLARE_HIGH_ACCURACY(T,U,Super)\
 template<>\
@@ -36,4 +45,56 @@ struct HighAccuracy<T, U> : Super {};
 	DECLARE_HIGH_ACCURACY(int, double, DoubleType);
 	DECLARE_HIGH_ACCURACY(double, int, DoubleType);
 
+	/*
+	混在型演算の結果型を決めるポリシー
+		AccuratePrecision : HighAccuracy をそのまま使う (未登録の組み合わせは double)
+		FloatPrecision    : float と整数の組み合わせは float に固定し、
+		                    float と double の混在はコンパイルエラーにする
+		                    整数同士は同じ型ならその型、HighAccuracy に登録された組み合わせ (char と int) はその型にし、
+		                    それ以外 (int と unsigned など) は double への暗黙の昇格になるのでコンパイルエラーにする
+	MFF_ACCURATE_PRECISION を定義すると AccuratePrecision が既定になる
+	(ODR違反を避けるためプロジェクト全体で統一すること)
+	*/
+	struct AccuratePrecision {};
+	struct FloatPrecision {};
+
+#if defined(MFF_ACCURATE_PRECISION)
+	using DefaultPrecision = AccuratePrecision;
+#else
+	using DefaultPrecision = FloatPrecision;
+#endif
+
+	template<typename T, typename U,
+		bool HasFloat = std::is_same<T, float>::value || std::is_same<U, float>::value,
+		bool HasDouble = std::is_same<T, double>::value || std::is_same<U, double>::value>
+	struct FloatPrecisionType : std::conditional<std::is_same<T, U>::value, SameType<T>, HighAccuracy<T, U>>::type {
+		//演算子のオーバーロード解決で U にベクトル型が来ることがあるので、整数同士の時だけ判定する
+		static_assert(!std::is_integral<T>::value || !std::is_integral<U>::value ||
+			std::is_same<T, U>::value || !std::is_base_of<UnregisteredAccuracy, HighAccuracy<T, U>>::value,
+			"this combination is promoted to double under FloatPrecision. cast explicitly or define MFF_ACCURATE_PRECISION.");
+	};
+
+	template<typename T, typename U>
+	struct FloatPrecisionType<T, U, true, false> : FloatType {};
+
+	template<typename T, typename U>
+	struct FloatPrecisionType<T, U, false, true> : DoubleType {};
+
+	template<typename T, typename U>
+	struct FloatPrecisionType<T, U, true, true> : FloatType {
+		static_assert(sizeof(T) == 0, "float and double are mixed under FloatPrecision. cast explicitly or define MFF_ACCURATE_PRECISION.");
+	};
+
+	template<typename Policy, typename T, typename U>
+	struct Precision;
+
+	template<typename T, typename U>
+	struct Precision<AccuratePrecision, T, U> : HighAccuracy<T, U> {};
+
+	template<typename T, typename U>
+	struct Precision<FloatPrecision, T, U> : FloatPrecisionType<T, U> {};
+
+	template<typename T, typename U, typename Policy = DefaultPrecision>
+	using PrecisionType = typename Precision<Policy, T, U>::type;
+
 } // namespace mff
\ No newline at end of file
@@ -0,0 +1,341 @@
+﻿#pragma once
+#include "Vector3.h"
+#include "Vector4.h"
+#include "../Simd/Simd.h"
+#include "../Simd/AlignedAllocator.h"
+#include <assert.h>
+#include <stddef.h>
+#include <vector>
+
+namespace mff {
+	template<int N>
+	struct StreamElement;
+
+	template<>
+	struct StreamElement<3> {
+		using type = Vector3<float>;
+	};
+
+	template<>
+	struct StreamElement<4> {
+		using type = Vector4<float>;
+	};
+
+	/*
+	SoA形式のベクトル配列
+	成分ごとに16byte境界に揃えた配列を持ち、要素数は4の倍数に切り上げて確保する
+	(切り上げ分は0で埋めてあるので、演算は4要素単位で端数処理なしに行える)
+	*/
+	template<int N>
+	struct VectorStream {
+		using Element = typename StreamElement<N>::type;
+
+		VectorStream() {}
+		explicit VectorStream(size_t size) {
+			Resize(size);
+		}
+		VectorStream(const Element* src, size_t count) {
+			Assign(src, count);
+		}
+
+		void Resize(size_t size) {
+			size_t capacity = (size + 3) & ~static_cast<size_t>(3);
+			if (capacity != this->capacity) {
+				std::vector<float, AlignedAllocator<float, 16>> tmp(capacity * N, 0.0f);
+				size_t keep = size < this->size ? size : this->size;
+				for (int c = 0; c < N; ++c) {
+					for (size_t i = 0; i < keep; ++i) {
+						tmp[c * capacity + i] = data[c * this->capacity + i];
+					}
+				}
+				data.swap(tmp);
+				this->capacity = capacity;
+			}
+			else {
+				for (int c = 0; c < N; ++c) {
+					for (size_t i = size; i < capacity; ++i) {
+						data[c * capacity + i] = 0.0f;
+					}
+				}
+			}
+			this->size = size;
+		}
+
+		size_t Size() const { return size; }
+		//4の倍数に切り上げた要素数
+		size_t Capacity() const { return capacity; }
+
+		float* Component(int c) { return data.data() + c * capacity; }
+		const float* Component(int c) const { return data.data() + c * capacity; }
+		float* X() { return Component(0); }
+		float* Y() { return Component(1); }
+		float* Z() { return Component(2); }
+		float* W() { return Component(3); }
+		const float* X() const { return Component(0); }
+		const float* Y() const { return Component(1); }
+		const float* Z() const { return Component(2); }
+		const float* W() const { return Component(3); }
+
+		Element Get(size_t i) const {
+			Element ret;
+			for (int c = 0; c < N; ++c) {
+				ret.m[c] = Component(c)[i];
+			}
+			return ret;
+		}
+
+		void Set(size_t i, const Element& v) {
+			for (int c = 0; c < N; ++c) {
+				Component(c)[i] = v.m[c];
+			}
+		}
+
+		//AoS配列から読み込む
+		void Assign(const Element* src, size_t count);
+		//AoS配列へ書き出す
+		void CopyTo(Element* dst) const;
+
+	private:
+		std::vector<float, AlignedAllocator<float, 16>> data;
+		size_t size = 0;
+		size_t capacity = 0;
+	};
+
+	using Vec3Stream = VectorStream<3>;
+	using Vec4Stream = VectorStream<4>;
+
+	template<>
+	inline void Vec3Stream::Assign(const Vector3<float>* src, size_t count) {
+		Resize(count);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			simd::Float4 x, y, z;
+			simd::LoadXYZ(src[i].m, x, y, z);
+			simd::Store(X() + i, x);
+			simd::Store(Y() + i, y);
+			simd::Store(Z() + i, z);
+		}
+		for (; i < count; ++i) {
+			Set(i, src[i]);
+		}
+	}
+
+	template<>
+	inline void Vec3Stream::CopyTo(Vector3<float>* dst) const {
+		size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			simd::StoreXYZ(dst[i].m, simd::Load(X() + i), simd::Load(Y() + i), simd::Load(Z() + i));
+		}
+		for (; i < size; ++i) {
+			dst[i] = Get(i);
+		}
+	}
+
+	template<>
+	inline void Vec4Stream::Assign(const Vector4<float>* src, size_t count) {
+		Resize(count);
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			simd::Float4 r0 = simd::Load(src[i + 0].m);
+			simd::Float4 r1 = simd::Load(src[i + 1].m);
+			simd::Float4 r2 = simd::Load(src[i + 2].m);
+			simd::Float4 r3 = simd::Load(src[i + 3].m);
+			simd::Transpose(r0, r1, r2, r3);
+			simd::Store(X() + i, r0);
+			simd::Store(Y() + i, r1);
+			simd::Store(Z() + i, r2);
+			simd::Store(W() + i, r3);
+		}
+		for (; i < count; ++i) {
+			Set(i, src[i]);
+		}
+	}
+
+	template<>
+	inline void Vec4Stream::CopyTo(Vector4<float>* dst) const {
+		size_t i = 0;
+		for (; i + 4 <= size; i += 4) {
+			simd::Float4 r0 = simd::Load(X() + i);
+			simd::Float4 r1 = simd::Load(Y() + i);
+			simd::Float4 r2 = simd::Load(Z() + i);
+			simd::Float4 r3 = simd::Load(W() + i);
+			simd::Transpose(r0, r1, r2, r3);
+			simd::Store(dst[i + 0].m, r0);
+			simd::Store(dst[i + 1].m, r1);
+			simd::Store(dst[i + 2].m, r2);
+			simd::Store(dst[i + 3].m, r3);
+		}
+		for (; i < size; ++i) {
+			dst[i] = Get(i);
+		}
+	}
+
+	/*
+	要素ごとの演算
+	入力は全て同じ要素数であること (違う場合は assert で止める)
+	出力先は入力と同じ要素数にリサイズされる (入力と同じストリームを指定してもよい)
+		Resize は領域を確保し直すことがあるので、成分のポインタは Resize の後で取る
+	*/
+#define VECTOR_STREAM_TWO_ARG_FUNCTION(name, func)\
+template<int N>\
+void name(const VectorStream<N>& lhs, const VectorStream<N>& rhs, VectorStream<N>& out){\
+	assert(lhs.Size() == rhs.Size() && "VectorStream sizes must match");\
+	out.Resize(lhs.Size());\
+	for (int c = 0; c < N; ++c) {\
+		const float* a = lhs.Component(c);\
+		const float* b = rhs.Component(c);\
+		float* o = out.Component(c);\
+		for (size_t i = 0; i < lhs.Capacity(); i += 4) {\
+			simd::Store(o + i, simd::func(simd::Load(a + i), simd::Load(b + i)));\
+		}\
+	}\
+}
+
+	VECTOR_STREAM_TWO_ARG_FUNCTION(Add, Add);
+	VECTOR_STREAM_TWO_ARG_FUNCTION(Sub, Sub);
+	VECTOR_STREAM_TWO_ARG_FUNCTION(Mul, Mul);
+
+	template<int N>
+	void Scale(const VectorStream<N>& vec, float scaler, VectorStream<N>& out) {
+		out.Resize(vec.Size());
+		const simd::Float4 s = simd::Splat(scaler);
+		for (int c = 0; c < N; ++c) {
+			const float* a = vec.Component(c);
+			float* o = out.Component(c);
+			for (size_t i = 0; i < vec.Capacity(); i += 4) {
+				simd::Store(o + i, simd::Mul(simd::Load(a + i), s));
+			}
+		}
+	}
+
+	//a * b + c
+	template<int N>
+	void MulAdd(const VectorStream<N>& a, const VectorStream<N>& b, const VectorStream<N>& c, VectorStream<N>& out) {
+		assert(a.Size() == b.Size() && a.Size() == c.Size() && "VectorStream sizes must match");
+		out.Resize(a.Size());
+		for (int k = 0; k < N; ++k) {
+			const float* pa = a.Component(k);
+			const float* pb = b.Component(k);
+			const float* pc = c.Component(k);
+			float* o = out.Component(k);
+			for (size_t i = 0; i < a.Capacity(); i += 4) {
+				simd::Store(o + i, simd::MulAdd(simd::Load(pa + i), simd::Load(pb + i), simd::Load(pc + i)));
+			}
+		}
+	}
+
+	namespace simd {
+		template<int N>
+		inline Float4 DotLanes(const VectorStream<N>& a, const VectorStream<N>& b, size_t i) {
+			Float4 ret = Mul(Load(a.Component(0) + i), Load(b.Component(0) + i));
+			for (int c = 1; c < N; ++c) {
+				ret = MulAdd(Load(a.Component(c) + i), Load(b.Component(c) + i), ret);
+			}
+			return ret;
+		}
+
+		//4要素単位で求めた値を float 配列へ書き出す (端数は書き込まない)
+		inline void StorePartial(float* out, size_t i, size_t size, Float4 v) {
+			if (i + 4 <= size) {
+				Store(out + i, v);
+				return;
+			}
+			float tmp[4];
+			Store(tmp, v);
+			for (size_t k = 0; i + k < size; ++k) {
+				out[i + k] = tmp[k];
+			}
+		}
+	} // namespace simd
+
+	//out は Size() 要素以上必要
+	template<int N>
+	void dot(const VectorStream<N>& lhs, const VectorStream<N>& rhs, float* out) {
+		assert(lhs.Size() == rhs.Size() && "VectorStream sizes must match");
+		for (size_t i = 0; i < lhs.Capacity(); i += 4) {
+			simd::StorePartial(out, i, lhs.Size(), simd::DotLanes(lhs, rhs, i));
+		}
+	}
+
+	template<int N>
+	void Length(const VectorStream<N>& vec, float* out) {
+		for (size_t i = 0; i < vec.Capacity(); i += 4) {
+			simd::StorePartial(out, i, vec.Size(), simd::Sqrt(simd::DotLanes(vec, vec, i)));
+		}
+	}
+
+	template<int N>
+	void Normalize(const VectorStream<N>& vec, VectorStream<N>& out) {
+		out.Resize(vec.Size());
+		for (size_t i = 0; i < vec.Capacity(); i += 4) {
+			simd::Float4 len = simd::Sqrt(simd::DotLanes(vec, vec, i));
+			//切り上げ分(長さ0)で0除算しないようにする
+			len = simd::Select(simd::Greater(len, simd::Zero()), len, simd::Splat(1.0f));
+			for (int c = 0; c < N; ++c) {
+				simd::Store(out.Component(c) + i, simd::Div(simd::Load(vec.Component(c) + i), len));
+			}
+		}
+	}
+
+	inline void cross(const Vec3Stream& lhs, const Vec3Stream& rhs, Vec3Stream& out) {
+		assert(lhs.Size() == rhs.Size() && "VectorStream sizes must match");
+		out.Resize(lhs.Size());
+		for (size_t i = 0; i < lhs.Capacity(); i += 4) {
+			simd::Float4 ax = simd::Load(lhs.X() + i), ay = simd::Load(lhs.Y() + i), az = simd::Load(lhs.Z() + i);
+			simd::Float4 bx = simd::Load(rhs.X() + i), by = simd::Load(rhs.Y() + i), bz = simd::Load(rhs.Z() + i);
+			simd::Store(out.X() + i, simd::Sub(simd::Mul(ay, bz), simd::Mul(az, by)));
+			simd::Store(out.Y() + i, simd::Sub(simd::Mul(az, bx), simd::Mul(ax, bz)));
+			simd::Store(out.Z() + i, simd::Sub(simd::Mul(ax, by), simd::Mul(ay, bx)));
+		}
+	}
+
+	/*
+	全要素の成分ごとの最小値・最大値 (バウンディングボックス計算用)
+	要素数0の場合は Element(FLT_MAX) / Element(-FLT_MAX) 相当の値を返す
+	*/
+	template<int N>
+	typename VectorStream<N>::Element Min(const VectorStream<N>& vec) {
+		typename VectorStream<N>::Element ret;
+		for (int c = 0; c < N; ++c) {
+			const float* p = vec.Component(c);
+			simd::Float4 m = simd::Splat(3.402823466e+38f);
+			size_t i = 0;
+			for (; i + 4 <= vec.Size(); i += 4) {
+				m = simd::Min(m, simd::Load(p + i));
+			}
+			float tmp[4];
+			simd::Store(tmp, m);
+			float r = tmp[0] < tmp[1] ? tmp[0] : tmp[1];
+			r = r < tmp[2] ? r : tmp[2];
+			r = r < tmp[3] ? r : tmp[3];
+			for (; i < vec.Size(); ++i) {
+				r = r < p[i] ? r : p[i];
+			}
+			ret.m[c] = r;
+		}
+		return ret;
+	}
+
+	template<int N>
+	typename VectorStream<N>::Element Max(const VectorStream<N>& vec) {
+		typename VectorStream<N>::Element ret;
+		for (int c = 0; c < N; ++c) {
+			const float* p = vec.Component(c);
+			simd::Float4 m = simd::Splat(-3.402823466e+38f);
+			size_t i = 0;
+			for (; i + 4 <= vec.Size(); i += 4) {
+				m = simd::Max(m, simd::Load(p + i));
+			}
+			float tmp[4];
+			simd::Store(tmp, m);
+			float r = tmp[0] > tmp[1] ? tmp[0] : tmp[1];
+			r = r > tmp[2] ? r : tmp[2];
+			r = r > tmp[3] ? r : tmp[3];
+			for (; i < vec.Size(); ++i) {
+				r = r > p[i] ? r : p[i];
+			}
+			ret.m[c] = r;
+		}
+		return ret;
+	}
+} // namespace mff
\ No newline at end of file
@@ -0,0 +1,345 @@
+# -*- coding: utf-8 -*-
+# FbxLoaderTests 用の小さな FBX と期待値を作る (標準ライブラリのみ)
+#   python3 MakeFbxFixtures.py
+#   -> cube_7400_zlib.fbx (バイナリ 32bit オフセット, 配列は zlib 圧縮)
+#      cube_7500_raw.fbx  (バイナリ 64bit オフセット, 配列は無圧縮)
+#      cube_ascii.fbx     (アスキー 7.4, 読み飛ばすべきノード付き)
+#      ../FbxFixtureExpected.h (ローダーとは別にここで double で計算した期待値)
+#
+# シーン
+#   Body : 立方体 (6四角形, 2マテリアル) に T(1,2,3) R(0,90,0) S(2,2,2)
+#          法線・UV は ByPolygonVertex、頂点カラーは ByVertice
+#   Hips -> Spine の2ボーン。y < 0 の頂点は Hips 1.0、y > 0 は Hips 0.25 + Spine 0.75
+#   Walk : 24fps で1秒。Spine の Rz が 0 -> 30 (0.5秒) -> 90 (1秒) の線形キー
+import io, math, os, random, struct, zlib
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+KTIME_PER_SECOND = 46186158000
+
+class Node:
+    def __init__(self, name, props=(), children=()):
+        self.name, self.props, self.children = name, list(props), list(children)
+
+# ---- バイナリ ----
+def encode_prop(p, compress):
+    t, v = p
+    if t == 'C': return b'C' + struct.pack('<B', v)
+    if t == 'I': return b'I' + struct.pack('<i', v)
+    if t == 'D': return b'D' + struct.pack('<d', v)
+    if t == 'L': return b'L' + struct.pack('<q', v)
+    if t == 'S':
+        b = v if isinstance(v, bytes) else v.encode()
+        return b'S' + struct.pack('<I', len(b)) + b
+    fmt = {'f': 'f', 'd': 'd', 'l': 'q', 'i': 'i'}[t]
+    raw = struct.pack('<%d%s' % (len(v), fmt), *v)
+    if compress:
+        c = zlib.compress(raw, 6)
+        return t.encode() + struct.pack('<III', len(v), 1, len(c)) + c
+    return t.encode() + struct.pack('<III', len(v), 0, len(raw)) + raw
+
+def encode_node(n, offset, wide, compress):
+    props = b''.join(encode_prop(p, compress) for p in n.props)
+    name = n.name.encode()
+    header_size = 25 if wide else 13
+    cur = offset + header_size + len(name) + len(props)
+    children = b''
+    if n.children:
+        for c in n.children:
+            e = encode_node(c, cur, wide, compress)
+            children += e
+            cur += len(e)
+        children += b'\0' * header_size
+        cur += header_size
+    head = struct.pack('<QQQB' if wide else '<IIIB', cur, len(n.props), len(props), len(name))
+    return head + name + props + children
+
+def write_binary(path, nodes, version, compress):
+    wide = version >= 7500
+    out = b'Kaydara FBX Binary  \0\x1a\0' + struct.pack('<I', version)
+    for n in nodes:
+        out += encode_node(n, len(out), wide, compress)
+    out += b'\0' * (25 if wide else 13)
+    out += b'\0' * 16
+    with open(path, 'wb') as f:
+        f.write(out)
+
+# ---- アスキー ----
+def format_number(t, v):
+    if t in 'Dfd':
+        r = repr(float(v))
+        return r[:-2] if r.endswith('.0') else r
+    return str(int(v))
+
+def format_prop(p):
+    t, v = p
+    if t == 'S':
+        s = v.decode('latin1') if isinstance(v, bytes) else v
+        if '\x00\x01' in s:
+            name, cls = s.split('\x00\x01')
+            s = cls + '::' + name
+        return '"' + s.replace('"', '&quot;') + '"'
+    if t == 'C': return 'T' if v else 'F'
+    return format_number(t, v)
+
+def write_ascii_node(out, n, indent):
+    arrays = [p for p in n.props if p[0] in 'fdli']
+    if arrays:
+        t, v = arrays[0]
+        if n.name == 'KeyAttrDataFloat':
+            #SDK はアスキーでは float のビット列を整数で書く
+            v = [struct.unpack('<i', struct.pack('<f', x))[0] for x in v]
+            t = 'i'
+        items = [format_number(t, x) for x in v]
+        lines = [','.join(items[i:i + 7]) for i in range(0, len(items), 7)] or ['']
+        out.write('%s%s: *%d {\n' % (indent, n.name, len(v)))
+        out.write('%s\ta: %s\n' % (indent, (',\n' + indent + '\t').join(lines)))
+        out.write('%s} \n' % indent)
+        return
+    props = ', '.join(format_prop(p) for p in n.props)
+    if n.children:
+        out.write('%s%s: %s {\n' % (indent, n.name, props))
+        for c in n.children:
+            write_ascii_node(out, c, indent + '\t')
+        out.write('%s}\n' % indent)
+    else:
+        out.write('%s%s: %s\n' % (indent, n.name, props))
+
+def write_ascii(path, nodes, version):
+    #ローダーが読まないノード (Definitions, Video, Pose, Takes) も SDK の出力と同じように混ぜる
+    rnd = random.Random(1)
+    blob = ''.join(rnd.choice('ABCDEFabcdef0123456789+/{}') for _ in range(2000))
+    definitions = Node('Definitions', [], [Node('Version', [('I', 100)]), Node('ObjectType', [('S', 'Model')], [Node('Count', [('I', 3)])])])
+    video = Node('Video', [('L', 900), object_name('Vid', 'Video'), ('S', 'Clip')],
+                 [Node('Content', [('S', blob)]), Node('Junk', [('d', [rnd.random() for _ in range(300)])])])
+    pose = Node('Pose', [('L', 901), object_name('Bind', 'Pose'), ('S', 'BindPose')], [Node('PoseNode', [], [Node('Matrix', [('d', [1.0] * 16)])])])
+    for n in nodes:
+        if n.name == 'Objects':
+            n.children = [video] + n.children + [pose]
+    nodes = nodes[:1] + [definitions] + nodes[1:] + [Node('Takes', [], [Node('Current', [('S', '')])])]
+    out = io.StringIO()
+    out.write('; FBX %d.%d.0 project file\n; ----------------------------------------------------\n\n' % (version // 1000, version % 1000 // 100))
+    for n in nodes:
+        write_ascii_node(out, n, '')
+        out.write('; section end\n\n')
+    with open(path, 'w', newline='') as f:
+        f.write(out.getvalue())
+
+# ---- シーン ----
+def prop70(name, typ, *values):
+    props = [('S', name), ('S', typ), ('S', ''), ('S', 'A')]
+    for v in values:
+        if isinstance(v, float): props.append(('D', v))
+        elif typ == 'KTime': props.append(('L', v))
+        else: props.append(('I', v))
+    return Node('P', props)
+
+def object_name(name, cls):
+    return ('S', name.encode() + b'\x00\x01' + cls.encode())
+
+#列ベクトルの 4x4 (行ごとのリスト)
+def mul(a, b): return [[sum(a[i][k] * b[k][j] for k in range(4)) for j in range(4)] for i in range(4)]
+def identity(): return [[1.0 if i == j else 0.0 for j in range(4)] for i in range(4)]
+def translate(v): m = identity(); m[0][3], m[1][3], m[2][3] = v; return m
+def scale(v): m = identity(); m[0][0], m[1][1], m[2][2] = v; return m
+def rotate(axis, degree):
+    r = math.radians(degree); c, s = math.cos(r), math.sin(r); m = identity()
+    a, b = (axis + 1) % 3, (axis + 2) % 3
+    m[a][a], m[a][b], m[b][a], m[b][b] = c, -s, s, c
+    return m
+def euler_xyz(v): return mul(rotate(2, v[2]), mul(rotate(1, v[1]), rotate(0, v[0])))
+def transpose(m): return [[m[j][i] for j in range(4)] for i in range(4)]
+def inverse(m):
+    a = [row[:] + [1.0 if i == j else 0.0 for j in range(4)] for i, row in enumerate(m)]
+    for c in range(4):
+        p = max(range(c, 4), key=lambda r: abs(a[r][c])); a[c], a[p] = a[p], a[c]
+        pv = a[c][c]; a[c] = [x / pv for x in a[c]]
+        for r in range(4):
+            if r != c:
+                f = a[r][c]; a[r] = [x - f * y for x, y in zip(a[r], a[c])]
+    return [row[4:] for row in a]
+def transform_point(m, p): return [sum(m[i][k] * (p[k] if k < 3 else 1.0) for k in range(4)) for i in range(3)]
+def transform_vector(m, p): return [sum(m[i][k] * p[k] for k in range(3)) for i in range(3)]
+def flatten(m): return [x for row in m for x in row]
+#FbxAMatrix のメモリ配置 (行ベクトル) = mff::Matrix4x4 の配置
+def row_vector(m): return flatten(transpose(m))
+
+MESH_T, MESH_R, MESH_S = (1.0, 2.0, 3.0), (0.0, 90.0, 0.0), (2.0, 2.0, 2.0)
+HIPS_T, SPINE_T = (0.0, 0.5, 0.0), (0.0, 1.0, 0.0)
+CPS = [(-1, -1, -1), (1, -1, -1), (1, 1, -1), (-1, 1, -1), (-1, -1, 1), (1, -1, 1), (1, 1, 1), (-1, 1, 1)]
+FACES = [(0, 3, 2, 1), (4, 5, 6, 7), (0, 1, 5, 4), (2, 3, 7, 6), (1, 2, 6, 5), (0, 4, 7, 3)]
+FACE_NORMALS = [(0, 0, -1), (0, 0, 1), (0, -1, 0), (0, 1, 0), (1, 0, 0), (-1, 0, 0)]
+UVS = [0, 0, 1, 0, 1, 1, 0, 1]
+UV_INDEX = [0, 1, 2, 3] * 6
+FACE_MATERIALS = [0, 1, 0, 1, 0, 1]
+COLORS = [c for i in range(8) for c in (i / 8.0, 0.5, 1 - i / 8.0, 1.0)]
+SPINE_KEYS = [(0.0, 0.0), (0.5, 30.0), (1.0, 90.0)]
+HIPS_GLOBAL = translate(HIPS_T)
+SPINE_GLOBAL = mul(HIPS_GLOBAL, translate(SPINE_T))
+
+def make_scene(version):
+    polygon_vertex_index = []
+    for f in FACES:
+        polygon_vertex_index += list(f[:-1]) + [~f[-1]]
+    normals = [float(x) for fi, f in enumerate(FACES) for _ in f for x in FACE_NORMALS[fi]]
+    hips_indices = list(range(len(CPS)))
+    hips_weights = [1.0 if p[1] < 0 else 0.25 for p in CPS]
+    spine_indices = [i for i, p in enumerate(CPS) if p[1] > 0]
+
+    geometry = Node('Geometry', [('L', 100), object_name('BodyGeo', 'Geometry'), ('S', 'Mesh')], [
+        Node('Vertices', [('d', [float(c) for p in CPS for c in p])]),
+        Node('PolygonVertexIndex', [('i', polygon_vertex_index)]),
+        Node('LayerElementNormal', [('I', 0)], [
+            Node('MappingInformationType', [('S', 'ByPolygonVertex')]),
+            Node('ReferenceInformationType', [('S', 'Direct')]),
+            Node('Normals', [('d', normals)])]),
+        Node('LayerElementColor', [('I', 0)], [
+            Node('MappingInformationType', [('S', 'ByVertice')]),
+            Node('ReferenceInformationType', [('S', 'Direct')]),
+            Node('Colors', [('d', COLORS)])]),
+        Node('LayerElementUV', [('I', 0)], [
+            Node('MappingInformationType', [('S', 'ByPolygonVertex')]),
+            Node('ReferenceInformationType', [('S', 'IndexToDirect')]),
+            Node('UV', [('d', [float(x) for x in UVS])]),
+            Node('UVIndex', [('i', UV_INDEX)])]),
+        Node('LayerElementMaterial', [('I', 0)], [
+            Node('MappingInformationType', [('S', 'ByPolygon')]),
+            Node('ReferenceInformationType', [('S', 'IndexToDirect')]),
+            Node('Materials', [('i', FACE_MATERIALS)])]),
+    ])
+    body = Node('Model', [('L', 200), object_name('Body', 'Model'), ('S', 'Mesh')], [
+        Node('Properties70', [], [prop70('Lcl Translation', 'Lcl Translation', *MESH_T), prop70('Lcl Rotation', 'Lcl Rotation', *MESH_R),
+                                  prop70('Lcl Scaling', 'Lcl Scaling', *MESH_S)])])
+    hips = Node('Model', [('L', 300), object_name('Hips', 'Model'), ('S', 'LimbNode')], [Node('Properties70', [], [prop70('Lcl Translation', 'Lcl Translation', *HIPS_T)])])
+    spine = Node('Model', [('L', 301), object_name('Spine', 'Model'), ('S', 'LimbNode')], [Node('Properties70', [], [prop70('Lcl Translation', 'Lcl Translation', *SPINE_T)])])
+    hips_attr = Node('NodeAttribute', [('L', 310), object_name('Hips', 'NodeAttribute'), ('S', 'LimbNode')])
+    spine_attr = Node('NodeAttribute', [('L', 311), object_name('Spine', 'NodeAttribute'), ('S', 'LimbNode')])
+    skin_material = Node('Material', [('L', 400), object_name('Skin', 'Material'), ('S', '')])
+    cloth_material = Node('Material', [('L', 401), object_name('Cloth', 'Material'), ('S', '')])
+    texture = Node('Texture', [('L', 410), object_name('SkinTex', 'Texture'), ('S', '')],
+                   [Node('FileName', [('S', 'C:/abs/skin.png')]), Node('RelativeFilename', [('S', 'tex/skin.png')])])
+    skin = Node('Deformer', [('L', 500), object_name('BodySkin', 'Deformer'), ('S', 'Skin')])
+    hips_cluster = Node('Deformer', [('L', 501), object_name('HipsCluster', 'SubDeformer'), ('S', 'Cluster')], [
+        Node('Indexes', [('i', hips_indices)]), Node('Weights', [('d', hips_weights)]),
+        Node('Transform', [('d', row_vector(identity()))]), Node('TransformLink', [('d', row_vector(HIPS_GLOBAL))])])
+    spine_cluster = Node('Deformer', [('L', 502), object_name('SpineCluster', 'SubDeformer'), ('S', 'Cluster')], [
+        Node('Indexes', [('i', spine_indices)]), Node('Weights', [('d', [0.75] * len(spine_indices))]),
+        Node('Transform', [('d', row_vector(identity()))]), Node('TransformLink', [('d', row_vector(SPINE_GLOBAL))])])
+    stack = Node('AnimationStack', [('L', 600), object_name('Walk', 'AnimStack'), ('S', '')], [
+        Node('Properties70', [], [prop70('LocalStart', 'KTime', 0), prop70('LocalStop', 'KTime', KTIME_PER_SECOND)])])
+    layer = Node('AnimationLayer', [('L', 601), object_name('Base', 'AnimLayer'), ('S', '')])
+    curve_node = Node('AnimationCurveNode', [('L', 602), object_name('R', 'AnimCurveNode'), ('S', '')], [
+        Node('Properties70', [], [prop70('d|X', 'Number', 0.0), prop70('d|Y', 'Number', 0.0), prop70('d|Z', 'Number', 0.0)])])
+    curve = Node('AnimationCurve', [('L', 603), object_name('', 'AnimCurve'), ('S', '')], [
+        Node('Default', [('D', 0.0)]), Node('KeyVer', [('I', 4009)]),
+        Node('KeyTime', [('l', [int(t * KTIME_PER_SECOND) for t, _ in SPINE_KEYS])]),
+        Node('KeyValueFloat', [('f', [v for _, v in SPINE_KEYS])]),
+        #線形補間
+        Node('KeyAttrFlags', [('i', [0x4])]), Node('KeyAttrDataFloat', [('f', [0.0] * 4)]), Node('KeyAttrRefCount', [('i', [len(SPINE_KEYS)])])])
+    objects = Node('Objects', [], [geometry, body, hips, spine, hips_attr, spine_attr, skin_material, cloth_material, texture,
+                                   skin, hips_cluster, spine_cluster, stack, layer, curve_node, curve])
+
+    def connect(kind, src, dst, prop=None):
+        return Node('C', [('S', kind), ('L', src), ('L', dst)] + ([('S', prop)] if prop else []))
+    connections = Node('Connections', [], [
+        connect('OO', 200, 0), connect('OO', 300, 0), connect('OO', 301, 300), connect('OO', 310, 300), connect('OO', 311, 301),
+        connect('OO', 100, 200), connect('OO', 400, 200), connect('OO', 401, 200), connect('OP', 410, 400, 'DiffuseColor'),
+        connect('OO', 500, 100), connect('OO', 501, 500), connect('OO', 502, 500), connect('OO', 300, 501), connect('OO', 301, 502),
+        connect('OO', 601, 600), connect('OO', 602, 601), connect('OP', 602, 301, 'Lcl Rotation'), connect('OP', 603, 602, 'd|Z')])
+    settings = Node('GlobalSettings', [], [Node('Version', [('I', 1000)]), Node('Properties70', [], [prop70('TimeMode', 'enum', 11)])])
+    return [Node('FBXHeaderExtension', [], [Node('FBXVersion', [('I', version)])]), settings, objects, connections]
+
+# ---- 期待値 ----
+def spine_rotation(t):
+    for (t0, v0), (t1, v1) in zip(SPINE_KEYS, SPINE_KEYS[1:]):
+        if t <= t1:
+            return v0 + (v1 - v0) * (t - t0) / (t1 - t0)
+    return SPINE_KEYS[-1][1]
+
+def expected():
+    world = mul(translate(MESH_T), mul(euler_xyz(MESH_R), scale(MESH_S)))
+    rotation = euler_xyz(MESH_R)
+    materials = [{'name': 'Skin', 'texture': 'tex/skin.png', 'vertices': [], 'indices': []},
+                 {'name': 'Cloth', 'texture': None, 'vertices': [], 'indices': []}]
+    #扇形に三角形化し、コントロールポイントと属性が同じ角を統合する (出現順に番号を振る)
+    for fi, f in enumerate(FACES):
+        material = materials[FACE_MATERIALS[fi]]
+        for k in range(1, len(f) - 1):
+            for cp, pv in ((f[0], fi * 4), (f[k], fi * 4 + k), (f[k + 1], fi * 4 + k + 1)):
+                v = {'cp': cp,
+                     'position': transform_point(world, CPS[cp]),
+                     'normal': transform_vector(rotation, FACE_NORMALS[fi]),
+                     'texCoord': UVS[UV_INDEX[pv] * 2: UV_INDEX[pv] * 2 + 2],
+                     'color': COLORS[cp * 4: cp * 4 + 4],
+                     'weights': [(0, 1.0)] if CPS[cp][1] < 0 else [(0, 0.25), (1, 0.75)]}
+                key = (cp, tuple(round(x, 6) for x in v['normal'] + v['texCoord'] + v['color']))
+                keys = [(u['cp'], tuple(round(x, 6) for x in u['normal'] + u['texCoord'] + u['color'])) for u in material['vertices']]
+                if key not in keys:
+                    keys.append(key)
+                    material['vertices'].append(v)
+                material['indices'].append(keys.index(key))
+    bones = [{'name': 'Hips', 'parent': -1, 'children': [1], 'baseInv': row_vector(inverse(HIPS_GLOBAL))},
+             {'name': 'Spine', 'parent': 0, 'children': [], 'baseInv': row_vector(inverse(SPINE_GLOBAL))}]
+    #24fps の各フレームの toMyMat(ボーン行列) * baseInv (SetBakeBaseInv(true) の既定)
+    #Loader と同じく行ベクトルの配置のまま掛けるので、列ベクトルでは baseInv が後から掛かる
+    def baked(world, base):
+        return flatten(mul(transpose(world), transpose(inverse(base))))
+    frames = []
+    for frame in range(25):
+        t = frame / 24.0
+        spine_world = mul(HIPS_GLOBAL, mul(translate(SPINE_T), rotate(2, spine_rotation(t))))
+        frames.append({'time': t, 'hips': baked(HIPS_GLOBAL, HIPS_GLOBAL), 'spine': baked(spine_world, SPINE_GLOBAL)})
+    return materials, bones, frames
+
+def c_float(v):
+    s = '%.9g' % (0.0 if abs(v) < 1e-12 else v)
+    return s + ('f' if '.' in s or 'e' in s else '.0f')
+
+def c_floats(values):
+    return '{ ' + ', '.join(c_float(v) for v in values) + ' }'
+
+def write_expected_header(path):
+    materials, bones, frames = expected()
+    out = io.StringIO()
+    out.write('\ufeff#pragma once\n')
+    out.write('//Tests/Data/MakeFbxFixtures.py で生成 (手で編集しないこと)\n')
+    out.write('#include <stddef.h>\n\nnamespace test {\n\tnamespace fixture {\n')
+    out.write('\t\tstruct ExpectedVertex {\n\t\t\tfloat position[3];\n\t\t\tfloat normal[3];\n\t\t\tfloat texCoord[2];\n\t\t\tfloat color[4];\n'
+              '\t\t\t//影響のあるボーンだけ (残りは weight 0)\n\t\t\tint influenceCount;\n\t\t\tunsigned int boneIndex[2];\n\t\t\tfloat weights[2];\n\t\t};\n\n')
+    out.write('\t\tstruct ExpectedMaterial {\n\t\t\tconst char* name;\n\t\t\t//テクスチャがなければ nullptr\n\t\t\tconst char* texture;\n'
+              '\t\t\tconst ExpectedVertex* vertices;\n\t\t\tsize_t vertexCount;\n\t\t\tconst unsigned int* indices;\n\t\t\tsize_t indexCount;\n\t\t};\n\n')
+    out.write('\t\tstruct ExpectedBone {\n\t\t\tconst char* name;\n\t\t\tint parentId;\n\t\t\t//子は最大1つ (なければ -1)\n\t\t\tint child;\n\t\t\tfloat baseInv[16];\n\t\t};\n\n')
+    out.write('\t\tstruct ExpectedFrame {\n\t\t\tfloat time;\n\t\t\t//[bone]\n\t\t\tfloat matrices[2][16];\n\t\t};\n\n')
+    out.write('\t\tconst char* const fixtureFiles[] = { "cube_7400_zlib.fbx", "cube_7500_raw.fbx", "cube_ascii.fbx" };\n\n')
+    for mi, m in enumerate(materials):
+        out.write('\t\tconst ExpectedVertex material%dVertices[] = {\n' % mi)
+        for v in m['vertices']:
+            w = v['weights'] + [(0, 0.0)] * (2 - len(v['weights']))
+            out.write('\t\t\t{ %s, %s, %s, %s, %d, { %du, %du }, %s },\n' % (
+                c_floats(v['position']), c_floats(v['normal']), c_floats(v['texCoord']), c_floats(v['color']),
+                len(v['weights']), w[0][0], w[1][0], c_floats([w[0][1], w[1][1]])))
+        out.write('\t\t};\n')
+        out.write('\t\tconst unsigned int material%dIndices[] = { %s };\n\n' % (mi, ', '.join(str(i) for i in m['indices'])))
+    out.write('\t\tconst ExpectedMaterial materials[] = {\n')
+    for mi, m in enumerate(materials):
+        texture = '"%s"' % m['texture'] if m['texture'] else 'nullptr'
+        out.write('\t\t\t{ "%s", %s, material%dVertices, %d, material%dIndices, %d },\n' % (
+            m['name'], texture, mi, len(m['vertices']), mi, len(m['indices'])))
+    out.write('\t\t};\n\n')
+    out.write('\t\tconst ExpectedBone bones[] = {\n')
+    for b in bones:
+        out.write('\t\t\t{ "%s", %d, %d, %s },\n' % (b['name'], b['parent'], b['children'][0] if b['children'] else -1, c_floats(b['baseInv'])))
+    out.write('\t\t};\n\n')
+    out.write('\t\tconst char* const animationName = "Walk";\n\t\tconst float animationTime = 1.0f;\n')
+    out.write('\t\tconst ExpectedFrame frames[] = {\n')
+    for f in frames:
+        out.write('\t\t\t{ %s, { %s, %s } },\n' % (c_float(f['time']), c_floats(f['hips']), c_floats(f['spine'])))
+    out.write('\t\t};\n')
+    out.write('\t} // namespace fixture\n} // namespace test\n')
+    with open(path, 'w', encoding='utf-8', newline='\n') as f:
+        f.write(out.getvalue())
+
+if __name__ == '__main__':
+    write_binary(os.path.join(HERE, 'cube_7400_zlib.fbx'), make_scene(7400), 7400, True)
+    write_binary(os.path.join(HERE, 'cube_7500_raw.fbx'), make_scene(7500), 7500, False)
+    write_ascii(os.path.join(HERE, 'cube_ascii.fbx'), make_scene(7400), 7400)
+    write_expected_header(os.path.join(HERE, '..', 'FbxFixtureExpected.h'))
@@ -0,0 +1,116 @@
+﻿#pragma once
+//Tests/Data/MakeFbxFixtures.py で生成 (手で編集しないこと)
+#include <stddef.h>
+
+namespace test {
+	namespace fixture {
+		struct ExpectedVertex {
+			float position[3];
+			float normal[3];
+			float texCoord[2];
+			float color[4];
+			//影響のあるボーンだけ (残りは weight 0)
+			int influenceCount;
+			unsigned int boneIndex[2];
+			float weights[2];
+		};
+
+		struct ExpectedMaterial {
+			const char* name;
+			//テクスチャがなければ nullptr
+			const char* texture;
+			const ExpectedVertex* vertices;
+			size_t vertexCount;
+			const unsigned int* indices;
+			size_t indexCount;
+		};
+
+		struct ExpectedBone {
+			const char* name;
+			int parentId;
+			//子は最大1つ (なければ -1)
+			int child;
+			float baseInv[16];
+		};
+
+		struct ExpectedFrame {
+			float time;
+			//[bone]
+			float matrices[2][16];
+		};
+
+		const char* const fixtureFiles[] = { "cube_7400_zlib.fbx", "cube_7500_raw.fbx", "cube_ascii.fbx" };
+
+		const ExpectedVertex material0Vertices[] = {
+			{ { -1.0f, 0.0f, 5.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.5f, 1.0f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { -1.0f, 4.0f, 5.0f }, { -1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.375f, 0.5f, 0.625f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { -1.0f, 4.0f, 1.0f }, { -1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f }, { 0.25f, 0.5f, 0.75f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { -1.0f, 0.0f, 1.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f }, { 0.125f, 0.5f, 0.875f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { -1.0f, 0.0f, 5.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f }, { 0.0f, 0.5f, 1.0f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { -1.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 0.0f }, { 0.125f, 0.5f, 0.875f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { 3.0f, 0.0f, 1.0f }, { 0.0f, -1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.625f, 0.5f, 0.375f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { 3.0f, 0.0f, 5.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 1.0f }, { 0.5f, 0.5f, 0.5f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { -1.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 0.0f }, { 0.125f, 0.5f, 0.875f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { -1.0f, 4.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f }, { 0.25f, 0.5f, 0.75f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { 3.0f, 4.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 1.0f, 1.0f }, { 0.75f, 0.5f, 0.25f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { 3.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f }, { 0.0f, 1.0f }, { 0.625f, 0.5f, 0.375f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+		};
+		const unsigned int material0Indices[] = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7, 8, 9, 10, 8, 10, 11 };
+
+		const ExpectedVertex material1Vertices[] = {
+			{ { 3.0f, 0.0f, 5.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f }, { 0.5f, 0.5f, 0.5f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { 3.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 0.0f }, { 0.625f, 0.5f, 0.375f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { 3.0f, 4.0f, 1.0f }, { 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f }, { 0.75f, 0.5f, 0.25f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { 3.0f, 4.0f, 5.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f }, { 0.875f, 0.5f, 0.125f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { -1.0f, 4.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f }, { 0.25f, 0.5f, 0.75f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { -1.0f, 4.0f, 5.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f }, { 0.375f, 0.5f, 0.625f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { 3.0f, 4.0f, 5.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.875f, 0.5f, 0.125f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { 3.0f, 4.0f, 1.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 1.0f }, { 0.75f, 0.5f, 0.25f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { -1.0f, 0.0f, 5.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f }, { 0.0f, 0.5f, 1.0f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { 3.0f, 0.0f, 5.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f }, { 0.5f, 0.5f, 0.5f, 1.0f }, 1, { 0u, 0u }, { 1.0f, 0.0f } },
+			{ { 3.0f, 4.0f, 5.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f }, { 0.875f, 0.5f, 0.125f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+			{ { -1.0f, 4.0f, 5.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f }, { 0.375f, 0.5f, 0.625f, 1.0f }, 2, { 0u, 1u }, { 0.25f, 0.75f } },
+		};
+		const unsigned int material1Indices[] = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7, 8, 9, 10, 8, 10, 11 };
+
+		const ExpectedMaterial materials[] = {
+			{ "Skin", "tex/skin.png", material0Vertices, 12, material0Indices, 18 },
+			{ "Cloth", nullptr, material1Vertices, 12, material1Indices, 18 },
+		};
+
+		const ExpectedBone bones[] = {
+			{ "Hips", -1, 1, { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -0.5f, 0.0f, 1.0f } },
+			{ "Spine", 0, -1, { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.5f, 0.0f, 1.0f } },
+		};
+
+		const char* const animationName = "Walk";
+		const float animationTime = 1.0f;
+		const ExpectedFrame frames[] = {
+			{ 0.0f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.0416666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.999048222f, 0.0436193874f, 0.0f, 0.0f, -0.0436193874f, 0.999048222f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.0833333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.996194698f, 0.0871557427f, 0.0f, 0.0f, -0.0871557427f, 0.996194698f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.125f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.991444861f, 0.130526192f, 0.0f, 0.0f, -0.130526192f, 0.991444861f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.166666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.984807753f, 0.173648178f, 0.0f, 0.0f, -0.173648178f, 0.984807753f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.208333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.976296007f, 0.216439614f, 0.0f, 0.0f, -0.216439614f, 0.976296007f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.25f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.965925826f, 0.258819045f, 0.0f, 0.0f, -0.258819045f, 0.965925826f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.291666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.953716951f, 0.3007058f, 0.0f, 0.0f, -0.3007058f, 0.953716951f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.333333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.939692621f, 0.342020143f, 0.0f, 0.0f, -0.342020143f, 0.939692621f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.375f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.923879533f, 0.382683432f, 0.0f, 0.0f, -0.382683432f, 0.923879533f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.416666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.906307787f, 0.422618262f, 0.0f, 0.0f, -0.422618262f, 0.906307787f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.458333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.887010833f, 0.461748613f, 0.0f, 0.0f, -0.461748613f, 0.887010833f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.5f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.866025404f, 0.5f, 0.0f, 0.0f, -0.5f, 0.866025404f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.541666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.819152044f, 0.573576436f, 0.0f, 0.0f, -0.573576436f, 0.819152044f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.583333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.766044443f, 0.64278761f, 0.0f, 0.0f, -0.64278761f, 0.766044443f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.625f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.707106781f, 0.707106781f, 0.0f, 0.0f, -0.707106781f, 0.707106781f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.666666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.64278761f, 0.766044443f, 0.0f, 0.0f, -0.766044443f, 0.64278761f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.708333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.573576436f, 0.819152044f, 0.0f, 0.0f, -0.819152044f, 0.573576436f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.75f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.5f, 0.866025404f, 0.0f, 0.0f, -0.866025404f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.791666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.422618262f, 0.906307787f, 0.0f, 0.0f, -0.906307787f, 0.422618262f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.833333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.342020143f, 0.939692621f, 0.0f, 0.0f, -0.939692621f, 0.342020143f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.875f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.258819045f, 0.965925826f, 0.0f, 0.0f, -0.965925826f, 0.258819045f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.916666667f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.173648178f, 0.984807753f, 0.0f, 0.0f, -0.984807753f, 0.173648178f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 0.958333333f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0871557427f, 0.996194698f, 0.0f, 0.0f, -0.996194698f, 0.0871557427f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+			{ 1.0f, { { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f } } },
+		};
+	} // namespace fixture
+} // namespace test
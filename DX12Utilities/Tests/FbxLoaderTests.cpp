@@ -0,0 +1,403 @@
+﻿#include "Test.h"
+#include "FbxFixtureExpected.h"
+#include "../Src/Lib/FbxLoader/NativeLoader.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+/*
+NativeLoader の読み込み結果を Data/ の FBX と FbxFixtureExpected.h の期待値で確認する
+	期待値は Data/MakeFbxFixtures.py がローダーとは別に double で計算したもの
+	バイナリ (7400 zlib / 7500 無圧縮) とアスキーで同じ結果になること、
+	キャッシュに書いて読み直しても同じ結果になることを確認する
+*/
+namespace test {
+	namespace {
+		using namespace FbxLoader;
+		using namespace fixture;
+
+		const float tolerance = 1e-5f;
+
+		std::string DataPath(const char* name) {
+			return std::string(MFF_TEST_DATA_DIR) + "/" + name;
+		}
+
+		bool Near(const float* a, const float* b, size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				if (!(fabsf(a[i] - b[i]) <= tolerance * (1.0f + fabsf(b[i])))) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		template<size_t N>
+		size_t CountOf(const ExpectedMaterial (&)[N]) { return N; }
+
+		void CheckMesh(const char* label, const std::vector<StaticMesh>& staticMeshes, const std::vector<SkinnedMesh>& skinnedMeshes) {
+			TEST_CHECK_MSG(staticMeshes.empty() && skinnedMeshes.size() == 1, "%s: static %zu, skinned %zu", label, staticMeshes.size(), skinnedMeshes.size());
+			if (skinnedMeshes.size() != 1) {
+				return;
+			}
+			const SkinnedMesh& mesh = skinnedMeshes[0];
+			TEST_CHECK_MSG(mesh.materials.size() == CountOf(materials), "%s: %zu materials", label, mesh.materials.size());
+			for (size_t m = 0; m < mesh.materials.size() && m < CountOf(materials); ++m) {
+				const Material<SkinnedVertex>& material = mesh.materials[m];
+				const ExpectedMaterial& expected = materials[m];
+				TEST_CHECK_MSG(material.name == expected.name, "%s: material %zu name %s", label, m, material.name.c_str());
+				const size_t textureCount = expected.texture ? 1 : 0;
+				TEST_CHECK_MSG(material.textureName.size() == textureCount && (!expected.texture || material.textureName[0] == expected.texture),
+					"%s: %s textures", label, expected.name);
+				TEST_CHECK_MSG(material.indeces.size() == expected.indexCount &&
+					std::equal(material.indeces.begin(), material.indeces.end(), expected.indices), "%s: %s indices", label, expected.name);
+				TEST_CHECK_MSG(material.verteces.size() == expected.vertexCount, "%s: %s has %zu vertices", label, expected.name, material.verteces.size());
+				for (size_t i = 0; i < material.verteces.size() && i < expected.vertexCount; ++i) {
+					const SkinnedVertex& v = material.verteces[i];
+					const ExpectedVertex& e = expected.vertices[i];
+					TEST_CHECK_MSG(Near(v.position.m, e.position, 3), "%s: %s vertex %zu position", label, expected.name, i);
+					TEST_CHECK_MSG(Near(v.normal.m, e.normal, 3), "%s: %s vertex %zu normal", label, expected.name, i);
+					TEST_CHECK_MSG(Near(v.texCoord.m, e.texCoord, 2), "%s: %s vertex %zu texCoord", label, expected.name, i);
+					TEST_CHECK_MSG(Near(v.color.m, e.color, 4), "%s: %s vertex %zu color", label, expected.name, i);
+					bool sameWeights = true;
+					for (int k = 0; k < e.influenceCount; ++k) {
+						sameWeights &= Near(&v.weights.m[k], &e.weights[k], 1) && v.boneIndex[k] == e.boneIndex[k];
+					}
+					//残りは weight 0
+					for (int k = e.influenceCount; k < 4; ++k) {
+						sameWeights &= v.weights.m[k] == 0.0f;
+					}
+					TEST_CHECK_MSG(sameWeights, "%s: %s vertex %zu weights", label, expected.name, i);
+				}
+			}
+		}
+
+		//LoadStaticMesh の結果 (スキンのあるメッシュを静的メッシュにしたもの)
+		void CheckStaticMesh(const char* label, const std::vector<StaticMesh>& meshes) {
+			TEST_CHECK_MSG(meshes.size() == 1, "%s: %zu meshes", label, meshes.size());
+			if (meshes.size() != 1) {
+				return;
+			}
+			const StaticMesh& mesh = meshes[0];
+			TEST_CHECK_MSG(mesh.materials.size() == CountOf(materials), "%s: %zu materials", label, mesh.materials.size());
+			for (size_t m = 0; m < mesh.materials.size() && m < CountOf(materials); ++m) {
+				const Material<StaticVertex>& material = mesh.materials[m];
+				bool same = material.verteces.size() == materials[m].vertexCount && material.indeces.size() == materials[m].indexCount &&
+					std::equal(material.indeces.begin(), material.indeces.end(), materials[m].indices);
+				for (size_t i = 0; same && i < material.verteces.size(); ++i) {
+					same = Near(material.verteces[i].position.m, materials[m].vertices[i].position, 3) &&
+						Near(material.verteces[i].normal.m, materials[m].vertices[i].normal, 3);
+				}
+				TEST_CHECK_MSG(same, "%s: %s", label, materials[m].name);
+			}
+		}
+
+		void CheckBone(const char* label, const BoneTreeData& tree) {
+			const size_t boneCount = sizeof(bones) / sizeof(bones[0]);
+			TEST_CHECK_MSG(tree.data.size() == boneCount, "%s: %zu bones", label, tree.data.size());
+			for (size_t b = 0; b < tree.data.size() && b < boneCount; ++b) {
+				const BoneData& bone = tree.data[b];
+				const ExpectedBone& expected = bones[b];
+				TEST_CHECK_MSG(bone.name == expected.name && bone.boneId == static_cast<int>(b) && bone.parentId == expected.parentId,
+					"%s: bone %zu is %s (id %d, parent %d)", label, b, bone.name.c_str(), bone.boneId, bone.parentId);
+				const size_t childCount = expected.child >= 0 ? 1 : 0;
+				TEST_CHECK_MSG(bone.children.size() == childCount && (childCount == 0 || bone.children[0] == expected.child),
+					"%s: %s has %zu children", label, expected.name, bone.children.size());
+				TEST_CHECK_MSG(Near(bone.baseInv.m, expected.baseInv, 16), "%s: %s baseInv", label, expected.name);
+			}
+		}
+
+		void CheckAnimation(const char* label, const std::vector<Animation>& animations) {
+			TEST_CHECK_MSG(animations.size() == 1, "%s: %zu animations", label, animations.size());
+			if (animations.size() != 1) {
+				return;
+			}
+			const Animation& animation = animations[0];
+			const size_t frameCount = sizeof(frames) / sizeof(frames[0]);
+			TEST_CHECK_MSG(animation.name == animationName && fabsf(animation.animationTime - animationTime) <= tolerance,
+				"%s: animation %s (%g s)", label, animation.name.c_str(), animation.animationTime);
+			TEST_CHECK_MSG(animation.boneAnimationData.size() == 2, "%s: %zu animated bones", label, animation.boneAnimationData.size());
+			for (size_t b = 0; b < animation.boneAnimationData.size() && b < 2; ++b) {
+				const auto& keys = animation.boneAnimationData[b].animDatas;
+				TEST_CHECK_MSG(keys.size() == frameCount, "%s: bone %zu has %zu keys", label, b, keys.size());
+				for (size_t f = 0; f < keys.size() && f < frameCount; ++f) {
+					TEST_CHECK_MSG(Near(&keys[f].first, &frames[f].time, 1) && Near(keys[f].second.m, frames[f].matrices[b], 16),
+						"%s: bone %zu frame %zu", label, b, f);
+				}
+			}
+		}
+
+		std::string ReadFile(const std::string& path) {
+			std::ifstream in(path, std::ios::binary);
+			return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		}
+
+		/*
+		無圧縮バイナリの fixture の KeyTime (3要素の 'l' 配列) を times に書き換えて dst に保存する
+		KeyTime が見つからなければ false
+		*/
+		bool WriteMutatedKeyTimes(const char* file, const std::string& dst, const int64_t (&times)[3]) {
+			std::string data = ReadFile(DataPath(file));
+			const std::string name = "KeyTime";
+			const size_t pos = data.find(name);
+			//名前の後は型 'l', 要素数, エンコーディング (0 = 無圧縮), バイト数, データ
+			const size_t header = pos + name.size();
+			if (pos == std::string::npos || header + 13 + sizeof(times) > data.size() || data[header] != 'l') {
+				return false;
+			}
+			uint32_t count = 0;
+			uint32_t encoding = 0;
+			memcpy(&count, &data[header + 1], sizeof(count));
+			memcpy(&encoding, &data[header + 5], sizeof(encoding));
+			if (count != 3 || encoding != 0) {
+				return false;
+			}
+			memcpy(&data[header + 13], times, sizeof(times));
+			std::ofstream out(dst, std::ios::binary);
+			out.write(data.data(), static_cast<std::streamsize>(data.size()));
+			return static_cast<bool>(out);
+		}
+
+		/*
+		キャッシュファイルのセクションの要素を書き換える (MeshCache.cpp の CacheHeader / CacheSection の配置に合わせる)
+		type のセクションの要素サイズが elementSize でなければ (形式が変わったら) false
+		*/
+		bool PatchCacheFloat(const std::string& file, uint32_t type, uint32_t elementSize, size_t element, size_t offset, float value) {
+			std::fstream io(file, std::ios::binary | std::ios::in | std::ios::out);
+			const size_t headerSize = 48;
+			const size_t sectionSize = 24;
+			uint32_t sectionCount = 0;
+			io.seekg(40);
+			io.read(reinterpret_cast<char*>(&sectionCount), sizeof(sectionCount));
+			for (uint32_t i = 0; io && i < sectionCount; ++i) {
+				uint32_t section[2] = {};
+				uint64_t range[2] = {};
+				io.seekg(static_cast<std::streamoff>(headerSize + sectionSize * i));
+				io.read(reinterpret_cast<char*>(section), sizeof(section));
+				io.read(reinterpret_cast<char*>(range), sizeof(range));
+				if (section[0] != type) {
+					continue;
+				}
+				if (section[1] != elementSize || element >= range[1]) {
+					return false;
+				}
+				io.seekp(static_cast<std::streamoff>(range[0] + elementSize * element + offset));
+				io.write(reinterpret_cast<const char*>(&value), sizeof(value));
+				return static_cast<bool>(io);
+			}
+			return false;
+		}
+
+		template<typename Loader>
+		void CheckLoader(const char* label, Loader& loader) {
+			std::vector<StaticMesh> staticMeshes;
+			std::vector<SkinnedMesh> skinnedMeshes;
+			loader.LoadAllMesh(staticMeshes, skinnedMeshes);
+			CheckMesh(label, staticMeshes, skinnedMeshes);
+			BoneTreeData tree;
+			loader.LoadBone(tree);
+			CheckBone(label, tree);
+			std::vector<Animation> animations;
+			loader.LoadAnimation(animations);
+			CheckAnimation(label, animations);
+		}
+	} // namespace
+
+	void RegisterFbxLoaderTests() {
+		for (const char* file : fixtureFiles) {
+			AddTest("FbxLoader", (std::string("native/") + file).c_str(), [file]() {
+				NativeLoader loader;
+				const bool initialized = loader.Initialize(DataPath(file));
+				TEST_CHECK_MSG(initialized, "%s: Initialize", file);
+				if (initialized) {
+					CheckLoader(file, loader);
+				}
+			});
+		}
+
+		//1回目は FBX を読んでキャッシュを書き、2回目はキャッシュから読む
+		AddTest("FbxLoader", "native/cache", []() {
+			for (const char* file : fixtureFiles) {
+				const std::string cacheFile = std::string(MFF_TEST_OUTPUT_DIR) + "/" + file + ".cache";
+				remove(cacheFile.c_str());
+				for (int pass = 0; pass < 2; ++pass) {
+					NativeLoader loader;
+					const bool initialized = loader.Initialize(DataPath(file), cacheFile);
+					TEST_CHECK_MSG(initialized && (pass == 0 || loader.GetCache()), "%s: pass %d", file, pass);
+					if (initialized) {
+						CheckLoader((std::string(file) + (pass == 0 ? " (write)" : " (cache)")).c_str(), loader);
+					}
+				}
+				remove(cacheFile.c_str());
+			}
+		});
+
+		//LoadStaticMesh はスキンのあるメッシュも静的メッシュとして返す (キャッシュから読んでいても同じ)
+		AddTest("FbxLoader", "native/static-mesh", []() {
+			const char* file = fixtureFiles[0];
+			const std::string cacheFile = std::string(MFF_TEST_OUTPUT_DIR) + "/" + file + ".static.cache";
+			remove(cacheFile.c_str());
+			std::vector<StaticMesh> results[3];
+			for (int pass = 0; pass < 3; ++pass) {
+				NativeLoader loader;
+				const bool initialized = pass == 0 ? loader.Initialize(DataPath(file)) : loader.Initialize(DataPath(file), cacheFile);
+				TEST_CHECK_MSG(initialized && (pass < 2 || loader.GetCache()), "pass %d", pass);
+				//前の中身は置き換える
+				results[pass].resize(2);
+				loader.LoadStaticMesh(results[pass]);
+				if (pass == 2) {
+					std::vector<SkinnedMesh> skinnedMeshes;
+					loader.LoadSkinnedMesh(skinnedMeshes);
+					TEST_CHECK_MSG(loader.GetCache() && skinnedMeshes.size() == 1, "cache stays open after LoadStaticMesh");
+				}
+			}
+			remove(cacheFile.c_str());
+			for (int pass = 0; pass < 3; ++pass) {
+				CheckStaticMesh((std::string("pass ") + std::to_string(pass)).c_str(), results[pass]);
+			}
+		});
+
+		//BuildMeshes をスレッドプールで動かしても (0 はハードウェアスレッド数) 1スレッドと同じ結果になる
+		AddTest("FbxLoader", "native/threads", []() {
+			const int threadCounts[] = { 1, 4, 7, 0 };
+			for (const char* file : fixtureFiles) {
+				for (int threadCount : threadCounts) {
+					const std::string label = std::string(file) + " (" + std::to_string(threadCount) + " threads)";
+					NativeLoader loader;
+					loader.SetThreadCount(threadCount);
+					const bool initialized = loader.Initialize(DataPath(file));
+					TEST_CHECK_MSG(initialized, "%s: Initialize", label.c_str());
+					if (!initialized) {
+						continue;
+					}
+					std::vector<StaticMesh> staticMeshes;
+					std::vector<SkinnedMesh> skinnedMeshes;
+					loader.LoadAllMesh(staticMeshes, skinnedMeshes);
+					CheckMesh(label.c_str(), staticMeshes, skinnedMeshes);
+					loader.LoadStaticMesh(staticMeshes);
+					CheckStaticMesh(label.c_str(), staticMeshes);
+				}
+			}
+		});
+
+		//SetOptimizeVertexCache の統計はキャッシュを書く時に Initialize の中で構築したものが残り、キャッシュから読んでも変わらない
+		AddTest("FbxLoader", "native/vertex-cache-reports", []() {
+			const char* file = fixtureFiles[0];
+			const std::string cacheFile = std::string(MFF_TEST_OUTPUT_DIR) + "/" + file + ".vcache.cache";
+			remove(cacheFile.c_str());
+			for (int pass = 0; pass < 3; ++pass) {
+				NativeLoader loader;
+				loader.SetOptimizeVertexCache(pass != 0);
+				const bool initialized = loader.Initialize(DataPath(file), cacheFile);
+				TEST_CHECK_MSG(initialized, "pass %d: Initialize", pass);
+				if (!initialized) {
+					continue;
+				}
+				const size_t expected = pass == 1 ? 1 : 0;
+				TEST_CHECK_MSG(loader.GetVertexCacheReports().size() == expected, "pass %d: %zu reports after Initialize", pass, loader.GetVertexCacheReports().size());
+				std::vector<StaticMesh> staticMeshes;
+				std::vector<SkinnedMesh> skinnedMeshes;
+				loader.LoadAllMesh(staticMeshes, skinnedMeshes);
+				const auto& reports = loader.GetVertexCacheReports();
+				TEST_CHECK_MSG(reports.size() == expected, "pass %d: %zu reports", pass, reports.size());
+				if (reports.size() == 1) {
+					TEST_CHECK_MSG(reports[0].isSkinned && reports[0].materials.size() == CountOf(materials), "pass %d: %zu materials", pass, reports[0].materials.size());
+				}
+			}
+			remove(cacheFile.c_str());
+		});
+
+		/*
+		壊れた KeyTime (時間順でない・int64 の端の値) でも未定義動作にならずに読めること (UBSan のビルドで確認する)
+		時間順でないカーブはキーなしとして扱い、時間順なら差が int64 に収まらなくても補間できる
+		*/
+		AddTest("FbxLoader", "native/corrupt-key-times", []() {
+			const int64_t mutations[][3] = {
+				{ 0, INT64_MAX, INT64_MIN },
+				{ 0, 0, 1 },
+				{ INT64_MIN, 1, INT64_MAX },
+			};
+			const std::string mutated = std::string(MFF_TEST_OUTPUT_DIR) + "/corrupt_key_times.fbx";
+			for (size_t i = 0; i < sizeof(mutations) / sizeof(mutations[0]); ++i) {
+				TEST_CHECK_MSG(WriteMutatedKeyTimes("cube_7500_raw.fbx", mutated, mutations[i]), "mutation %zu: KeyTime not found", i);
+				NativeLoader loader;
+				TEST_CHECK_MSG(loader.Initialize(mutated), "mutation %zu: Initialize", i);
+				std::vector<Animation> animations;
+				loader.LoadAnimation(animations);
+				TEST_CHECK_MSG(animations.size() == 1, "mutation %zu: %zu animations", i, animations.size());
+				bool finite = true;
+				size_t keyCount = 0;
+				for (const Animation& animation : animations) {
+					for (const auto& bone : animation.boneAnimationData) {
+						keyCount += bone.animDatas.size();
+						for (const auto& key : bone.animDatas) {
+							for (float v : key.second.m) {
+								finite &= isfinite(v) != 0;
+							}
+						}
+					}
+				}
+				TEST_CHECK_MSG(finite && keyCount == 2 * sizeof(frames) / sizeof(frames[0]), "mutation %zu: %zu keys", i, keyCount);
+			}
+			remove(mutated.c_str());
+		});
+
+		/*
+		アニメーションの時間が壊れたキャッシュは使わずに FBX を読み直す
+		(そのまま使うと BoneAnimationData::GetMat が範囲外を読んだり止まらなくなったりする)
+		*/
+		AddTest("FbxLoader", "native/corrupt-cache-times", []() {
+			//MeshCache.cpp の SectionAnimations / SectionTracks / SectionKeys とそのレコードの配置
+			struct Mutation {
+				const char* label;
+				uint32_t type;
+				uint32_t elementSize;
+				size_t element;
+				size_t offset;
+				float value;
+			};
+			const Mutation mutations[] = {
+				{ "animation time NaN", 11, 20, 0, 8, NAN },
+				{ "animation time negative", 11, 20, 0, 8, -1.0f },
+				{ "track time zero", 12, 16, 0, 8, 0.0f },
+				{ "track time infinite", 12, 16, 0, 8, INFINITY },
+				{ "first key after zero", 13, 68, 0, 0, 0.5f },
+				{ "keys out of order", 13, 68, 3, 0, -1.0f },
+				{ "key time NaN", 13, 68, 5, 0, NAN },
+			};
+			const char* file = fixtureFiles[0];
+			const std::string cacheFile = std::string(MFF_TEST_OUTPUT_DIR) + "/" + file + ".corrupt.cache";
+			for (const Mutation& mutation : mutations) {
+				remove(cacheFile.c_str());
+				{
+					NativeLoader writer;
+					TEST_CHECK_MSG(writer.Initialize(DataPath(file), cacheFile), "%s: write", mutation.label);
+				}
+				const std::string written = ReadFile(cacheFile);
+				TEST_CHECK_MSG(PatchCacheFloat(cacheFile, mutation.type, mutation.elementSize, mutation.element, mutation.offset, mutation.value) &&
+					ReadFile(cacheFile) != written, "%s: patch", mutation.label);
+				NativeLoader loader;
+				const bool initialized = loader.Initialize(DataPath(file), cacheFile);
+				//読み直した時はキャッシュを書き直すので、書き換える前と同じ内容に戻る
+				TEST_CHECK_MSG(initialized && ReadFile(cacheFile) == written, "%s: corrupt cache was used", mutation.label);
+				if (!initialized) {
+					continue;
+				}
+				std::vector<Animation> animations;
+				loader.LoadAnimation(animations);
+				CheckAnimation(mutation.label, animations);
+				for (Animation& animation : animations) {
+					for (auto& bone : animation.boneAnimationData) {
+						for (int i = 0; i < 8; ++i) {
+							bone.GetMat(animation.animationTime * i / 8);
+						}
+					}
+				}
+			}
+			remove(cacheFile.c_str());
+		});
+	}
+} // namespace test
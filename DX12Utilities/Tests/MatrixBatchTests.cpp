@@ -0,0 +1,281 @@
+﻿#include "Test.h"
+#include "../Src/Math/Batch/MatrixBatch.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+/*
+InverseMatrices / AffineInverseMatrices の精度
+	double の掃き出し法 (部分ピボット) の逆行列を基準にして、ノルム比の誤差を条件数で割った値を確認する
+		誤差 = max|out - ref| / max|ref|、条件数 = ||A||inf * ||A^-1||inf
+	in-place と 4の倍数でない個数、単体の Inverse / AffineInverse との一致も確認する
+*/
+namespace test {
+	namespace {
+		using namespace mff;
+
+		//誤差 / (条件数 * FLT_EPSILON) の上限
+		const double maxScaledError = 4.0;
+
+		struct Reference {
+			double inv[16];
+			double cond;
+		};
+
+		bool InverseReference(const Matrix4x4<float>& mat, Reference& ref) {
+			double a[4][8];
+			for (int r = 0; r < 4; ++r) {
+				for (int c = 0; c < 4; ++c) {
+					a[r][c] = mat.m[r * 4 + c];
+					a[r][c + 4] = r == c ? 1.0 : 0.0;
+				}
+			}
+			for (int col = 0; col < 4; ++col) {
+				int pivot = col;
+				for (int r = col + 1; r < 4; ++r) {
+					if (fabs(a[r][col]) > fabs(a[pivot][col])) {
+						pivot = r;
+					}
+				}
+				if (a[pivot][col] == 0.0) {
+					return false;
+				}
+				for (int c = 0; c < 8; ++c) {
+					std::swap(a[col][c], a[pivot][c]);
+				}
+				const double inv = 1.0 / a[col][col];
+				for (int c = 0; c < 8; ++c) {
+					a[col][c] *= inv;
+				}
+				for (int r = 0; r < 4; ++r) {
+					if (r != col) {
+						const double f = a[r][col];
+						for (int c = 0; c < 8; ++c) {
+							a[r][c] -= f * a[col][c];
+						}
+					}
+				}
+			}
+			double normA = 0, normInv = 0;
+			for (int r = 0; r < 4; ++r) {
+				double rowA = 0, rowInv = 0;
+				for (int c = 0; c < 4; ++c) {
+					ref.inv[r * 4 + c] = a[r][c + 4];
+					rowA += fabs(mat.m[r * 4 + c]);
+					rowInv += fabs(a[r][c + 4]);
+				}
+				normA = std::max(normA, rowA);
+				normInv = std::max(normInv, rowInv);
+			}
+			ref.cond = normA * normInv;
+			return true;
+		}
+
+		//誤差 / (条件数 * FLT_EPSILON)
+		double ScaledError(const Matrix4x4<float>& out, const Reference& ref) {
+			double maxDiff = 0, maxRef = 0;
+			for (int i = 0; i < 16; ++i) {
+				const double diff = fabs(static_cast<double>(out.m[i]) - ref.inv[i]);
+				//NaN も失敗にする
+				maxDiff = diff == diff ? std::max(maxDiff, diff) : INFINITY;
+				maxRef = std::max(maxRef, fabs(ref.inv[i]));
+			}
+			return maxDiff / maxRef / (ref.cond * FLT_EPSILON);
+		}
+
+		//double の行列の積 (直交行列を作る時に使う)
+		void Multiply(const double* a, const double* b, double* out) {
+			for (int r = 0; r < 4; ++r) {
+				for (int c = 0; c < 4; ++c) {
+					double sum = 0;
+					for (int k = 0; k < 4; ++k) {
+						sum += a[r * 4 + k] * b[k * 4 + c];
+					}
+					out[r * 4 + c] = sum;
+				}
+			}
+		}
+
+		//ランダムな4次元の直交行列 (ランダム行列のグラム・シュミット)
+		void RandomOrthogonal(Random& random, double* q) {
+			for (int r = 0; r < 4; ++r) {
+				for (;;) {
+					double v[4];
+					for (double& e : v) {
+						e = random.Range(-1, 1);
+					}
+					for (int k = 0; k < r; ++k) {
+						double dot = 0;
+						for (int c = 0; c < 4; ++c) {
+							dot += v[c] * q[k * 4 + c];
+						}
+						for (int c = 0; c < 4; ++c) {
+							v[c] -= dot * q[k * 4 + c];
+						}
+					}
+					const double len = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3]);
+					if (len > 0.1) {
+						for (int c = 0; c < 4; ++c) {
+							q[r * 4 + c] = v[c] / len;
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		//特異値が (1, 1, 1, smallest) の一般の行列 (条件数はおよそ 1 / smallest)
+		Matrix4x4<float> RandomGeneral(Random& random, double smallest) {
+			double u[16], v[16], us[16], m[16];
+			RandomOrthogonal(random, u);
+			RandomOrthogonal(random, v);
+			for (int r = 0; r < 4; ++r) {
+				for (int c = 0; c < 4; ++c) {
+					us[r * 4 + c] = u[r * 4 + c] * (c == 3 ? smallest : 1.0);
+				}
+			}
+			Multiply(us, v, m);
+			Matrix4x4<float> ret;
+			for (int i = 0; i < 16; ++i) {
+				ret.m[i] = static_cast<float>(m[i]);
+			}
+			return ret;
+		}
+
+		//回転・拡大縮小・平行移動 (最下行 0,0,0,1)。上側3x3の最小の拡大率が smallest
+		Matrix4x4<float> RandomAffine(Random& random, double smallest) {
+			//任意軸の回転 (Rodrigues) に列ごとの拡大率を掛ける
+			const double axis[3] = { random.Range(-1, 1), random.Range(-1, 1), random.Range(0.1f, 1) };
+			const double len = sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+			const double x = axis[0] / len, y = axis[1] / len, z = axis[2] / len;
+			const double angle = random.Range(0, 6.28f);
+			const double c = cos(angle), s = sin(angle), t = 1 - c;
+			const double rot[9] = {
+				t * x * x + c, t * x * y - s * z, t * x * z + s * y,
+				t * x * y + s * z, t * y * y + c, t * y * z - s * x,
+				t * x * z - s * y, t * y * z + s * x, t * z * z + c,
+			};
+			const double scale[3] = { random.Range(0.5f, 2), random.Range(0.5f, 2), smallest };
+			Matrix4x4<float> ret;
+			for (int r = 0; r < 3; ++r) {
+				for (int col = 0; col < 3; ++col) {
+					ret.m[r * 4 + col] = static_cast<float>(rot[r * 3 + col] * scale[col]);
+				}
+				ret.m[r * 4 + 3] = random.Range(-10, 10);
+			}
+			ret.m[12] = ret.m[13] = ret.m[14] = 0;
+			ret.m[15] = 1;
+			return ret;
+		}
+
+		void CheckInverse(const std::vector<Matrix4x4<float>>& src, bool affine, const char* label) {
+			std::vector<Matrix4x4<float>> dst(src.size());
+			if (affine) {
+				AffineInverseMatrices(src.data(), dst.data(), src.size());
+			}
+			else {
+				InverseMatrices(src.data(), dst.data(), src.size());
+			}
+			double worst = 0;
+			for (size_t i = 0; i < src.size(); ++i) {
+				Reference ref;
+				TEST_CHECK(InverseReference(src[i], ref));
+				const double error = ScaledError(dst[i], ref);
+				worst = std::max(worst, error);
+				TEST_CHECK_MSG(error <= maxScaledError, "%s[%zu]: error %.3g * cond %.3g * FLT_EPSILON", label, i, error, ref.cond);
+				if (affine) {
+					TEST_CHECK(dst[i].m[12] == 0.0f && dst[i].m[13] == 0.0f && dst[i].m[14] == 0.0f && dst[i].m[15] == 1.0f);
+				}
+			}
+			printf("    %s: worst %.3f * cond * FLT_EPSILON\n", label, worst);
+		}
+
+		//4の倍数でない個数を含む count 個ずつの in-place と単体版の結果
+		void CheckInPlaceAndScalar(const std::vector<Matrix4x4<float>>& src, bool affine) {
+			for (size_t count = 1; count <= 9; ++count) {
+				std::vector<Matrix4x4<float>> out(count), inPlace(src.begin(), src.begin() + count);
+				if (affine) {
+					AffineInverseMatrices(src.data(), out.data(), count);
+					AffineInverseMatrices(inPlace.data(), inPlace.data(), count);
+				}
+				else {
+					InverseMatrices(src.data(), out.data(), count);
+					InverseMatrices(inPlace.data(), inPlace.data(), count);
+				}
+				TEST_CHECK_MSG(memcmp(out.data(), inPlace.data(), count * sizeof(Matrix4x4<float>)) == 0, "in-place differs (count %zu)", count);
+				for (size_t i = 0; i < count; ++i) {
+					const Matrix4x4<float> scalar = affine ? AffineInverse(src[i]) : Inverse(src[i]);
+					for (int e = 0; e < 16; ++e) {
+						if (affine && e >= 12) {
+							continue;
+						}
+						//同じ式なので縮約 (FMA) の有無の差だけ許す
+						const float diff = fabsf(scalar.m[e] - out[i].m[e]);
+						TEST_CHECK_MSG(diff <= 1e-5f * std::max(1.0f, fabsf(scalar.m[e])), "scalar [%zu].m[%d] %.9g vs batch %.9g", i, e, scalar.m[e], out[i].m[e]);
+					}
+				}
+			}
+		}
+	} // namespace
+
+	void RegisterMatrixBatchTests() {
+		AddTest("MatrixBatch", "inverse/well-conditioned", []() {
+			Random random(1);
+			std::vector<Matrix4x4<float>> src;
+			for (int i = 0; i < 1001; ++i) {
+				src.push_back(RandomGeneral(random, random.Range(0.2f, 1)));
+			}
+			CheckInverse(src, false, "general");
+		});
+		AddTest("MatrixBatch", "inverse/near-singular", []() {
+			Random random(2);
+			for (double smallest : { 1e-2, 1e-3, 1e-4 }) {
+				std::vector<Matrix4x4<float>> src;
+				for (int i = 0; i < 257; ++i) {
+					src.push_back(RandomGeneral(random, smallest));
+				}
+				char label[32];
+				snprintf(label, sizeof(label), "smallest %g", smallest);
+				CheckInverse(src, false, label);
+			}
+		});
+		AddTest("MatrixBatch", "inverse/in-place", []() {
+			Random random(3);
+			std::vector<Matrix4x4<float>> src;
+			for (int i = 0; i < 9; ++i) {
+				src.push_back(RandomGeneral(random, i % 2 ? 1e-3 : 0.5));
+			}
+			CheckInPlaceAndScalar(src, false);
+		});
+		AddTest("MatrixBatch", "affine/well-conditioned", []() {
+			Random random(4);
+			std::vector<Matrix4x4<float>> src;
+			for (int i = 0; i < 1001; ++i) {
+				src.push_back(RandomAffine(random, random.Range(0.5f, 2)));
+			}
+			CheckInverse(src, true, "affine");
+		});
+		AddTest("MatrixBatch", "affine/near-singular", []() {
+			Random random(5);
+			for (double smallest : { 1e-2, 1e-3, 1e-4 }) {
+				std::vector<Matrix4x4<float>> src;
+				for (int i = 0; i < 257; ++i) {
+					src.push_back(RandomAffine(random, smallest));
+				}
+				char label[32];
+				snprintf(label, sizeof(label), "affine smallest %g", smallest);
+				CheckInverse(src, true, label);
+			}
+		});
+		AddTest("MatrixBatch", "affine/in-place", []() {
+			Random random(6);
+			std::vector<Matrix4x4<float>> src;
+			for (int i = 0; i < 9; ++i) {
+				src.push_back(RandomAffine(random, i % 2 ? 1e-3 : 1.0));
+			}
+			CheckInPlaceAndScalar(src, true);
+		});
+	}
+} // namespace test
@@ -0,0 +1,209 @@
+﻿#include "Test.h"
+#include "../Src/Lib/FbxLoader/MeshBuilder.h"
+#include <string.h>
+#include <string>
+#include <vector>
+
+/*
+BuildMesh の並列版が1スレッドの結果とバイト単位で一致することを確認する
+	入力は並列版に入る大きさ (角が 1 << 17 以上) で、統合の経路を一通り含むようにする
+		マテリアルの切り替えと範囲外のマテリアルインデックス、UV の継ぎ目、
+		1つのコントロールポイントに maxChain を超える頂点が付く扇 (ハッシュの表を使う)、
+		三角形の順序の入れ替え (コントロールポイントの範囲をまたいで角が並ぶ)、末尾の半端な角
+BuildMeshes の OptimizeVertexCache の統計が並べ替え前後のインデックスを AnalyzeVertexCache したものと一致することも確認する
+*/
+namespace test {
+	namespace {
+		using namespace FbxLoader;
+		using mff::Vector2;
+		using mff::Vector3;
+		using mff::Vector4;
+
+		MeshSource MakeSource(bool isSkinned) {
+			const int n = 160;
+			const int fanCount = 64;
+			const int fanSize = 48;
+			Random random(11);
+			MeshSource source;
+			source.name = isSkinned ? "skinned" : "static";
+			source.materials.resize(4);
+			for (size_t m = 0; m < source.materials.size(); ++m) {
+				source.materials[m].name = "material" + std::to_string(m);
+				source.materials[m].textureName.push_back("texture" + std::to_string(m) + ".png");
+			}
+			for (int y = 0; y <= n; ++y) {
+				for (int x = 0; x <= n; ++x) {
+					source.positions.push_back(Vector3<float>(static_cast<float>(x), static_cast<float>(y), random.Range(-1, 1)));
+				}
+			}
+
+			std::vector<std::vector<int>> triangles;
+			std::vector<std::vector<Vector2<float>>> triangleUvs;
+			std::vector<Vector3<float>> triangleNormals;
+			std::vector<int> triangleMaterials;
+			for (int y = 0; y < n; ++y) {
+				for (int x = 0; x < n; ++x) {
+					const int quad[2][3][2] = { { { x, y }, { x + 1, y }, { x + 1, y + 1 } }, { { x, y }, { x + 1, y + 1 }, { x, y + 1 } } };
+					for (const auto& triangle : quad) {
+						std::vector<int> cps;
+						std::vector<Vector2<float>> uvs;
+						for (const auto& p : triangle) {
+							float u = p[0] / static_cast<float>(n);
+							if (p[0] % 8 == 0) {
+								u = (x & 1) ? 1.0f : 0.0f;
+							}
+							cps.push_back(p[1] * (n + 1) + p[0]);
+							uvs.push_back(Vector2<float>(u, p[1] / static_cast<float>(n)));
+						}
+						triangles.push_back(cps);
+						triangleUvs.push_back(uvs);
+						triangleNormals.push_back(Vector3<float>(0, 0, 1));
+						//範囲外は0番として扱われる
+						const int material = (x / 16 + y / 16) % 5;
+						triangleMaterials.push_back(material == 4 ? -1 : material);
+					}
+				}
+			}
+			//扇の中心は格子の点を使い、法線は 8 通りに限って同じ頂点もまとめられるようにする
+			for (int fan = 0; fan < fanCount; ++fan) {
+				const int center = static_cast<int>(random.Next() % source.positions.size());
+				for (int i = 0; i < fanSize; ++i) {
+					const int a = static_cast<int>(random.Next() % source.positions.size());
+					const int b = static_cast<int>(random.Next() % source.positions.size());
+					triangles.push_back({ center, a, b });
+					triangleUvs.push_back({ Vector2<float>(), Vector2<float>(), Vector2<float>() });
+					const float k = static_cast<float>(random.Next() % 8);
+					triangleNormals.push_back(mff::Normalize(Vector3<float>(k, 1, 2)));
+					triangleMaterials.push_back(static_cast<int>(random.Next() % 2));
+				}
+			}
+
+			//三角形の順序を入れ替える
+			std::vector<size_t> order(triangles.size());
+			for (size_t i = 0; i < order.size(); ++i) {
+				order[i] = i;
+			}
+			for (size_t i = order.size(); i > 1; --i) {
+				std::swap(order[i - 1], order[random.Next() % i]);
+			}
+			for (size_t t : order) {
+				for (int c = 0; c < 3; ++c) {
+					source.cpIndices.push_back(triangles[t][c]);
+					source.texCoords.push_back(triangleUvs[t][c]);
+					source.normals.push_back(triangleNormals[t]);
+					source.colors.push_back(Vector4<float>(1, 1, triangleUvs[t][c].x, 1));
+					source.tangents.push_back(Vector4<float>(1, 0, 0, (t & 1) ? 1.0f : -1.0f));
+				}
+				source.materialIndices.push_back(triangleMaterials[t]);
+			}
+			//半端な角は使われない
+			source.cpIndices.push_back(0);
+			source.cpIndices.push_back(1);
+
+			if (isSkinned) {
+				source.cpWeights.resize(source.positions.size());
+				for (auto& w : source.cpWeights) {
+					for (int k = 0; k < 5; ++k) {
+						w.weights.push_back(std::make_pair(static_cast<int>(random.Next() % 32), static_cast<double>(random.Range(0.1f, 1.0f))));
+					}
+				}
+				LimitWeights(source.cpWeights);
+			}
+			return source;
+		}
+
+		template<typename Mesh>
+		void CheckSameMesh(const char* label, const Mesh& serial, const Mesh& parallel) {
+			TEST_CHECK_MSG(serial.name == parallel.name, "%s: name", label);
+			TEST_CHECK_MSG(serial.materials.size() == parallel.materials.size(), "%s: %zu / %zu materials", label, serial.materials.size(), parallel.materials.size());
+			for (size_t m = 0; m < serial.materials.size() && m < parallel.materials.size(); ++m) {
+				const auto& a = serial.materials[m];
+				const auto& b = parallel.materials[m];
+				TEST_CHECK_MSG(a.name == b.name && a.textureName == b.textureName, "%s: material %zu name", label, m);
+				TEST_CHECK_MSG(a.indeces.size() == b.indeces.size() &&
+					(a.indeces.empty() || memcmp(a.indeces.data(), b.indeces.data(), a.indeces.size() * sizeof(a.indeces[0])) == 0),
+					"%s: material %zu indices differ (%zu / %zu)", label, m, a.indeces.size(), b.indeces.size());
+				TEST_CHECK_MSG(a.verteces.size() == b.verteces.size() &&
+					(a.verteces.empty() || memcmp(a.verteces.data(), b.verteces.data(), a.verteces.size() * sizeof(a.verteces[0])) == 0),
+					"%s: material %zu vertices differ (%zu / %zu)", label, m, a.verteces.size(), b.verteces.size());
+			}
+		}
+
+		template<typename Mesh>
+		void CheckThreadCounts(bool isSkinned) {
+			const MeshSource source = MakeSource(isSkinned);
+			//MeshBuilder.cpp の parallelCornerCount 以上でないと並列版を通らない
+			TEST_CHECK_MSG(source.cpIndices.size() >= (1u << 17), "only %zu corners", source.cpIndices.size());
+			Mesh serial;
+			BuildMesh(source, serial, 1);
+			size_t vertexCount = 0;
+			size_t indexCount = 0;
+			for (const auto& material : serial.materials) {
+				vertexCount += material.verteces.size();
+				indexCount += material.indeces.size();
+			}
+			TEST_CHECK_MSG(indexCount == source.cpIndices.size() / 3 * 3 && vertexCount < indexCount,
+				"%s: %zu vertices for %zu indices", source.name.c_str(), vertexCount, indexCount);
+			const int threadCounts[] = { 4, 7 };
+			for (int threadCount : threadCounts) {
+				Mesh parallel;
+				BuildMesh(source, parallel, threadCount);
+				CheckSameMesh((source.name + " " + std::to_string(threadCount) + " threads").c_str(), serial, parallel);
+			}
+		}
+
+		template<typename VertType>
+		bool IsSameStatistics(const mff::VertexCacheStatistics& statistics, const Material<VertType>& material) {
+			const mff::VertexCacheStatistics expected = mff::AnalyzeVertexCache(material.indeces.data(), material.indeces.size(), material.verteces.size());
+			return statistics.transformCount == expected.transformCount && statistics.acmr == expected.acmr && statistics.atvr == expected.atvr;
+		}
+
+		//before は並べ替え前 (BuildMesh の結果)、after は BuildMeshes の結果と比べる
+		template<typename Mesh>
+		void CheckReport(const MeshVertexCacheReport& report, const Mesh& before, const Mesh& after, bool isSkinned) {
+			TEST_CHECK_MSG(report.name == before.name && report.isSkinned == isSkinned, "%s: report is for %s", before.name.c_str(), report.name.c_str());
+			TEST_CHECK_MSG(report.materials.size() == before.materials.size() && after.materials.size() == before.materials.size(),
+				"%s: %zu reports for %zu materials", before.name.c_str(), report.materials.size(), before.materials.size());
+			for (size_t m = 0; m < report.materials.size() && m < before.materials.size() && m < after.materials.size(); ++m) {
+				const VertexCacheReport& r = report.materials[m];
+				TEST_CHECK_MSG(IsSameStatistics(r.before, before.materials[m]) && IsSameStatistics(r.after, after.materials[m]),
+					"%s: material %zu statistics", before.name.c_str(), m);
+				TEST_CHECK_MSG(r.after.transformCount <= r.before.transformCount, "%s: material %zu transforms %zu -> %zu",
+					before.name.c_str(), m, r.before.transformCount, r.after.transformCount);
+			}
+		}
+	} // namespace
+
+	void RegisterMeshBuilderTests() {
+		AddTest("MeshBuilder", "parallel/static", []() {
+			CheckThreadCounts<StaticMesh>(false);
+		});
+		AddTest("MeshBuilder", "parallel/skinned", []() {
+			CheckThreadCounts<SkinnedMesh>(true);
+		});
+		AddTest("MeshBuilder", "build-meshes/vertex-cache-reports", []() {
+			std::vector<MeshSource> staticSources(1, MakeSource(false));
+			std::vector<MeshSource> skinnedSources(1, MakeSource(true));
+			StaticMesh staticBefore;
+			SkinnedMesh skinnedBefore;
+			BuildMesh(staticSources[0], staticBefore);
+			BuildMesh(skinnedSources[0], skinnedBefore);
+
+			std::vector<StaticMesh> staticMeshes;
+			std::vector<SkinnedMesh> skinnedMeshes;
+			std::vector<MeshVertexCacheReport> reports;
+			BuildMeshes(staticSources, staticMeshes, skinnedSources, skinnedMeshes, 2, true, &reports);
+			TEST_CHECK_MSG(reports.size() == 2 && staticMeshes.size() == 1 && skinnedMeshes.size() == 1, "%zu reports", reports.size());
+			if (reports.size() == 2 && staticMeshes.size() == 1 && skinnedMeshes.size() == 1) {
+				CheckReport(reports[0], staticBefore, staticMeshes[0], false);
+				CheckReport(reports[1], skinnedBefore, skinnedMeshes[0], true);
+			}
+
+			//並べ替えない時は空にする
+			staticSources.assign(1, MakeSource(false));
+			skinnedSources.clear();
+			BuildMeshes(staticSources, staticMeshes, skinnedSources, skinnedMeshes, 2, false, &reports);
+			TEST_CHECK_MSG(reports.empty(), "%zu reports without optimizeVertexCache", reports.size());
+		});
+	}
+} // namespace test
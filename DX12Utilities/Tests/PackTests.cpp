@@ -0,0 +1,292 @@
+﻿#include "Test.h"
+#include "../Src/Math/Batch/Pack.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+/*
+圧縮フォーマット変換の往復誤差と丸め
+	half は全 65536 値の復号を ldexp で作った値と比べ、符号化はその表から最近接 (同距離は仮数が偶数) を探した値と比べる
+	snorm/unorm/R10G10B10A2 は全ての整数値の往復が一致し、範囲内の float の往復誤差が半ステップ (0.5 / scale) と float の丸め以下であることを確認する
+	配列版は特殊値を含む入力で単体版とビット単位で一致することを確認する (4の倍数でない個数も含む)
+*/
+namespace test {
+	namespace {
+		using namespace mff;
+
+		uint32_t Bits(float v) {
+			return pack::ToBits(v);
+		}
+
+		bool IsHalfNan(uint16_t h) {
+			return (h & 0x7c00) == 0x7c00 && (h & 0x3ff) != 0;
+		}
+
+		//binary16 の値 (NaN は NaN)
+		double HalfReference(uint16_t h) {
+			const int exponent = (h >> 10) & 0x1f;
+			const int mantissa = h & 0x3ff;
+			double ret;
+			if (exponent == 0x1f) {
+				ret = mantissa ? NAN : INFINITY;
+			}
+			else if (exponent == 0) {
+				ret = ldexp(mantissa, -24);
+			}
+			else {
+				ret = ldexp(mantissa + 1024, exponent - 25);
+			}
+			return (h & 0x8000) ? -ret : ret;
+		}
+
+		//最近接偶数丸めの符号化 (正の有限値 0..0x7bff を二分探索して選ぶ)
+		uint16_t FloatToHalfReference(float v) {
+			if (v != v) {
+				return 0x7e00;
+			}
+			const uint16_t sign = (Bits(v) & 0x80000000u) ? 0x8000 : 0;
+			const double a = fabs(static_cast<double>(v));
+			//65504 と 65536 (次の値があれば) の中点以上は Inf
+			if (a >= 65520.0) {
+				return sign | 0x7c00;
+			}
+			//正の値は符号化と大小の順序が同じ
+			uint16_t lo = 0, hi = 0x7bff;
+			while (lo < hi) {
+				const uint16_t mid = static_cast<uint16_t>((lo + hi + 1) / 2);
+				if (HalfReference(mid) <= a) {
+					lo = mid;
+				}
+				else {
+					hi = static_cast<uint16_t>(mid - 1);
+				}
+			}
+			uint16_t ret = lo;
+			if (lo < 0x7bff) {
+				const double below = a - HalfReference(lo);
+				const double above = HalfReference(static_cast<uint16_t>(lo + 1)) - a;
+				if (above < below || (above == below && (lo & 1))) {
+					ret = static_cast<uint16_t>(lo + 1);
+				}
+			}
+			return sign | ret;
+		}
+
+		//整数 -> float -> 整数 の往復と、[lo, hi] の float の往復誤差
+		template<typename Int, typename Encode, typename Decode>
+		void CheckNormRoundTrip(const char* label, int minCode, int maxCode, float lo, float hi, float scale, Encode encode, Decode decode) {
+			for (int code = minCode; code <= maxCode; ++code) {
+				const float f = decode(static_cast<Int>(code));
+				//snorm の最小値 (-128, -32768) は -1 として読むので -127, -32767 に戻る
+				const int expected = code < -static_cast<int>(scale) ? -static_cast<int>(scale) : code;
+				TEST_CHECK_MSG(encode(f) == static_cast<Int>(expected), "%s: code %d -> %.9g -> %d", label, code, f, static_cast<int>(encode(f)));
+			}
+			Random random(7);
+			//半ステップ + scale 倍した時の float の丸め (整数部が16bit以下なので 2^-8 ステップ未満) + 復号の丸め
+			const float bound = (0.5f + 1.0f / 256.0f) / scale + FLT_EPSILON;
+			for (int i = 0; i < 100000; ++i) {
+				const float f = random.Range(lo, hi);
+				const float back = decode(encode(f));
+				TEST_CHECK_MSG(fabsf(back - f) <= bound, "%s: %.9g -> %.9g", label, f, back);
+			}
+			TEST_CHECK_MSG(encode(hi * 2) == encode(hi) && encode(lo * 2 - 1) == encode(lo), "%s: clamp", label);
+			TEST_CHECK_MSG(encode(NAN) == 0, "%s: NaN", label);
+		}
+
+		//特殊値とランダムなビット列を混ぜた入力
+		std::vector<float> SpecialFloats(size_t count, uint32_t seed) {
+			const float specials[] = { 0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 65504.0f, 65520.0f, 1e10f, -1e10f, INFINITY, -INFINITY, NAN, -NAN,
+				5.96046448e-8f, 2.98023224e-8f, 6.10351562e-5f, 1e-45f, 2.0f, -2.0f, 0.99999994f };
+			Random random(seed);
+			std::vector<float> ret;
+			for (size_t i = 0; i < count; ++i) {
+				if (i < sizeof(specials) / sizeof(specials[0])) {
+					ret.push_back(specials[i]);
+				}
+				else if (i % 3 == 0) {
+					ret.push_back(pack::FromBits(random.Next()));
+				}
+				else {
+					ret.push_back(random.Range(-1.5f, 1.5f));
+				}
+			}
+			return ret;
+		}
+
+		//配列版と単体版を count = 0..max で比べる
+		template<typename Src, typename Dst, typename Batch, typename Single>
+		void CheckBatch(const char* label, const std::vector<Src>& src, Batch batch, Single single) {
+			//全バイト 0xcd の値 (Vector4 などはコンストラクタがあるのでバイト列から memcpy で作る)
+			unsigned char bytes[sizeof(Dst)];
+			memset(bytes, 0xcd, sizeof(bytes));
+			Dst sentinel;
+			memcpy(&sentinel, bytes, sizeof(Dst));
+			for (size_t count : { static_cast<size_t>(0), static_cast<size_t>(1), static_cast<size_t>(3), static_cast<size_t>(5),
+				static_cast<size_t>(7), static_cast<size_t>(15), static_cast<size_t>(17), src.size() }) {
+				//末尾の1要素は書き込まれないことを確認する
+				std::vector<Dst> dst(count + 1, sentinel), expected(count + 1, sentinel);
+				batch(src.data(), dst.data(), count);
+				for (size_t i = 0; i < count; ++i) {
+					expected[i] = single(src[i]);
+				}
+				TEST_CHECK_MSG(memcmp(dst.data(), expected.data(), dst.size() * sizeof(Dst)) == 0, "%s: batch differs from scalar (count %zu)", label, count);
+			}
+		}
+	} // namespace
+
+	void RegisterPackTests() {
+		AddTest("Pack", "half/exhaustive-round-trip", []() {
+			std::vector<uint16_t> all(65536);
+			for (uint32_t h = 0; h < 65536; ++h) {
+				all[h] = static_cast<uint16_t>(h);
+			}
+			std::vector<float> decoded(all.size());
+			HalfToFloat(all.data(), decoded.data(), all.size());
+			std::vector<uint16_t> encoded(all.size());
+			FloatToHalf(decoded.data(), encoded.data(), decoded.size());
+			for (uint32_t h = 0; h < 65536; ++h) {
+				const uint16_t half = static_cast<uint16_t>(h);
+				const float f = HalfToFloat(half);
+				const double ref = HalfReference(half);
+				if (IsHalfNan(half)) {
+					TEST_CHECK_MSG(f != f && decoded[h] != decoded[h], "0x%04x must decode to NaN", h);
+					TEST_CHECK_MSG(IsHalfNan(FloatToHalf(f)) && IsHalfNan(encoded[h]) && (FloatToHalf(f) & 0x8000) == (h & 0x8000), "0x%04x NaN round trip", h);
+					continue;
+				}
+				TEST_CHECK_MSG(static_cast<double>(f) == ref && Bits(f) == Bits(decoded[h]), "0x%04x -> %.9g (expected %.9g)", h, f, ref);
+				//-0 も含めてビット単位で戻る
+				TEST_CHECK_MSG(FloatToHalf(f) == half && encoded[h] == half, "0x%04x -> %.9g -> 0x%04x", h, f, FloatToHalf(f));
+			}
+		});
+		AddTest("Pack", "half/ties-to-even", []() {
+			//隣り合う有限の half の中点と、その前後1ulp
+			for (uint32_t h = 0; h < 0x7bff; ++h) {
+				const double mid = (HalfReference(static_cast<uint16_t>(h)) + HalfReference(static_cast<uint16_t>(h + 1))) * 0.5;
+				const float f = static_cast<float>(mid);
+				//中点は float で正確に表せる
+				TEST_CHECK(static_cast<double>(f) == mid);
+				const uint16_t even = static_cast<uint16_t>((h & 1) ? h + 1 : h);
+				for (float sign : { 1.0f, -1.0f }) {
+					const uint16_t signBit = sign < 0 ? 0x8000 : 0;
+					TEST_CHECK_MSG(FloatToHalf(f * sign) == (even | signBit), "tie %.9g -> 0x%04x (expected 0x%04x)", f * sign, FloatToHalf(f * sign), even | signBit);
+					TEST_CHECK_MSG(FloatToHalf(nextafterf(f, 0.0f) * sign) == (h | signBit), "below tie %.9g", f * sign);
+					TEST_CHECK_MSG(FloatToHalf(nextafterf(f, INFINITY) * sign) == ((h + 1) | signBit), "above tie %.9g", f * sign);
+				}
+			}
+			//ランダムな float と独立に作った参照を比べる
+			Random random(8);
+			for (int i = 0; i < 200000; ++i) {
+				const float f = i % 2 ? pack::FromBits(random.Next()) : random.Range(-70000.0f, 70000.0f) * (i % 5 ? 1.0f : 1e-6f);
+				const uint16_t expected = FloatToHalfReference(f);
+				const uint16_t actual = FloatToHalf(f);
+				if (f != f) {
+					TEST_CHECK_MSG(IsHalfNan(actual), "NaN 0x%08x -> 0x%04x", Bits(f), actual);
+					continue;
+				}
+				TEST_CHECK_MSG(actual == expected, "%.9g (0x%08x) -> 0x%04x (expected 0x%04x)", f, Bits(f), actual, expected);
+			}
+		});
+		AddTest("Pack", "half/overflow", []() {
+			TEST_CHECK(FloatToHalf(65504.0f) == 0x7bff);
+			//65520 は 65504 と 65536 の中点で、偶数側 (65536) に丸めると Inf
+			TEST_CHECK(FloatToHalf(nextafterf(65520.0f, 0.0f)) == 0x7bff);
+			TEST_CHECK(FloatToHalf(65520.0f) == 0x7c00);
+			TEST_CHECK(FloatToHalf(-65520.0f) == 0xfc00);
+			TEST_CHECK(FloatToHalf(1e10f) == 0x7c00);
+			TEST_CHECK(FloatToHalf(3.4e38f) == 0x7c00);
+			TEST_CHECK(FloatToHalf(INFINITY) == 0x7c00);
+			TEST_CHECK(FloatToHalf(-INFINITY) == 0xfc00);
+			TEST_CHECK(IsHalfNan(FloatToHalf(NAN)));
+			//最小の非正規化数の半分は 0 (偶数) に、それより大きければ最小の非正規化数になる
+			TEST_CHECK(FloatToHalf(ldexpf(1.0f, -25)) == 0x0000);
+			TEST_CHECK(FloatToHalf(nextafterf(ldexpf(1.0f, -25), 1.0f)) == 0x0001);
+			TEST_CHECK(FloatToHalf(-1e-45f) == 0x8000);
+			const float specials[] = { 65520.0f, -65520.0f, 1e10f, INFINITY, -INFINITY };
+			uint16_t batch[5];
+			FloatToHalf(specials, batch, 5);
+			TEST_CHECK(batch[0] == 0x7c00 && batch[1] == 0xfc00 && batch[2] == 0x7c00 && batch[3] == 0x7c00 && batch[4] == 0xfc00);
+		});
+		AddTest("Pack", "norm/round-trip", []() {
+			CheckNormRoundTrip<int8_t>("snorm8", -128, 127, -1.0f, 1.0f, 127.0f,
+				[](float v) { return FloatToSnorm8(v); }, [](int8_t v) { return Snorm8ToFloat(v); });
+			CheckNormRoundTrip<int16_t>("snorm16", -32768, 32767, -1.0f, 1.0f, 32767.0f,
+				[](float v) { return FloatToSnorm16(v); }, [](int16_t v) { return Snorm16ToFloat(v); });
+			CheckNormRoundTrip<uint8_t>("unorm8", 0, 255, 0.0f, 1.0f, 255.0f,
+				[](float v) { return FloatToUnorm8(v); }, [](uint8_t v) { return Unorm8ToFloat(v); });
+			CheckNormRoundTrip<uint16_t>("unorm16", 0, 65535, 0.0f, 1.0f, 65535.0f,
+				[](float v) { return FloatToUnorm16(v); }, [](uint16_t v) { return Unorm16ToFloat(v); });
+		});
+		AddTest("Pack", "1010102/round-trip", []() {
+			//各チャンネルの全ての値 (他のチャンネルは別の値にしてビットの混ざりも確認する)
+			for (uint32_t c = 0; c < 1024; ++c) {
+				const uint32_t packed = c | ((1023 - c) << 10) | (((c * 7) & 1023) << 20) | ((c & 3) << 30);
+				TEST_CHECK_MSG(PackUnorm1010102(UnpackUnorm1010102(packed)) == packed, "0x%08x", packed);
+			}
+			Random random(9);
+			for (int i = 0; i < 100000; ++i) {
+				const Vector4<float> v(random.Range(0, 1), random.Range(0, 1), random.Range(0, 1), random.Range(0, 1));
+				const Vector4<float> back = UnpackUnorm1010102(PackUnorm1010102(v));
+				for (int c = 0; c < 4; ++c) {
+					const float bound = (0.5f + 1.0f / 256.0f) / (c < 3 ? 1023.0f : 3.0f) + FLT_EPSILON;
+					TEST_CHECK_MSG(fabsf(back.m[c] - v.m[c]) <= bound, "channel %d: %.9g -> %.9g", c, v.m[c], back.m[c]);
+				}
+			}
+			TEST_CHECK(PackUnorm1010102(Vector4<float>(2, -1, NAN, 5)) == (0x3ffu | (0u << 10) | (0u << 20) | (3u << 30)));
+		});
+		AddTest("Pack", "batch-matches-scalar", []() {
+			const std::vector<float> floats = SpecialFloats(1031, 10);
+			CheckBatch<float, uint16_t>("FloatToHalf", floats,
+				[](const float* s, uint16_t* d, size_t n) { FloatToHalf(s, d, n); }, [](float v) { return FloatToHalf(v); });
+			CheckBatch<float, int8_t>("FloatToSnorm8", floats,
+				[](const float* s, int8_t* d, size_t n) { FloatToSnorm8(s, d, n); }, [](float v) { return FloatToSnorm8(v); });
+			CheckBatch<float, int16_t>("FloatToSnorm16", floats,
+				[](const float* s, int16_t* d, size_t n) { FloatToSnorm16(s, d, n); }, [](float v) { return FloatToSnorm16(v); });
+			CheckBatch<float, uint8_t>("FloatToUnorm8", floats,
+				[](const float* s, uint8_t* d, size_t n) { FloatToUnorm8(s, d, n); }, [](float v) { return FloatToUnorm8(v); });
+			CheckBatch<float, uint16_t>("FloatToUnorm16", floats,
+				[](const float* s, uint16_t* d, size_t n) { FloatToUnorm16(s, d, n); }, [](float v) { return FloatToUnorm16(v); });
+
+			std::vector<uint16_t> halfs(65536);
+			for (uint32_t i = 0; i < 65536; ++i) {
+				halfs[i] = static_cast<uint16_t>(i);
+			}
+			//NaN のビット列も比べる
+			CheckBatch<uint16_t, float>("HalfToFloat", halfs,
+				[](const uint16_t* s, float* d, size_t n) { HalfToFloat(s, d, n); }, [](uint16_t v) { return HalfToFloat(v); });
+			std::vector<int8_t> s8(256);
+			std::vector<uint8_t> u8(256);
+			for (int i = 0; i < 256; ++i) {
+				s8[i] = static_cast<int8_t>(i - 128);
+				u8[i] = static_cast<uint8_t>(i);
+			}
+			std::vector<int16_t> s16(65536);
+			for (int i = 0; i < 65536; ++i) {
+				s16[i] = static_cast<int16_t>(i - 32768);
+			}
+			CheckBatch<int8_t, float>("Snorm8ToFloat", s8,
+				[](const int8_t* s, float* d, size_t n) { Snorm8ToFloat(s, d, n); }, [](int8_t v) { return Snorm8ToFloat(v); });
+			CheckBatch<uint8_t, float>("Unorm8ToFloat", u8,
+				[](const uint8_t* s, float* d, size_t n) { Unorm8ToFloat(s, d, n); }, [](uint8_t v) { return Unorm8ToFloat(v); });
+			CheckBatch<int16_t, float>("Snorm16ToFloat", s16,
+				[](const int16_t* s, float* d, size_t n) { Snorm16ToFloat(s, d, n); }, [](int16_t v) { return Snorm16ToFloat(v); });
+			CheckBatch<uint16_t, float>("Unorm16ToFloat", halfs,
+				[](const uint16_t* s, float* d, size_t n) { Unorm16ToFloat(s, d, n); }, [](uint16_t v) { return Unorm16ToFloat(v); });
+
+			std::vector<Vector4<float>> colors;
+			for (size_t i = 0; i + 4 <= floats.size(); i += 4) {
+				colors.push_back(Vector4<float>(floats[i], floats[i + 1], floats[i + 2], floats[i + 3]));
+			}
+			CheckBatch<Vector4<float>, uint32_t>("PackUnorm1010102", colors,
+				[](const Vector4<float>* s, uint32_t* d, size_t n) { PackUnorm1010102(s, d, n); }, [](const Vector4<float>& v) { return PackUnorm1010102(v); });
+			std::vector<uint32_t> packed;
+			Random random(11);
+			for (int i = 0; i < 1031; ++i) {
+				packed.push_back(random.Next());
+			}
+			CheckBatch<uint32_t, Vector4<float>>("UnpackUnorm1010102", packed,
+				[](const uint32_t* s, Vector4<float>* d, size_t n) { UnpackUnorm1010102(s, d, n); }, [](uint32_t v) { return UnpackUnorm1010102(v); });
+		});
+	}
+} // namespace test
@@ -0,0 +1,99 @@
+﻿#include "Test.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+使い方
+	UnitTests [--list] [group...]
+	group を省略すると全てのテストを実行する
+*/
+namespace test {
+	namespace {
+		int failures = 0;
+		//1つのテストで出力する失敗の上限 (ループ内の失敗で埋まらないように)
+		const int maxReports = 20;
+	} // namespace
+
+	std::vector<Case>& Cases() {
+		static std::vector<Case> cases;
+		return cases;
+	}
+
+	void AddTest(const char* group, const char* name, std::function<void()> func) {
+		Cases().push_back(Case{ group, name, std::move(func) });
+	}
+
+	void Fail(const char* file, int line, const char* format, ...) {
+		++failures;
+		if (failures > maxReports) {
+			return;
+		}
+		const char* slash = strrchr(file, '/');
+		const char* backslash = strrchr(file, '\\');
+		const char* base = slash > backslash ? slash + 1 : (backslash ? backslash + 1 : file);
+		fprintf(stderr, "    %s(%d): ", base, line);
+		va_list args;
+		va_start(args, format);
+		vfprintf(stderr, format, args);
+		va_end(args);
+		fprintf(stderr, "\n");
+	}
+
+	int FailureCount() {
+		return failures;
+	}
+} // namespace test
+
+int main(int argc, char** argv) {
+	using namespace test;
+	RegisterMatrixBatchTests();
+	RegisterVectorStreamTests();
+	RegisterVectorAccuracyTests();
+	RegisterPackTests();
+	RegisterFbxLoaderTests();
+	RegisterMeshBuilderTests();
+
+	bool list = false;
+	std::vector<std::string> groups;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--list") == 0) {
+			list = true;
+		}
+		else {
+			groups.push_back(argv[i]);
+		}
+	}
+
+	int failedTests = 0;
+	int runTests = 0;
+	for (const Case& c : Cases()) {
+		bool selected = groups.empty();
+		for (const std::string& group : groups) {
+			selected |= group == c.group;
+		}
+		if (!selected) {
+			continue;
+		}
+		if (list) {
+			printf("%s/%s\n", c.group.c_str(), c.name.c_str());
+			continue;
+		}
+		failures = 0;
+		c.func();
+		++runTests;
+		if (failures > 0) {
+			++failedTests;
+			printf("FAIL %s/%s (%d)\n", c.group.c_str(), c.name.c_str(), failures);
+		}
+		else {
+			printf("ok   %s/%s\n", c.group.c_str(), c.name.c_str());
+		}
+		fflush(stdout);
+	}
+	if (!list && runTests == 0) {
+		fprintf(stderr, "no tests matched\n");
+		return 1;
+	}
+	return failedTests > 0 ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+﻿#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+mff 数学ライブラリと FbxLoader (SDK を使わない NativeLoader) の単体テスト
+	テストは group と name を付けて登録し、TEST_CHECK / TEST_CHECK_MSG で失敗を記録する
+	1つでも失敗すると終了コードが 1 になる
+	ctest はグループごとに UnitTests <group> を呼ぶ
+*/
+namespace test {
+	struct Case {
+		//"MatrixBatch" など (ctest の1テスト)
+		std::string group;
+		std::string name;
+		std::function<void()> func;
+	};
+
+	std::vector<Case>& Cases();
+	void AddTest(const char* group, const char* name, std::function<void()> func);
+
+	void RegisterMatrixBatchTests();
+	void RegisterVectorStreamTests();
+	void RegisterVectorAccuracyTests();
+	void RegisterPackTests();
+	void RegisterFbxLoaderTests();
+	void RegisterMeshBuilderTests();
+
+	//xorshift32 (入力データの生成用。再現性のため種は固定)
+	class Random {
+	public:
+		explicit Random(uint32_t seed) : state(seed ? seed : 1) {}
+
+		uint32_t Next() {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			return state;
+		}
+
+		//[lo, hi)
+		float Range(float lo, float hi) {
+			return lo + (hi - lo) * static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f);
+		}
+
+	private:
+		uint32_t state;
+	};
+
+	//失敗を記録する (実行は続ける)
+	void Fail(const char* file, int line, const char* format, ...);
+	//実行中のテストで記録した失敗の数
+	int FailureCount();
+} // namespace test
+
+#define TEST_CHECK(expr) \
+	do { \
+		if (!(expr)) { \
+			::test::Fail(__FILE__, __LINE__, "%s", #expr); \
+		} \
+	} while (0)
+
+//失敗時に printf 形式のメッセージを出す
+#define TEST_CHECK_MSG(expr, ...) \
+	do { \
+		if (!(expr)) { \
+			::test::Fail(__FILE__, __LINE__, __VA_ARGS__); \
+		} \
+	} while (0)
@@ -0,0 +1,48 @@
+﻿#include "Test.h"
+#include "../Src/Math/Vector/Vector2.h"
+#include "../Src/Math/Vector/Vector3.h"
+#include "../Src/Math/Vector/Vector4.h"
+#include <type_traits>
+
+/*
+混在型演算の結果型 (PrecisionType)
+	結果型はコンパイル時に確認する。double への暗黙の昇格になる組み合わせ (float と double、int と unsigned など) は
+	FloatPrecision ではコンパイルエラーになるのでここには書けない
+*/
+namespace test {
+	namespace {
+		using namespace mff;
+
+		template<typename T, typename U, typename Policy, typename Expected>
+		struct ExpectPrecision {
+			static_assert(std::is_same<typename Precision<Policy, T, U>::type, Expected>::value, "unexpected PrecisionType");
+			static const bool value = true;
+		};
+
+		static_assert(ExpectPrecision<float, int, FloatPrecision, float>::value, "");
+		static_assert(ExpectPrecision<unsigned int, float, FloatPrecision, float>::value, "");
+		static_assert(ExpectPrecision<float, size_t, FloatPrecision, float>::value, "");
+		static_assert(ExpectPrecision<int, double, FloatPrecision, double>::value, "");
+		static_assert(ExpectPrecision<char, int, FloatPrecision, int>::value, "");
+		static_assert(ExpectPrecision<int, int, FloatPrecision, int>::value, "");
+		static_assert(ExpectPrecision<unsigned int, unsigned int, FloatPrecision, unsigned int>::value, "");
+		static_assert(ExpectPrecision<float, double, AccuratePrecision, double>::value, "");
+		static_assert(ExpectPrecision<int, unsigned int, AccuratePrecision, double>::value, "");
+	} // namespace
+
+	void RegisterVectorAccuracyTests() {
+		AddTest("VectorAccuracy", "integer", []() {
+			//同じ整数型同士の演算はその型のまま
+			const Vector3<int> a(1, 2, 3);
+			const auto sum = a + a;
+			static_assert(std::is_same<decltype(sum), const Vector3<int>>::value, "int + int must stay int");
+			TEST_CHECK(sum.x == 2 && sum.y == 4 && sum.z == 6);
+			const auto mixed = Vector2<char>(1, 2) + Vector2<int>(10, 20);
+			static_assert(std::is_same<decltype(mixed), const Vector2<int>>::value, "char + int must be int");
+			TEST_CHECK(mixed.x == 11 && mixed.y == 22);
+			const auto scaled = Vector4<float>(1, 2, 3, 4) * 2;
+			static_assert(std::is_same<decltype(scaled), const Vector4<float>>::value, "float * int must be float");
+			TEST_CHECK(scaled.w == 8.0f);
+		});
+	}
+} // namespace test
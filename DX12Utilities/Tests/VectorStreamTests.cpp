@@ -0,0 +1,84 @@
+﻿#include "Test.h"
+#include "../Src/Math/Vector/VectorStream.h"
+#include <vector>
+
+/*
+VectorStream の要素ごとの演算
+	出力先が入力と同じストリームの場合と、出力先の要素数が入力と違う (確保し直しが起きる) 場合を確認する
+	切り上げ分が0のままであることも確認する
+*/
+namespace test {
+	namespace {
+		using namespace mff;
+
+		Vec3Stream MakeStream(size_t count, uint32_t seed) {
+			Random random(seed);
+			Vec3Stream ret(count);
+			for (size_t i = 0; i < count; ++i) {
+				ret.Set(i, Vector3<float>(random.Range(-1, 1), random.Range(-1, 1), random.Range(-1, 1)));
+			}
+			return ret;
+		}
+
+		bool IsPaddingZero(const Vec3Stream& s) {
+			for (int c = 0; c < 3; ++c) {
+				for (size_t i = s.Size(); i < s.Capacity(); ++i) {
+					if (s.Component(c)[i] != 0.0f) {
+						return false;
+					}
+				}
+			}
+			return true;
+		}
+
+		//a + b * 2 を1要素ずつ計算した値
+		bool IsAddScaled(const Vec3Stream& out, const Vec3Stream& a, const Vec3Stream& b) {
+			for (size_t i = 0; i < a.Size(); ++i) {
+				for (int c = 0; c < 3; ++c) {
+					if (out.Component(c)[i] != a.Component(c)[i] + b.Component(c)[i] * 2.0f) {
+						return false;
+					}
+				}
+			}
+			return out.Size() == a.Size() && IsPaddingZero(out);
+		}
+	} // namespace
+
+	void RegisterVectorStreamTests() {
+		AddTest("VectorStream", "aliasing", []() {
+			for (size_t count = 0; count <= 9; ++count) {
+				const Vec3Stream a = MakeStream(count, 1);
+				const Vec3Stream b = MakeStream(count, 2);
+				Vec3Stream b2;
+				Scale(b, 2.0f, b2);
+
+				Vec3Stream lhs = a;
+				Add(lhs, b2, lhs);
+				TEST_CHECK_MSG(IsAddScaled(lhs, a, b), "out == lhs (count %zu)", count);
+				Vec3Stream rhs = b2;
+				Add(a, rhs, rhs);
+				TEST_CHECK_MSG(IsAddScaled(rhs, a, b), "out == rhs (count %zu)", count);
+				Vec3Stream both = b;
+				MulAdd(both, MakeStream(count, 3), both, both);
+				TEST_CHECK_MSG(both.Size() == count && IsPaddingZero(both), "MulAdd out == a == c (count %zu)", count);
+			}
+		});
+		AddTest("VectorStream", "resize-output", []() {
+			for (size_t count = 0; count <= 9; ++count) {
+				const Vec3Stream a = MakeStream(count, 4);
+				const Vec3Stream b = MakeStream(count, 5);
+				Vec3Stream b2;
+				Scale(b, 2.0f, b2);
+				//大きいものから縮める・小さいものから広げる (切り上げ分は0になる)
+				for (size_t outCount : { static_cast<size_t>(0), count + 5, static_cast<size_t>(17) }) {
+					Vec3Stream out = MakeStream(outCount, 6);
+					Add(a, b2, out);
+					TEST_CHECK_MSG(IsAddScaled(out, a, b), "count %zu, out %zu", count, outCount);
+					Vec3Stream crossed = MakeStream(outCount, 7);
+					cross(a, b, crossed);
+					TEST_CHECK_MSG(crossed.Size() == count && IsPaddingZero(crossed), "cross count %zu, out %zu", count, outCount);
+				}
+			}
+		});
+	}
+} // namespace test